@@ -1,4 +1,18 @@
 #include "AiCrowd.hpp"
+#include <DetourCommon.h>
+#include <algorithm>
+#include <cstring>
+
+static_assert(sizeof(dtPolyRef) == sizeof(uint32_t), "DtCrowdAgentStates::targetRefs expects 32 bit poly refs");
+
+// Agent corridors hold this many polygons, see dtCrowd::init
+static const int MaxCorridorPolys = 256;
+
+static void CrowdParallelFor(void* userData, dtCrowdTaskFunc task, void* taskData, int count)
+{
+	WorkerPool* pool = (WorkerPool*)userData;
+	pool->ParallelFor(count, [&](int index, int worker) { task(taskData, index, worker); });
+}
 
 AiCrowd::AiCrowd()
 {
@@ -12,10 +26,13 @@ AiCrowd::~AiCrowd()
 
 int AiCrowd::Init(NavigationMesh * navmesh, int maxAgents, float maxRadius)
 {
+	m_navigation = navmesh;
 	m_navMesh = navmesh->GetNavmesh();
-	m_navQuery = navmesh->GetNavmeshQuery();
 
 	crowd->init(maxAgents, maxRadius, m_navMesh);
+	m_navQuery = crowd->getNavMeshQuery();
+	m_moveTargets.assign(maxAgents, MoveTarget());
+	m_fieldPath.resize(MaxCorridorPolys - 1);
 
 	dtObstacleAvoidanceParams params;
 	memcpy(&params, crowd->getObstacleAvoidanceParams(0), sizeof(dtObstacleAvoidanceParams));
@@ -53,12 +70,24 @@ int AiCrowd::Init(NavigationMesh * navmesh, int maxAgents, float maxRadius)
 	return 1;
 }
 
+// Moves the crowd to the snapshot the call runs on, agents keep their corridors since both snapshots share refs
+void AiCrowd::Bind(const NavigationSnapshot& snapshot)
+{
+	if (m_navMesh == snapshot.GetNavmesh())
+		return;
+	m_navMesh = snapshot.GetNavmesh();
+	crowd->setNavMesh(m_navMesh);
+}
+
 int AiCrowd::AddAgent(float3 position, DtAgentParams* agentParams)
 {
+	NavigationReadScope scope(m_navigation);
+	Bind(scope.Get());
 	const dtCrowdAgentParams ap = CreateParams(agentParams);
 	int id = crowd->addAgent(&position.x, &ap);
 	if (id != -1) {
-		activeAgentCount++;
+		m_moveTargets[id].ref = 0;
+		m_activeIndices.insert(std::lower_bound(m_activeIndices.begin(), m_activeIndices.end(), id), id);
 	}
 	return id;
 }
@@ -69,7 +98,8 @@ void AiCrowd::RemoveAgent(int idx)
 	if (ag->active)
 	{
 		crowd->removeAgent(idx);
-		activeAgentCount--;
+		m_moveTargets[idx].ref = 0;
+		m_activeIndices.erase(std::lower_bound(m_activeIndices.begin(), m_activeIndices.end(), idx));
 	}
 }
 
@@ -77,6 +107,16 @@ void AiCrowd::SetAgentParams(int idx, DtAgentParams* agentParams)
 {
 	const dtCrowdAgentParams ap = CreateParams(agentParams);
 	crowd->updateAgentParameters(idx, &ap);
+
+	// The filter may have changed, the next move request has to look the target up again
+	if (idx >= 0 && idx < (int)m_moveTargets.size())
+		m_moveTargets[idx].ref = 0;
+}
+
+void AiCrowd::SetAgentParamsBatch(const int* indices, DtAgentParams* agentParams, int count)
+{
+	for (int i = 0; i < count; ++i)
+		SetAgentParams(indices[i], &agentParams[i]);
 }
 
 void AiCrowd::GetAgentParams(int idx, DtAgentParams* agentParams)
@@ -91,6 +131,7 @@ void AiCrowd::GetAgentParams(int idx, DtAgentParams* agentParams)
 	agentParams->pathOptimizationRange = ag->params.pathOptimizationRange;
 	agentParams->obstacleAvoidanceType = ag->params.obstacleAvoidanceType;
 	agentParams->separationWeight = ag->params.separationWeight;
+	agentParams->queryFilterType = ag->params.queryFilterType;
 
 	agentParams->anticipateTurns = ag->params.updateFlags & DT_CROWD_ANTICIPATE_TURNS ? 1 : 0;
 	agentParams->optimizeVis = ag->params.updateFlags & DT_CROWD_OPTIMIZE_VIS ? 1 : 0;
@@ -101,9 +142,16 @@ void AiCrowd::GetAgentParams(int idx, DtAgentParams* agentParams)
 
 int AiCrowd::RequestMove(int idx, float3 position)
 {
+	const dtCrowdAgent* ag = crowd->getAgent(idx);
+	if (!ag || !ag->active)
+		return 0;
+
+	NavigationReadScope scope(m_navigation);
+	Bind(scope.Get());
+
 	dtPolyRef startPoly;
 	float m_targetPos[3];
-	const dtQueryFilter* filter = crowd->getFilter(0);
+	const dtQueryFilter* filter = crowd->getFilter(ag->params.queryFilterType);
 	const float* halfExtents = crowd->getQueryExtents();
 
 	dtStatus status;
@@ -111,43 +159,199 @@ int AiCrowd::RequestMove(int idx, float3 position)
 	if (dtStatusFailed(status)) {
 		return 0;
 	}
-	const dtCrowdAgent* ag = crowd->getAgent(idx);
-	if (ag && ag->active)
+
+	bool moveStatus = crowd->requestMoveTarget(idx, startPoly, m_targetPos);
+	m_moveTargets[idx].position = position;
+	m_moveTargets[idx].ref = moveStatus ? startPoly : 0;
+	return moveStatus ? 1 : 0;
+}
+
+// True when the agent is still on its way to the target last submitted at exactly this position
+bool AiCrowd::IsMovingTo(const dtCrowdAgent* ag, int idx, const float3& position)
+{
+	const MoveTarget& target = m_moveTargets[idx];
+	if (!target.ref || target.ref != ag->targetRef)
+		return false;
+	if (target.position.x != position.x || target.position.y != position.y || target.position.z != position.z)
+		return false;
+	return ag->targetState == DT_CROWDAGENT_TARGET_REQUESTING || ag->targetState == DT_CROWDAGENT_TARGET_WAITING_FOR_QUEUE
+		|| ag->targetState == DT_CROWDAGENT_TARGET_WAITING_FOR_PATH || ag->targetState == DT_CROWDAGENT_TARGET_VALID;
+}
+
+// Submits move requests for count agents with a single call. Agents already moving to the same target are skipped,
+// the remaining nearest poly lookups run in tile order and are shared between agents with the same target.
+// outStatus is optional and receives 1 for every agent that is moving to its target. Returns the number of such agents.
+int AiCrowd::RequestMoveBatch(const int* indices, const float3* targets, int count, int* outStatus)
+{
+	NavigationReadScope scope(m_navigation);
+	Bind(scope.Get());
+	int accepted = 0;
+	m_moveLookups.clear();
+	for (int i = 0; i < count; ++i)
 	{
-		bool moveStatus = crowd->requestMoveTarget(idx, startPoly, m_targetPos);
-		return moveStatus ? 1 : 0;
+		if (outStatus)
+			outStatus[i] = 0;
+
+		int idx = indices[i];
+		const dtCrowdAgent* ag = crowd->getAgent(idx);
+		if (!ag || !ag->active)
+			continue;
+
+		if (IsMovingTo(ag, idx, targets[i]))
+		{
+			if (outStatus)
+				outStatus[i] = 1;
+			accepted++;
+			continue;
+		}
+
+		MoveLookup lookup;
+		m_navMesh->calcTileLoc(&targets[i].x, &lookup.tx, &lookup.ty);
+		lookup.filter = ag->params.queryFilterType;
+		lookup.item = i;
+		m_moveLookups.push_back(lookup);
 	}
 
-	return 0;
-		
+	// Same tile lookups next to each other, identical targets adjacent within a tile
+	std::sort(m_moveLookups.begin(), m_moveLookups.end(), [targets](const MoveLookup& a, const MoveLookup& b)
+	{
+		if (a.ty != b.ty) return a.ty < b.ty;
+		if (a.tx != b.tx) return a.tx < b.tx;
+		if (a.filter != b.filter) return a.filter < b.filter;
+		const float3& pa = targets[a.item];
+		const float3& pb = targets[b.item];
+		if (pa.x != pb.x) return pa.x < pb.x;
+		if (pa.z != pb.z) return pa.z < pb.z;
+		if (pa.y != pb.y) return pa.y < pb.y;
+		return a.item < b.item;
+	});
+
+	const float* halfExtents = crowd->getQueryExtents();
+	const MoveLookup* previous = nullptr;
+	dtPolyRef ref = 0;
+	float nearest[3];
+	for (const MoveLookup& lookup : m_moveLookups)
+	{
+		const float3& target = targets[lookup.item];
+		bool shared = previous && previous->filter == lookup.filter && targets[previous->item].x == target.x
+			&& targets[previous->item].y == target.y && targets[previous->item].z == target.z;
+		if (!shared)
+		{
+			ref = 0;
+			if (dtStatusFailed(m_navQuery->findNearestPoly(&target.x, halfExtents, crowd->getFilter(lookup.filter), &ref, nearest)))
+				ref = 0;
+		}
+		previous = &lookup;
+
+		int idx = indices[lookup.item];
+		bool moveStatus = ref && crowd->requestMoveTarget(idx, ref, nearest);
+		m_moveTargets[idx].position = target;
+		m_moveTargets[idx].ref = moveStatus ? ref : 0;
+		if (moveStatus)
+		{
+			if (outStatus)
+				outStatus[lookup.item] = 1;
+			accepted++;
+		}
+	}
+
+	return accepted;
+}
+
+// Moves agents to the goal of a flow field. Each corridor is read from the field's next hops, no path request is
+// queued. Agents outside the field or off the mesh are left alone. Corridors longer than an agent can hold end
+// short of the goal and the crowd replans the rest when the agent gets there.
+// outStatus is optional and receives 1 for every agent that got a corridor. Returns the number of such agents.
+int AiCrowd::RequestMoveField(const int* indices, int count, const FlowField* field, int* outStatus)
+{
+	NavigationReadScope scope(m_navigation);
+	Bind(scope.Get());
+	int accepted = 0;
+	for (int i = 0; i < count; ++i)
+	{
+		if (outStatus)
+			outStatus[i] = 0;
+
+		int idx = indices[i];
+		dtCrowdAgent* ag = crowd->getEditableAgent(idx);
+		if (!ag || !ag->active || ag->state != DT_CROWDAGENT_STATE_WALKING)
+			continue;
+
+		int pathCount = 0;
+		if (!field->GetCorridor(ag->corridor.getFirstPoly(), m_fieldPath.data(), &pathCount, (int)m_fieldPath.size()))
+			continue;
+
+		float target[3];
+		dtVcopy(target, &field->GetGoalPos().x);
+		bool partial = m_fieldPath[pathCount - 1] != field->GetGoalRef();
+		if (partial && dtStatusFailed(m_navQuery->closestPointOnPoly(m_fieldPath[pathCount - 1], &field->GetGoalPos().x, target, nullptr)))
+			continue;
+
+		// Same state the crowd leaves an agent in once its path request completed
+		ag->corridor.setCorridor(target, m_fieldPath.data(), pathCount);
+		ag->boundary.reset();
+		ag->partial = partial;
+		ag->targetRef = field->GetGoalRef();
+		dtVcopy(ag->targetPos, &field->GetGoalPos().x);
+		ag->targetPathqRef = DT_PATHQ_INVALID;
+		ag->targetReplan = false;
+		ag->targetReplanTime = 0.0f;
+		ag->targetState = DT_CROWDAGENT_TARGET_VALID;
+
+		m_moveTargets[idx].position = field->GetGoalPos();
+		m_moveTargets[idx].ref = field->GetGoalRef();
+		if (outStatus)
+			outStatus[i] = 1;
+		accepted++;
+	}
+	return accepted;
 }
 
 void AiCrowd::GetActiveAgents(DtCrowdAgentsResult * result)
 {
 	int index = 0;
-	for (int i = 0; i < crowd->getAgentCount(); ++i)
+	for (int i : m_activeIndices)
 	{
-		const dtCrowdAgent* ag = crowd->getAgent(i);
-		if (!ag->active) continue;
-		
-		DtCrowdAgent ca = result->agents[index];
-		ca.active = ag->active ? 1 : 0;
-		ca.desiredSpeed = ag->desiredSpeed;
-		ca.partial = ag->partial ? 1 : 0;
-		ca.position.x = ag->npos[0];
-		ca.position.y = ag->npos[1];
-		ca.position.z = ag->npos[2];
-		
-		result->agents[index] = ca;
-
+		GetAgent(i, &result->agents[index]);
 		index++;
 	}
 	result->agentCount = index;
 }
 
+// Bulk readback of all active agents into caller provided arrays, one call per tick instead of one per agent.
+// Returns the number of agents written, at most states->capacity.
+int AiCrowd::GetAgentStates(DtCrowdAgentStates* states)
+{
+	int count = std::min((int)m_activeIndices.size(), states->capacity);
+	for (int i = 0; i < count; ++i)
+	{
+		int idx = m_activeIndices[i];
+		const dtCrowdAgent* ag = crowd->getAgent(idx);
+
+		if (states->indices)
+			states->indices[i] = idx;
+		if (states->positions)
+			states->positions[i] = { ag->npos[0], ag->npos[1], ag->npos[2] };
+		if (states->velocities)
+			states->velocities[i] = { ag->vel[0], ag->vel[1], ag->vel[2] };
+		if (states->desiredSpeeds)
+			states->desiredSpeeds[i] = ag->desiredSpeed;
+		if (states->states)
+			states->states[i] = ag->state;
+		if (states->partial)
+			states->partial[i] = ag->partial ? 1 : 0;
+		if (states->targetRefs)
+			states->targetRefs[i] = ag->targetRef;
+		if (states->corridorLengths)
+			states->corridorLengths[i] = ag->corridor.getPathCount();
+	}
+	states->count = count;
+	return count;
+}
+
 int AiCrowd::GetAgentCount()
 {
-	return activeAgentCount;
+	return (int)m_activeIndices.size();
 }
 
 void AiCrowd::GetAgent(int idx, DtCrowdAgent* result)
@@ -169,10 +373,42 @@ void AiCrowd::GetAgent(int idx, DtCrowdAgent* result)
 
 void AiCrowd::Update(const float dt)
 {
+	NavigationReadScope scope(m_navigation);
+	Bind(scope.Get());
 	//dtCrowdAgentDebugInfo debug;
 	crowd->update(dt, nullptr);
 }
 
+// Runs the per agent phases of Update on threadCount threads, the calling thread included.
+// A count of 1 or less returns to single threaded updates. Results do not depend on the thread count.
+int AiCrowd::SetThreadCount(int threadCount)
+{
+	crowd->setParallelFor(nullptr, nullptr, 1);
+	m_pool.reset();
+	if (threadCount <= 1)
+		return 1;
+
+	m_pool.reset(new WorkerPool(threadCount));
+	if (!crowd->setParallelFor(CrowdParallelFor, m_pool.get(), m_pool->GetWorkerCount()))
+	{
+		m_pool.reset();
+		return 0;
+	}
+	return 1;
+}
+
+// Copies the filter into one of the crowd's DT_CROWD_MAX_QUERY_FILTER_TYPE slots, agents select a slot with
+// queryFilterType. Later changes to the filter need another SetFilter, null restores the default filter.
+int AiCrowd::SetFilter(int filterType, const QueryFilter* filter)
+{
+	if (filterType < 0 || filterType >= DT_CROWD_MAX_QUERY_FILTER_TYPE)
+		return 0;
+
+	dtQueryFilter* slot = crowd->getEditableFilter(filterType);
+	*slot = filter ? *filter->Get() : dtQueryFilter();
+	return 1;
+}
+
 dtCrowdAgentParams AiCrowd::CreateParams(DtAgentParams* agentParams)
 {
 	dtCrowdAgentParams ap;
@@ -186,6 +422,7 @@ dtCrowdAgentParams AiCrowd::CreateParams(DtAgentParams* agentParams)
 	ap.pathOptimizationRange = agentParams->pathOptimizationRange;
 	ap.obstacleAvoidanceType = agentParams->obstacleAvoidanceType;
 	ap.separationWeight = agentParams->separationWeight;
+	ap.queryFilterType = (unsigned char)dtClamp(agentParams->queryFilterType, 0, DT_CROWD_MAX_QUERY_FILTER_TYPE - 1);
 
 	ap.updateFlags = 0;
 	if (agentParams->anticipateTurns)
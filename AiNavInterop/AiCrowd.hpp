@@ -1,14 +1,40 @@
 #pragma once
 #include <DetourCrowd.h>
+#include "FlowField.hpp"
 #include "NavigationMesh.hpp"
+#include "QueryFilter.hpp"
+#include "WorkerPool.hpp"
+#include <memory>
+#include <vector>
 
 class AiCrowd {
 private:
-	int activeAgentCount = 0;
+	// Last target submitted for an agent, ref is 0 when there is none
+	struct MoveTarget
+	{
+		float3 position;
+		dtPolyRef ref;
+	};
+	struct MoveLookup
+	{
+		int tx;
+		int ty;
+		int filter;
+		int item;
+	};
+
+	NavigationMesh* m_navigation = nullptr;
 	dtNavMesh* m_navMesh = nullptr;
-	dtNavMeshQuery* m_navQuery = nullptr;
+	const dtNavMeshQuery* m_navQuery = nullptr;
 	dtCrowd* crowd = nullptr;
+	std::unique_ptr<WorkerPool> m_pool;
+	std::vector<int> m_activeIndices;
+	std::vector<MoveTarget> m_moveTargets;
+	std::vector<MoveLookup> m_moveLookups;
+	std::vector<dtPolyRef> m_fieldPath;
+	void Bind(const NavigationSnapshot& snapshot);
 	dtCrowdAgentParams CreateParams(DtAgentParams* agentParams);
+	bool IsMovingTo(const dtCrowdAgent* ag, int idx, const float3& position);
 public:
 	AiCrowd();
 	~AiCrowd();
@@ -18,8 +44,14 @@ public:
 	void SetAgentParams(int idx, DtAgentParams* agentParams);
 	void GetAgentParams(int idx, DtAgentParams* agentParams);
 	int RequestMove(int idx, float3 position);
+	int RequestMoveBatch(const int* indices, const float3* targets, int count, int* outStatus);
+	int RequestMoveField(const int* indices, int count, const FlowField* field, int* outStatus);
+	void SetAgentParamsBatch(const int* indices, DtAgentParams* agentParams, int count);
 	int GetAgentCount();
 	void GetAgent(int idx, DtCrowdAgent* result);
 	void GetActiveAgents(DtCrowdAgentsResult* result);
+	int GetAgentStates(DtCrowdAgentStates* states);
 	void Update(const float dt);
+	int SetThreadCount(int threadCount);
+	int SetFilter(int filterType, const QueryFilter* filter);
 };
\ No newline at end of file
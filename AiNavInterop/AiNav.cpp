@@ -51,6 +51,31 @@ void SetSettings(NavigationBuilder* nav, DtBuildSettings* buildSettings)
 	nav->SetSettings(*buildSettings);
 }
 
+void SetBuildArena(NavigationBuilder* nav, int enabled, int initialSize)
+{
+	nav->SetArena(enabled != 0, initialSize > 0 ? (size_t)initialSize : 0);
+}
+
+void SetParallelRasterization(NavigationBuilder* nav, int enabled)
+{
+	nav->SetParallelRasterization(enabled != 0);
+}
+
+void SetParallelRegions(NavigationBuilder* nav, int enabled)
+{
+	nav->SetParallelRegions(enabled != 0);
+}
+
+int GetSimdSupport()
+{
+	return rcGetSimdSupport();
+}
+
+int SetSimdLevel(int level)
+{
+	return rcSetSimdLevel(level);
+}
+
 DtGeneratedData* BuildNavmesh(NavigationBuilder* nav,
 	float3* vertices, int numVertices,
 	int* indices, int numIndices, uint8_t* areas)
@@ -58,6 +83,21 @@ DtGeneratedData* BuildNavmesh(NavigationBuilder* nav,
 	return nav->BuildNavmesh(vertices, numVertices, indices, numIndices, areas);
 }
 
+int BuildNavmeshTiles(NavigationBuilder* nav, DtTileInput* inputs, int count, DtGeneratedData* outs)
+{
+	return nav->BuildNavmeshTiles(inputs, count, outs);
+}
+
+void FreeNavmeshData(DtGeneratedData* data)
+{
+	if (data->navmeshData)
+	{
+		dtFree(data->navmeshData);
+		data->navmeshData = nullptr;
+		data->navmeshDataLength = 0;
+	}
+}
+
 // Navmesh Query
 void* CreateNavmesh(float cellTileSize)
 {
@@ -80,11 +120,145 @@ int AddTile(NavigationMesh* navmesh, uint8_t* data, int dataLength)
 	return navmesh->LoadTile(data, dataLength);
 }
 
+int AddTileOwned(NavigationMesh* navmesh, DtGeneratedData* data)
+{
+	return navmesh->LoadTileOwned(data);
+}
+
 int RemoveTile(NavigationMesh* navmesh, int2 tileCoordinate)
 {
 	return navmesh->RemoveTile(tileCoordinate);
 }
 
+int EnableClusterGraph(NavigationMesh* navmesh, int enabled)
+{
+	return navmesh->EnableClusterGraph(enabled);
+}
+
+int EnableConcurrentReads(NavigationMesh* navmesh, int enabled)
+{
+	return navmesh->EnableConcurrentReads(enabled);
+}
+
+// Tile packs
+
+int TilePackWrite(const char* path, uint8_t** tiles, int* tileLengths, int count)
+{
+	return TilePack::Write(path, tiles, tileLengths, count);
+}
+
+TilePack* TilePackOpen(const char* path)
+{
+	return TilePack::Open(path);
+}
+
+void TilePackClose(TilePack* pack)
+{
+	// Tiles still resident in a navmesh keep the mapping alive until they are removed
+	pack->Release();
+}
+
+int TilePackGetTileCount(TilePack* pack)
+{
+	return pack->GetTileCount();
+}
+
+int TilePackGetTileLocation(TilePack* pack, int index, int* x, int* y, int* layer)
+{
+	const TilePackEntry* entry = pack->GetEntry(index);
+	if (!entry)
+		return 0;
+	*x = entry->x;
+	*y = entry->y;
+	*layer = entry->layer;
+	return 1;
+}
+
+int AddTileFromPack(NavigationMesh* navmesh, TilePack* pack, int x, int y, int layer)
+{
+	int index = pack->FindTile(x, y, layer);
+	if (index < 0)
+		return 0;
+	return navmesh->LoadTileFromPack(pack, index);
+}
+
+int AddAllTilesFromPack(NavigationMesh* navmesh, TilePack* pack)
+{
+	int added = 0;
+	for (int i = 0; i < pack->GetTileCount(); ++i)
+		added += navmesh->LoadTileFromPack(pack, i);
+	return added;
+}
+
+// Tile residency
+
+TileResidencyManager* ResidencyCreate(NavigationMesh* navmesh)
+{
+	return new TileResidencyManager(navmesh);
+}
+
+void ResidencyDestroy(TileResidencyManager* residency)
+{
+	delete residency;
+}
+
+void ResidencySetPackSource(TileResidencyManager* residency, TilePack* pack)
+{
+	residency->SetPackSource(pack);
+}
+
+void ResidencySetCallbackSource(TileResidencyManager* residency, TileSourceCallback callback, void* userData)
+{
+	residency->SetCallbackSource(callback, userData);
+}
+
+void ResidencySetFocus(TileResidencyManager* residency, DtResidencyFocus* focus, int count)
+{
+	residency->SetFocus(focus, count);
+}
+
+int ResidencyUpdate(TileResidencyManager* residency, float budgetMs, int budgetBytes)
+{
+	return residency->Update(budgetMs, budgetBytes);
+}
+
+int ResidencyGetResidentCount(TileResidencyManager* residency)
+{
+	return residency->GetResidentCount();
+}
+
+// Query filters
+
+QueryFilter* FilterCreate()
+{
+	return new QueryFilter();
+}
+
+void FilterDestroy(QueryFilter* filter)
+{
+	delete filter;
+}
+
+void FilterSetIncludeFlags(QueryFilter* filter, int flags)
+{
+	filter->SetIncludeFlags((unsigned short)flags);
+}
+
+void FilterSetExcludeFlags(QueryFilter* filter, int flags)
+{
+	filter->SetExcludeFlags((unsigned short)flags);
+}
+
+int FilterSetAreaCost(QueryFilter* filter, int area, float cost)
+{
+	return filter->SetAreaCost(area, cost) ? 1 : 0;
+}
+
+float FilterGetAreaCost(QueryFilter* filter, int area)
+{
+	return filter->GetAreaCost(area);
+}
+
 // Query
 
 void* QueryCreate(NavigationMesh* navmesh, int maxNodes)
@@ -118,6 +292,11 @@ void QueryFindStraightPath(AiQuery* aiQuery, NavMeshPathfindQuery query, NavMesh
 	aiQuery->FindStraightPath(query, result);
 }
 
+void QueryFindStraightPathCorridor(AiQuery* aiQuery, NavMeshPathfindQuery query, NavMeshPathfindResult* result, NavMeshPathfindCorridor* corridor)
+{
+	aiQuery->FindStraightPath(query, result, corridor);
+}
+
 int QueryHasPath(AiQuery* aiQuery, NavMeshPathfindQuery query)
 {
 	return aiQuery->HasPath(query);
@@ -128,11 +307,21 @@ void QueryRaycast(AiQuery* aiQuery, NavMeshRaycastQuery query, NavMeshRaycastRes
 	aiQuery->Raycast(query, result);
 }
 
+int QueryRaycastBatch(AiQuery* aiQuery, float3* starts, float3* ends, dtPolyRef* startRefs, int count, float3 extent, dtPolyRef* visited, int maxVisited, NavMeshRaycastBatchResult* results)
+{
+	return aiQuery->RaycastBatch(starts, ends, startRefs, count, extent, visited, maxVisited, results);
+}
+
 int QuerySamplePosition(AiQuery* aiQuery, float3 point, float3 extent, float3* result)
 {
 	return aiQuery->SamplePosition(point, extent, result);
 }
 
+int QuerySamplePositionBatch(AiQuery* aiQuery, float3* points, float3* extents, int count, float3* outPos, dtPolyRef* outRef)
+{
+	return aiQuery->SamplePositionBatch(points, extents, count, outPos, outRef);
+}
+
 int QueryGetRandomPosition(AiQuery* aiQuery, float3* result)
 {
 	return aiQuery->GetRandomPosition(result);
@@ -143,6 +332,83 @@ int QueryGetLocation(AiQuery* aiQuery, float3 point, float3 extent, float3* resu
 	return aiQuery->GetLocation(point, extent, result);
 }
 
+int QueryGetIsland(AiQuery* aiQuery, float3 point, float3 extent)
+{
+	return aiQuery->GetIsland(point, extent);
+}
+
+int QueryEnablePathCache(AiQuery* aiQuery, int capacity)
+{
+	return aiQuery->EnablePathCache(capacity);
+}
+
+void QueryGetPathCacheStats(AiQuery* aiQuery, int* hits, int* misses)
+{
+	aiQuery->GetPathCacheStats(hits, misses);
+}
+
+void QuerySetFilter(AiQuery* aiQuery, QueryFilter* filter)
+{
+	aiQuery->SetFilter(filter);
+}
+
+// Path service
+
+PathService* PathServiceCreate(NavigationMesh* navmesh, int workerCount, int maxNodes, int capacity, int maxPathPoints)
+{
+	if (workerCount <= 0)
+		workerCount = WorkerPool::GetDefaultWorkerCount();
+	return new PathService(navmesh, workerCount, maxNodes, capacity, maxPathPoints);
+}
+
+void PathServiceDestroy(PathService* service)
+{
+	delete service;
+}
+
+uint32_t PathServiceRequest(PathService* service, NavMeshPathfindQuery query)
+{
+	return service->Request(query);
+}
+
+int PathServicePoll(PathService* service, uint32_t handle, NavMeshPathfindResult* result)
+{
+	return service->Poll(handle, result);
+}
+
+void PathServiceCancel(PathService* service, uint32_t handle)
+{
+	service->Cancel(handle);
+}
+
+int PathServiceGetPendingCount(PathService* service)
+{
+	return service->GetPendingCount();
+}
+
+// Flow field
+
+void* FlowFieldCreate(NavigationMesh* navmesh, int maxNodes)
+{
+	FlowField* field = new FlowField();
+	if (!field->Init(navmesh, maxNodes))
+	{
+		delete field;
+		field = nullptr;
+	}
+	return field;
+}
+
+void FlowFieldDestroy(FlowField* field)
+{
+	delete field;
+}
+
+int FlowFieldBuild(FlowField* field, float3 goal, float3 extent, float radius)
+{
+	return field->Build(goal, extent, radius);
+}
+
 // Crowd
 
 void* CrowdCreate(NavigationMesh* navmesh, int maxAgents, float maxAgentRadius)
@@ -166,6 +432,11 @@ void CrowdGetAgents(AiCrowd* crowd, DtCrowdAgentsResult* result)
 	crowd->GetActiveAgents(result);
 }
 
+int CrowdGetAgentStates(AiCrowd* crowd, DtCrowdAgentStates* states)
+{
+	return crowd->GetAgentStates(states);
+}
+
 void CrowdGetAgent(AiCrowd* crowd, int idx, DtCrowdAgent* result)
 {
 	crowd->GetAgent(idx, result);
@@ -196,6 +467,21 @@ int CrowdRequestMoveAgent(AiCrowd* crowd, int idx, float3 position)
 	return crowd->RequestMove(idx, position);
 }
 
+int CrowdRequestMoveBatch(AiCrowd* crowd, int* indices, float3* targets, int count, int* outStatus)
+{
+	return crowd->RequestMoveBatch(indices, targets, count, outStatus);
+}
+
+int CrowdRequestMoveField(AiCrowd* crowd, FlowField* field, int* indices, int count, int* outStatus)
+{
+	return crowd->RequestMoveField(indices, count, field, outStatus);
+}
+
+void CrowdSetAgentParamsBatch(AiCrowd* crowd, int* indices, DtAgentParams* agentParams, int count)
+{
+	crowd->SetAgentParamsBatch(indices, agentParams, count);
+}
+
 int CrowdGetAgentCount(AiCrowd* crowd)
 {
 	return crowd->GetAgentCount();
@@ -205,3 +491,13 @@ void CrowdUpdate(AiCrowd* crowd, const float dt)
 {
 	crowd->Update(dt);
 }
+
+int CrowdSetThreadCount(AiCrowd* crowd, int threadCount)
+{
+	return crowd->SetThreadCount(threadCount);
+}
+
+int CrowdSetFilter(AiCrowd* crowd, int filterType, QueryFilter* filter)
+{
+	return crowd->SetFilter(filterType, filter);
+}
@@ -4,8 +4,14 @@
 #include "NavigationMesh.hpp"
 #include "AiCrowd.hpp"
 #include "AiQuery.hpp"
+#include "FlowField.hpp"
+#include "PathService.hpp"
+#include "QueryFilter.hpp"
+#include "TileResidency.hpp"
 
-#ifdef AINAV_EXPORTS
+#if !defined(_WIN32)
+#define AINAV_API __attribute__((visibility("default")))
+#elif defined(AINAV_EXPORTS)
 #define AINAV_API __declspec(dllexport)
 #else
 #define AINAV_API __declspec(dllimport)
@@ -19,23 +25,73 @@ extern "C" AINAV_API void TestReturnArray(DtCrowdAgentsResult * result);
 extern "C" AINAV_API NavigationBuilder * CreateBuilder();
 extern "C" AINAV_API void DestroyBuilder(NavigationBuilder * nav);
 extern "C" AINAV_API void SetSettings(NavigationBuilder * nav, DtBuildSettings * buildSettings);
+extern "C" AINAV_API void SetBuildArena(NavigationBuilder * nav, int enabled, int initialSize);
+extern "C" AINAV_API void SetParallelRasterization(NavigationBuilder * nav, int enabled);
+extern "C" AINAV_API void SetParallelRegions(NavigationBuilder * nav, int enabled);
+extern "C" AINAV_API int GetSimdSupport();
+extern "C" AINAV_API int SetSimdLevel(int level);
 extern "C" AINAV_API DtGeneratedData * BuildNavmesh(NavigationBuilder * nav, float3 * vertices, int numVertices, int* indices, int numIndices, uint8_t* areas);
+extern "C" AINAV_API int BuildNavmeshTiles(NavigationBuilder * nav, DtTileInput * inputs, int count, DtGeneratedData * outs);
+extern "C" AINAV_API void FreeNavmeshData(DtGeneratedData * data);
 extern "C" AINAV_API void* CreateNavmesh(float cellTileSize);
 extern "C" AINAV_API void DestroyNavmesh(NavigationMesh * navmesh);
 extern "C" AINAV_API int AddTile(NavigationMesh * navmesh, uint8_t * data, int dataLength);
+extern "C" AINAV_API int AddTileOwned(NavigationMesh * navmesh, DtGeneratedData * data);
 extern "C" AINAV_API int RemoveTile(NavigationMesh * navmesh, int2 tileCoordinate);
+extern "C" AINAV_API int EnableClusterGraph(NavigationMesh * navmesh, int enabled);
+extern "C" AINAV_API int EnableConcurrentReads(NavigationMesh * navmesh, int enabled);
 
+extern "C" AINAV_API int TilePackWrite(const char* path, uint8_t * *tiles, int* tileLengths, int count);
+extern "C" AINAV_API TilePack * TilePackOpen(const char* path);
+extern "C" AINAV_API void TilePackClose(TilePack * pack);
+extern "C" AINAV_API int TilePackGetTileCount(TilePack * pack);
+extern "C" AINAV_API int TilePackGetTileLocation(TilePack * pack, int index, int* x, int* y, int* layer);
+extern "C" AINAV_API int AddTileFromPack(NavigationMesh * navmesh, TilePack * pack, int x, int y, int layer);
+extern "C" AINAV_API int AddAllTilesFromPack(NavigationMesh * navmesh, TilePack * pack);
+
+extern "C" AINAV_API TileResidencyManager * ResidencyCreate(NavigationMesh * navmesh);
+extern "C" AINAV_API void ResidencyDestroy(TileResidencyManager * residency);
+extern "C" AINAV_API void ResidencySetPackSource(TileResidencyManager * residency, TilePack * pack);
+extern "C" AINAV_API void ResidencySetCallbackSource(TileResidencyManager * residency, TileSourceCallback callback, void* userData);
+extern "C" AINAV_API void ResidencySetFocus(TileResidencyManager * residency, DtResidencyFocus * focus, int count);
+extern "C" AINAV_API int ResidencyUpdate(TileResidencyManager * residency, float budgetMs, int budgetBytes);
+extern "C" AINAV_API int ResidencyGetResidentCount(TileResidencyManager * residency);
+
+extern "C" AINAV_API QueryFilter * FilterCreate();
+extern "C" AINAV_API void FilterDestroy(QueryFilter * filter);
+extern "C" AINAV_API void FilterSetIncludeFlags(QueryFilter * filter, int flags);
+extern "C" AINAV_API void FilterSetExcludeFlags(QueryFilter * filter, int flags);
+extern "C" AINAV_API int FilterSetAreaCost(QueryFilter * filter, int area, float cost);
+extern "C" AINAV_API float FilterGetAreaCost(QueryFilter * filter, int area);
 
 extern "C" AINAV_API void* QueryCreate(NavigationMesh * navmesh, int maxNodes);
 extern "C" AINAV_API void QueryDestroy(AiQuery * aiQuery);
 extern "C" AINAV_API void QueryInvalidate(AiQuery * aiQuery);
 extern "C" AINAV_API int QueryIsValid(AiQuery * aiQuery);
 extern "C" AINAV_API void QueryFindStraightPath(AiQuery * aiQuery, NavMeshPathfindQuery query, NavMeshPathfindResult * result);
+extern "C" AINAV_API void QueryFindStraightPathCorridor(AiQuery * aiQuery, NavMeshPathfindQuery query, NavMeshPathfindResult * result, NavMeshPathfindCorridor * corridor);
 extern "C" AINAV_API int QueryHasPath(AiQuery * aiQuery, NavMeshPathfindQuery query);
 extern "C" AINAV_API void QueryRaycast(AiQuery * aiQuery, NavMeshRaycastQuery query, NavMeshRaycastResult * result);
+extern "C" AINAV_API int QueryRaycastBatch(AiQuery * aiQuery, float3 * starts, float3 * ends, dtPolyRef * startRefs, int count, float3 extent, dtPolyRef * visited, int maxVisited, NavMeshRaycastBatchResult * results);
 extern "C" AINAV_API int QuerySamplePosition(AiQuery * aiQuery, float3 point, float3 extent, float3 * result);
+extern "C" AINAV_API int QuerySamplePositionBatch(AiQuery * aiQuery, float3 * points, float3 * extents, int count, float3 * outPos, dtPolyRef * outRef);
 extern "C" AINAV_API int QueryGetRandomPosition(AiQuery * aiQuery, float3 * result);
 extern "C" AINAV_API int QueryGetLocation(AiQuery * aiQuery, float3 point, float3 extent, float3 * result);
+extern "C" AINAV_API int QueryGetIsland(AiQuery * aiQuery, float3 point, float3 extent);
+extern "C" AINAV_API int QueryEnablePathCache(AiQuery * aiQuery, int capacity);
+extern "C" AINAV_API void QueryGetPathCacheStats(AiQuery * aiQuery, int* hits, int* misses);
+extern "C" AINAV_API void QuerySetFilter(AiQuery * aiQuery, QueryFilter * filter);
+
+extern "C" AINAV_API PathService * PathServiceCreate(NavigationMesh * navmesh, int workerCount, int maxNodes, int capacity, int maxPathPoints);
+extern "C" AINAV_API void PathServiceDestroy(PathService * service);
+extern "C" AINAV_API uint32_t PathServiceRequest(PathService * service, NavMeshPathfindQuery query);
+extern "C" AINAV_API int PathServicePoll(PathService * service, uint32_t handle, NavMeshPathfindResult * result);
+extern "C" AINAV_API void PathServiceCancel(PathService * service, uint32_t handle);
+extern "C" AINAV_API int PathServiceGetPendingCount(PathService * service);
+
+extern "C" AINAV_API void* FlowFieldCreate(NavigationMesh * navmesh, int maxNodes);
+extern "C" AINAV_API void FlowFieldDestroy(FlowField * field);
+extern "C" AINAV_API int FlowFieldBuild(FlowField * field, float3 goal, float3 extent, float radius);
 
 extern "C" AINAV_API void* CrowdCreate(NavigationMesh * navmesh, int maxAgents, float maxAgentRadius);
 extern "C" AINAV_API void CrowdDestroy(AiCrowd * crowd);
@@ -45,6 +101,12 @@ extern "C" AINAV_API int CrowdGetAgentCount(AiCrowd * crowd);
 extern "C" AINAV_API void CrowdSetAgentParams(AiCrowd * crowd, int idx, DtAgentParams * agentParams);
 extern "C" AINAV_API void CrowdGetAgentParams(AiCrowd * crowd, int idx, DtAgentParams * agentParams);
 extern "C" AINAV_API int CrowdRequestMoveAgent(AiCrowd * crowd, int idx, float3 position);
+extern "C" AINAV_API int CrowdRequestMoveBatch(AiCrowd * crowd, int* indices, float3 * targets, int count, int* outStatus);
+extern "C" AINAV_API int CrowdRequestMoveField(AiCrowd * crowd, FlowField * field, int* indices, int count, int* outStatus);
+extern "C" AINAV_API void CrowdSetAgentParamsBatch(AiCrowd * crowd, int* indices, DtAgentParams * agentParams, int count);
 extern "C" AINAV_API void CrowdUpdate(AiCrowd * crowd, const float dt);
+extern "C" AINAV_API int CrowdSetThreadCount(AiCrowd * crowd, int threadCount);
+extern "C" AINAV_API int CrowdSetFilter(AiCrowd * crowd, int filterType, QueryFilter * filter);
 extern "C" AINAV_API void CrowdGetAgent(AiCrowd * crowd, int idx, DtCrowdAgent * result);
 extern "C" AINAV_API void CrowdGetAgents(AiCrowd * crowd, DtCrowdAgentsResult * result);
+extern "C" AINAV_API int CrowdGetAgentStates(AiCrowd * crowd, DtCrowdAgentStates * states);
@@ -1,6 +1,11 @@
 #include "NavigationMesh.hpp"
 #include "AiQuery.hpp"
 #include <DetourCommon.h>
+#include <cstdlib>
+#include <vector>
+
+// Corridor scratch reserved up front, the managed default for maxPathPoints
+static const int InitialPathPolys = 512;
 
 static float frand()
 {
@@ -15,12 +20,16 @@ AiQuery::~AiQuery()
 {
 	if (m_navQuery)
 		dtFreeNavMeshQuery(m_navQuery);
+	delete m_pathCache;
 }
 
 int AiQuery::Init(NavigationMesh* navmesh, int maxNodes)
 {
+	m_navigation = navmesh;
 	m_navMesh = navmesh->GetNavmesh();
 	m_navQuery = dtAllocNavMeshQuery();
+	m_maxNodes = maxNodes;
+	m_polys.resize(InitialPathPolys);
 
 	dtStatus status = m_navQuery->init(m_navMesh, maxNodes);
 	if (dtStatusFailed(status))
@@ -28,6 +37,55 @@ int AiQuery::Init(NavigationMesh* navmesh, int maxNodes)
 	return 1;
 }
 
+// Caches up to capacity corridors between FindStraightPath and HasPath calls, 0 disables the cache
+int AiQuery::EnablePathCache(int capacity)
+{
+	delete m_pathCache;
+	m_pathCache = nullptr;
+	if (capacity > 0)
+		m_pathCache = new PathCache(capacity);
+	return 1;
+}
+
+// Points the query at the snapshot the call runs on, the node pool is only cleared when it changed
+void AiQuery::Bind(const NavigationSnapshot& snapshot)
+{
+	if (m_navMesh == snapshot.GetNavmesh())
+		return;
+	m_navMesh = snapshot.GetNavmesh();
+	m_navQuery->init(m_navMesh, m_maxNodes);
+}
+
+dtPolyRef* AiQuery::GetPolyScratch(int maxPolys)
+{
+	if ((int)m_polys.size() < maxPolys)
+		m_polys.resize(maxPolys);
+	return m_polys.data();
+}
+
+// Filter used by calls that do not pass one with the query, null restores the default filter
+void AiQuery::SetFilter(const QueryFilter* filter)
+{
+	m_filter = filter;
+}
+
+// The filter passed with a query wins over the one set on this query, null when both use the default filter
+const QueryFilter* AiQuery::SelectFilter(const QueryFilter* filter) const
+{
+	return filter ? filter : m_filter;
+}
+
+const dtQueryFilter* AiQuery::GetDetourFilter(const QueryFilter* filter) const
+{
+	return filter ? filter->Get() : &m_defaultFilter;
+}
+
+void AiQuery::GetPathCacheStats(int* hits, int* misses)
+{
+	*hits = m_pathCache ? m_pathCache->GetHits() : 0;
+	*misses = m_pathCache ? m_pathCache->GetMisses() : 0;
+}
+
 void AiQuery::Invalidate()
 {
 	invalidated = 1;
@@ -43,12 +101,15 @@ int AiQuery::GetRandomPosition(float3* result)
 	if (invalidated == 1)
 		return 0;
 
+	NavigationReadScope scope(m_navigation);
+	Bind(scope.Get());
+
 	dtPolyRef startPoly;
 	float3 startPoint;
-	dtQueryFilter filter;
+	const dtQueryFilter* filter = GetDetourFilter(m_filter);
 	dtStatus status;
 
-	status = m_navQuery->findRandomPoint(&filter, frand, &startPoly, &startPoint.x);
+	status = m_navQuery->findRandomPoint(filter, frand, &startPoly, &startPoint.x);
 	if (dtStatusFailed(status)) {
 		return 0;
 	}
@@ -63,13 +124,16 @@ int AiQuery::SamplePosition(float3 point, float3 extent, float3* result)
 	if (invalidated == 1)
 		return 0;
 
+	NavigationReadScope scope(m_navigation);
+	Bind(scope.Get());
+
 	dtPolyRef startPoly;
 	float3 startPoint;
 
-	dtQueryFilter filter;
+	const dtQueryFilter* filter = GetDetourFilter(m_filter);
 	dtStatus status;
 
-	status = m_navQuery->findNearestPoly(&point.x, &extent.x, &filter, &startPoly, &startPoint.x);
+	status = m_navQuery->findNearestPoly(&point.x, &extent.x, filter, &startPoly, &startPoint.x);
 	if (dtStatusFailed(status) || !startPoly) {
 		return 0;
 	}
@@ -80,21 +144,61 @@ int AiQuery::SamplePosition(float3 point, float3 extent, float3* result)
 	return 1;
 }
 
+// Island of the polygon nearest to the point, equal ids mean a path exists. 0 when no polygon was found.
+int AiQuery::GetIsland(float3 point, float3 extent)
+{
+	if (invalidated == 1)
+		return 0;
+
+	NavigationReadScope scope(m_navigation);
+	Bind(scope.Get());
+
+	dtPolyRef poly;
+	float3 nearest;
+	dtStatus status = m_navQuery->findNearestPoly(&point.x, &extent.x, GetDetourFilter(m_filter), &poly, &nearest.x);
+	if (dtStatusFailed(status) || !poly)
+		return 0;
+
+	const NavigationIslands* islands = scope.Get().GetIslands();
+	return islands ? islands->GetIsland(poly) : 0;
+}
+
+// SamplePosition for count points in one call, the same result per point. outRef is optional and receives the polygon
+// of every point or 0 where none was found. Returns the number of points with a polygon.
+int AiQuery::SamplePositionBatch(const float3* points, const float3* extents, int count, float3* outPos, dtPolyRef* outRef)
+{
+	if (invalidated == 1)
+		return 0;
+
+	NavigationReadScope scope(m_navigation);
+	Bind(scope.Get());
+
+	if (!outRef)
+	{
+		m_batchRefs.resize(count);
+		outRef = m_batchRefs.data();
+	}
+	return m_nearestBatch.Run(m_navQuery, GetDetourFilter(m_filter), points, extents, count, outPos, outRef);
+}
+
 int AiQuery::GetLocation(float3 point, float3 extent, float3* result) {
 
 	if (invalidated == 1)
 		return 0;
 
+	NavigationReadScope scope(m_navigation);
+	Bind(scope.Get());
+
 	dtPolyRef startPoly;
 	float3 startPoint;
 
-	dtQueryFilter filter;
+	const dtQueryFilter* filter = GetDetourFilter(m_filter);
 	dtStatus status;
 
 	float npos[3];
 	bool overlay = false;
 
-	status = m_navQuery->findNearestPoly(&point.x, &extent.x, &filter, &startPoly, npos);
+	status = m_navQuery->findNearestPoly(&point.x, &extent.x, filter, &startPoly, npos);
 	if (dtStatusFailed(status) || !startPoly) {
 		return 0;
 	}
@@ -116,70 +220,110 @@ int AiQuery::HasPath(NavMeshPathfindQuery query)
 	if (invalidated == 1)
 		return 0;
 
+	NavigationReadScope scope(m_navigation);
+	Bind(scope.Get());
+
 	dtPolyRef startPoly, endPoly;
 	float3 startPoint, endPoint;
 
 	// Find the starting polygons and point on it to start from
-	dtQueryFilter filter;
+	const QueryFilter* custom = SelectFilter(query.filter);
+	const dtQueryFilter* filter = GetDetourFilter(custom);
+	const uint32_t filterId = custom ? custom->GetId() : 0;
 	dtStatus status;
-	status = m_navQuery->findNearestPoly(&query.source.x, &query.findNearestPolyExtent.x, &filter, &startPoly, &startPoint.x);
+	status = m_navQuery->findNearestPoly(&query.source.x, &query.findNearestPolyExtent.x, filter, &startPoly, &startPoint.x);
 	if (dtStatusFailed(status))
 		return 0;
-	status = m_navQuery->findNearestPoly(&query.target.x, &query.findNearestPolyExtent.x, &filter, &endPoly, &endPoint.x);
+	status = m_navQuery->findNearestPoly(&query.target.x, &query.findNearestPolyExtent.x, filter, &endPoly, &endPoint.x);
 	if (dtStatusFailed(status))
 		return 0;
 
-	std::vector<dtPolyRef> polys;
-	polys.resize(query.maxPathPoints);
+	// Polygons on different islands can never be connected
+	const NavigationIslands* islands = scope.Get().GetIslands();
+	if (islands && !islands->IsConnected(startPoly, endPoly))
+		return 0;
+
+	dtPolyRef* polys = GetPolyScratch(query.maxPathPoints);
 	int pathPointCount = 0;
+	if (m_pathCache && m_pathCache->Find(scope.Get(), startPoly, endPoly, filterId, polys, &pathPointCount, query.maxPathPoints))
+		return 1;
+
+	// Far apart polygons only need the abstract route, the graph is built with the default filter
+	const ClusterGraph* clusterGraph = custom ? nullptr : scope.Get().GetClusterGraph();
+	if (clusterGraph && clusterGraph->IsLongRange(startPoly, endPoly))
+		return clusterGraph->FindRoute(startPoly, &startPoint.x, endPoly, &endPoint.x, m_clusterSearch) ? 1 : 0;
+
 	status = m_navQuery->findPath(startPoly, endPoly, &startPoint.x, &endPoint.x,
-		&filter, polys.data(), &pathPointCount, polys.size());
+		filter, polys, &pathPointCount, query.maxPathPoints);
 	if (dtStatusFailed(status) || (status & DT_PARTIAL_RESULT) != 0)
 		return 0;
 
+	if (m_pathCache)
+		m_pathCache->Store(scope.Get(), startPoly, endPoly, filterId, polys, pathPointCount);
 	return 1;
 }
 
-void AiQuery::FindStraightPath(NavMeshPathfindQuery query, NavMeshPathfindResult* result)
+// The corridor is optional, its buffers receive the polygons the path runs through and the flags of every point
+void AiQuery::FindStraightPath(NavMeshPathfindQuery query, NavMeshPathfindResult* result, NavMeshPathfindCorridor* corridor)
 {
+	if (corridor)
+		corridor->numPolys = 0;
 	if (invalidated == 1)
 		return;
 
+	NavigationReadScope scope(m_navigation);
+	Bind(scope.Get());
+
 	// Reset result
 	result->pathFound = false;
 	dtPolyRef startPoly, endPoly;
 	float3 startPoint, endPoint;
 
 	// Find the starting polygons and point on it to start from
-	dtQueryFilter filter;
+	const QueryFilter* custom = SelectFilter(query.filter);
+	const dtQueryFilter* filter = GetDetourFilter(custom);
+	const uint32_t filterId = custom ? custom->GetId() : 0;
 	dtStatus status;
-	status = m_navQuery->findNearestPoly(&query.source.x, &query.findNearestPolyExtent.x, &filter, &startPoly, &startPoint.x);
+	status = m_navQuery->findNearestPoly(&query.source.x, &query.findNearestPolyExtent.x, filter, &startPoly, &startPoint.x);
 	if (dtStatusFailed(status))
 		return;
-	status = m_navQuery->findNearestPoly(&query.target.x, &query.findNearestPolyExtent.x, &filter, &endPoly, &endPoint.x);
+	status = m_navQuery->findNearestPoly(&query.target.x, &query.findNearestPolyExtent.x, filter, &endPoly, &endPoint.x);
 	if (dtStatusFailed(status))
 		return;
 
-	std::vector<dtPolyRef> polys;
-	polys.resize(query.maxPathPoints);
-	int pathPointCount = 0;
-	status = m_navQuery->findPath(startPoly, endPoly, &startPoint.x, &endPoint.x,
-		&filter, polys.data(), &pathPointCount, polys.size());
-	if (dtStatusFailed(status) || (status & DT_PARTIAL_RESULT) != 0)
+	const NavigationIslands* islands = scope.Get().GetIslands();
+	if (islands && !islands->IsConnected(startPoly, endPoly))
 		return;
 
-	std::vector<float3> straightPath;
-	std::vector<uint8_t> straightPathFlags;
-	std::vector<dtPolyRef> straightpathPolys;
-	straightPath.resize(query.maxPathPoints);
-	straightPathFlags.resize(query.maxPathPoints);
-	straightpathPolys.resize(query.maxPathPoints);
+	// The search writes straight into the caller's corridor when there is one
+	dtPolyRef* polys = corridor && corridor->polys ? corridor->polys : GetPolyScratch(query.maxPathPoints);
+	int pathPointCount = 0;
+	const ClusterGraph* clusterGraph = custom ? nullptr : scope.Get().GetClusterGraph();
+	bool cached = m_pathCache && m_pathCache->Find(scope.Get(), startPoly, endPoly, filterId, polys, &pathPointCount, query.maxPathPoints);
+	if (!cached && clusterGraph && clusterGraph->IsLongRange(startPoly, endPoly))
+	{
+		if (!clusterGraph->FindPath(startPoly, &startPoint.x, endPoly, &endPoint.x,
+			polys, &pathPointCount, query.maxPathPoints, m_clusterSearch))
+			return;
+	}
+	else if (!cached)
+	{
+		status = m_navQuery->findPath(startPoly, endPoly, &startPoint.x, &endPoint.x,
+			filter, polys, &pathPointCount, query.maxPathPoints);
+		if (dtStatusFailed(status) || (status & DT_PARTIAL_RESULT) != 0)
+			return;
+	}
+	if (!cached && m_pathCache)
+		m_pathCache->Store(scope.Get(), startPoly, endPoly, filterId, polys, pathPointCount);
+
 	status = m_navQuery->findStraightPath(&startPoint.x, &endPoint.x,
-		polys.data(), pathPointCount,
-		(float*)result->pathPoints, straightPathFlags.data(), straightpathPolys.data(),
+		polys, pathPointCount,
+		(float*)result->pathPoints, corridor ? corridor->pathFlags : nullptr, corridor ? corridor->pathPolys : nullptr,
 		&result->numPathPoints, query.maxPathPoints);
 	if (dtStatusFailed(status))
 		return;
+	if (corridor && corridor->polys)
+		corridor->numPolys = pathPointCount;
 	result->pathFound = true;
 }
 
@@ -188,23 +332,42 @@ void AiQuery::Raycast(NavMeshRaycastQuery query, NavMeshRaycastResult* result)
 	if (invalidated == 1)
 		return;
 
+	NavigationReadScope scope(m_navigation);
+	Bind(scope.Get());
+
 	// Reset result
 	result->hit = false;
-	dtQueryFilter filter;
+	const dtQueryFilter* filter = GetDetourFilter(SelectFilter(query.filter));
 
 	dtPolyRef startPoly;
-	dtStatus status = m_navQuery->findNearestPoly(&query.start.x, &query.findNearestPolyExtent.x, &filter, &startPoly, 0);
+	dtStatus status = m_navQuery->findNearestPoly(&query.start.x, &query.findNearestPolyExtent.x, filter, &startPoly, 0);
 	if (dtStatusFailed(status))
 		return;
 
-	float t;
-	std::vector<dtPolyRef> polys;
-	polys.resize(query.maxPathPoints);
-	int raycastPolyCount = 0;
-	status = m_navQuery->raycast(startPoly, &query.start.x, &query.end.x, &filter, &t, &result->normal.x, polys.data(), &raycastPolyCount, polys.size());
+	// The visited polygons are not returned, so none are collected
+	dtRaycastHit hit;
+	hit.path = nullptr;
+	hit.maxPath = 0;
+	status = m_navQuery->raycast(startPoly, &query.start.x, &query.end.x, filter, 0, &hit);
 	if (dtStatusFailed(status))
 		return;
 
 	result->hit = true;
-	dtVlerp(&result->position.x, &query.start.x, &query.end.x, t);
+	dtVcopy(&result->normal.x, hit.hitNormal);
+	dtVlerp(&result->position.x, &query.start.x, &query.end.x, hit.t);
+}
+
+// Raycast for count rays in one call, see RayBatch. visited is optional, without it no visited polygons are
+// collected. Returns the number of rays that could start.
+int AiQuery::RaycastBatch(const float3* starts, const float3* ends, const dtPolyRef* startRefs, int count, float3 extent,
+	dtPolyRef* visited, int maxVisited, NavMeshRaycastBatchResult* results)
+{
+	if (invalidated == 1)
+		return 0;
+
+	NavigationReadScope scope(m_navigation);
+	Bind(scope.Get());
+
+	return m_rayBatch.Run(m_navQuery, m_nearestBatch, GetDetourFilter(m_filter), starts, ends, startRefs, count, extent,
+		visited, maxVisited, results);
 }
@@ -2,22 +2,50 @@
 #include <DetourNavMesh.h>
 #include <DetourNavMeshQuery.h>
 #include "NavigationMesh.hpp"
+#include "NearestPolyBatch.hpp"
+#include "PathCache.hpp"
+#include "RayBatch.hpp"
+#include "QueryFilter.hpp"
+#include <vector>
 
 class AiQuery {
 private:
 	dtNavMesh* m_navMesh = nullptr;
 	dtNavMeshQuery* m_navQuery = nullptr;
+	NavigationMesh* m_navigation = nullptr;
+	ClusterSearch m_clusterSearch;
+	PathCache* m_pathCache = nullptr;
+	NearestPolyBatch m_nearestBatch;
+	RayBatch m_rayBatch;
+	std::vector<dtPolyRef> m_batchRefs;
+	// Corridor scratch of the path queries, grows to the largest maxPathPoints seen
+	std::vector<dtPolyRef> m_polys;
+	dtQueryFilter m_defaultFilter;
+	const QueryFilter* m_filter = nullptr;
+	int m_maxNodes = 0;
 	int invalidated = 0;
+
+	void Bind(const NavigationSnapshot& snapshot);
+	dtPolyRef* GetPolyScratch(int maxPolys);
+	const QueryFilter* SelectFilter(const QueryFilter* filter) const;
+	const dtQueryFilter* GetDetourFilter(const QueryFilter* filter) const;
 public:
 	AiQuery();
 	~AiQuery();
 	int Init(NavigationMesh* navmesh, int maxNodes);
-	void FindStraightPath(NavMeshPathfindQuery query, NavMeshPathfindResult* result);
+	void FindStraightPath(NavMeshPathfindQuery query, NavMeshPathfindResult* result, NavMeshPathfindCorridor* corridor = nullptr);
 	int HasPath(NavMeshPathfindQuery query);
 	void Raycast(NavMeshRaycastQuery query, NavMeshRaycastResult* result);
+	int RaycastBatch(const float3* starts, const float3* ends, const dtPolyRef* startRefs, int count, float3 extent,
+		dtPolyRef* visited, int maxVisited, NavMeshRaycastBatchResult* results);
 	int SamplePosition(float3 point, float3 extent, float3* result);
+	int SamplePositionBatch(const float3* points, const float3* extents, int count, float3* outPos, dtPolyRef* outRef);
 	int GetRandomPosition(float3* result);
 	int GetLocation(float3 point, float3 extent, float3* result);
+	int GetIsland(float3 point, float3 extent);
+	void SetFilter(const QueryFilter* filter);
+	int EnablePathCache(int capacity);
+	void GetPathCacheStats(int* hits, int* misses);
 	int IsValid();
 	void Invalidate();
 };
\ No newline at end of file
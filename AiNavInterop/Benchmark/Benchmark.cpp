@@ -0,0 +1,893 @@
+// Native benchmark of the build, query and crowd hot paths on procedural worlds.
+// Results are written as JSON, to stdout or to the file given with --out.
+//
+//   AiNavBenchmark [--quick] [--worlds terrain,city,buildings] [--tiles n] [--agents 128,256,...] [--threads n] [--seed n] [--out file]
+#include "AiNav.h"
+#include "TestWorlds.hpp"
+#include <DetourNavMesh.h>
+#include <DetourNode.h>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+struct BenchmarkOptions
+{
+	bool quick = false;
+	std::vector<std::string> worlds = { "terrain", "city", "buildings" };
+	std::vector<int> agentCounts = { 128, 256, 512, 1024, 2048, 4096 };
+	int threads = 1;
+	uint32_t seed = 1;
+	int tilesPerSide = 8;
+	int queryCount = 2000;
+	int searchCount = 500;
+	int crowdTicks = 200;
+	int warmupTicks = 10;
+	const char* outPath = nullptr;
+};
+
+// Same defaults as NavMeshBuildSettings.Default and NavAgentSettings.Default on the managed side
+static const int TileSize = 64;
+static const float CellSize = 0.3f;
+static const float CellHeight = 0.2f;
+static const float QueryExtent[3] = { 2.0f, 4.0f, 2.0f };
+static const int FlowFieldMaxNodes = 65535;
+static const int MaxPathPoints = 256;
+static const float CrowdTickSeconds = 1.0f / 30.0f;
+static const int SearchMaxNodes = 8192;
+
+typedef std::chrono::steady_clock Clock;
+
+static double ElapsedMs(Clock::time_point start)
+{
+	return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+}
+
+struct Percentiles
+{
+	double mean = 0.0;
+	double p50 = 0.0;
+	double p90 = 0.0;
+	double p99 = 0.0;
+	double max = 0.0;
+};
+
+// Nearest rank percentiles
+static Percentiles ComputePercentiles(std::vector<double> samples)
+{
+	Percentiles result;
+	if (samples.empty())
+		return result;
+
+	std::sort(samples.begin(), samples.end());
+	auto rank = [&](double p)
+	{
+		size_t index = (size_t)(p * samples.size());
+		return samples[std::min(index, samples.size() - 1)];
+	};
+	double sum = 0.0;
+	for (double sample : samples)
+		sum += sample;
+	result.mean = sum / samples.size();
+	result.p50 = rank(0.50);
+	result.p90 = rank(0.90);
+	result.p99 = rank(0.99);
+	result.max = samples.back();
+	return result;
+}
+
+// Minimal streaming JSON writer, enough for flat objects and arrays of them
+class JsonWriter
+{
+	FILE* m_file;
+	std::vector<bool> m_first;
+	bool m_pendingKey = false;
+
+	void Separator()
+	{
+		if (m_pendingKey)
+		{
+			m_pendingKey = false;
+			return;
+		}
+		if (!m_first.empty())
+		{
+			if (!m_first.back())
+				fputc(',', m_file);
+			m_first.back() = false;
+			fprintf(m_file, "\n%*s", (int)m_first.size() * 2, "");
+		}
+	}
+public:
+	JsonWriter(FILE* file) : m_file(file) {}
+
+	void BeginObject() { Separator(); fputc('{', m_file); m_first.push_back(true); }
+	void EndObject() { m_first.pop_back(); fprintf(m_file, "\n%*s}", (int)m_first.size() * 2, ""); }
+	void BeginArray() { Separator(); fputc('[', m_file); m_first.push_back(true); }
+	void EndArray() { m_first.pop_back(); fprintf(m_file, "\n%*s]", (int)m_first.size() * 2, ""); }
+	void Key(const char* key) { Separator(); fprintf(m_file, "\"%s\": ", key); m_pendingKey = true; }
+	void Value(const char* value) { Separator(); fprintf(m_file, "\"%s\"", value); }
+	void Value(int value) { Separator(); fprintf(m_file, "%d", value); }
+	void Value(double value) { Separator(); fprintf(m_file, "%.6g", value); }
+	void Value(bool value) { Separator(); fputs(value ? "true" : "false", m_file); }
+
+	template <typename T>
+	void Field(const char* key, T value) { Key(key); Value(value); }
+
+	void Field(const char* key, const Percentiles& p)
+	{
+		Key(key);
+		BeginObject();
+		Field("mean", p.mean);
+		Field("p50", p.p50);
+		Field("p90", p.p90);
+		Field("p99", p.p99);
+		Field("max", p.max);
+		EndObject();
+	}
+
+	void Finish() { fputc('\n', m_file); }
+};
+
+static DtBuildSettings CreateTileSettings(const TestWorld& world, int x, int y)
+{
+	DtBuildSettings settings;
+	memset(&settings, 0, sizeof(settings));
+	settings.boundingBox.min.x = x * world.tileWorldSize;
+	settings.boundingBox.min.y = world.bounds.min.y - 1.0f;
+	settings.boundingBox.min.z = y * world.tileWorldSize;
+	settings.boundingBox.max.x = (x + 1) * world.tileWorldSize;
+	settings.boundingBox.max.y = world.bounds.max.y + 1.0f;
+	settings.boundingBox.max.z = (y + 1) * world.tileWorldSize;
+	settings.cellHeight = CellHeight;
+	settings.cellSize = CellSize;
+	settings.tileSize = TileSize;
+	settings.tilePosition.x = x;
+	settings.tilePosition.y = y;
+	settings.regionMinArea = 2;
+	settings.regionMergeArea = 20;
+	settings.edgeMaxLen = 12.0f;
+	settings.edgeMaxError = 1.3f;
+	settings.detailSampleDistInput = 6.0f;
+	settings.detailSampleMaxErrorInput = 1.0f;
+	settings.agentHeight = 2.0f;
+	settings.agentRadius = 0.5f;
+	settings.agentMaxClimb = 0.4f;
+	settings.agentMaxSlope = 45.0f;
+	return settings;
+}
+
+static DtAgentParams CreateAgentParams()
+{
+	DtAgentParams params;
+	memset(&params, 0, sizeof(params));
+	params.radius = 0.5f;
+	params.height = 2.0f;
+	params.maxAcceleration = 6.0f;
+	params.maxSpeed = 3.0f;
+	params.collisionQueryRange = 6.0f;
+	params.pathOptimizationRange = 15.0f;
+	params.separationWeight = 2.0f;
+	params.anticipateTurns = 1;
+	params.optimizeVis = 1;
+	params.optimizeTopo = 1;
+	params.obstacleAvoidance = 1;
+	params.crowdSeparation = 1;
+	params.obstacleAvoidanceType = 3;
+	return params;
+}
+
+// Per tile input as a game would hand it over, only the triangles overlapping the tile plus the border
+struct TileInputs
+{
+	std::vector<DtBuildSettings> settings;
+	std::vector<std::vector<int>> indices;
+	std::vector<std::vector<uint8_t>> areas;
+};
+
+static TileInputs CollectTileInputs(const TestWorld& world)
+{
+	TileInputs inputs;
+	float border = 8.0f * CellSize;
+	for (int y = 0; y < world.tilesY; ++y)
+	{
+		for (int x = 0; x < world.tilesX; ++x)
+		{
+			DtBuildSettings settings = CreateTileSettings(world, x, y);
+			inputs.settings.push_back(settings);
+			inputs.indices.emplace_back();
+			inputs.areas.emplace_back();
+			world.CollectTriangles(settings.boundingBox.min.x - border, settings.boundingBox.min.z - border,
+				settings.boundingBox.max.x + border, settings.boundingBox.max.z + border, inputs.indices.back(), inputs.areas.back());
+		}
+	}
+	return inputs;
+}
+
+// Builds every tile one at a time through NavigationBuilder::BuildNavmesh and adds it to navmesh when given one.
+// With parallelRasterization each tile is rasterized in row bands across the builder's worker pool,
+// with parallelRegions its distance field and watershed regions are built across the pool.
+static void BenchmarkBuild(const TestWorld& world, const TileInputs& inputs, NavigationMesh* navmesh,
+	bool parallelRasterization, bool parallelRegions, JsonWriter& json)
+{
+	NavigationBuilder builder;
+	builder.SetParallelRasterization(parallelRasterization);
+	builder.SetParallelRegions(parallelRegions);
+	std::vector<double> tileMs;
+	int built = 0;
+	int dataBytes = 0;
+	float3* vertices = (float3*)world.vertices.data();
+
+	auto start = Clock::now();
+	for (size_t i = 0; i < inputs.settings.size(); ++i)
+	{
+		if (inputs.indices[i].empty())
+			continue;
+
+		auto tileStart = Clock::now();
+		builder.SetSettings(inputs.settings[i]);
+		DtGeneratedData* data = builder.BuildNavmesh(vertices, (int)world.vertices.size(),
+			(int*)inputs.indices[i].data(), (int)inputs.indices[i].size(), (uint8_t*)inputs.areas[i].data());
+		tileMs.push_back(ElapsedMs(tileStart));
+
+		if (data->success && data->navmeshData)
+		{
+			built++;
+			dataBytes += data->navmeshDataLength;
+			if (!navmesh || !navmesh->LoadTileOwned(data))
+				FreeNavmeshData(data);
+		}
+	}
+	double totalMs = ElapsedMs(start);
+
+	json.BeginObject();
+	json.Field("world", world.name.c_str());
+	json.Field("mode", parallelRasterization ? "parallelRasterization" : parallelRegions ? "parallelRegions" : "serial");
+	if (parallelRasterization || parallelRegions)
+		json.Field("workers", WorkerPool::GetDefaultWorkerCount());
+	json.Field("tiles", (int)tileMs.size());
+	json.Field("tilesWithData", built);
+	json.Field("triangles", world.GetTriangleCount());
+	json.Field("dataBytes", dataBytes);
+	json.Field("totalMs", totalMs);
+	json.Field("tilesPerSecond", tileMs.size() / (totalMs / 1000.0));
+	json.Field("tileMs", ComputePercentiles(tileMs));
+	json.EndObject();
+}
+
+// Same tiles through the batched NavigationBuilder::BuildNavmeshTiles
+static void BenchmarkBatchBuild(const TestWorld& world, const TileInputs& inputs, JsonWriter& json)
+{
+	NavigationBuilder builder;
+	std::vector<DtTileInput> tiles;
+	for (size_t i = 0; i < inputs.settings.size(); ++i)
+	{
+		if (inputs.indices[i].empty())
+			continue;
+		DtTileInput tile;
+		tile.buildSettings = inputs.settings[i];
+		tile.vertices = (float3*)world.vertices.data();
+		tile.numVertices = (int)world.vertices.size();
+		tile.indices = (int*)inputs.indices[i].data();
+		tile.numIndices = (int)inputs.indices[i].size();
+		tile.areas = (uint8_t*)inputs.areas[i].data();
+		tiles.push_back(tile);
+	}
+
+	std::vector<DtGeneratedData> outs(tiles.size());
+	auto start = Clock::now();
+	int built = builder.BuildNavmeshTiles(tiles.data(), (int)tiles.size(), outs.data());
+	double totalMs = ElapsedMs(start);
+	for (auto& out : outs)
+		FreeNavmeshData(&out);
+
+	json.BeginObject();
+	json.Field("world", world.name.c_str());
+	json.Field("mode", "batch");
+	json.Field("workers", WorkerPool::GetDefaultWorkerCount());
+	json.Field("tiles", (int)tiles.size());
+	json.Field("tilesWithData", built);
+	json.Field("totalMs", totalMs);
+	json.Field("tilesPerSecond", tiles.size() / (totalMs / 1000.0));
+	json.EndObject();
+}
+
+// Serial build of the same tiles with each DtBuildSettings::partitionType, build time against the polygons it produces
+static void BenchmarkPartition(const TestWorld& world, const TileInputs& inputs, int partitionType, JsonWriter& json)
+{
+	static const char* PartitionNames[] = { "watershed", "monotone", "layers" };
+
+	NavigationBuilder builder;
+	std::vector<double> tileMs;
+	int built = 0;
+	int polygons = 0;
+	int dataBytes = 0;
+	float3* vertices = (float3*)world.vertices.data();
+
+	auto start = Clock::now();
+	for (size_t i = 0; i < inputs.settings.size(); ++i)
+	{
+		if (inputs.indices[i].empty())
+			continue;
+
+		DtBuildSettings settings = inputs.settings[i];
+		settings.partitionType = partitionType;
+		auto tileStart = Clock::now();
+		builder.SetSettings(settings);
+		DtGeneratedData* data = builder.BuildNavmesh(vertices, (int)world.vertices.size(),
+			(int*)inputs.indices[i].data(), (int)inputs.indices[i].size(), (uint8_t*)inputs.areas[i].data());
+		tileMs.push_back(ElapsedMs(tileStart));
+
+		if (data->success && data->navmeshData)
+		{
+			built++;
+			polygons += ((const dtMeshHeader*)data->navmeshData)->polyCount;
+			dataBytes += data->navmeshDataLength;
+			FreeNavmeshData(data);
+		}
+	}
+	double totalMs = ElapsedMs(start);
+
+	json.BeginObject();
+	json.Field("world", world.name.c_str());
+	json.Field("partition", PartitionNames[partitionType]);
+	json.Field("tiles", (int)tileMs.size());
+	json.Field("tilesWithData", built);
+	json.Field("polygons", polygons);
+	json.Field("dataBytes", dataBytes);
+	json.Field("totalMs", totalMs);
+	json.Field("tilesPerSecond", tileMs.size() / (totalMs / 1000.0));
+	json.Field("tileMs", ComputePercentiles(tileMs));
+	json.EndObject();
+}
+
+static float3 RandomPosition(AiQuery& query)
+{
+	float3 position = { 0.0f, 0.0f, 0.0f };
+	query.GetRandomPosition(&position);
+	return position;
+}
+
+static void WriteQueryResult(JsonWriter& json, const TestWorld& world, const char* operation, const std::vector<double>& latencyUs, int succeeded)
+{
+	double totalUs = 0.0;
+	for (double sample : latencyUs)
+		totalUs += sample;
+
+	json.BeginObject();
+	json.Field("world", world.name.c_str());
+	json.Field("operation", operation);
+	json.Field("count", (int)latencyUs.size());
+	json.Field("succeeded", succeeded);
+	json.Field("queriesPerSecond", totalUs > 0.0 ? latencyUs.size() / (totalUs / 1000000.0) : 0.0);
+	json.Field("latencyUs", ComputePercentiles(latencyUs));
+	json.EndObject();
+}
+
+static void BenchmarkPathQueries(const TestWorld& world, AiQuery& query, const std::vector<float3>& starts, const std::vector<float3>& ends,
+	const char* findName, const char* hasName, JsonWriter& json)
+{
+	int count = (int)starts.size();
+	std::vector<float3> path(MaxPathPoints);
+	std::vector<double> latency(count);
+	auto toUs = [](Clock::time_point start) { return ElapsedMs(start) * 1000.0; };
+
+	int succeeded = 0;
+	for (int i = 0; i < count; ++i)
+	{
+		NavMeshPathfindQuery request = { starts[i], ends[i], { QueryExtent[0], QueryExtent[1], QueryExtent[2] }, MaxPathPoints, nullptr };
+		NavMeshPathfindResult result;
+		result.pathPoints = path.data();
+		auto start = Clock::now();
+		query.FindStraightPath(request, &result);
+		latency[i] = toUs(start);
+		succeeded += result.pathFound ? 1 : 0;
+	}
+	WriteQueryResult(json, world, findName, latency, succeeded);
+
+	succeeded = 0;
+	for (int i = 0; i < count; ++i)
+	{
+		NavMeshPathfindQuery request = { starts[i], ends[i], { QueryExtent[0], QueryExtent[1], QueryExtent[2] }, MaxPathPoints, nullptr };
+		auto start = Clock::now();
+		succeeded += query.HasPath(request);
+		latency[i] = toUs(start);
+	}
+	WriteQueryResult(json, world, hasName, latency, succeeded);
+}
+
+static void BenchmarkQueries(const TestWorld& world, NavigationMesh* navmesh, const BenchmarkOptions& options, JsonWriter& json)
+{
+	AiQuery query;
+	query.Init(navmesh, 2048);
+
+	std::vector<float3> starts(options.queryCount);
+	std::vector<float3> ends(options.queryCount);
+	for (int i = 0; i < options.queryCount; ++i)
+	{
+		starts[i] = RandomPosition(query);
+		ends[i] = RandomPosition(query);
+	}
+
+	std::vector<double> latency(options.queryCount);
+	auto toUs = [](Clock::time_point start) { return ElapsedMs(start) * 1000.0; };
+
+	BenchmarkPathQueries(world, query, starts, ends, "findStraightPath", "hasPath", json);
+
+	// Same pairs again through the hierarchical graph
+	auto graphStart = Clock::now();
+	navmesh->EnableClusterGraph(1);
+	double graphMs = ElapsedMs(graphStart);
+	BenchmarkPathQueries(world, query, starts, ends, "findStraightPathClusterGraph", "hasPathClusterGraph", json);
+	navmesh->EnableClusterGraph(0);
+	json.BeginObject();
+	json.Field("world", world.name.c_str());
+	json.Field("operation", "clusterGraphBuild");
+	json.Field("totalMs", graphMs);
+	json.EndObject();
+
+	// Group move orders, squads of agents standing close together path to one rally point. The first agent of a
+	// squad pays for the search, with the path cache the others reuse its corridor when they share its polygon.
+	const int squadSize = 16;
+	std::vector<float3> squadStarts(options.queryCount);
+	std::vector<float3> squadEnds(options.queryCount);
+	for (int i = 0; i < options.queryCount; ++i)
+	{
+		int leader = i - i % squadSize;
+		float3 point = starts[leader];
+		point.x += ((float)rand() / (float)RAND_MAX - 0.5f) * 2.0f;
+		point.z += ((float)rand() / (float)RAND_MAX - 0.5f) * 2.0f;
+		float3 extent = { QueryExtent[0], QueryExtent[1], QueryExtent[2] };
+		squadStarts[i] = query.SamplePosition(point, extent, &point) ? point : starts[leader];
+		squadEnds[i] = ends[leader];
+	}
+	BenchmarkPathQueries(world, query, squadStarts, squadEnds, "findStraightPathGroup", "hasPathGroup", json);
+	query.EnablePathCache(64);
+	BenchmarkPathQueries(world, query, squadStarts, squadEnds, "findStraightPathGroupPathCache", "hasPathGroupPathCache", json);
+	int hits, misses;
+	query.GetPathCacheStats(&hits, &misses);
+	query.EnablePathCache(0);
+	json.BeginObject();
+	json.Field("world", world.name.c_str());
+	json.Field("operation", "pathCache");
+	json.Field("hits", hits);
+	json.Field("misses", misses);
+	json.EndObject();
+
+	// Rays of up to 20m from each start towards its end position
+	int succeeded = 0;
+	for (int i = 0; i < options.queryCount; ++i)
+	{
+		float3 end = ends[i];
+		float dx = end.x - starts[i].x;
+		float dz = end.z - starts[i].z;
+		float length = sqrtf(dx * dx + dz * dz);
+		if (length > 20.0f)
+		{
+			end.x = starts[i].x + dx / length * 20.0f;
+			end.z = starts[i].z + dz / length * 20.0f;
+		}
+		NavMeshRaycastQuery request = { starts[i], end, { QueryExtent[0], QueryExtent[1], QueryExtent[2] }, MaxPathPoints, nullptr };
+		NavMeshRaycastResult result;
+		auto start = Clock::now();
+		query.Raycast(request, &result);
+		latency[i] = toUs(start);
+		succeeded += result.hit ? 1 : 0;
+	}
+	WriteQueryResult(json, world, "raycast", latency, succeeded);
+
+	// Perception style rays, a few origins each looking at many points. Batched once with the visited polygons,
+	// once hit only and once with the start refs the previous batch returned. Latency is per ray.
+	static const int Origins = 16;
+	std::vector<float3> rayStarts(options.queryCount);
+	std::vector<float3> rayEnds(options.queryCount);
+	for (int i = 0; i < options.queryCount; ++i)
+	{
+		rayStarts[i] = starts[i % Origins];
+		rayEnds[i] = ends[i];
+		float dx = rayEnds[i].x - rayStarts[i].x;
+		float dz = rayEnds[i].z - rayStarts[i].z;
+		float length = sqrtf(dx * dx + dz * dz);
+		if (length > 20.0f)
+		{
+			rayEnds[i].x = rayStarts[i].x + dx / length * 20.0f;
+			rayEnds[i].z = rayStarts[i].z + dz / length * 20.0f;
+		}
+	}
+
+	succeeded = 0;
+	for (int i = 0; i < options.queryCount; ++i)
+	{
+		NavMeshRaycastQuery request = { rayStarts[i], rayEnds[i], { QueryExtent[0], QueryExtent[1], QueryExtent[2] }, MaxPathPoints, nullptr };
+		NavMeshRaycastResult result;
+		auto start = Clock::now();
+		query.Raycast(request, &result);
+		latency[i] = toUs(start);
+		succeeded += result.hit ? 1 : 0;
+	}
+	WriteQueryResult(json, world, "raycastOrigins", latency, succeeded);
+
+	float3 rayExtent = { QueryExtent[0], QueryExtent[1], QueryExtent[2] };
+	std::vector<NavMeshRaycastBatchResult> rayResults(options.queryCount);
+	std::vector<dtPolyRef> visited((size_t)options.queryCount * MaxPathPoints);
+	std::vector<dtPolyRef> startRefs(options.queryCount);
+	const char* batchNames[] = { "raycastBatch", "raycastBatchHitOnly", "raycastBatchStartRefs" };
+	for (int mode = 0; mode < 3; ++mode)
+	{
+		auto batchStart = Clock::now();
+		succeeded = query.RaycastBatch(rayStarts.data(), rayEnds.data(), mode == 2 ? startRefs.data() : nullptr, options.queryCount,
+			rayExtent, mode == 0 ? visited.data() : nullptr, MaxPathPoints, rayResults.data());
+		std::fill(latency.begin(), latency.end(), ElapsedMs(batchStart) * 1000.0 / std::max(options.queryCount, 1));
+		WriteQueryResult(json, world, batchNames[mode], latency, succeeded);
+		for (int i = 0; i < options.queryCount; ++i)
+			startRefs[i] = rayResults[i].startRef;
+	}
+
+	float3 extent = { QueryExtent[0], QueryExtent[1], QueryExtent[2] };
+	succeeded = 0;
+	for (int i = 0; i < options.queryCount; ++i)
+	{
+		float3 point = starts[i];
+		point.y += 1.0f;
+		float3 result;
+		auto start = Clock::now();
+		succeeded += query.SamplePosition(point, extent, &result);
+		latency[i] = toUs(start);
+	}
+	WriteQueryResult(json, world, "samplePosition", latency, succeeded);
+
+	// Same points in one call, latency is per point
+	std::vector<float3> points(options.queryCount);
+	std::vector<float3> extents(options.queryCount, extent);
+	std::vector<float3> sampled(options.queryCount);
+	for (int i = 0; i < options.queryCount; ++i)
+	{
+		points[i] = starts[i];
+		points[i].y += 1.0f;
+	}
+	auto batchStart = Clock::now();
+	succeeded = query.SamplePositionBatch(points.data(), extents.data(), options.queryCount, sampled.data(), nullptr);
+	std::fill(latency.begin(), latency.end(), ElapsedMs(batchStart) * 1000.0 / std::max(options.queryCount, 1));
+	WriteQueryResult(json, world, "samplePositionBatch", latency, succeeded);
+
+	succeeded = 0;
+	for (int i = 0; i < options.queryCount; ++i)
+	{
+		float3 point = starts[i];
+		point.y += 1.0f;
+		float3 result;
+		auto start = Clock::now();
+		succeeded += query.GetLocation(point, extent, &result);
+		latency[i] = toUs(start);
+	}
+	WriteQueryResult(json, world, "getLocation", latency, succeeded);
+}
+
+// Raw A* over long distances with a large node pool, the open list is what dominates here
+static void BenchmarkPathSearch(const TestWorld& world, NavigationMesh* navmesh, const BenchmarkOptions& options, JsonWriter& json)
+{
+	dtNavMeshQuery* navQuery = dtAllocNavMeshQuery();
+	if (dtStatusFailed(navQuery->init(navmesh->GetNavmesh(), SearchMaxNodes)))
+	{
+		dtFreeNavMeshQuery(navQuery);
+		return;
+	}
+	dtQueryFilter filter;
+	AiQuery query;
+	query.Init(navmesh, 2048);
+
+	// Pairs at least half the world apart
+	float minDistance = world.tilesX * world.tileWorldSize * 0.5f;
+	std::vector<dtPolyRef> polys(SearchMaxNodes);
+	std::vector<double> latency;
+	std::vector<double> nodes;
+	int succeeded = 0;
+	int attempts = 0;
+	while ((int)latency.size() < options.searchCount && attempts++ < options.searchCount * 20)
+	{
+		float3 startPoint = RandomPosition(query);
+		float3 endPoint = RandomPosition(query);
+		float dx = endPoint.x - startPoint.x;
+		float dz = endPoint.z - startPoint.z;
+		if (dx * dx + dz * dz < minDistance * minDistance)
+			continue;
+
+		dtPolyRef startRef, endRef;
+		navQuery->findNearestPoly(&startPoint.x, QueryExtent, &filter, &startRef, nullptr);
+		navQuery->findNearestPoly(&endPoint.x, QueryExtent, &filter, &endRef, nullptr);
+		if (!startRef || !endRef)
+			continue;
+
+		int count = 0;
+		auto start = Clock::now();
+		dtStatus status = navQuery->findPath(startRef, endRef, &startPoint.x, &endPoint.x, &filter, polys.data(), &count, SearchMaxNodes);
+		latency.push_back(ElapsedMs(start) * 1000.0);
+		nodes.push_back(navQuery->getNodePool()->getNodeCount());
+		if (dtStatusSucceed(status) && !dtStatusDetail(status, DT_PARTIAL_RESULT))
+			succeeded++;
+	}
+	dtFreeNavMeshQuery(navQuery);
+
+	WriteQueryResult(json, world, "findPath", latency, succeeded);
+	json.BeginObject();
+	json.Field("world", world.name.c_str());
+	json.Field("operation", "findPathNodes");
+	json.Field("maxNodes", SearchMaxNodes);
+	json.Field("nodes", ComputePercentiles(nodes));
+	json.EndObject();
+}
+
+static void BenchmarkCrowd(const TestWorld& world, NavigationMesh* navmesh, int agentCount, const BenchmarkOptions& options, JsonWriter& json)
+{
+	AiQuery query;
+	query.Init(navmesh, 2048);
+	AiCrowd crowd;
+	if (!crowd.Init(navmesh, agentCount, 2.0f))
+		return;
+	crowd.SetThreadCount(options.threads);
+
+	DtAgentParams params = CreateAgentParams();
+	std::vector<int> indices;
+	std::vector<float3> targets;
+	for (int i = 0; i < agentCount; ++i)
+	{
+		int idx = crowd.AddAgent(RandomPosition(query), &params);
+		if (idx < 0)
+			continue;
+		indices.push_back(idx);
+		targets.push_back(RandomPosition(query));
+	}
+	crowd.RequestMoveBatch(indices.data(), targets.data(), (int)indices.size(), nullptr);
+
+	// A few agents get a new target every tick so the path queue never drains
+	int retarget = std::max(1, (int)indices.size() / 64);
+	std::vector<double> tickMs;
+	int next = 0;
+	for (int tick = 0; tick < options.warmupTicks + options.crowdTicks; ++tick)
+	{
+		for (int i = 0; i < retarget; ++i)
+		{
+			next = (next + 1) % (int)indices.size();
+			targets[next] = RandomPosition(query);
+		}
+		crowd.RequestMoveBatch(indices.data(), targets.data(), (int)indices.size(), nullptr);
+
+		auto start = Clock::now();
+		crowd.Update(CrowdTickSeconds);
+		if (tick >= options.warmupTicks)
+			tickMs.push_back(ElapsedMs(start));
+	}
+
+	// Every agent converges on one rally point, one search per agent against one flow field for all of them
+	std::vector<float3> positions(indices.size());
+	DtCrowdAgentStates states = {};
+	states.capacity = (int)positions.size();
+	states.positions = positions.data();
+	crowd.GetAgentStates(&states);
+	float3 rally = RandomPosition(query);
+	std::vector<float3> path(MaxPathPoints);
+	auto searchStart = Clock::now();
+	for (int i = 0; i < states.count; ++i)
+	{
+		NavMeshPathfindQuery request = { positions[i], rally, { QueryExtent[0], QueryExtent[1], QueryExtent[2] }, MaxPathPoints, nullptr };
+		NavMeshPathfindResult result;
+		result.pathPoints = path.data();
+		query.FindStraightPath(request, &result);
+	}
+	double convergeSearchMs = ElapsedMs(searchStart);
+
+	FlowField field;
+	field.Init(navmesh, FlowFieldMaxNodes);
+	auto fieldStart = Clock::now();
+	field.Build(rally, { QueryExtent[0], QueryExtent[1], QueryExtent[2] }, 0.0f);
+	int fieldAgents = crowd.RequestMoveField(indices.data(), (int)indices.size(), &field, nullptr);
+	double convergeFieldMs = ElapsedMs(fieldStart);
+
+	json.BeginObject();
+	json.Field("world", world.name.c_str());
+	json.Field("agents", (int)indices.size());
+	json.Field("threads", options.threads);
+	json.Field("ticks", (int)tickMs.size());
+	json.Field("tickMs", ComputePercentiles(tickMs));
+	json.Field("convergeSearchMs", convergeSearchMs);
+	json.Field("convergeFlowFieldMs", convergeFieldMs);
+	json.Field("convergeFlowFieldAgents", fieldAgents);
+	json.EndObject();
+}
+
+static std::vector<std::string> SplitList(const char* value)
+{
+	std::vector<std::string> items;
+	std::string item;
+	for (const char* c = value; ; ++c)
+	{
+		if (*c == ',' || *c == '\0')
+		{
+			if (!item.empty())
+				items.push_back(item);
+			item.clear();
+			if (*c == '\0')
+				break;
+		}
+		else
+			item += *c;
+	}
+	return items;
+}
+
+static bool ParseOptions(int argc, char** argv, BenchmarkOptions& options)
+{
+	bool agentsSet = false;
+	bool tilesSet = false;
+	for (int i = 1; i < argc; ++i)
+	{
+		const char* arg = argv[i];
+		const char* value = i + 1 < argc ? argv[i + 1] : nullptr;
+		if (!strcmp(arg, "--quick"))
+		{
+			options.quick = true;
+			continue;
+		}
+		if (!value)
+			return false;
+		i++;
+		if (!strcmp(arg, "--worlds"))
+			options.worlds = SplitList(value);
+		else if (!strcmp(arg, "--agents"))
+		{
+			options.agentCounts.clear();
+			for (const auto& item : SplitList(value))
+				options.agentCounts.push_back(atoi(item.c_str()));
+			agentsSet = true;
+		}
+		else if (!strcmp(arg, "--tiles"))
+		{
+			options.tilesPerSide = std::max(1, atoi(value));
+			tilesSet = true;
+		}
+		else if (!strcmp(arg, "--threads"))
+			options.threads = std::max(1, atoi(value));
+		else if (!strcmp(arg, "--seed"))
+			options.seed = (uint32_t)strtoul(value, nullptr, 10);
+		else if (!strcmp(arg, "--out"))
+			options.outPath = value;
+		else
+			return false;
+	}
+
+	if (options.quick)
+	{
+		if (!tilesSet)
+			options.tilesPerSide = 3;
+		options.queryCount = 200;
+		options.searchCount = 50;
+		options.crowdTicks = 20;
+		options.warmupTicks = 2;
+		if (!agentsSet)
+			options.agentCounts = { 128, 512 };
+	}
+	return true;
+}
+
+int main(int argc, char** argv)
+{
+	BenchmarkOptions options;
+	if (!ParseOptions(argc, argv, options))
+	{
+		fprintf(stderr, "usage: %s [--quick] [--worlds terrain,city,buildings] [--tiles n] [--agents 128,256,...] [--threads n] [--seed n] [--out file]\n", argv[0]);
+		return 1;
+	}
+
+	FILE* out = stdout;
+	if (options.outPath)
+	{
+		out = fopen(options.outPath, "w");
+		if (!out)
+		{
+			fprintf(stderr, "unable to open %s\n", options.outPath);
+			return 1;
+		}
+	}
+
+	float tileWorldSize = TileSize * CellSize;
+	std::vector<TestWorld> worlds;
+	for (const auto& name : options.worlds)
+	{
+		int tiles = options.tilesPerSide;
+		if (name == "terrain")
+			worlds.push_back(CreateTerrainWorld(tiles, tiles, tileWorldSize, options.seed));
+		else if (name == "city")
+			worlds.push_back(CreateCityWorld(tiles, tiles, tileWorldSize, options.seed));
+		else if (name == "buildings")
+			worlds.push_back(CreateBuildingsWorld(tiles, tiles, tileWorldSize, options.seed));
+		else
+		{
+			fprintf(stderr, "unknown world %s\n", name.c_str());
+			return 1;
+		}
+	}
+
+	JsonWriter json(out);
+	json.BeginObject();
+	json.Key("config");
+	json.BeginObject();
+	json.Field("quick", options.quick);
+	json.Field("seed", (int)options.seed);
+	json.Field("tilesPerSide", options.tilesPerSide);
+	json.Field("tileSize", TileSize);
+	json.Field("cellSize", (double)CellSize);
+	json.Field("queryCount", options.queryCount);
+	json.Field("searchCount", options.searchCount);
+	json.Field("crowdTicks", options.crowdTicks);
+	json.Field("crowdThreads", options.threads);
+	json.EndObject();
+
+	std::vector<NavigationMesh*> navmeshes;
+	json.Key("build");
+	json.BeginArray();
+	for (const auto& world : worlds)
+	{
+		TileInputs inputs = CollectTileInputs(world);
+		NavigationMesh* navmesh = new NavigationMesh();
+		navmesh->Init(tileWorldSize);
+		BenchmarkBuild(world, inputs, navmesh, false, false, json);
+		BenchmarkBuild(world, inputs, nullptr, true, false, json);
+		BenchmarkBuild(world, inputs, nullptr, false, true, json);
+		BenchmarkBatchBuild(world, inputs, json);
+		navmeshes.push_back(navmesh);
+	}
+	json.EndArray();
+
+	json.Key("partition");
+	json.BeginArray();
+	for (const auto& world : worlds)
+	{
+		TileInputs inputs = CollectTileInputs(world);
+		for (int partitionType = PartitionWatershed; partitionType <= PartitionLayers; ++partitionType)
+			BenchmarkPartition(world, inputs, partitionType, json);
+	}
+	json.EndArray();
+
+	json.Key("query");
+	json.BeginArray();
+	for (size_t i = 0; i < worlds.size(); ++i)
+	{
+		srand(options.seed);
+		BenchmarkQueries(worlds[i], navmeshes[i], options, json);
+	}
+	json.EndArray();
+
+	json.Key("pathSearch");
+	json.BeginArray();
+	for (size_t i = 0; i < worlds.size(); ++i)
+	{
+		srand(options.seed);
+		BenchmarkPathSearch(worlds[i], navmeshes[i], options, json);
+	}
+	json.EndArray();
+
+	json.Key("crowd");
+	json.BeginArray();
+	for (size_t i = 0; i < worlds.size(); ++i)
+	{
+		for (int agentCount : options.agentCounts)
+		{
+			srand(options.seed);
+			BenchmarkCrowd(worlds[i], navmeshes[i], agentCount, options, json);
+		}
+	}
+	json.EndArray();
+
+	json.EndObject();
+	json.Finish();
+
+	for (auto* navmesh : navmeshes)
+		delete navmesh;
+	if (out != stdout)
+		fclose(out);
+	return 0;
+}
@@ -0,0 +1,364 @@
+#include "TestWorlds.hpp"
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+
+static const uint8_t WalkableArea = 63;
+
+// Small deterministic generator so worlds are identical on every platform
+class WorldRandom
+{
+	uint32_t m_state;
+public:
+	WorldRandom(uint32_t seed) : m_state(seed ? seed : 0x9e3779b9u) {}
+
+	uint32_t Next()
+	{
+		m_state ^= m_state << 13;
+		m_state ^= m_state >> 17;
+		m_state ^= m_state << 5;
+		return m_state;
+	}
+
+	float Range(float min, float max)
+	{
+		return min + (max - min) * (float)(Next() & 0xffffff) / (float)0xffffff;
+	}
+
+	int Range(int min, int max)
+	{
+		return min + (int)(Next() % (uint32_t)(max - min + 1));
+	}
+};
+
+static float3 Make(float x, float y, float z)
+{
+	float3 v = { x, y, z };
+	return v;
+}
+
+int TestWorld::GetTriangleCount() const
+{
+	return (int)indices.size() / 3;
+}
+
+void TestWorld::CollectTriangles(float minX, float minZ, float maxX, float maxZ, std::vector<int>& outIndices, std::vector<uint8_t>& outAreas) const
+{
+	outIndices.clear();
+	outAreas.clear();
+	for (int i = 0; i < GetTriangleCount(); ++i)
+	{
+		const float3& a = vertices[indices[i * 3 + 0]];
+		const float3& b = vertices[indices[i * 3 + 1]];
+		const float3& c = vertices[indices[i * 3 + 2]];
+		if (std::max(std::max(a.x, b.x), c.x) < minX || std::min(std::min(a.x, b.x), c.x) > maxX)
+			continue;
+		if (std::max(std::max(a.z, b.z), c.z) < minZ || std::min(std::min(a.z, b.z), c.z) > maxZ)
+			continue;
+		outIndices.insert(outIndices.end(), indices.begin() + i * 3, indices.begin() + i * 3 + 3);
+		outAreas.push_back(areas[i]);
+	}
+}
+
+void TestWorld::AddTriangle(float3 a, float3 b, float3 c)
+{
+	int base = (int)vertices.size();
+	vertices.push_back(a);
+	vertices.push_back(b);
+	vertices.push_back(c);
+	indices.push_back(base);
+	indices.push_back(base + 1);
+	indices.push_back(base + 2);
+	areas.push_back(WalkableArea);
+}
+
+void TestWorld::AddQuad(float3 a, float3 b, float3 c, float3 d)
+{
+	int base = (int)vertices.size();
+	vertices.push_back(a);
+	vertices.push_back(b);
+	vertices.push_back(c);
+	vertices.push_back(d);
+	int quad[6] = { base, base + 1, base + 2, base, base + 2, base + 3 };
+	indices.insert(indices.end(), quad, quad + 6);
+	areas.push_back(WalkableArea);
+	areas.push_back(WalkableArea);
+}
+
+void TestWorld::AddFloor(float minX, float minZ, float maxX, float maxZ, float y)
+{
+	AddQuad(Make(minX, y, minZ), Make(minX, y, maxZ), Make(maxX, y, maxZ), Make(maxX, y, minZ));
+}
+
+void TestWorld::AddBox(float3 min, float3 max, bool walkableTop)
+{
+	AddFloor(min.x, min.z, max.x, max.z, max.y);
+	if (!walkableTop)
+		areas[areas.size() - 1] = areas[areas.size() - 2] = 0;
+	AddQuad(Make(min.x, min.y, min.z), Make(min.x, max.y, min.z), Make(max.x, max.y, min.z), Make(max.x, min.y, min.z));
+	AddQuad(Make(max.x, min.y, max.z), Make(max.x, max.y, max.z), Make(min.x, max.y, max.z), Make(min.x, min.y, max.z));
+	AddQuad(Make(min.x, min.y, max.z), Make(min.x, max.y, max.z), Make(min.x, max.y, min.z), Make(min.x, min.y, min.z));
+	AddQuad(Make(max.x, min.y, min.z), Make(max.x, max.y, min.z), Make(max.x, max.y, max.z), Make(max.x, min.y, max.z));
+}
+
+void TestWorld::UpdateBounds()
+{
+	bounds.min = Make(FLT_MAX, FLT_MAX, FLT_MAX);
+	bounds.max = Make(-FLT_MAX, -FLT_MAX, -FLT_MAX);
+	for (const auto& v : vertices)
+	{
+		bounds.min.x = std::min(bounds.min.x, v.x);
+		bounds.min.y = std::min(bounds.min.y, v.y);
+		bounds.min.z = std::min(bounds.min.z, v.z);
+		bounds.max.x = std::max(bounds.max.x, v.x);
+		bounds.max.y = std::max(bounds.max.y, v.y);
+		bounds.max.z = std::max(bounds.max.z, v.z);
+	}
+}
+
+static TestWorld CreateWorld(const char* name, int tilesX, int tilesY, float tileWorldSize)
+{
+	TestWorld world;
+	world.name = name;
+	world.tilesX = tilesX;
+	world.tilesY = tilesY;
+	world.tileWorldSize = tileWorldSize;
+	return world;
+}
+
+// Value noise on an integer lattice, smoothly interpolated, in [0, 1]
+static float LatticeValue(int x, int z, uint32_t seed)
+{
+	uint32_t h = (uint32_t)x * 374761393u + (uint32_t)z * 668265263u + seed * 2246822519u;
+	h = (h ^ (h >> 13)) * 1274126177u;
+	h ^= h >> 16;
+	return (float)(h & 0xffff) / 65535.0f;
+}
+
+static float ValueNoise(float x, float z, uint32_t seed)
+{
+	int ix = (int)floorf(x);
+	int iz = (int)floorf(z);
+	float fx = x - ix;
+	float fz = z - iz;
+	fx = fx * fx * (3.0f - 2.0f * fx);
+	fz = fz * fz * (3.0f - 2.0f * fz);
+	float a = LatticeValue(ix, iz, seed);
+	float b = LatticeValue(ix + 1, iz, seed);
+	float c = LatticeValue(ix, iz + 1, seed);
+	float d = LatticeValue(ix + 1, iz + 1, seed);
+	return (a + (b - a) * fx) + ((c + (d - c) * fx) - (a + (b - a) * fx)) * fz;
+}
+
+static float TerrainHeight(float x, float z, uint32_t seed)
+{
+	return ValueNoise(x / 48.0f, z / 48.0f, seed) * 10.0f
+		+ ValueNoise(x / 16.0f, z / 16.0f, seed + 1) * 3.0f
+		+ ValueNoise(x / 4.0f, z / 4.0f, seed + 2) * 0.3f;
+}
+
+TestWorld CreateTerrainWorld(int tilesX, int tilesY, float tileWorldSize, uint32_t seed)
+{
+	TestWorld world = CreateWorld("terrain", tilesX, tilesY, tileWorldSize);
+
+	const float spacing = 1.0f;
+	int countX = (int)ceilf(tilesX * tileWorldSize / spacing);
+	int countZ = (int)ceilf(tilesY * tileWorldSize / spacing);
+
+	for (int z = 0; z <= countZ; ++z)
+	{
+		for (int x = 0; x <= countX; ++x)
+		{
+			float wx = x * spacing;
+			float wz = z * spacing;
+			world.vertices.push_back(Make(wx, TerrainHeight(wx, wz, seed), wz));
+		}
+	}
+
+	int stride = countX + 1;
+	for (int z = 0; z < countZ; ++z)
+	{
+		for (int x = 0; x < countX; ++x)
+		{
+			int a = z * stride + x;
+			int b = a + 1;
+			int c = a + stride;
+			int d = c + 1;
+			int quad[6] = { a, c, b, b, c, d };
+			world.indices.insert(world.indices.end(), quad, quad + 6);
+			world.areas.push_back(WalkableArea);
+			world.areas.push_back(WalkableArea);
+		}
+	}
+
+	// Trees and rocks scattered over the hills, they break the open ground up into many small polygons
+	WorldRandom random(seed);
+	float sizeX = tilesX * tileWorldSize;
+	float sizeZ = tilesY * tileWorldSize;
+	int obstacles = (int)(sizeX * sizeZ / 40.0f);
+	for (int i = 0; i < obstacles; ++i)
+	{
+		float x = random.Range(0.0f, sizeX);
+		float z = random.Range(0.0f, sizeZ);
+		float y = TerrainHeight(x, z, seed) - 0.5f;
+		if (random.Range(0.0f, 1.0f) < 0.7f)
+		{
+			float w = random.Range(0.4f, 0.8f);
+			world.AddBox(Make(x, y, z), Make(x + w, y + 6.0f, z + w), false);
+		}
+		else
+		{
+			float w = random.Range(1.0f, 3.0f);
+			float d = random.Range(1.0f, 3.0f);
+			world.AddBox(Make(x, y, z), Make(x + w, y + random.Range(1.0f, 2.0f), z + d), false);
+		}
+	}
+
+	world.UpdateBounds();
+	return world;
+}
+
+TestWorld CreateCityWorld(int tilesX, int tilesY, float tileWorldSize, uint32_t seed)
+{
+	TestWorld world = CreateWorld("city", tilesX, tilesY, tileWorldSize);
+	WorldRandom random(seed);
+
+	const float cell = 32.0f;
+	const float street = 8.0f;
+	const float curb = 0.15f;
+	float sizeX = tilesX * tileWorldSize;
+	float sizeZ = tilesY * tileWorldSize;
+
+	for (float cz = 0.0f; cz < sizeZ; cz += cell)
+	{
+		for (float cx = 0.0f; cx < sizeX; cx += cell)
+		{
+			float bx = cx + street * 0.5f;
+			float bz = cz + street * 0.5f;
+			float block = cell - street;
+
+			// Street ring around the block. No ground floor under the block, recast would merge it with the block top
+			// and make the inside of every building walkable.
+			world.AddFloor(cx, cz, cx + cell, bz, 0.0f);
+			world.AddFloor(cx, bz + block, cx + cell, cz + cell, 0.0f);
+			world.AddFloor(cx, bz, bx, bz + block, 0.0f);
+			world.AddFloor(bx + block, bz, cx + cell, bz + block, 0.0f);
+
+			// Raised block split into 2x2 lots. The block top is only walkable where a lot adds sidewalk or plaza on it,
+			// so the space enclosed by a building stays out of the navmesh.
+			world.AddBox(Make(bx, 0.0f, bz), Make(bx + block, curb, bz + block), false);
+
+			float lot = block * 0.5f;
+			for (int lz = 0; lz < 2; ++lz)
+			{
+				for (int lx = 0; lx < 2; ++lx)
+				{
+					float lotX = bx + lx * lot;
+					float lotZ = bz + lz * lot;
+					float x0 = lotX + 1.0f;
+					float z0 = lotZ + 1.0f;
+					float x1 = x0 + lot - 2.0f;
+					float z1 = z0 + lot - 2.0f;
+					if (random.Range(0.0f, 1.0f) < 0.75f)
+					{
+						float height = random.Range(6.0f, 40.0f);
+						world.AddBox(Make(x0, curb, z0), Make(x1, height, z1), false);
+						world.AddFloor(lotX, lotZ, lotX + lot, z0, curb);
+						world.AddFloor(lotX, z1, lotX + lot, lotZ + lot, curb);
+						world.AddFloor(lotX, z0, x0, z1, curb);
+						world.AddFloor(x1, z0, lotX + lot, z1, curb);
+						continue;
+					}
+					world.AddFloor(lotX, lotZ, lotX + lot, lotZ + lot, curb);
+
+					// Plaza with benches and planters
+					int obstacles = random.Range(2, 5);
+					for (int i = 0; i < obstacles; ++i)
+					{
+						float w = random.Range(0.6f, 2.0f);
+						float d = random.Range(0.6f, 2.0f);
+						float h = random.Range(0.5f, 1.2f);
+						float ox = random.Range(x0, x1 - w);
+						float oz = random.Range(z0, z1 - d);
+						world.AddBox(Make(ox, curb, oz), Make(ox + w, curb + h, oz + d));
+					}
+				}
+			}
+		}
+	}
+
+	world.UpdateBounds();
+	return world;
+}
+
+// Slab with a rectangular opening, the opening is where the ramp from the floor below arrives
+static void AddSlab(TestWorld& world, float x0, float z0, float x1, float z1, float y, float hx0, float hz0, float hx1, float hz1)
+{
+	const float thickness = 0.3f;
+	world.AddBox(Make(x0, y - thickness, z0), Make(hx0, y, z1));
+	world.AddBox(Make(hx1, y - thickness, z0), Make(x1, y, z1));
+	world.AddBox(Make(hx0, y - thickness, z0), Make(hx1, y, hz0));
+	world.AddBox(Make(hx0, y - thickness, hz1), Make(hx1, y, z1));
+}
+
+TestWorld CreateBuildingsWorld(int tilesX, int tilesY, float tileWorldSize, uint32_t seed)
+{
+	TestWorld world = CreateWorld("buildings", tilesX, tilesY, tileWorldSize);
+	WorldRandom random(seed);
+
+	const float cell = 24.0f;
+	const float footprint = 16.0f;
+	const float storey = 3.5f;
+	const float wall = 0.3f;
+	const float door = 3.0f;
+	float sizeX = tilesX * tileWorldSize;
+	float sizeZ = tilesY * tileWorldSize;
+
+	for (float cz = 0.0f; cz < sizeZ; cz += cell)
+	{
+		for (float cx = 0.0f; cx < sizeX; cx += cell)
+		{
+			world.AddFloor(cx, cz, std::min(cx + cell, sizeX), std::min(cz + cell, sizeZ), 0.0f);
+			if (cx + cell > sizeX || cz + cell > sizeZ)
+				continue;
+
+			float x0 = cx + (cell - footprint) * 0.5f;
+			float z0 = cz + (cell - footprint) * 0.5f;
+			float x1 = x0 + footprint;
+			float z1 = z0 + footprint;
+			int floors = random.Range(2, 4);
+			float top = floors * storey;
+
+			// Walls with a door on the south side of the ground floor
+			float doorX = x0 + footprint * 0.5f - door * 0.5f;
+			world.AddBox(Make(x0, 0.0f, z0), Make(doorX, top, z0 + wall));
+			world.AddBox(Make(doorX + door, 0.0f, z0), Make(x1, top, z0 + wall));
+			world.AddBox(Make(doorX, storey - 0.5f, z0), Make(doorX + door, top, z0 + wall));
+			world.AddBox(Make(x0, 0.0f, z1 - wall), Make(x1, top, z1));
+			world.AddBox(Make(x0, 0.0f, z0), Make(x0 + wall, top, z1));
+			world.AddBox(Make(x1 - wall, 0.0f, z0), Make(x1, top, z1));
+
+			// Ramps alternate sides so each one starts on solid floor
+			for (int level = 1; level <= floors; ++level)
+			{
+				float y = level * storey;
+				if (level == floors)
+				{
+					world.AddBox(Make(x0, y - 0.3f, z0), Make(x1, y, z1), false);
+					break;
+				}
+
+				// The opening is a bit wider than the ramp so the slab edge doesn't take away headroom
+				float rx0 = (level % 2) ? x0 + 1.5f : x1 - 4.5f;
+				float rx1 = rx0 + 3.0f;
+				float rz0 = z0 + 3.0f;
+				float rz1 = z0 + 13.0f;
+				AddSlab(world, x0 + wall, z0 + wall, x1 - wall, z1 - wall, y, rx0 - 0.3f, rz0, rx1 + 0.3f, rz1);
+				world.AddQuad(Make(rx0, y - storey, rz0), Make(rx0, y, rz1), Make(rx1, y, rz1), Make(rx1, y - storey, rz0));
+			}
+		}
+	}
+
+	world.UpdateBounds();
+	return world;
+}
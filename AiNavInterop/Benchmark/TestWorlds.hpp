@@ -0,0 +1,39 @@
+#pragma once
+#include "Navigation.hpp"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Procedural triangle soup used by the benchmark, laid out on a grid of navmesh tiles starting at the origin
+struct TestWorld
+{
+	std::string name;
+	std::vector<float3> vertices;
+	std::vector<int> indices;
+	std::vector<uint8_t> areas;
+	int tilesX = 0;
+	int tilesY = 0;
+	float tileWorldSize = 0.0f;
+	DtBoundingBox bounds;
+
+	int GetTriangleCount() const;
+
+	// Triangles overlapping the xz rectangle, what a game would collect for a single tile
+	void CollectTriangles(float minX, float minZ, float maxX, float maxZ, std::vector<int>& indices, std::vector<uint8_t>& areas) const;
+
+	void AddTriangle(float3 a, float3 b, float3 c);
+	// Quad a b c d, counter clockwise seen from above for upward facing quads
+	void AddQuad(float3 a, float3 b, float3 c, float3 d);
+	// Horizontal rectangle facing up
+	void AddFloor(float minX, float minZ, float maxX, float maxZ, float y);
+	// Closed box without a bottom face, roofs nobody should walk on get a null area top
+	void AddBox(float3 min, float3 max, bool walkableTop = true);
+	void UpdateBounds();
+};
+
+// Rolling hills sampled on a 1m grid with a few slopes too steep to walk, scattered trees and rocks
+TestWorld CreateTerrainWorld(int tilesX, int tilesY, float tileWorldSize, uint32_t seed);
+// Streets, raised sidewalks, buildings of random height and small plaza obstacles
+TestWorld CreateCityWorld(int tilesX, int tilesY, float tileWorldSize, uint32_t seed);
+// Buildings with several stacked floors connected by ramps, the navmesh gets multiple layers per tile
+TestWorld CreateBuildingsWorld(int tilesX, int tilesY, float tileWorldSize, uint32_t seed);
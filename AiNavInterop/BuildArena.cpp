@@ -0,0 +1,264 @@
+#include "BuildArena.hpp"
+#include "RecastAlloc.h"
+#include "RecastAssert.h"
+#include "DetourAlloc.h"
+#include <atomic>
+#include <cstdlib>
+#include <map>
+#include <mutex>
+
+static const size_t ArenaAlignment = 16;
+static const uint32_t NoBlock = 0xffffffffu;
+
+// Precedes every block handed out, keeps the block chain of a chunk walkable so frees can roll the top back
+struct BuildArena::Block
+{
+	size_t size;
+	// Offset of the previous block header in the same chunk, NoBlock for the first one
+	uint32_t previous;
+	// Position in the free list of its size class while freed, -1 while in use
+	int32_t freeIndex;
+};
+static_assert(sizeof(BuildArena::Block) <= ArenaAlignment, "Block header must fit the alignment");
+static const size_t BlockHeaderSize = ArenaAlignment;
+
+static thread_local BuildArena* t_arena = nullptr;
+
+// Chunks of every arena by start address, lets a free on a thread without (or with another) arena find the owner
+static std::mutex s_chunkMutex;
+static std::map<const uint8_t*, const uint8_t*> s_chunks;
+static std::atomic<int> s_chunkCount(0);
+
+static bool IsArenaMemory(const void* ptr)
+{
+	if (s_chunkCount.load(std::memory_order_relaxed) == 0)
+		return false;
+
+	const uint8_t* p = (const uint8_t*)ptr;
+	std::lock_guard<std::mutex> lock(s_chunkMutex);
+	auto it = s_chunks.upper_bound(p);
+	if (it == s_chunks.begin())
+		return false;
+	--it;
+	return p < it->second;
+}
+
+static void* ArenaRcAlloc(size_t size, rcAllocHint)
+{
+	if (t_arena)
+		return t_arena->Alloc(size);
+	return malloc(size);
+}
+
+static void* ArenaDtAlloc(size_t size, dtAllocHint hint)
+{
+	if (t_arena && hint == DT_ALLOC_TEMP)
+		return t_arena->Alloc(size);
+	return malloc(size);
+}
+
+static void ArenaFree(void* ptr)
+{
+	if (!ptr)
+		return;
+	if (t_arena && t_arena->Owns(ptr))
+	{
+		t_arena->Free(ptr);
+		return;
+	}
+
+	// Arena memory freed outside the scope of its arena, the block stays allocated until the arena is reset
+	if (IsArenaMemory(ptr))
+	{
+		rcAssert(!"Arena memory freed outside of its arena scope");
+		return;
+	}
+	free(ptr);
+}
+
+// The hooks fall back to malloc/free on threads without an arena, so installing them is safe process wide.
+static void InstallAllocators()
+{
+	static std::once_flag installed;
+	std::call_once(installed, []
+	{
+		rcAllocSetCustom(ArenaRcAlloc, ArenaFree);
+		dtAllocSetCustom(ArenaDtAlloc, ArenaFree);
+	});
+}
+
+static int SizeClass(size_t size)
+{
+	int sizeClass = 0;
+	while (size > ArenaAlignment && sizeClass < BuildArena::SizeClasses - 1)
+	{
+		size >>= 1;
+		sizeClass++;
+	}
+	return sizeClass;
+}
+
+BuildArena::BuildArena(size_t initialSize)
+{
+	InstallAllocators();
+	AddChunk(initialSize);
+}
+
+BuildArena::~BuildArena()
+{
+	FreeChunks();
+}
+
+bool BuildArena::AddChunk(size_t minSize)
+{
+	size_t size = m_chunks.empty() ? 0 : m_chunks.back().size * 2;
+	if (size < minSize)
+		size = minSize;
+	if (size < 64 * 1024)
+		size = 64 * 1024;
+
+	uint8_t* data = (uint8_t*)malloc(size);
+	if (!data)
+		return false;
+	{
+		std::lock_guard<std::mutex> lock(s_chunkMutex);
+		s_chunks[data] = data + size;
+		s_chunkCount++;
+	}
+
+	// What the abandoned chunk used counts towards the high water mark of a single chunk
+	m_retired += m_offset;
+	m_chunks.push_back({ data, size });
+	m_offset = 0;
+	m_top = NoBlock;
+	return true;
+}
+
+void BuildArena::FreeChunks()
+{
+	std::lock_guard<std::mutex> lock(s_chunkMutex);
+	for (auto& chunk : m_chunks)
+	{
+		s_chunks.erase(chunk.data);
+		s_chunkCount--;
+		free(chunk.data);
+	}
+	m_chunks.clear();
+}
+
+BuildArena::Block* BuildArena::BlockAt(uint32_t offset) const
+{
+	return (Block*)(m_chunks.back().data + offset);
+}
+
+void BuildArena::PushFree(Block* block)
+{
+	std::vector<Block*>& list = m_free[SizeClass(block->size)];
+	block->freeIndex = (int32_t)list.size();
+	list.push_back(block);
+}
+
+void BuildArena::RemoveFree(Block* block)
+{
+	std::vector<Block*>& list = m_free[SizeClass(block->size)];
+	Block* last = list.back();
+	list[block->freeIndex] = last;
+	last->freeIndex = block->freeIndex;
+	list.pop_back();
+	block->freeIndex = -1;
+}
+
+void* BuildArena::Alloc(size_t size)
+{
+	size = (size + ArenaAlignment - 1) & ~(ArenaAlignment - 1);
+
+	// Reuse a block freed out of order, first fit in its own size class or any block of a larger one
+	for (int sizeClass = SizeClass(size); sizeClass < SizeClasses; ++sizeClass)
+	{
+		std::vector<Block*>& list = m_free[sizeClass];
+		for (size_t i = list.size(); i-- > 0;)
+		{
+			Block* block = list[i];
+			if (block->size < size)
+				continue;
+			RemoveFree(block);
+			return (uint8_t*)block + BlockHeaderSize;
+		}
+	}
+
+	const size_t needed = BlockHeaderSize + size;
+	if (m_chunks.empty() || m_offset + needed > m_chunks.back().size)
+	{
+		if (!AddChunk(needed))
+			return nullptr;
+	}
+
+	Block* block = BlockAt((uint32_t)m_offset);
+	block->size = size;
+	block->previous = m_top;
+	block->freeIndex = -1;
+	m_top = (uint32_t)m_offset;
+	m_offset += needed;
+	if (m_retired + m_offset > m_highWater)
+		m_highWater = m_retired + m_offset;
+	return (uint8_t*)block + BlockHeaderSize;
+}
+
+void BuildArena::Free(void* ptr)
+{
+	Block* block = (Block*)((uint8_t*)ptr - BlockHeaderSize);
+	if (m_top == NoBlock || block != BlockAt(m_top))
+	{
+		PushFree(block);
+		return;
+	}
+
+	// Roll the top back over this block and every freed block right below it
+	m_offset = m_top;
+	m_top = block->previous;
+	while (m_top != NoBlock && BlockAt(m_top)->freeIndex >= 0)
+	{
+		RemoveFree(BlockAt(m_top));
+		m_offset = m_top;
+		m_top = BlockAt(m_top)->previous;
+	}
+}
+
+bool BuildArena::Owns(const void* ptr) const
+{
+	const uint8_t* p = (const uint8_t*)ptr;
+	for (auto& chunk : m_chunks)
+	{
+		if (p >= chunk.data && p < chunk.data + chunk.size)
+			return true;
+	}
+	return false;
+}
+
+void BuildArena::Reset()
+{
+	// Fold into a single chunk that holds the high water mark so later tiles stay in one block
+	if (m_chunks.size() > 1)
+	{
+		FreeChunks();
+		m_retired = 0;
+		m_offset = 0;
+		AddChunk(m_highWater);
+	}
+	for (auto& list : m_free)
+		list.clear();
+	m_retired = 0;
+	m_offset = 0;
+	m_top = NoBlock;
+}
+
+BuildArena::Scope::Scope(BuildArena* arena)
+{
+	m_previous = t_arena;
+	t_arena = arena;
+}
+
+BuildArena::Scope::~Scope()
+{
+	t_arena = m_previous;
+}
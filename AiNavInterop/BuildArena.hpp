@@ -0,0 +1,56 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Stack allocator backing Recast/Detour scratch allocations of a single builder.
+// While a Scope is active on a thread every rcAlloc and every temporary dtAlloc on that thread comes from the arena.
+// Freeing the most recent block rolls the top back, blocks freed out of order are kept for reuse by later allocations
+// and Reset releases everything at once.
+// Persistent Detour allocations (the generated tile data) always go to the system allocator.
+class BuildArena
+{
+public:
+	struct Block;
+	static const int SizeClasses = 24;
+
+private:
+	struct Chunk
+	{
+		uint8_t* data;
+		size_t size;
+	};
+
+	std::vector<Chunk> m_chunks;
+	size_t m_offset = 0;
+	// Offset of the most recent block in the last chunk
+	uint32_t m_top = 0xffffffffu;
+	// Bytes used in chunks that were abandoned for a larger one since the last Reset
+	size_t m_retired = 0;
+	// Most bytes in use at once, Reset sizes the folded chunk from it
+	size_t m_highWater = 0;
+	std::vector<Block*> m_free[SizeClasses];
+
+	bool AddChunk(size_t minSize);
+	void FreeChunks();
+	Block* BlockAt(uint32_t offset) const;
+	void PushFree(Block* block);
+	void RemoveFree(Block* block);
+public:
+	BuildArena(size_t initialSize);
+	~BuildArena();
+	void* Alloc(size_t size);
+	void Free(void* ptr);
+	bool Owns(const void* ptr) const;
+	void Reset();
+
+	// Makes the arena the allocation target of the current thread for the lifetime of the scope.
+	// A null arena leaves the thread on the system allocator.
+	class Scope
+	{
+		BuildArena* m_previous;
+	public:
+		Scope(BuildArena* arena);
+		~Scope();
+	};
+};
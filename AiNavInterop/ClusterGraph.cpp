@@ -0,0 +1,422 @@
+#include "ClusterGraph.hpp"
+#include <DetourCommon.h>
+#include <algorithm>
+#include <cfloat>
+#include <cstdlib>
+#include <functional>
+
+typedef std::pair<float, int> OpenEntry;
+
+// Abstract costs follow polygon centers and run well above the straight line distance. Overestimating the
+// heuristic gives a slightly worse route for far fewer expansions, string pulling hides most of the difference.
+static const float HeuristicScale = 1.5f;
+
+ClusterGraph::ClusterGraph(const dtNavMesh* navMesh) : m_navMesh(navMesh)
+{
+}
+
+int ClusterGraph::AllocNode()
+{
+	if (!m_freeNodes.empty())
+	{
+		int id = m_freeNodes.back();
+		m_freeNodes.pop_back();
+		return id;
+	}
+	m_nodes.emplace_back();
+	return (int)m_nodes.size() - 1;
+}
+
+int ClusterGraph::FindNode(dtPolyRef ref) const
+{
+	unsigned int tileIndex = m_navMesh->decodePolyIdTile(ref);
+	if (tileIndex >= m_tiles.size())
+		return -1;
+	const Tile& tile = m_tiles[tileIndex];
+	unsigned int polyIndex = PolyIndex(ref);
+	if (polyIndex >= tile.polyNodes.size())
+		return -1;
+	int id = tile.polyNodes[polyIndex];
+	if (id < 0 || m_nodes[id].ref != ref)
+		return -1;
+	return id;
+}
+
+int ClusterGraph::PolyIndex(dtPolyRef ref) const
+{
+	return (int)m_navMesh->decodePolyIdPoly(ref);
+}
+
+dtPolyRef ClusterGraph::PolyBase(dtPolyRef ref) const
+{
+	unsigned int salt, tileIndex, polyIndex;
+	m_navMesh->decodePolyId(ref, salt, tileIndex, polyIndex);
+	return m_navMesh->encodePolyId(salt, tileIndex, 0);
+}
+
+// Same test as dtQueryFilter::passFilter, which is only inlined inside detour
+bool ClusterGraph::PassFilter(const dtPoly* poly) const
+{
+	return (poly->flags & m_filter.getIncludeFlags()) != 0 && (poly->flags & m_filter.getExcludeFlags()) == 0;
+}
+
+int ClusterGraph::GetNodeCount() const
+{
+	return (int)(m_nodes.size() - m_freeNodes.size());
+}
+
+void ClusterGraph::PolyCenter(const dtMeshTile* tile, int polyIndex, float* center) const
+{
+	const dtPoly* poly = &tile->polys[polyIndex];
+	dtVset(center, 0.0f, 0.0f, 0.0f);
+	for (int i = 0; i < poly->vertCount; ++i)
+		dtVadd(center, center, &tile->verts[poly->verts[i] * 3]);
+	dtVscale(center, center, 1.0f / poly->vertCount);
+}
+
+// Dijkstra over the polygons of one tile, leaves the cost to every polygon in search.polyCost and the
+// shortest path tree in search.polyParent
+void ClusterGraph::SearchTile(const dtMeshTile* tile, int polyIndex, const float* pos, ClusterSearch& search) const
+{
+	int polyCount = tile->header->polyCount;
+	search.polyCenters.resize(polyCount * 3);
+	for (int i = 0; i < polyCount; ++i)
+		PolyCenter(tile, i, &search.polyCenters[i * 3]);
+	search.polyCost.assign(polyCount, FLT_MAX);
+	search.polyParent.assign(polyCount, -1);
+	search.polyOpen.clear();
+
+	search.polyCost[polyIndex] = 0.0f;
+	search.polyOpen.push_back(OpenEntry(0.0f, polyIndex));
+	while (!search.polyOpen.empty())
+	{
+		std::pop_heap(search.polyOpen.begin(), search.polyOpen.end(), std::greater<OpenEntry>());
+		OpenEntry entry = search.polyOpen.back();
+		search.polyOpen.pop_back();
+		int current = entry.second;
+		if (entry.first > search.polyCost[current])
+			continue;
+
+		const dtPoly* poly = &tile->polys[current];
+		const float* from = current == polyIndex ? pos : &search.polyCenters[current * 3];
+		for (int i = 0; i < poly->vertCount; ++i)
+		{
+			unsigned short nei = poly->neis[i];
+			if (!nei || (nei & DT_EXT_LINK))
+				continue;
+			int next = nei - 1;
+			const dtPoly* nextPoly = &tile->polys[next];
+			if (!PassFilter(nextPoly))
+				continue;
+
+			float cost = entry.first + dtVdist(from, &search.polyCenters[next * 3]) * m_filter.getAreaCost(nextPoly->getArea());
+			if (cost < search.polyCost[next])
+			{
+				search.polyCost[next] = cost;
+				search.polyParent[next] = (short)current;
+				search.polyOpen.push_back(OpenEntry(cost, next));
+				std::push_heap(search.polyOpen.begin(), search.polyOpen.end(), std::greater<OpenEntry>());
+			}
+		}
+	}
+}
+
+void ClusterGraph::AddTile(dtTileRef tileRef)
+{
+	const dtMeshTile* tile = m_navMesh->getTileByRef(tileRef);
+	if (!tile || !tile->header)
+		return;
+
+	unsigned int tileIndex = m_navMesh->decodePolyIdTile((dtPolyRef)tileRef);
+	if (tileIndex >= m_tiles.size())
+		m_tiles.resize(tileIndex + 1);
+	if (!m_tiles[tileIndex].nodes.empty())
+		RemoveTile(tileRef);
+
+	// Border polygons become nodes
+	Tile& clusterTile = m_tiles[tileIndex];
+	dtPolyRef base = m_navMesh->getPolyRefBase(tile);
+	int polyCount = tile->header->polyCount;
+	clusterTile.polyNodes.assign(polyCount, -1);
+	for (int i = 0; i < polyCount; ++i)
+	{
+		const dtPoly* poly = &tile->polys[i];
+		if (poly->getType() == DT_POLYTYPE_OFFMESH_CONNECTION)
+			continue;
+		if (!PassFilter(poly))
+			continue;
+
+		bool border = false;
+		for (int j = 0; j < poly->vertCount; ++j)
+		{
+			if (poly->neis[j] & DT_EXT_LINK)
+				border = true;
+		}
+		if (!border)
+			continue;
+
+		int id = AllocNode();
+		Node& node = m_nodes[id];
+		node.ref = base | (dtPolyRef)i;
+		PolyCenter(tile, i, node.pos);
+		node.tile = (int)tileIndex;
+		node.local = (int)clusterTile.nodes.size();
+		node.links.clear();
+		clusterTile.nodes.push_back(id);
+		clusterTile.polyNodes[i] = id;
+	}
+
+	// Cheapest path inside the tile between every pair of nodes
+	int count = (int)clusterTile.nodes.size();
+	clusterTile.costs.assign(count * count, FLT_MAX);
+	clusterTile.parents.resize(count * polyCount);
+	for (int a = 0; a < count; ++a)
+	{
+		const Node& node = m_nodes[clusterTile.nodes[a]];
+		SearchTile(tile, PolyIndex(node.ref), node.pos, m_buildSearch);
+		for (int b = 0; b < count; ++b)
+		{
+			int polyIndex = PolyIndex(m_nodes[clusterTile.nodes[b]].ref);
+			clusterTile.costs[a * count + b] = m_buildSearch.polyCost[polyIndex];
+		}
+		for (int i = 0; i < polyCount; ++i)
+			clusterTile.parents[a * polyCount + i] = m_buildSearch.polyParent[i];
+	}
+
+	// Detour connected the tile to its neighbours, refresh the links on both sides
+	const int maxLayers = 32;
+	const dtMeshTile* neighbours[maxLayers];
+	for (int y = tile->header->y - 1; y <= tile->header->y + 1; ++y)
+	{
+		for (int x = tile->header->x - 1; x <= tile->header->x + 1; ++x)
+		{
+			int layers = m_navMesh->getTilesAt(x, y, neighbours, maxLayers);
+			for (int i = 0; i < layers; ++i)
+				UpdateLinks(neighbours[i]);
+		}
+	}
+}
+
+void ClusterGraph::UpdateLinks(const dtMeshTile* tile)
+{
+	unsigned int tileIndex = m_navMesh->decodePolyIdTile(m_navMesh->getPolyRefBase(tile));
+	if (tileIndex >= m_tiles.size())
+		return;
+
+	for (int id : m_tiles[tileIndex].nodes)
+	{
+		Node& node = m_nodes[id];
+		node.links.clear();
+		const dtPoly* poly = &tile->polys[PolyIndex(node.ref)];
+		for (unsigned int i = poly->firstLink; i != DT_NULL_LINK; i = tile->links[i].next)
+		{
+			dtPolyRef ref = tile->links[i].ref;
+			if (!ref || m_navMesh->decodePolyIdTile(ref) == tileIndex)
+				continue;
+			int target = FindNode(ref);
+			if (target < 0)
+				continue;
+
+			const dtMeshTile* targetTile = nullptr;
+			const dtPoly* targetPoly = nullptr;
+			m_navMesh->getTileAndPolyByRefUnsafe(ref, &targetTile, &targetPoly);
+			Edge edge;
+			edge.node = target;
+			edge.cost = dtVdist(node.pos, m_nodes[target].pos) * m_filter.getAreaCost(targetPoly->getArea());
+			node.links.push_back(edge);
+		}
+	}
+}
+
+void ClusterGraph::RemoveTile(dtTileRef tileRef)
+{
+	unsigned int tileIndex = m_navMesh->decodePolyIdTile((dtPolyRef)tileRef);
+	if (tileIndex >= m_tiles.size())
+		return;
+
+	Tile& clusterTile = m_tiles[tileIndex];
+	for (int id : clusterTile.nodes)
+	{
+		// Links are symmetric, drop the ones pointing back at this tile
+		for (const Edge& edge : m_nodes[id].links)
+		{
+			std::vector<Edge>& links = m_nodes[edge.node].links;
+			links.erase(std::remove_if(links.begin(), links.end(), [id](const Edge& other) { return other.node == id; }), links.end());
+		}
+		m_nodes[id].links.clear();
+		m_nodes[id].ref = 0;
+		m_freeNodes.push_back(id);
+	}
+	clusterTile.nodes.clear();
+	clusterTile.polyNodes.clear();
+	clusterTile.costs.clear();
+	clusterTile.parents.clear();
+}
+
+bool ClusterGraph::IsLongRange(dtPolyRef startRef, dtPolyRef endRef) const
+{
+	const dtMeshTile* startTile = nullptr;
+	const dtMeshTile* endTile = nullptr;
+	const dtPoly* poly = nullptr;
+	if (dtStatusFailed(m_navMesh->getTileAndPolyByRef(startRef, &startTile, &poly)))
+		return false;
+	if (dtStatusFailed(m_navMesh->getTileAndPolyByRef(endRef, &endTile, &poly)))
+		return false;
+	return abs(startTile->header->x - endTile->header->x) > 1 || abs(startTile->header->y - endTile->header->y) > 1;
+}
+
+bool ClusterGraph::FindRoute(dtPolyRef startRef, const float* startPos, dtPolyRef endRef, const float* endPos, ClusterSearch& search) const
+{
+	search.route.clear();
+
+	const dtMeshTile* startTile = nullptr;
+	const dtMeshTile* endTile = nullptr;
+	const dtPoly* poly = nullptr;
+	if (dtStatusFailed(m_navMesh->getTileAndPolyByRef(startRef, &startTile, &poly)))
+		return false;
+	if (dtStatusFailed(m_navMesh->getTileAndPolyByRef(endRef, &endTile, &poly)))
+		return false;
+	unsigned int startTileIndex = m_navMesh->decodePolyIdTile(startRef);
+	unsigned int endTileIndex = m_navMesh->decodePolyIdTile(endRef);
+	if (startTileIndex >= m_tiles.size() || endTileIndex >= m_tiles.size())
+		return false;
+	const Tile& startClusterTile = m_tiles[startTileIndex];
+	const Tile& endClusterTile = m_tiles[endTileIndex];
+
+	// Connect the start and end polygons to the nodes of their tiles
+	SearchTile(startTile, PolyIndex(startRef), startPos, search);
+	float directCost = startTileIndex == endTileIndex ? search.polyCost[PolyIndex(endRef)] : FLT_MAX;
+	search.startCost.resize(startClusterTile.nodes.size());
+	for (size_t i = 0; i < startClusterTile.nodes.size(); ++i)
+		search.startCost[i] = search.polyCost[PolyIndex(m_nodes[startClusterTile.nodes[i]].ref)];
+	search.startParent.swap(search.polyParent);
+
+	SearchTile(endTile, PolyIndex(endRef), endPos, search);
+	search.endCost.resize(endClusterTile.nodes.size());
+	for (size_t i = 0; i < endClusterTile.nodes.size(); ++i)
+		search.endCost[i] = search.polyCost[PolyIndex(m_nodes[endClusterTile.nodes[i]].ref)];
+	search.endParent.swap(search.polyParent);
+
+	int goal = (int)m_nodes.size();
+	if ((int)search.cost.size() < goal + 1)
+	{
+		search.cost.resize(goal + 1);
+		search.parent.resize(goal + 1);
+		search.visited.resize(goal + 1, 0);
+		search.closed.resize(goal + 1, 0);
+	}
+	if (++search.stamp == 0)
+	{
+		std::fill(search.visited.begin(), search.visited.end(), 0);
+		std::fill(search.closed.begin(), search.closed.end(), 0);
+		search.stamp = 1;
+	}
+	search.open.clear();
+
+	auto push = [&](int node, float cost, int parent)
+	{
+		if (search.visited[node] == search.stamp && cost >= search.cost[node])
+			return;
+		search.visited[node] = search.stamp;
+		search.cost[node] = cost;
+		search.parent[node] = parent;
+		float heuristic = node == goal ? 0.0f : dtVdist(m_nodes[node].pos, endPos) * HeuristicScale;
+		search.open.push_back(OpenEntry(cost + heuristic, node));
+		std::push_heap(search.open.begin(), search.open.end(), std::greater<OpenEntry>());
+	};
+
+	if (directCost < FLT_MAX)
+		push(goal, directCost, -1);
+	for (size_t i = 0; i < startClusterTile.nodes.size(); ++i)
+	{
+		if (search.startCost[i] < FLT_MAX)
+			push(startClusterTile.nodes[i], search.startCost[i], -1);
+	}
+
+	while (!search.open.empty())
+	{
+		std::pop_heap(search.open.begin(), search.open.end(), std::greater<OpenEntry>());
+		int current = search.open.back().second;
+		search.open.pop_back();
+
+		if (current == goal)
+		{
+			for (int node = search.parent[goal]; node >= 0; node = search.parent[node])
+				search.route.push_back(node);
+			std::reverse(search.route.begin(), search.route.end());
+			return true;
+		}
+		if (search.closed[current] == search.stamp)
+			continue;
+		search.closed[current] = search.stamp;
+
+		const Node& node = m_nodes[current];
+		float cost = search.cost[current];
+		if (node.tile == (int)endTileIndex && search.endCost[node.local] < FLT_MAX)
+			push(goal, cost + search.endCost[node.local], current);
+
+		const Tile& tile = m_tiles[node.tile];
+		int count = (int)tile.nodes.size();
+		const float* row = &tile.costs[node.local * count];
+		for (int i = 0; i < count; ++i)
+		{
+			if (i != node.local && row[i] < FLT_MAX)
+				push(tile.nodes[i], cost + row[i], current);
+		}
+		for (const Edge& edge : node.links)
+			push(edge.node, cost + edge.cost, current);
+	}
+	return false;
+}
+
+// Appends the tile local path to polyIndex from the root of a shortest path tree, or from polyIndex to the root
+// when reversed is false. The segment starts on the polygon the previous one ended on.
+void ClusterGraph::AppendSegment(dtPolyRef base, const short* parents, int polyIndex, bool reversed,
+	dtPolyRef* path, int* pathCount, int maxPath, ClusterSearch& search) const
+{
+	search.segment.clear();
+	for (int i = polyIndex; i >= 0; i = parents[i])
+		search.segment.push_back(base | (dtPolyRef)i);
+	if (reversed)
+		std::reverse(search.segment.begin(), search.segment.end());
+
+	size_t first = *pathCount > 0 ? 1 : 0;
+	for (size_t i = first; i < search.segment.size() && *pathCount < maxPath; ++i)
+		path[(*pathCount)++] = search.segment[i];
+}
+
+bool ClusterGraph::FindPath(dtPolyRef startRef, const float* startPos, dtPolyRef endRef, const float* endPos,
+	dtPolyRef* path, int* pathCount, int maxPath, ClusterSearch& search) const
+{
+	*pathCount = 0;
+	if (maxPath <= 0 || !FindRoute(startRef, startPos, endRef, endPos, search))
+		return false;
+
+	// Refine the route one tile at a time from the shortest path trees, stopping once the path is full
+	std::vector<int>& route = search.route;
+	if (route.empty())
+	{
+		// Start and end share a tile and the path never leaves it
+		AppendSegment(PolyBase(startRef), search.startParent.data(), PolyIndex(endRef), true, path, pathCount, maxPath, search);
+		return path[*pathCount - 1] == endRef;
+	}
+
+	AppendSegment(PolyBase(startRef), search.startParent.data(), PolyIndex(m_nodes[route[0]].ref), true, path, pathCount, maxPath, search);
+	for (size_t i = 1; i < route.size() && *pathCount < maxPath; ++i)
+	{
+		const Node& previous = m_nodes[route[i - 1]];
+		const Node& node = m_nodes[route[i]];
+		if (previous.tile != node.tile)
+		{
+			// Neighbours through a link
+			path[(*pathCount)++] = node.ref;
+			continue;
+		}
+		const Tile& tile = m_tiles[node.tile];
+		int polyCount = (int)tile.polyNodes.size();
+		AppendSegment(PolyBase(node.ref), &tile.parents[previous.local * polyCount], PolyIndex(node.ref), true, path, pathCount, maxPath, search);
+	}
+	if (*pathCount < maxPath)
+		AppendSegment(PolyBase(endRef), search.endParent.data(), PolyIndex(m_nodes[route.back()].ref), false, path, pathCount, maxPath, search);
+	return path[*pathCount - 1] == endRef;
+}
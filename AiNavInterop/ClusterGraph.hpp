@@ -0,0 +1,106 @@
+#pragma once
+#include <DetourNavMesh.h>
+#include <DetourNavMeshQuery.h>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+// Per query scratch for ClusterGraph searches, reused between calls so a search does not allocate once warm
+struct ClusterSearch
+{
+	// Abstract A*, indexed by node id with the goal at the end
+	std::vector<float> cost;
+	std::vector<int> parent;
+	std::vector<uint32_t> visited;
+	std::vector<uint32_t> closed;
+	uint32_t stamp = 0;
+	std::vector<std::pair<float, int>> open;
+
+	// Dijkstra inside the start and end tiles, indexed by tile local poly
+	std::vector<float> polyCenters;
+	std::vector<float> polyCost;
+	std::vector<short> polyParent;
+	std::vector<std::pair<float, int>> polyOpen;
+	std::vector<float> startCost;
+	std::vector<float> endCost;
+	std::vector<short> startParent;
+	std::vector<short> endParent;
+
+	std::vector<int> route;
+	std::vector<dtPolyRef> segment;
+};
+
+// Abstract graph over tile border polygons, used for long range paths that would exhaust a flat search.
+// Every polygon with an edge on a tile border is a node. Nodes of one tile are connected with the cheapest cost
+// between them that stays inside the tile, nodes of neighbouring tiles through their detour links.
+// Costs are measured between polygon centers with the default filter.
+// NavigationMesh keeps the graph in sync as tiles are added and removed, so it has the same synchronization
+// requirements as the navmesh. Searches are const and only touch the passed ClusterSearch.
+class ClusterGraph
+{
+	struct Edge
+	{
+		int node;
+		float cost;
+	};
+
+	struct Node
+	{
+		dtPolyRef ref;
+		float pos[3];
+		int tile;
+		int local;
+		// Nodes in other tiles linked to this polygon
+		std::vector<Edge> links;
+	};
+
+	struct Tile
+	{
+		std::vector<int> nodes;
+		// Tile local poly index to node id, -1 for interior polygons
+		std::vector<int> polyNodes;
+		// nodes.size() squared, FLT_MAX where no path inside the tile connects two nodes
+		std::vector<float> costs;
+		// Shortest path tree inside the tile from each node, nodes.size() rows of polygon parents
+		std::vector<short> parents;
+	};
+
+	const dtNavMesh* m_navMesh;
+	dtQueryFilter m_filter;
+	std::vector<Node> m_nodes;
+	std::vector<int> m_freeNodes;
+	std::vector<Tile> m_tiles;
+	ClusterSearch m_buildSearch;
+
+	int AllocNode();
+	int FindNode(dtPolyRef ref) const;
+	int PolyIndex(dtPolyRef ref) const;
+	dtPolyRef PolyBase(dtPolyRef ref) const;
+	bool PassFilter(const dtPoly* poly) const;
+	void UpdateLinks(const dtMeshTile* tile);
+	void PolyCenter(const dtMeshTile* tile, int polyIndex, float* center) const;
+	void SearchTile(const dtMeshTile* tile, int polyIndex, const float* pos, ClusterSearch& search) const;
+	void AppendSegment(dtPolyRef base, const short* parents, int polyIndex, bool reversed,
+		dtPolyRef* path, int* pathCount, int maxPath, ClusterSearch& search) const;
+public:
+	ClusterGraph(const dtNavMesh* navMesh);
+
+	// Called after detour added the tile
+	void AddTile(dtTileRef tileRef);
+	// Called before detour removes the tile
+	void RemoveTile(dtTileRef tileRef);
+
+	int GetNodeCount() const;
+
+	// True when the polygons are far enough apart for the abstract search to beat a flat one
+	bool IsLongRange(dtPolyRef startRef, dtPolyRef endRef) const;
+
+	// Abstract A* from the start to the end polygon. Fills search.route with the node ids to pass through.
+	bool FindRoute(dtPolyRef startRef, const float* startPos, dtPolyRef endRef, const float* endPos, ClusterSearch& search) const;
+
+	// Finds the route and refines it into a polygon corridor one tile at a time from the stored shortest path trees.
+	// Refinement stops once maxPath polygons are collected, the rest of the route is never expanded.
+	// A corridor cut short this way doesn't reach the end polygon and returns false, like a partial flat search.
+	bool FindPath(dtPolyRef startRef, const float* startPos, dtPolyRef endRef, const float* endPos,
+		dtPolyRef* path, int* pathCount, int maxPath, ClusterSearch& search) const;
+};
@@ -20,6 +20,7 @@
 #define DETOURNODE_H
 
 #include "DetourNavMesh.h"
+#include "DetourAssert.h"
 
 enum dtNodeFlags
 {
@@ -42,6 +43,7 @@ struct dtNode
 	unsigned int state : DT_NODE_STATE_BITS;	///< extra state information. A polyRef can have multiple nodes with different extra info. see DT_MAX_STATES_PER_NODE
 	unsigned int flags : 3;						///< Node flags. A combination of dtNodeFlags.
 	dtPolyRef id;								///< Polygon ref the node corresponds to.
+	int heapIndex;								///< Position in the dtNodeQueue heap, only valid while the node is open.
 };
 
 static const int DT_MAX_STATES_PER_NODE = 1 << DT_NODE_STATE_BITS;	// number of extra states per node. See dtNode::state
@@ -129,16 +131,11 @@ public:
 		bubbleUp(m_size-1, node);
 	}
 	
+	// The node must be in the queue, its total cost can only have decreased.
 	inline void modify(dtNode* node)
 	{
-		for (int i = 0; i < m_size; ++i)
-		{
-			if (m_heap[i] == node)
-			{
-				bubbleUp(i, node);
-				return;
-			}
-		}
+		dtAssert(node->heapIndex >= 0 && node->heapIndex < m_size && m_heap[node->heapIndex] == node);
+		bubbleUp(node->heapIndex, node);
 	}
 	
 	inline bool empty() const { return m_size == 0; }
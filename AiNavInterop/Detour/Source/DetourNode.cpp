@@ -144,6 +144,7 @@ dtNode* dtNodePool::getNode(dtPolyRef id, unsigned char state)
 	node->id = id;
 	node->state = state;
 	node->flags = 0;
+	node->heapIndex = -1;
 	
 	m_next[i] = m_first[bucket];
 	m_first[bucket] = i;
@@ -176,10 +177,12 @@ void dtNodeQueue::bubbleUp(int i, dtNode* node)
 	while ((i > 0) && (m_heap[parent]->total > node->total))
 	{
 		m_heap[i] = m_heap[parent];
+		m_heap[i]->heapIndex = i;
 		i = parent;
 		parent = (i-1)/2;
 	}
 	m_heap[i] = node;
+	node->heapIndex = i;
 }
 
 void dtNodeQueue::trickleDown(int i, dtNode* node)
@@ -193,6 +196,7 @@ void dtNodeQueue::trickleDown(int i, dtNode* node)
 			child++;
 		}
 		m_heap[i] = m_heap[child];
+		m_heap[i]->heapIndex = i;
 		i = child;
 		child = (i*2)+1;
 	}
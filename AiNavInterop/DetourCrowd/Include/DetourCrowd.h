@@ -198,6 +198,20 @@ struct dtCrowdAgentDebugInfo
 	dtObstacleAvoidanceDebugData* vod;
 };
 
+/// A unit of work of a multithreaded crowd update.
+///  @param[in]		taskData	The task data given to the #dtCrowdParallelForFunc.
+///  @param[in]		index		The task index. [Limits: 0 <= value < count]
+///  @param[in]		thread		The index of the thread running the task. [Limits: 0 <= value < threadCount]
+typedef void (*dtCrowdTaskFunc)(void* taskData, int index, int thread);
+
+/// Runs @p task for every index in [0, @p count) and returns once all of them have completed.
+/// Tasks may run concurrently, but no two tasks running at the same time may be given the same thread index.
+///  @param[in]		userData	The user data given to dtCrowd::setParallelFor.
+///  @param[in]		task		The task to run.
+///  @param[in]		taskData	Data to pass to @p task.
+///  @param[in]		count		The number of tasks.
+typedef void (*dtCrowdParallelForFunc)(void* userData, dtCrowdTaskFunc task, void* taskData, int count);
+
 /// Provides local steering behaviors for a group of agents. 
 /// @ingroup crowd
 class dtCrowd
@@ -227,6 +241,13 @@ class dtCrowd
 
 	dtNavMeshQuery* m_navquery;
 
+	dtCrowdParallelForFunc m_parallelFor;
+	void* m_parallelForUserData;
+	int m_threadCount;
+	dtNavMeshQuery** m_threadNavqueries;
+	dtObstacleAvoidanceQuery** m_threadObstacleQueries;
+	int* m_threadVelocitySamples;
+
 	void updateTopologyOptimization(dtCrowdAgent** agents, const int nagents, const float dt);
 	void updateMoveRequest(const float dt);
 	void checkPathValidity(dtCrowdAgent** agents, const int nagents, const float dt);
@@ -236,6 +257,21 @@ class dtCrowd
 	bool requestMoveTargetReplan(const int idx, dtPolyRef ref, const float* pos);
 
 	void purge();
+	void purgeThreads();
+	bool initThreads(const int threadCount);
+
+	static void runUpdateTask(void* taskData, int index, int thread);
+	void runUpdatePhase(const int phase, dtCrowdAgent** agents, const int nagents, const float dt, dtCrowdAgentDebugInfo* debug);
+	void updatePhase(const int phase, dtCrowdAgent** agents, const int nagents, const int begin, const int end,
+					 const float dt, dtCrowdAgentDebugInfo* debug, const int thread);
+	void updateNeighbours(dtCrowdAgent** agents, const int nagents, const int begin, const int end, const int thread);
+	void updateCorners(dtCrowdAgent** agents, const int begin, const int end, dtCrowdAgentDebugInfo* debug, const int thread);
+	void updateSteering(dtCrowdAgent** agents, const int begin, const int end);
+	void updateVelocityPlanning(dtCrowdAgent** agents, const int begin, const int end, dtCrowdAgentDebugInfo* debug, const int thread);
+	void updateIntegration(dtCrowdAgent** agents, const int begin, const int end, const float dt);
+	void updateCollisionDisplacement(dtCrowdAgent** agents, const int begin, const int end);
+	void updateCollisionApply(dtCrowdAgent** agents, const int begin, const int end);
+	void updateMovePosition(dtCrowdAgent** agents, const int begin, const int end, const int thread);
 	
 public:
 	dtCrowd();
@@ -312,6 +348,23 @@ public:
 	/// @return The number of agents returned in @p agents.
 	int getActiveAgents(dtCrowdAgent** agents, const int maxAgents);
 
+	/// Enables multithreaded updates, the per agent phases of #update are fanned out through @p parallelFor.
+	///  @param[in]		parallelFor		The parallel for implementation, or null for single threaded updates. [Opt]
+	///  @param[in]		userData		User data passed to @p parallelFor.
+	///  @param[in]		threadCount		The number of distinct thread indices @p parallelFor hands to tasks. [Limit: >= 1]
+	/// @return True if the per thread queries could be allocated and @p parallelFor only used thread indices below @p threadCount.
+	bool setParallelFor(dtCrowdParallelForFunc parallelFor, void* userData, const int threadCount);
+
+	/// Switches planning to another navigation mesh that holds the same tiles under the same references,
+	/// like the other snapshot of a double buffered mesh. Agent corridors are kept, searches in flight restart.
+	///  @param[in]		nav		The navigation mesh to use for planning.
+	/// @return True if the queries could be initialized.
+	bool setNavMesh(const dtNavMesh* nav);
+
+	/// The number of threads the crowd keeps query objects for.
+	/// @return The thread count.
+	int getThreadCount() const { return m_threadCount; }
+
 	/// Updates the steering and positions of all agents.
 	///  @param[in]		dt		The time, in seconds, to update the simulation. [Limit: > 0]
 	///  @param[out]	debug	A debug object to load with debug information. [Opt]
@@ -48,6 +48,7 @@ class dtPathQueue
 	dtPathQueueRef m_nextHandle;
 	int m_maxPathSize;
 	int m_queueHead;
+	int m_maxSearchNodeCount;
 	dtNavMeshQuery* m_navquery;
 	
 	void purge();
@@ -58,6 +59,9 @@ public:
 	
 	bool init(const int maxPathSize, const int maxSearchNodeCount, dtNavMesh* nav);
 	
+	/// Moves the queue to a mesh with the same tiles under the same references, requests in flight restart.
+	bool setNavMesh(const dtNavMesh* nav);
+	
 	void update(const int maxIters);
 	
 	dtPathQueueRef request(dtPolyRef startRef, dtPolyRef endRef,
@@ -50,6 +50,8 @@ static const int MAX_ITERS_PER_UPDATE = 100;
 
 static const int MAX_PATHQUEUE_NODES = 4096;
 static const int MAX_COMMON_NODES = 512;
+static const int MAX_OBSTACLE_CIRCLES = 6;
+static const int MAX_OBSTACLE_SEGMENTS = 8;
 
 inline float tween(const float t, const float t0, const float t1)
 {
@@ -340,7 +342,13 @@ dtCrowd::dtCrowd() :
 	m_maxPathResult(0),
 	m_maxAgentRadius(0),
 	m_velocitySampleCount(0),
-	m_navquery(0)
+	m_navquery(0),
+	m_parallelFor(0),
+	m_parallelForUserData(0),
+	m_threadCount(0),
+	m_threadNavqueries(0),
+	m_threadObstacleQueries(0),
+	m_threadVelocitySamples(0)
 {
 }
 
@@ -351,6 +359,10 @@ dtCrowd::~dtCrowd()
 
 void dtCrowd::purge()
 {
+	purgeThreads();
+	m_parallelFor = 0;
+	m_parallelForUserData = 0;
+
 	for (int i = 0; i < m_maxAgents; ++i)
 		m_agents[i].~dtCrowdAgent();
 	dtFree(m_agents);
@@ -398,7 +410,7 @@ bool dtCrowd::init(const int maxAgents, const float maxAgentRadius, dtNavMesh* n
 	m_obstacleQuery = dtAllocObstacleAvoidanceQuery();
 	if (!m_obstacleQuery)
 		return false;
-	if (!m_obstacleQuery->init(6, 8))
+	if (!m_obstacleQuery->init(MAX_OBSTACLE_CIRCLES, MAX_OBSTACLE_SEGMENTS))
 		return false;
 
 	// Init obstacle query params.
@@ -459,6 +471,151 @@ bool dtCrowd::init(const int maxAgents, const float maxAgentRadius, dtNavMesh* n
 	if (dtStatusFailed(m_navquery->init(nav, MAX_COMMON_NODES)))
 		return false;
 	
+	if (!initThreads(1))
+		return false;
+	
+	return true;
+}
+
+void dtCrowd::purgeThreads()
+{
+	// The first thread uses the crowd's own queries, they are freed with the crowd.
+	for (int i = 1; i < m_threadCount; ++i)
+	{
+		dtFreeNavMeshQuery(m_threadNavqueries[i]);
+		dtFreeObstacleAvoidanceQuery(m_threadObstacleQueries[i]);
+	}
+	dtFree(m_threadNavqueries);
+	m_threadNavqueries = 0;
+	dtFree(m_threadObstacleQueries);
+	m_threadObstacleQueries = 0;
+	dtFree(m_threadVelocitySamples);
+	m_threadVelocitySamples = 0;
+	m_threadCount = 0;
+}
+
+bool dtCrowd::initThreads(const int threadCount)
+{
+	purgeThreads();
+	
+	m_threadNavqueries = (dtNavMeshQuery**)dtAlloc(sizeof(dtNavMeshQuery*)*threadCount, DT_ALLOC_PERM);
+	m_threadObstacleQueries = (dtObstacleAvoidanceQuery**)dtAlloc(sizeof(dtObstacleAvoidanceQuery*)*threadCount, DT_ALLOC_PERM);
+	m_threadVelocitySamples = (int*)dtAlloc(sizeof(int)*threadCount, DT_ALLOC_PERM);
+	if (!m_threadNavqueries || !m_threadObstacleQueries || !m_threadVelocitySamples)
+	{
+		purgeThreads();
+		return false;
+	}
+	memset(m_threadNavqueries, 0, sizeof(dtNavMeshQuery*)*threadCount);
+	memset(m_threadObstacleQueries, 0, sizeof(dtObstacleAvoidanceQuery*)*threadCount);
+	memset(m_threadVelocitySamples, 0, sizeof(int)*threadCount);
+	m_threadCount = threadCount;
+	
+	m_threadNavqueries[0] = m_navquery;
+	m_threadObstacleQueries[0] = m_obstacleQuery;
+	
+	// Queries keep per search state, every other thread gets its own.
+	for (int i = 1; i < threadCount; ++i)
+	{
+		m_threadNavqueries[i] = dtAllocNavMeshQuery();
+		if (!m_threadNavqueries[i])
+			return false;
+		if (dtStatusFailed(m_threadNavqueries[i]->init(m_navquery->getAttachedNavMesh(), MAX_COMMON_NODES)))
+			return false;
+		
+		m_threadObstacleQueries[i] = dtAllocObstacleAvoidanceQuery();
+		if (!m_threadObstacleQueries[i])
+			return false;
+		if (!m_threadObstacleQueries[i]->init(MAX_OBSTACLE_CIRCLES, MAX_OBSTACLE_SEGMENTS))
+			return false;
+	}
+	
+	return true;
+}
+
+bool dtCrowd::setNavMesh(const dtNavMesh* nav)
+{
+	if (!m_navquery)
+		return false;
+	if (m_navquery->getAttachedNavMesh() == nav)
+		return true;
+	
+	if (dtStatusFailed(m_navquery->init(nav, MAX_COMMON_NODES)))
+		return false;
+	for (int i = 1; i < m_threadCount; ++i)
+	{
+		if (dtStatusFailed(m_threadNavqueries[i]->init(nav, MAX_COMMON_NODES)))
+			return false;
+	}
+	return m_pathq.setNavMesh(nav);
+}
+
+// Tasks per thread run by the parallel for check, enough for every thread of a pool to pick some up.
+static const int CHECK_TASKS_PER_THREAD = 4;
+
+static void recordTaskThread(void* taskData, int index, int thread)
+{
+	int* threads = (int*)taskData;
+	threads[index] = thread;
+}
+
+static bool checkParallelFor(dtCrowdParallelForFunc parallelFor, void* userData, const int threadCount)
+{
+	const int ntasks = threadCount*CHECK_TASKS_PER_THREAD;
+	int* threads = (int*)dtAlloc(sizeof(int)*ntasks, DT_ALLOC_TEMP);
+	if (!threads)
+		return false;
+	for (int i = 0; i < ntasks; ++i)
+		threads[i] = -1;
+	
+	parallelFor(userData, recordTaskThread, threads, ntasks);
+	
+	bool valid = true;
+	for (int i = 0; i < ntasks; ++i)
+	{
+		if (threads[i] < 0 || threads[i] >= threadCount)
+			valid = false;
+	}
+	dtFree(threads);
+	return valid;
+}
+
+/// @par
+///
+/// Must be called after #init, re-initializing the crowd returns it to single threaded updates.
+/// @p parallelFor is called from #update only, once per update phase. The calling thread may take part in
+/// running the tasks as long as every thread uses its own index.
+/// @p parallelFor is run once here and rejected when it hands out thread indices outside [0, @p threadCount),
+/// the crowd then stays single threaded.
+bool dtCrowd::setParallelFor(dtCrowdParallelForFunc parallelFor, void* userData, const int threadCount)
+{
+	if (!m_navquery)
+		return false;
+	
+	m_parallelFor = 0;
+	m_parallelForUserData = 0;
+	
+	if (parallelFor && threadCount < 1)
+	{
+		initThreads(1);
+		return false;
+	}
+	
+	const int count = parallelFor ? threadCount : 1;
+	if (!initThreads(count))
+	{
+		initThreads(1);
+		return false;
+	}
+	
+	if (parallelFor && !checkParallelFor(parallelFor, userData, count))
+	{
+		initThreads(1);
+		return false;
+	}
+	
+	m_parallelFor = parallelFor;
+	m_parallelForUserData = userData;
 	return true;
 }
 
@@ -1044,36 +1201,87 @@ void dtCrowd::checkPathValidity(dtCrowdAgent** agents, const int nagents, const
 	}
 }
 	
-void dtCrowd::update(const float dt, dtCrowdAgentDebugInfo* debug)
+// Per agent update phases, each one only writes the state of the agents it is given
+// and reads what earlier phases produced, so the agents of a phase can be processed in any order.
+enum dtCrowdUpdatePhase
 {
-	m_velocitySampleCount = 0;
-	
-	const int debugIdx = debug ? debug->idx : -1;
-	
-	dtCrowdAgent** agents = m_activeAgents;
-	int nagents = getActiveAgents(agents, m_maxAgents);
+	DT_CROWD_PHASE_NEIGHBOURS,
+	DT_CROWD_PHASE_CORNERS,
+	DT_CROWD_PHASE_STEERING,
+	DT_CROWD_PHASE_VELOCITY_PLANNING,
+	DT_CROWD_PHASE_INTEGRATE,
+	DT_CROWD_PHASE_COLLISION_DISPLACEMENT,
+	DT_CROWD_PHASE_COLLISION_APPLY,
+	DT_CROWD_PHASE_MOVE,
+};
+
+struct dtCrowdUpdateTask
+{
+	dtCrowd* crowd;
+	int phase;
+	dtCrowdAgent** agents;
+	int nagents;
+	float dt;
+	dtCrowdAgentDebugInfo* debug;
+};
+
+// Number of agents processed by a single parallel task.
+static const int UPDATE_TASK_AGENTS = 32;
+
+void dtCrowd::runUpdateTask(void* taskData, int index, int thread)
+{
+	const dtCrowdUpdateTask* task = (const dtCrowdUpdateTask*)taskData;
+	dtCrowd* crowd = task->crowd;
+	dtAssert(thread >= 0 && thread < crowd->m_threadCount);
+	const int begin = index*UPDATE_TASK_AGENTS;
+	const int end = dtMin(begin + UPDATE_TASK_AGENTS, task->nagents);
+	crowd->updatePhase(task->phase, task->agents, task->nagents, begin, end, task->dt, task->debug, thread);
+}
 
-	// Check that all agents still have valid paths.
-	checkPathValidity(agents, nagents, dt);
-	
-	// Update async move request and path finder.
-	updateMoveRequest(dt);
+/// @par
+///
+/// Runs the phase over all agents, fanned out over the parallel for function when one is set.
+/// Returns once every agent has been processed, which is the barrier between two phases.
+void dtCrowd::runUpdatePhase(const int phase, dtCrowdAgent** agents, const int nagents, const float dt, dtCrowdAgentDebugInfo* debug)
+{
+	const int ntasks = (nagents + UPDATE_TASK_AGENTS-1) / UPDATE_TASK_AGENTS;
+	if (!m_parallelFor || ntasks < 2)
+	{
+		updatePhase(phase, agents, nagents, 0, nagents, dt, debug, 0);
+		return;
+	}
 
-	// Optimize path topology.
-	updateTopologyOptimization(agents, nagents, dt);
-	
-	// Register agents to proximity grid.
-	m_grid->clear();
-	for (int i = 0; i < nagents; ++i)
+	dtCrowdUpdateTask task;
+	task.crowd = this;
+	task.phase = phase;
+	task.agents = agents;
+	task.nagents = nagents;
+	task.dt = dt;
+	task.debug = debug;
+	m_parallelFor(m_parallelForUserData, runUpdateTask, &task, ntasks);
+}
+
+void dtCrowd::updatePhase(const int phase, dtCrowdAgent** agents, const int nagents, const int begin, const int end,
+						  const float dt, dtCrowdAgentDebugInfo* debug, const int thread)
+{
+	switch (phase)
 	{
-		dtCrowdAgent* ag = agents[i];
-		const float* p = ag->npos;
-		const float r = ag->params.radius;
-		m_grid->addItem((unsigned short)i, p[0]-r, p[2]-r, p[0]+r, p[2]+r);
+		case DT_CROWD_PHASE_NEIGHBOURS: updateNeighbours(agents, nagents, begin, end, thread); break;
+		case DT_CROWD_PHASE_CORNERS: updateCorners(agents, begin, end, debug, thread); break;
+		case DT_CROWD_PHASE_STEERING: updateSteering(agents, begin, end); break;
+		case DT_CROWD_PHASE_VELOCITY_PLANNING: updateVelocityPlanning(agents, begin, end, debug, thread); break;
+		case DT_CROWD_PHASE_INTEGRATE: updateIntegration(agents, begin, end, dt); break;
+		case DT_CROWD_PHASE_COLLISION_DISPLACEMENT: updateCollisionDisplacement(agents, begin, end); break;
+		case DT_CROWD_PHASE_COLLISION_APPLY: updateCollisionApply(agents, begin, end); break;
+		case DT_CROWD_PHASE_MOVE: updateMovePosition(agents, begin, end, thread); break;
 	}
+}
+
+void dtCrowd::updateNeighbours(dtCrowdAgent** agents, const int nagents, const int begin, const int end, const int thread)
+{
+	dtNavMeshQuery* navquery = m_threadNavqueries[thread];
 	
-	// Get nearby navmesh segments and agents to collide with.
-	for (int i = 0; i < nagents; ++i)
+	for (int i = begin; i < end; ++i)
 	{
 		dtCrowdAgent* ag = agents[i];
 		if (ag->state != DT_CROWDAGENT_STATE_WALKING)
@@ -1083,10 +1291,10 @@ void dtCrowd::update(const float dt, dtCrowdAgentDebugInfo* debug)
 		// if it has become invalid.
 		const float updateThr = ag->params.collisionQueryRange*0.25f;
 		if (dtVdist2DSqr(ag->npos, ag->boundary.getCenter()) > dtSqr(updateThr) ||
-			!ag->boundary.isValid(m_navquery, &m_filters[ag->params.queryFilterType]))
+			!ag->boundary.isValid(navquery, &m_filters[ag->params.queryFilterType]))
 		{
 			ag->boundary.update(ag->corridor.getFirstPoly(), ag->npos, ag->params.collisionQueryRange,
-								m_navquery, &m_filters[ag->params.queryFilterType]);
+								navquery, &m_filters[ag->params.queryFilterType]);
 		}
 		// Query neighbour agents
 		ag->nneis = getNeighbours(ag->npos, ag->params.height, ag->params.collisionQueryRange,
@@ -1095,9 +1303,14 @@ void dtCrowd::update(const float dt, dtCrowdAgentDebugInfo* debug)
 		for (int j = 0; j < ag->nneis; j++)
 			ag->neis[j].idx = getAgentIndex(agents[ag->neis[j].idx]);
 	}
+}
+
+void dtCrowd::updateCorners(dtCrowdAgent** agents, const int begin, const int end, dtCrowdAgentDebugInfo* debug, const int thread)
+{
+	dtNavMeshQuery* navquery = m_threadNavqueries[thread];
+	const int debugIdx = debug ? debug->idx : -1;
 	
-	// Find next corner to steer to.
-	for (int i = 0; i < nagents; ++i)
+	for (int i = begin; i < end; ++i)
 	{
 		dtCrowdAgent* ag = agents[i];
 		
@@ -1108,14 +1321,14 @@ void dtCrowd::update(const float dt, dtCrowdAgentDebugInfo* debug)
 		
 		// Find corners for steering
 		ag->ncorners = ag->corridor.findCorners(ag->cornerVerts, ag->cornerFlags, ag->cornerPolys,
-												DT_CROWDAGENT_MAX_CORNERS, m_navquery, &m_filters[ag->params.queryFilterType]);
+												DT_CROWDAGENT_MAX_CORNERS, navquery, &m_filters[ag->params.queryFilterType]);
 		
 		// Check to see if the corner after the next corner is directly visible,
 		// and short cut to there.
 		if ((ag->params.updateFlags & DT_CROWD_OPTIMIZE_VIS) && ag->ncorners > 0)
 		{
 			const float* target = &ag->cornerVerts[dtMin(1,ag->ncorners-1)*3];
-			ag->corridor.optimizePathVisibility(target, ag->params.pathOptimizationRange, m_navquery, &m_filters[ag->params.queryFilterType]);
+			ag->corridor.optimizePathVisibility(target, ag->params.pathOptimizationRange, navquery, &m_filters[ag->params.queryFilterType]);
 			
 			// Copy data for debug purposes.
 			if (debugIdx == i)
@@ -1134,50 +1347,11 @@ void dtCrowd::update(const float dt, dtCrowdAgentDebugInfo* debug)
 			}
 		}
 	}
-	
-	// Trigger off-mesh connections (depends on corners).
-	for (int i = 0; i < nagents; ++i)
-	{
-		dtCrowdAgent* ag = agents[i];
-		
-		if (ag->state != DT_CROWDAGENT_STATE_WALKING)
-			continue;
-		if (ag->targetState == DT_CROWDAGENT_TARGET_NONE || ag->targetState == DT_CROWDAGENT_TARGET_VELOCITY)
-			continue;
-		
-		// Check 
-		const float triggerRadius = ag->params.radius*2.25f;
-		if (overOffmeshConnection(ag, triggerRadius))
-		{
-			// Prepare to off-mesh connection.
-			const int idx = (int)(ag - m_agents);
-			dtCrowdAgentAnimation* anim = &m_agentAnims[idx];
-			
-			// Adjust the path over the off-mesh connection.
-			dtPolyRef refs[2];
-			if (ag->corridor.moveOverOffmeshConnection(ag->cornerPolys[ag->ncorners-1], refs,
-													   anim->startPos, anim->endPos, m_navquery))
-			{
-				dtVcopy(anim->initPos, ag->npos);
-				anim->polyRef = refs[1];
-				anim->active = true;
-				anim->t = 0.0f;
-				anim->tmax = (dtVdist2D(anim->startPos, anim->endPos) / ag->params.maxSpeed) * 0.5f;
-				
-				ag->state = DT_CROWDAGENT_STATE_OFFMESH;
-				ag->ncorners = 0;
-				ag->nneis = 0;
-				continue;
-			}
-			else
-			{
-				// Path validity check will ensure that bad/blocked connections will be replanned.
-			}
-		}
-	}
-		
-	// Calculate steering.
-	for (int i = 0; i < nagents; ++i)
+}
+
+void dtCrowd::updateSteering(dtCrowdAgent** agents, const int begin, const int end)
+{
+	for (int i = begin; i < end; ++i)
 	{
 		dtCrowdAgent* ag = agents[i];
 
@@ -1254,9 +1428,14 @@ void dtCrowd::update(const float dt, dtCrowdAgentDebugInfo* debug)
 		// Set the desired velocity.
 		dtVcopy(ag->dvel, dvel);
 	}
+}
+
+void dtCrowd::updateVelocityPlanning(dtCrowdAgent** agents, const int begin, const int end, dtCrowdAgentDebugInfo* debug, const int thread)
+{
+	dtObstacleAvoidanceQuery* obstacleQuery = m_threadObstacleQueries[thread];
+	const int debugIdx = debug ? debug->idx : -1;
 	
-	// Velocity planning.	
-	for (int i = 0; i < nagents; ++i)
+	for (int i = begin; i < end; ++i)
 	{
 		dtCrowdAgent* ag = agents[i];
 		
@@ -1265,13 +1444,13 @@ void dtCrowd::update(const float dt, dtCrowdAgentDebugInfo* debug)
 		
 		if (ag->params.updateFlags & DT_CROWD_OBSTACLE_AVOIDANCE)
 		{
-			m_obstacleQuery->reset();
+			obstacleQuery->reset();
 			
 			// Add neighbours as obstacles.
 			for (int j = 0; j < ag->nneis; ++j)
 			{
 				const dtCrowdAgent* nei = &m_agents[ag->neis[j].idx];
-				m_obstacleQuery->addCircle(nei->npos, nei->params.radius, nei->vel, nei->dvel);
+				obstacleQuery->addCircle(nei->npos, nei->params.radius, nei->vel, nei->dvel);
 			}
 
 			// Append neighbour segments as obstacles.
@@ -1280,7 +1459,7 @@ void dtCrowd::update(const float dt, dtCrowdAgentDebugInfo* debug)
 				const float* s = ag->boundary.getSegment(j);
 				if (dtTriArea2D(ag->npos, s, s+3) < 0.0f)
 					continue;
-				m_obstacleQuery->addSegment(s, s+3);
+				obstacleQuery->addSegment(s, s+3);
 			}
 
 			dtObstacleAvoidanceDebugData* vod = 0;
@@ -1295,15 +1474,15 @@ void dtCrowd::update(const float dt, dtCrowdAgentDebugInfo* debug)
 				
 			if (adaptive)
 			{
-				ns = m_obstacleQuery->sampleVelocityAdaptive(ag->npos, ag->params.radius, ag->desiredSpeed,
-															 ag->vel, ag->dvel, ag->nvel, params, vod);
+				ns = obstacleQuery->sampleVelocityAdaptive(ag->npos, ag->params.radius, ag->desiredSpeed,
+														   ag->vel, ag->dvel, ag->nvel, params, vod);
 			}
 			else
 			{
-				ns = m_obstacleQuery->sampleVelocityGrid(ag->npos, ag->params.radius, ag->desiredSpeed,
-														 ag->vel, ag->dvel, ag->nvel, params, vod);
+				ns = obstacleQuery->sampleVelocityGrid(ag->npos, ag->params.radius, ag->desiredSpeed,
+													   ag->vel, ag->dvel, ag->nvel, params, vod);
 			}
-			m_velocitySampleCount += ns;
+			m_threadVelocitySamples[thread] += ns;
 		}
 		else
 		{
@@ -1311,91 +1490,100 @@ void dtCrowd::update(const float dt, dtCrowdAgentDebugInfo* debug)
 			dtVcopy(ag->nvel, ag->dvel);
 		}
 	}
+}
 
-	// Integrate.
-	for (int i = 0; i < nagents; ++i)
+void dtCrowd::updateIntegration(dtCrowdAgent** agents, const int begin, const int end, const float dt)
+{
+	for (int i = begin; i < end; ++i)
 	{
 		dtCrowdAgent* ag = agents[i];
 		if (ag->state != DT_CROWDAGENT_STATE_WALKING)
 			continue;
 		integrate(ag, dt);
 	}
-	
-	// Handle collisions.
+}
+
+void dtCrowd::updateCollisionDisplacement(dtCrowdAgent** agents, const int begin, const int end)
+{
 	static const float COLLISION_RESOLVE_FACTOR = 0.7f;
 	
-	for (int iter = 0; iter < 4; ++iter)
+	for (int i = begin; i < end; ++i)
 	{
-		for (int i = 0; i < nagents; ++i)
+		dtCrowdAgent* ag = agents[i];
+		const int idx0 = getAgentIndex(ag);
+		
+		if (ag->state != DT_CROWDAGENT_STATE_WALKING)
+			continue;
+
+		dtVset(ag->disp, 0,0,0);
+		
+		float w = 0;
+
+		for (int j = 0; j < ag->nneis; ++j)
 		{
-			dtCrowdAgent* ag = agents[i];
-			const int idx0 = getAgentIndex(ag);
-			
-			if (ag->state != DT_CROWDAGENT_STATE_WALKING)
-				continue;
+			const dtCrowdAgent* nei = &m_agents[ag->neis[j].idx];
+			const int idx1 = getAgentIndex(nei);
 
-			dtVset(ag->disp, 0,0,0);
+			float diff[3];
+			dtVsub(diff, ag->npos, nei->npos);
+			diff[1] = 0;
 			
-			float w = 0;
-
-			for (int j = 0; j < ag->nneis; ++j)
+			float dist = dtVlenSqr(diff);
+			if (dist > dtSqr(ag->params.radius + nei->params.radius))
+				continue;
+			dist = dtMathSqrtf(dist);
+			float pen = (ag->params.radius + nei->params.radius) - dist;
+			if (dist < 0.0001f)
 			{
-				const dtCrowdAgent* nei = &m_agents[ag->neis[j].idx];
-				const int idx1 = getAgentIndex(nei);
-
-				float diff[3];
-				dtVsub(diff, ag->npos, nei->npos);
-				diff[1] = 0;
-				
-				float dist = dtVlenSqr(diff);
-				if (dist > dtSqr(ag->params.radius + nei->params.radius))
-					continue;
-				dist = dtMathSqrtf(dist);
-				float pen = (ag->params.radius + nei->params.radius) - dist;
-				if (dist < 0.0001f)
-				{
-					// Agents on top of each other, try to choose diverging separation directions.
-					if (idx0 > idx1)
-						dtVset(diff, -ag->dvel[2],0,ag->dvel[0]);
-					else
-						dtVset(diff, ag->dvel[2],0,-ag->dvel[0]);
-					pen = 0.01f;
-				}
+				// Agents on top of each other, try to choose diverging separation directions.
+				if (idx0 > idx1)
+					dtVset(diff, -ag->dvel[2],0,ag->dvel[0]);
 				else
-				{
-					pen = (1.0f/dist) * (pen*0.5f) * COLLISION_RESOLVE_FACTOR;
-				}
-				
-				dtVmad(ag->disp, ag->disp, diff, pen);			
-				
-				w += 1.0f;
+					dtVset(diff, ag->dvel[2],0,-ag->dvel[0]);
+				pen = 0.01f;
 			}
-			
-			if (w > 0.0001f)
+			else
 			{
-				const float iw = 1.0f / w;
-				dtVscale(ag->disp, ag->disp, iw);
+				pen = (1.0f/dist) * (pen*0.5f) * COLLISION_RESOLVE_FACTOR;
 			}
+			
+			dtVmad(ag->disp, ag->disp, diff, pen);			
+			
+			w += 1.0f;
 		}
 		
-		for (int i = 0; i < nagents; ++i)
+		if (w > 0.0001f)
 		{
-			dtCrowdAgent* ag = agents[i];
-			if (ag->state != DT_CROWDAGENT_STATE_WALKING)
-				continue;
-			
-			dtVadd(ag->npos, ag->npos, ag->disp);
+			const float iw = 1.0f / w;
+			dtVscale(ag->disp, ag->disp, iw);
 		}
 	}
+}
+
+void dtCrowd::updateCollisionApply(dtCrowdAgent** agents, const int begin, const int end)
+{
+	for (int i = begin; i < end; ++i)
+	{
+		dtCrowdAgent* ag = agents[i];
+		if (ag->state != DT_CROWDAGENT_STATE_WALKING)
+			continue;
+		
+		dtVadd(ag->npos, ag->npos, ag->disp);
+	}
+}
+
+void dtCrowd::updateMovePosition(dtCrowdAgent** agents, const int begin, const int end, const int thread)
+{
+	dtNavMeshQuery* navquery = m_threadNavqueries[thread];
 	
-	for (int i = 0; i < nagents; ++i)
+	for (int i = begin; i < end; ++i)
 	{
 		dtCrowdAgent* ag = agents[i];
 		if (ag->state != DT_CROWDAGENT_STATE_WALKING)
 			continue;
 		
 		// Move along navmesh.
-		ag->corridor.movePosition(ag->npos, m_navquery, &m_filters[ag->params.queryFilterType]);
+		ag->corridor.movePosition(ag->npos, navquery, &m_filters[ag->params.queryFilterType]);
 		// Get valid constrained position back.
 		dtVcopy(ag->npos, ag->corridor.getPos());
 
@@ -1407,6 +1595,110 @@ void dtCrowd::update(const float dt, dtCrowdAgentDebugInfo* debug)
 		}
 
 	}
+}
+
+/// @par
+///
+/// The per agent phases (boundary and neighbour queries, corner finding, steering, velocity planning,
+/// integration, collision resolution and moving along the navmesh) run through the function set with
+/// #setParallelFor when there is one. Path requests, topology optimization and off-mesh connections are
+/// always processed on the calling thread. The result is the same as a single threaded update.
+void dtCrowd::update(const float dt, dtCrowdAgentDebugInfo* debug)
+{
+	m_velocitySampleCount = 0;
+	for (int i = 0; i < m_threadCount; ++i)
+		m_threadVelocitySamples[i] = 0;
+	
+	dtCrowdAgent** agents = m_activeAgents;
+	int nagents = getActiveAgents(agents, m_maxAgents);
+
+	// Check that all agents still have valid paths.
+	checkPathValidity(agents, nagents, dt);
+	
+	// Update async move request and path finder.
+	updateMoveRequest(dt);
+
+	// Optimize path topology.
+	updateTopologyOptimization(agents, nagents, dt);
+	
+	// Register agents to proximity grid.
+	m_grid->clear();
+	for (int i = 0; i < nagents; ++i)
+	{
+		dtCrowdAgent* ag = agents[i];
+		const float* p = ag->npos;
+		const float r = ag->params.radius;
+		m_grid->addItem((unsigned short)i, p[0]-r, p[2]-r, p[0]+r, p[2]+r);
+	}
+	
+	// Get nearby navmesh segments and agents to collide with.
+	runUpdatePhase(DT_CROWD_PHASE_NEIGHBOURS, agents, nagents, dt, debug);
+	
+	// Find next corner to steer to.
+	runUpdatePhase(DT_CROWD_PHASE_CORNERS, agents, nagents, dt, debug);
+	
+	// Trigger off-mesh connections (depends on corners).
+	for (int i = 0; i < nagents; ++i)
+	{
+		dtCrowdAgent* ag = agents[i];
+		
+		if (ag->state != DT_CROWDAGENT_STATE_WALKING)
+			continue;
+		if (ag->targetState == DT_CROWDAGENT_TARGET_NONE || ag->targetState == DT_CROWDAGENT_TARGET_VELOCITY)
+			continue;
+		
+		// Check 
+		const float triggerRadius = ag->params.radius*2.25f;
+		if (overOffmeshConnection(ag, triggerRadius))
+		{
+			// Prepare to off-mesh connection.
+			const int idx = (int)(ag - m_agents);
+			dtCrowdAgentAnimation* anim = &m_agentAnims[idx];
+			
+			// Adjust the path over the off-mesh connection.
+			dtPolyRef refs[2];
+			if (ag->corridor.moveOverOffmeshConnection(ag->cornerPolys[ag->ncorners-1], refs,
+													   anim->startPos, anim->endPos, m_navquery))
+			{
+				dtVcopy(anim->initPos, ag->npos);
+				anim->polyRef = refs[1];
+				anim->active = true;
+				anim->t = 0.0f;
+				anim->tmax = (dtVdist2D(anim->startPos, anim->endPos) / ag->params.maxSpeed) * 0.5f;
+				
+				ag->state = DT_CROWDAGENT_STATE_OFFMESH;
+				ag->ncorners = 0;
+				ag->nneis = 0;
+				continue;
+			}
+			else
+			{
+				// Path validity check will ensure that bad/blocked connections will be replanned.
+			}
+		}
+	}
+		
+	// Calculate steering.
+	runUpdatePhase(DT_CROWD_PHASE_STEERING, agents, nagents, dt, debug);
+	
+	// Velocity planning.	
+	runUpdatePhase(DT_CROWD_PHASE_VELOCITY_PLANNING, agents, nagents, dt, debug);
+	for (int i = 0; i < m_threadCount; ++i)
+		m_velocitySampleCount += m_threadVelocitySamples[i];
+
+	// Integrate.
+	runUpdatePhase(DT_CROWD_PHASE_INTEGRATE, agents, nagents, dt, debug);
+	
+	// Handle collisions.
+	for (int iter = 0; iter < 4; ++iter)
+	{
+		// All displacements are computed from the positions of the previous iteration before any is applied.
+		runUpdatePhase(DT_CROWD_PHASE_COLLISION_DISPLACEMENT, agents, nagents, dt, debug);
+		runUpdatePhase(DT_CROWD_PHASE_COLLISION_APPLY, agents, nagents, dt, debug);
+	}
+	
+	// Move along navmesh.
+	runUpdatePhase(DT_CROWD_PHASE_MOVE, agents, nagents, dt, debug);
 	
 	// Update agents using off-mesh connection.
 	for (int i = 0; i < m_maxAgents; ++i)
@@ -28,6 +28,7 @@ dtPathQueue::dtPathQueue() :
 	m_nextHandle(1),
 	m_maxPathSize(0),
 	m_queueHead(0),
+	m_maxSearchNodeCount(0),
 	m_navquery(0)
 {
 	for (int i = 0; i < MAX_QUEUE; ++i)
@@ -61,6 +62,7 @@ bool dtPathQueue::init(const int maxPathSize, const int maxSearchNodeCount, dtNa
 		return false;
 	
 	m_maxPathSize = maxPathSize;
+	m_maxSearchNodeCount = maxSearchNodeCount;
 	for (int i = 0; i < MAX_QUEUE; ++i)
 	{
 		m_queue[i].ref = DT_PATHQ_INVALID;
@@ -74,6 +76,22 @@ bool dtPathQueue::init(const int maxPathSize, const int maxSearchNodeCount, dtNa
 	return true;
 }
 
+bool dtPathQueue::setNavMesh(const dtNavMesh* nav)
+{
+	if (!m_navquery)
+		return false;
+	if (dtStatusFailed(m_navquery->init(nav, m_maxSearchNodeCount)))
+		return false;
+	
+	// The sliced search state lived in the query, start those requests over.
+	for (int i = 0; i < MAX_QUEUE; ++i)
+	{
+		if (m_queue[i].ref != DT_PATHQ_INVALID && dtStatusInProgress(m_queue[i].status))
+			m_queue[i].status = 0;
+	}
+	return true;
+}
+
 void dtPathQueue::update(const int maxIters)
 {
 	static const int MAX_KEEP_ALIVE = 2; // in update ticks.
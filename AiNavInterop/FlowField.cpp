@@ -0,0 +1,148 @@
+#include "FlowField.hpp"
+#include <cfloat>
+
+FlowField::FlowField()
+{
+}
+
+FlowField::~FlowField()
+{
+	if (m_navQuery)
+		dtFreeNavMeshQuery(m_navQuery);
+}
+
+int FlowField::Init(NavigationMesh* navmesh, int maxNodes)
+{
+	m_navigation = navmesh;
+	m_navMesh = navmesh->GetNavmesh();
+	m_navQuery = dtAllocNavMeshQuery();
+	if (!m_navQuery)
+		return 0;
+
+	dtStatus status = m_navQuery->init(m_navMesh, maxNodes);
+	if (dtStatusFailed(status))
+		return 0;
+
+	m_maxNodes = maxNodes;
+	m_refs.resize(maxNodes);
+	m_parents.resize(maxNodes);
+	m_costs.resize(maxNodes);
+	m_tiles.assign(m_navMesh->getMaxTiles(), TileRange{ -1, 0 });
+	return 1;
+}
+
+int FlowField::Build(float3 goal, float3 extent, float radius)
+{
+	NavigationReadScope scope(m_navigation);
+	if (m_navMesh != scope.Get().GetNavmesh())
+	{
+		m_navMesh = scope.Get().GetNavmesh();
+		m_navQuery->init(m_navMesh, m_maxNodes);
+	}
+
+	for (int tileIndex : m_touchedTiles)
+		m_tiles[tileIndex].offset = -1;
+	m_touchedTiles.clear();
+	m_entries.clear();
+	m_polyCount = 0;
+	m_goalRef = 0;
+
+	dtStatus status = m_navQuery->findNearestPoly(&goal.x, &extent.x, &m_filter, &m_goalRef, &m_goalPos.x);
+	if (dtStatusFailed(status) || !m_goalRef)
+		return 0;
+
+	// Every node the search touches is returned, so the pool size bounds the result
+	int count = 0;
+	status = m_navQuery->findPolysAroundCircle(m_goalRef, &m_goalPos.x, radius > 0.0f ? radius : FLT_MAX, &m_filter,
+		m_refs.data(), m_parents.data(), m_costs.data(), &count, m_maxNodes);
+	if (dtStatusFailed(status))
+		return 0;
+
+	for (int i = 0; i < count; ++i)
+	{
+		unsigned int tileIndex = m_navMesh->decodePolyIdTile(m_refs[i]);
+		TileRange& range = m_tiles[tileIndex];
+		if (range.offset < 0)
+		{
+			range.offset = (int)m_entries.size();
+			range.polyCount = m_navMesh->getTile(tileIndex)->header->polyCount;
+			m_touchedTiles.push_back(tileIndex);
+			m_entries.resize(m_entries.size() + range.polyCount, Entry{ 0, 0, 0.0f });
+		}
+
+		Entry& entry = m_entries[range.offset + m_navMesh->decodePolyIdPoly(m_refs[i])];
+		entry.ref = m_refs[i];
+		entry.next = m_parents[i];
+		entry.cost = m_costs[i];
+	}
+	m_polyCount = count;
+	return count;
+}
+
+const FlowField::Entry* FlowField::FindEntry(const dtNavMesh* navMesh, dtPolyRef ref) const
+{
+	if (!ref || !navMesh->isValidPolyRef(ref))
+		return nullptr;
+	const TileRange& range = m_tiles[navMesh->decodePolyIdTile(ref)];
+	unsigned int polyIndex = navMesh->decodePolyIdPoly(ref);
+	if (range.offset < 0 || polyIndex >= (unsigned int)range.polyCount)
+		return nullptr;
+
+	// Comparing the whole ref rejects polygons of a tile that was replaced since the build
+	const Entry& entry = m_entries[range.offset + polyIndex];
+	return entry.ref == ref ? &entry : nullptr;
+}
+
+dtPolyRef FlowField::GetGoalRef() const
+{
+	return m_goalRef;
+}
+
+const float3& FlowField::GetGoalPos() const
+{
+	return m_goalPos;
+}
+
+int FlowField::GetPolyCount() const
+{
+	return m_polyCount;
+}
+
+bool FlowField::GetNextHop(dtPolyRef ref, dtPolyRef* next) const
+{
+	NavigationReadScope scope(m_navigation);
+	const Entry* entry = FindEntry(scope.Get().GetNavmesh(), ref);
+	if (!entry)
+		return false;
+	*next = entry->next;
+	return true;
+}
+
+bool FlowField::GetCost(dtPolyRef ref, float* cost) const
+{
+	NavigationReadScope scope(m_navigation);
+	const Entry* entry = FindEntry(scope.Get().GetNavmesh(), ref);
+	if (!entry)
+		return false;
+	*cost = entry->cost;
+	return true;
+}
+
+bool FlowField::GetCorridor(dtPolyRef startRef, dtPolyRef* path, int* pathCount, int maxPath) const
+{
+	NavigationReadScope scope(m_navigation);
+	*pathCount = 0;
+	dtPolyRef ref = startRef;
+	while (ref && *pathCount < maxPath)
+	{
+		const Entry* entry = FindEntry(scope.Get().GetNavmesh(), ref);
+		if (!entry)
+		{
+			*pathCount = 0;
+			return false;
+		}
+		path[(*pathCount)++] = ref;
+		ref = entry->next;
+	}
+	return *pathCount > 0;
+}
@@ -0,0 +1,68 @@
+#pragma once
+#include <DetourNavMesh.h>
+#include <DetourNavMeshQuery.h>
+#include "NavigationMesh.hpp"
+#include <vector>
+
+// Next hop table towards a single goal, for many agents converging on one point.
+// Build runs one Dijkstra search outwards from the goal polygon with findPolysAroundCircle and keeps its parent
+// links, since polygon links and the default costs are symmetric the parent of a polygon is the first step of its
+// shortest path to the goal. The search is bounded by the radius and by the node pool of the field's query.
+// Lookups are O(1) through per tile offsets. Polygons of tiles removed after the build fail the lookup, tiles added
+// after the build are not covered until the next Build.
+class FlowField
+{
+	struct Entry
+	{
+		dtPolyRef ref;
+		dtPolyRef next;
+		float cost;
+	};
+
+	NavigationMesh* m_navigation = nullptr;
+	const dtNavMesh* m_navMesh = nullptr;
+	dtNavMeshQuery* m_navQuery = nullptr;
+	dtQueryFilter m_filter;
+	int m_maxNodes = 0;
+	dtPolyRef m_goalRef = 0;
+	float3 m_goalPos;
+
+	// Entries of a tile index, offset is -1 for tiles the search did not reach
+	struct TileRange
+	{
+		int offset;
+		int polyCount;
+	};
+
+	std::vector<TileRange> m_tiles;
+	std::vector<int> m_touchedTiles;
+	std::vector<Entry> m_entries;
+	int m_polyCount = 0;
+
+	// Search output
+	std::vector<dtPolyRef> m_refs;
+	std::vector<dtPolyRef> m_parents;
+	std::vector<float> m_costs;
+
+	const Entry* FindEntry(const dtNavMesh* navMesh, dtPolyRef ref) const;
+public:
+	FlowField();
+	~FlowField();
+	int Init(NavigationMesh* navmesh, int maxNodes);
+
+	// Builds the field towards the polygon nearest to goal. A radius of 0 or less searches until the node pool is
+	// exhausted. Returns the number of polygons covered, 0 when the goal is not on the navmesh.
+	int Build(float3 goal, float3 extent, float radius);
+
+	dtPolyRef GetGoalRef() const;
+	const float3& GetGoalPos() const;
+	int GetPolyCount() const;
+
+	// Next polygon towards the goal, 0 on the goal polygon. False when the polygon is not covered.
+	bool GetNextHop(dtPolyRef ref, dtPolyRef* next) const;
+	// Cost of the shortest path from the polygon to the goal
+	bool GetCost(dtPolyRef ref, float* cost) const;
+	// Follows the next hops from startRef, path starts with startRef and ends with the goal polygon unless maxPath
+	// polygons were written first. False when startRef is not covered or a hop lies in a removed tile.
+	bool GetCorridor(dtPolyRef startRef, dtPolyRef* path, int* pathCount, int maxPath) const;
+};
@@ -22,6 +22,11 @@ typedef struct DtBoundingBox
 	float3 max;
 } DtBoundingBox;
 
+// Region partitioning of DtBuildSettings::partitionType
+static const int PartitionWatershed = 0;
+static const int PartitionMonotone = 1;
+static const int PartitionLayers = 2;
+
 struct DtBuildSettings
 {
 	// Bounding box for the generated navigation mesh
@@ -40,6 +45,8 @@ struct DtBuildSettings
 	float agentRadius;
 	float agentMaxClimb;
 	float agentMaxSlope;
+	// Watershed gives the best polygons, monotone builds fastest and skips the distance field, layers sits in between
+	int partitionType;
 };
 
 struct DtGeneratedData
@@ -52,6 +59,17 @@ struct DtGeneratedData
 	int navmeshDataLength = 0;
 };
 
+// One tile of a batched build, see NavigationBuilder::BuildNavmeshTiles
+struct DtTileInput
+{
+	DtBuildSettings buildSettings;
+	float3* vertices;
+	int numVertices;
+	int* indices;
+	int numIndices;
+	uint8_t* areas;
+};
+
 
 struct DtCrowdAgent
 {
@@ -68,6 +86,22 @@ struct DtCrowdAgentsResult
 	int agentCount = 0;
 };
 
+// Caller owned structure of arrays, filled with one entry per active agent in ascending agent index order.
+// Arrays left null are skipped, the others must have room for capacity entries.
+struct DtCrowdAgentStates
+{
+	int capacity;
+	int count;
+	int* indices;
+	float3* positions;
+	float3* velocities;
+	float* desiredSpeeds;
+	uint8_t* states;
+	uint8_t* partial;
+	uint32_t* targetRefs;
+	int* corridorLengths;
+};
+
 struct DtAgentParams {
 	float radius;						///< Agent radius. [Limit: >= 0]
 	float height;						///< Agent height. [Limit: > 0]
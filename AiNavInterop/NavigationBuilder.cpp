@@ -22,11 +22,25 @@
 //
 
 #include "DetourNavMeshBuilder.h"
+#include "RecastAlloc.h"
 
 #include "Navigation.hpp"
 #include "NavigationBuilder.hpp"
-#include <corecrt_memory.h>
+#include <cstring>
 #include <math.h>
+#include <atomic>
+
+// Bands per worker, a few more bands than workers keeps them busy when triangles cluster in part of the tile
+static const int RasterBandsPerWorker = 4;
+
+// Region expansion runs once per watershed level, fewer and larger tasks keep the per step overhead down
+static const int RegionBandsPerWorker = 2;
+
+static void RecastParallelFor(void* userData, rcTaskFunc task, void* taskData, int count)
+{
+	WorkerPool* pool = (WorkerPool*)userData;
+	pool->ParallelFor(count, [&](int index, int) { task(taskData, index); });
+}
 
 NavigationBuilder::NavigationBuilder()
 {
@@ -39,9 +53,13 @@ NavigationBuilder::~NavigationBuilder()
 }
 void NavigationBuilder::Cleanup()
 {
+	BuildArena::Scope arenaScope(m_arena.get());
+
 	if (m_navmeshData)
 	{
-		dtFree(m_navmeshData);
+		// The data is no longer ours once AddTileOwned took it out of the result
+		if (m_result.navmeshData == m_navmeshData)
+			dtFree(m_navmeshData);
 		m_navmeshData = nullptr;
 		m_navmeshDataLength = 0;
 	}
@@ -50,9 +68,14 @@ void NavigationBuilder::Cleanup()
 		rcFreeHeightField(m_solid);
 		m_solid = nullptr;
 	}
+	if (m_flatSolid)
+	{
+		rcFreeFlatHeightfield(m_flatSolid);
+		m_flatSolid = nullptr;
+	}
 	if (m_triareas)
 	{
-		delete[] m_triareas;
+		rcFree(m_triareas);
 		m_triareas = nullptr;
 	}
 	if (m_chf)
@@ -70,11 +93,27 @@ void NavigationBuilder::Cleanup()
 		rcFreePolyMeshDetail(m_dmesh);
 		m_dmesh = nullptr;
 	}
+	if (m_cset)
+	{
+		rcFreeContourSet(m_cset);
+		m_cset = nullptr;
+	}
+
+	if (m_arena)
+		m_arena->Reset();
 }
 DtGeneratedData* NavigationBuilder::BuildNavmesh(float3* vertices, int numVertices, int* indices, int numIndices, uint8_t* areas)
 {
+	BuildArena::Scope arenaScope(m_arena.get());
+
+	// Make sure state is clean
+	Cleanup();
+
 	DtGeneratedData* ret = &m_result;
 	ret->success = false;
+	ret->error = 0;
+	ret->navmeshData = nullptr;
+	ret->navmeshDataLength = 0;
 
 	float bmin[3];
 	memcpy(bmin, &m_buildSettings.boundingBox.min.x, sizeof(float) * 3);
@@ -131,10 +170,6 @@ DtGeneratedData* NavigationBuilder::BuildNavmesh(float3* vertices, int numVertic
 	int width = tileSize + borderSize * 2;
 	int height = tileSize + borderSize * 2;
 
-
-	// Make sure state is clean
-	Cleanup();
-
 	if (numIndices == 0 || numVertices == 0)
 		return ret;
 
@@ -148,7 +183,7 @@ DtGeneratedData* NavigationBuilder::BuildNavmesh(float3* vertices, int numVertic
 	}
 
 	int numTriangles = numIndices / 3;
-	m_triareas = new uint8_t[numTriangles];
+	m_triareas = (uint8_t*)rcAlloc(numTriangles, RC_ALLOC_PERM);
 	if (!m_triareas)
 	{
 		return ret;
@@ -167,16 +202,37 @@ DtGeneratedData* NavigationBuilder::BuildNavmesh(float3* vertices, int numVertic
 		}
 	}
 
-	if (!rcRasterizeTriangles(m_context, (float*)vertices, numVertices, indices, m_triareas, numTriangles, *m_solid, walkableClimb))
+	bool rasterized;
+	if (m_parallelRasterization)
+	{
+		WorkerPool* pool = GetPool();
+		rasterized = rcRasterizeTrianglesParallel(m_context, (float*)vertices, numVertices, indices, m_triareas, numTriangles, *m_solid, walkableClimb,
+			RecastParallelFor, pool, pool->GetWorkerCount() * RasterBandsPerWorker);
+	}
+	else
+	{
+		rasterized = rcRasterizeTriangles(m_context, (float*)vertices, numVertices, indices, m_triareas, numTriangles, *m_solid, walkableClimb);
+	}
+	if (!rasterized)
 	{
 		ret->error = 10;
 		return ret;
 	}
 
+	// Copy the span lists into contiguous columns once, the filters and compaction below only walk arrays.
+	m_flatSolid = rcAllocFlatHeightfield();
+	if (!m_flatSolid || !rcBuildFlatHeightfield(m_context, *m_solid, *m_flatSolid))
+	{
+		ret->error = 15;
+		return ret;
+	}
+	rcFreeHeightField(m_solid);
+	m_solid = 0;
+
 	// Filter walkables surfaces.
-	rcFilterLowHangingWalkableObstacles(m_context, walkableClimb, *m_solid);
-	rcFilterLedgeSpans(m_context, walkableHeight, walkableClimb, *m_solid);
-	rcFilterWalkableLowHeightSpans(m_context, walkableHeight, *m_solid);
+	rcFilterLowHangingWalkableObstacles(m_context, walkableClimb, *m_flatSolid);
+	rcFilterLedgeSpans(m_context, walkableHeight, walkableClimb, *m_flatSolid);
+	rcFilterWalkableLowHeightSpans(m_context, walkableHeight, *m_flatSolid);
 
 	// Compact the heightfield so that it is faster to handle from now on.
 	// This will result more cache coherent data as well as the neighbours
@@ -187,15 +243,15 @@ DtGeneratedData* NavigationBuilder::BuildNavmesh(float3* vertices, int numVertic
 		ret->error = 20;
 		return ret;
 	}
-	if (!rcBuildCompactHeightfield(m_context, walkableHeight, walkableClimb, *m_solid, *m_chf))
+	if (!rcBuildCompactHeightfield(m_context, walkableHeight, walkableClimb, *m_flatSolid, *m_chf))
 	{
 		ret->error = 30;
 		return ret;
 	}
 
 	// No longer need solid heightfield after compacting it
-	rcFreeHeightField(m_solid);
-	m_solid = 0;
+	rcFreeFlatHeightfield(m_flatSolid);
+	m_flatSolid = 0;
 
 	// Erode the walkable area by agent radius.
 	if (!rcErodeWalkableArea(m_context, walkableRadius, *m_chf))
@@ -204,14 +260,41 @@ DtGeneratedData* NavigationBuilder::BuildNavmesh(float3* vertices, int numVertic
 		return ret;
 	}
 
-	// Prepare for region partitioning, by calculating distance field along the walkable surface.
-	if (!rcBuildDistanceField(m_context, *m_chf))
+	// Partition the walkable surface into simple regions without holes.
+	// Only watershed needs the distance field along the walkable surface.
+	bool distanceField = true, regions;
+	if (m_buildSettings.partitionType == PartitionMonotone)
+	{
+		regions = rcBuildRegionsMonotone(m_context, *m_chf, borderSize, m_buildSettings.regionMinArea, m_buildSettings.regionMergeArea);
+	}
+	else if (m_buildSettings.partitionType == PartitionLayers)
+	{
+		regions = rcBuildLayerRegions(m_context, *m_chf, borderSize, m_buildSettings.regionMinArea);
+	}
+	else if (m_buildSettings.partitionType != PartitionWatershed)
+	{
+		ret->error = 55;
+		return ret;
+	}
+	else if (m_parallelRegions)
+	{
+		WorkerPool* pool = GetPool();
+		const int bands = pool->GetWorkerCount() * RegionBandsPerWorker;
+		distanceField = rcBuildDistanceFieldParallel(m_context, *m_chf, RecastParallelFor, pool, bands);
+		regions = distanceField && rcBuildRegionsParallel(m_context, *m_chf, borderSize, m_buildSettings.regionMinArea, m_buildSettings.regionMergeArea,
+			RecastParallelFor, pool, bands);
+	}
+	else
+	{
+		distanceField = rcBuildDistanceField(m_context, *m_chf);
+		regions = distanceField && rcBuildRegions(m_context, *m_chf, borderSize, m_buildSettings.regionMinArea, m_buildSettings.regionMergeArea);
+	}
+	if (!distanceField)
 	{
 		ret->error = 50;
 		return ret;
 	}
-	// Partition the walkable surface into simple regions without holes.
-	if (!rcBuildRegions(m_context, *m_chf, borderSize, m_buildSettings.regionMinArea, m_buildSettings.regionMergeArea))
+	if (!regions)
 	{
 		ret->error = 60;
 		return ret;
@@ -306,6 +389,108 @@ DtGeneratedData* NavigationBuilder::BuildNavmesh(float3* vertices, int numVertic
 	return ret;
 }
 
+// Builds every input tile across the worker pool.
+// Unlike BuildNavmesh the navmesh data in outs is owned by the caller, release it with dtFree (FreeNavmeshData).
+// Returns the number of tiles that built successfully.
+int NavigationBuilder::BuildNavmeshTiles(DtTileInput* inputs, int count, DtGeneratedData* outs)
+{
+	if (!inputs || !outs || count <= 0)
+		return 0;
+
+	EnsureWorkers();
+
+	// A lone tile is built by the calling thread's worker so its rasterization and regions can use the whole pool,
+	// the settings and result of this builder stay untouched
+	if (count == 1 && (m_parallelRasterization || m_parallelRegions))
+	{
+		NavigationBuilder* builder = m_workers[0].get();
+		builder->m_parallelRasterization = m_parallelRasterization;
+		builder->m_parallelRegions = m_parallelRegions;
+		builder->SetSettings(inputs[0].buildSettings);
+		DtGeneratedData* result = builder->BuildNavmesh(inputs[0].vertices, inputs[0].numVertices, inputs[0].indices, inputs[0].numIndices, inputs[0].areas);
+		builder->m_parallelRasterization = false;
+		builder->m_parallelRegions = false;
+		outs[0] = *result;
+		result->navmeshData = nullptr;
+		result->navmeshDataLength = 0;
+		return result->success ? 1 : 0;
+	}
+
+	std::atomic<int> built(0);
+	m_pool->ParallelFor(count, [&](int index, int worker)
+	{
+		NavigationBuilder* builder = m_workers[worker].get();
+		const DtTileInput& input = inputs[index];
+
+		builder->SetSettings(input.buildSettings);
+		DtGeneratedData* result = builder->BuildNavmesh(input.vertices, input.numVertices, input.indices, input.numIndices, input.areas);
+		outs[index] = *result;
+
+		// Hand the tile data over to the caller so the next tile on this worker doesn't free it
+		result->navmeshData = nullptr;
+		result->navmeshDataLength = 0;
+		if (result->success)
+			built++;
+	});
+
+	return built;
+}
+
+void NavigationBuilder::EnsureWorkers()
+{
+	if (m_pool)
+		return;
+
+	m_pool.reset(new WorkerPool(WorkerPool::GetDefaultWorkerCount()));
+	for (int i = 0; i < m_pool->GetWorkerCount(); ++i)
+	{
+		m_workers.emplace_back(new NavigationBuilder());
+		m_workers.back()->SetArena(m_arena != nullptr, m_arenaSize);
+		m_workers.back()->m_sharedPool = m_pool.get();
+	}
+}
+
+// Workers run parallel single tile builds on the pool of the builder that owns them
+WorkerPool* NavigationBuilder::GetPool()
+{
+	if (m_sharedPool)
+		return m_sharedPool;
+	EnsureWorkers();
+	return m_pool.get();
+}
+
+// Switches between the system allocator and a per-builder scratch arena.
+// Workers used by batched builds follow the setting of their parent builder.
+void NavigationBuilder::SetArena(bool enabled, size_t initialSize)
+{
+	// Everything allocated so far has to be released by the allocator it came from
+	Cleanup();
+
+	m_arenaSize = initialSize;
+	if (enabled)
+		m_arena.reset(new BuildArena(initialSize));
+	else
+		m_arena.reset();
+
+	for (auto& worker : m_workers)
+		worker->SetArena(enabled, initialSize);
+}
+
+// Splits the rasterization of every BuildNavmesh call into row bands built across the worker pool.
+// The heightfield is the same as a serial build. Batched builds already run one tile per worker, so their workers keep rasterizing serially,
+// only a batch of a single tile is rasterized in bands.
+void NavigationBuilder::SetParallelRasterization(bool enabled)
+{
+	m_parallelRasterization = enabled;
+}
+
+// Builds the distance field and watershed regions of every BuildNavmesh call across the worker pool.
+// The regions are the same as a serial build. Like parallel rasterization it only applies to single tile builds.
+void NavigationBuilder::SetParallelRegions(bool enabled)
+{
+	m_parallelRegions = enabled;
+}
+
 void NavigationBuilder::SetSettings(DtBuildSettings buildSettings)
 {
 	// Copy this to have access to original settings
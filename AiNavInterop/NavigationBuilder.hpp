@@ -1,11 +1,16 @@
 #pragma once
 #include "Recast.h"
 #include "Navigation.hpp"
+#include "BuildArena.hpp"
+#include "WorkerPool.hpp"
 #include <cstdint>
+#include <memory>
+#include <vector>
 
 class NavigationBuilder
 {
 	rcHeightfield* m_solid = nullptr;
+	rcFlatHeightfield* m_flatSolid = nullptr;
 	uint8_t* m_triareas = nullptr;
 	rcCompactHeightfield* m_chf = nullptr;
 	rcContourSet* m_cset = nullptr;
@@ -20,13 +25,34 @@ class NavigationBuilder
 	int m_navmeshDataLength = 0;
 
 	DtGeneratedData m_result;
+
+	// When set all Recast scratch memory of a build comes from this arena and is reset between tiles
+	std::unique_ptr<BuildArena> m_arena;
+	size_t m_arenaSize = 0;
+
+	// Batched builds, each worker builds on its own builder so Recast scratch state is never shared
+	std::unique_ptr<WorkerPool> m_pool;
+	std::vector<std::unique_ptr<NavigationBuilder>> m_workers;
+	// Pool of the parent builder when this builder is one of its workers
+	WorkerPool* m_sharedPool = nullptr;
+
+	// Rasterize single tile builds in row bands across the worker pool
+	bool m_parallelRasterization = false;
+	// Build the distance field and watershed regions of single tile builds across the worker pool
+	bool m_parallelRegions = false;
 public:
 	NavigationBuilder();
 	~NavigationBuilder();
 	void Cleanup();
 	DtGeneratedData* BuildNavmesh(float3* vertices, int numVertices, int* indices, int numIndices, uint8_t* areas);
+	int BuildNavmeshTiles(DtTileInput* inputs, int count, DtGeneratedData* outs);
 	void SetSettings(DtBuildSettings buildSettings);
+	void SetArena(bool enabled, size_t initialSize);
+	void SetParallelRasterization(bool enabled);
+	void SetParallelRegions(bool enabled);
 
 private:
 	int CreateDetourMesh();
+	void EnsureWorkers();
+	WorkerPool* GetPool();
 };
\ No newline at end of file
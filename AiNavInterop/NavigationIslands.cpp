@@ -0,0 +1,299 @@
+#include "NavigationIslands.hpp"
+#include <algorithm>
+
+NavigationIslands::NavigationIslands(const dtNavMesh* navMesh) : m_navMesh(navMesh)
+{
+	m_islands.resize(1);
+}
+
+int NavigationIslands::AllocComponent()
+{
+	if (!m_freeComponents.empty())
+	{
+		int id = m_freeComponents.back();
+		m_freeComponents.pop_back();
+		return id;
+	}
+	m_components.emplace_back();
+	return (int)m_components.size() - 1;
+}
+
+int NavigationIslands::AllocIsland()
+{
+	m_islandCount++;
+	if (!m_freeIslands.empty())
+	{
+		int id = m_freeIslands.back();
+		m_freeIslands.pop_back();
+		return id;
+	}
+	m_islands.emplace_back();
+	return (int)m_islands.size() - 1;
+}
+
+void NavigationIslands::FreeIsland(int island)
+{
+	m_islands[island].clear();
+	m_freeIslands.push_back(island);
+	m_islandCount--;
+}
+
+int NavigationIslands::FindComponent(dtPolyRef ref) const
+{
+	unsigned int salt, tileIndex, polyIndex;
+	m_navMesh->decodePolyId(ref, salt, tileIndex, polyIndex);
+	if (tileIndex >= m_tiles.size())
+		return -1;
+	const Tile& tile = m_tiles[tileIndex];
+	if (polyIndex >= tile.polyComponents.size())
+		return -1;
+	return tile.polyComponents[polyIndex];
+}
+
+int NavigationIslands::FindRoot(int index)
+{
+	while (m_parents[index] != index)
+	{
+		m_parents[index] = m_parents[m_parents[index]];
+		index = m_parents[index];
+	}
+	return index;
+}
+
+void NavigationIslands::Union(int a, int b)
+{
+	a = FindRoot(a);
+	b = FindRoot(b);
+	if (a != b)
+		m_parents[std::max(a, b)] = std::min(a, b);
+}
+
+// Same test as dtQueryFilter::passFilter, which is only inlined inside detour
+bool NavigationIslands::PassFilter(const dtPoly* poly) const
+{
+	return (poly->flags & m_filter.getIncludeFlags()) != 0 && (poly->flags & m_filter.getExcludeFlags()) == 0;
+}
+
+void NavigationIslands::AddTile(dtTileRef tileRef)
+{
+	const dtMeshTile* tile = m_navMesh->getTileByRef(tileRef);
+	if (!tile || !tile->header)
+		return;
+
+	unsigned int tileIndex = m_navMesh->decodePolyIdTile((dtPolyRef)tileRef);
+	if (tileIndex >= m_tiles.size())
+		m_tiles.resize(tileIndex + 1);
+	if (!m_tiles[tileIndex].components.empty())
+		RemoveTile(tileRef);
+
+	// Components inside the tile, links include off-mesh connections
+	int polyCount = tile->header->polyCount;
+	m_parents.resize(polyCount);
+	for (int i = 0; i < polyCount; ++i)
+		m_parents[i] = PassFilter(&tile->polys[i]) ? i : -1;
+	for (int i = 0; i < polyCount; ++i)
+	{
+		if (m_parents[i] < 0)
+			continue;
+		for (unsigned int k = tile->polys[i].firstLink; k != DT_NULL_LINK; k = tile->links[k].next)
+		{
+			dtPolyRef ref = tile->links[k].ref;
+			if (!ref || m_navMesh->decodePolyIdTile(ref) != tileIndex)
+				continue;
+			int other = (int)m_navMesh->decodePolyIdPoly(ref);
+			if (m_parents[other] >= 0)
+				Union(i, other);
+		}
+	}
+
+	// Every new component starts as an island of its own
+	Tile& islandTile = m_tiles[tileIndex];
+	islandTile.polyComponents.assign(polyCount, -1);
+	for (int i = 0; i < polyCount; ++i)
+	{
+		if (m_parents[i] < 0)
+			continue;
+		int root = FindRoot(i);
+		if (root == i)
+		{
+			int id = AllocComponent();
+			int island = AllocIsland();
+			m_components[id].tile = (int)tileIndex;
+			m_components[id].island = island;
+			m_components[id].neighbours.clear();
+			m_islands[island].push_back(id);
+			islandTile.components.push_back(id);
+		}
+		// Roots are the lowest index of their component, so they are assigned before any other member
+		islandTile.polyComponents[i] = root == i ? islandTile.components.back() : islandTile.polyComponents[root];
+	}
+
+	// Detour linked the tile to its neighbours, only those links can merge islands
+	for (int i = 0; i < polyCount; ++i)
+	{
+		int component = islandTile.polyComponents[i];
+		if (component < 0)
+			continue;
+		for (unsigned int k = tile->polys[i].firstLink; k != DT_NULL_LINK; k = tile->links[k].next)
+		{
+			dtPolyRef ref = tile->links[k].ref;
+			if (!ref || m_navMesh->decodePolyIdTile(ref) == tileIndex)
+				continue;
+			int other = FindComponent(ref);
+			if (other >= 0)
+				Connect(component, other);
+		}
+	}
+
+	// One way off-mesh connections only show up as links of the neighbour
+	const int maxLayers = 32;
+	const dtMeshTile* neighbours[maxLayers];
+	for (int y = tile->header->y - 1; y <= tile->header->y + 1; ++y)
+	{
+		for (int x = tile->header->x - 1; x <= tile->header->x + 1; ++x)
+		{
+			int layers = m_navMesh->getTilesAt(x, y, neighbours, maxLayers);
+			for (int n = 0; n < layers; ++n)
+			{
+				const dtMeshTile* neighbour = neighbours[n];
+				unsigned int neighbourIndex = m_navMesh->decodePolyIdTile(m_navMesh->getPolyRefBase(neighbour));
+				if (neighbourIndex == tileIndex || neighbourIndex >= m_tiles.size())
+					continue;
+
+				const std::vector<int>& polyComponents = m_tiles[neighbourIndex].polyComponents;
+				for (int i = 0; i < (int)polyComponents.size(); ++i)
+				{
+					if (polyComponents[i] < 0)
+						continue;
+					for (unsigned int k = neighbour->polys[i].firstLink; k != DT_NULL_LINK; k = neighbour->links[k].next)
+					{
+						dtPolyRef ref = neighbour->links[k].ref;
+						if (!ref || m_navMesh->decodePolyIdTile(ref) != tileIndex)
+							continue;
+						int other = FindComponent(ref);
+						if (other >= 0)
+							Connect(polyComponents[i], other);
+					}
+				}
+			}
+		}
+	}
+}
+
+// Links are treated as undirected, so a one way off-mesh connection merges two islands. That only costs an early
+// out, never a path.
+void NavigationIslands::Connect(int a, int b)
+{
+	std::vector<int>& neighbours = m_components[a].neighbours;
+	if (std::find(neighbours.begin(), neighbours.end(), b) != neighbours.end())
+		return;
+	neighbours.push_back(b);
+	m_components[b].neighbours.push_back(a);
+	MergeIslands(m_components[a].island, m_components[b].island);
+}
+
+// Relabels the smaller island, so a component changes island O(log n) times while a world streams in
+void NavigationIslands::MergeIslands(int a, int b)
+{
+	if (a == b)
+		return;
+	if (m_islands[a].size() < m_islands[b].size())
+		std::swap(a, b);
+
+	std::vector<int>& target = m_islands[a];
+	for (int id : m_islands[b])
+	{
+		m_components[id].island = a;
+		target.push_back(id);
+	}
+	FreeIsland(b);
+}
+
+void NavigationIslands::RemoveTile(dtTileRef tileRef)
+{
+	unsigned int tileIndex = m_navMesh->decodePolyIdTile((dtPolyRef)tileRef);
+	if (tileIndex >= m_tiles.size())
+		return;
+
+	Tile& islandTile = m_tiles[tileIndex];
+	std::vector<int> islands;
+	for (int id : islandTile.components)
+	{
+		Component& component = m_components[id];
+		if (std::find(islands.begin(), islands.end(), component.island) == islands.end())
+			islands.push_back(component.island);
+		for (int other : component.neighbours)
+		{
+			std::vector<int>& neighbours = m_components[other].neighbours;
+			neighbours.erase(std::remove(neighbours.begin(), neighbours.end(), id), neighbours.end());
+		}
+		component.neighbours.clear();
+		component.tile = -1;
+		component.island = 0;
+		m_freeComponents.push_back(id);
+	}
+	islandTile.components.clear();
+	islandTile.polyComponents.clear();
+
+	// Islands the tile was not part of keep their ids and components
+	for (int island : islands)
+		SplitIsland(island);
+}
+
+// Flood fills what is left of an island after some of its components were removed, every connected piece
+// becomes an island of its own
+void NavigationIslands::SplitIsland(int island)
+{
+	std::vector<int> members;
+	members.swap(m_islands[island]);
+	FreeIsland(island);
+	for (int id : members)
+	{
+		if (m_components[id].tile >= 0)
+			m_components[id].island = 0;
+	}
+
+	for (int seed : members)
+	{
+		if (m_components[seed].tile < 0 || m_components[seed].island != 0)
+			continue;
+
+		int piece = AllocIsland();
+		m_components[seed].island = piece;
+		m_stack.assign(1, seed);
+		while (!m_stack.empty())
+		{
+			int id = m_stack.back();
+			m_stack.pop_back();
+			m_islands[piece].push_back(id);
+			for (int other : m_components[id].neighbours)
+			{
+				if (m_components[other].island != 0)
+					continue;
+				m_components[other].island = piece;
+				m_stack.push_back(other);
+			}
+		}
+	}
+}
+
+int NavigationIslands::GetIsland(dtPolyRef ref) const
+{
+	if (!m_navMesh->isValidPolyRef(ref))
+		return 0;
+	int component = FindComponent(ref);
+	if (component < 0)
+		return 0;
+	return m_components[component].island;
+}
+
+int NavigationIslands::GetIslandCount() const
+{
+	return m_islandCount;
+}
+
+bool NavigationIslands::IsConnected(dtPolyRef startRef, dtPolyRef endRef) const
+{
+	int island = GetIsland(startRef);
+	return island != 0 && island == GetIsland(endRef);
+}
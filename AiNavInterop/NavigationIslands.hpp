@@ -0,0 +1,66 @@
+#pragma once
+#include <DetourNavMesh.h>
+#include <DetourNavMeshQuery.h>
+#include <vector>
+
+// Connected regions of the navmesh, so a query between polygons that can never reach each other is rejected
+// without searching. Polygons are grouped into components inside each tile, components are linked across tile
+// borders, and every component gets the id of the island it belongs to.
+// NavigationMesh keeps the islands in sync as tiles are added and removed, so it has the same synchronization
+// requirements as the navmesh. Lookups are const and safe from any number of query threads.
+class NavigationIslands
+{
+	struct Component
+	{
+		int tile;
+		int island;
+		// Components in other tiles linked to this one in either direction
+		std::vector<int> neighbours;
+	};
+
+	struct Tile
+	{
+		// Tile local poly index to component id, -1 for polygons the filter excludes
+		std::vector<int> polyComponents;
+		std::vector<int> components;
+	};
+
+	const dtNavMesh* m_navMesh;
+	dtQueryFilter m_filter;
+	std::vector<Component> m_components;
+	std::vector<int> m_freeComponents;
+	std::vector<Tile> m_tiles;
+	// Components of every island by id, id 0 is never used
+	std::vector<std::vector<int>> m_islands;
+	std::vector<int> m_freeIslands;
+	int m_islandCount = 0;
+
+	// Union find scratch for tile components, flood fill scratch for splitting islands
+	std::vector<int> m_parents;
+	std::vector<int> m_stack;
+
+	int AllocComponent();
+	int AllocIsland();
+	void FreeIsland(int island);
+	int FindComponent(dtPolyRef ref) const;
+	int FindRoot(int index);
+	void Union(int a, int b);
+	bool PassFilter(const dtPoly* poly) const;
+	void Connect(int a, int b);
+	void MergeIslands(int a, int b);
+	void SplitIsland(int island);
+public:
+	NavigationIslands(const dtNavMesh* navMesh);
+
+	// Called after detour added the tile, merges the islands the new tile connects
+	void AddTile(dtTileRef tileRef);
+	// Called before detour removes the tile, splits only the islands the tile was part of
+	void RemoveTile(dtTileRef tileRef);
+
+	// Island id of the polygon, 0 for invalid or excluded polygons.
+	// Ids are stable while an island is unchanged but not contiguous, compare them rather than counting on a range.
+	int GetIsland(dtPolyRef ref) const;
+	int GetIslandCount() const;
+	// False when no path can exist between the polygons
+	bool IsConnected(dtPolyRef startRef, dtPolyRef endRef) const;
+};
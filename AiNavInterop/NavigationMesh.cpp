@@ -1,131 +1,525 @@
-#pragma once
-
 #include "Navigation.hpp"
 #include "NavigationMesh.hpp"
-#include <corecrt_memory.h>
+#include <cstring>
 #include <DetourCommon.h>
 #include <memory>
+#include <thread>
+#include <vector>
 
 static float frand()
 {
 	return (float)rand() / (float)RAND_MAX;
 }
 
+static uint8_t* CopyTileData(const uint8_t* data, int dataLength)
+{
+	uint8_t* copy = new uint8_t[dataLength];
+	memcpy(copy, data, dataLength);
+	return copy;
+}
+
+dtNavMesh* NavigationSnapshot::GetNavmesh() const
+{
+	return m_navMesh;
+}
+
+const ClusterGraph* NavigationSnapshot::GetClusterGraph() const
+{
+	return m_clusterGraph;
+}
+
+const NavigationIslands* NavigationSnapshot::GetIslands() const
+{
+	return m_islands;
+}
+
+uint32_t NavigationSnapshot::GetTileVersion(unsigned int tileIndex) const
+{
+	return tileIndex < m_tileVersions.size() ? m_tileVersions[tileIndex] : 0;
+}
+
+NavigationReadScope::NavigationReadScope(NavigationMesh* navigation)
+{
+	m_navigation = navigation;
+	m_snapshot = navigation->AcquireSnapshot();
+}
+
+NavigationReadScope::~NavigationReadScope()
+{
+	m_navigation->ReleaseSnapshot(m_snapshot);
+}
+
+const NavigationSnapshot& NavigationReadScope::Get() const
+{
+	return *m_snapshot;
+}
 
 NavigationMesh::NavigationMesh()
 {
+	m_published = 0;
+	m_readers[0] = 0;
+	m_readers[1] = 0;
 }
 
 NavigationMesh::~NavigationMesh()
 {
+	for (NavigationSnapshot& snapshot : m_snapshots)
+		DestroySnapshot(snapshot);
+	DiscardChanges();
+
+	for (dtNavMeshQuery* query : m_freeQueries)
+		dtFreeNavMeshQuery(query);
+	m_freeQueries.clear();
+}
+
+int NavigationMesh::Init(float cellTileSize)
+{
+	memset(&m_params, 0, sizeof(m_params));
+	m_params.orig[0] = 0.0f;
+	m_params.orig[1] = 0.0f;
+	m_params.orig[2] = 0.0f;
+	m_params.tileWidth = cellTileSize;
+	m_params.tileHeight = cellTileSize;
+
+	// TODO: Link these parameters to the builder
+	int tileBits = 14;
+	if (tileBits > 14) tileBits = 14;
+	int polyBits = 22 - tileBits;
+	m_params.maxTiles = 1 << tileBits;
+	m_params.maxPolys = 1 << polyBits;
+
+	if (!InitSnapshot(m_snapshots[0]))
+		return 0;
+	m_snapshotCount = 1;
+	return 1;
+}
+
+bool NavigationMesh::InitSnapshot(NavigationSnapshot& snapshot)
+{
+	snapshot.m_navMesh = dtAllocNavMesh();
+	if (!snapshot.m_navMesh)
+		return false;
+	if (dtStatusFailed(snapshot.m_navMesh->init(&m_params)))
+		return false;
+
+	snapshot.m_islands = new NavigationIslands(snapshot.m_navMesh);
+	snapshot.m_tileVersions.assign(m_params.maxTiles, 0);
+	return true;
+}
+
+void NavigationMesh::DestroySnapshot(NavigationSnapshot& snapshot)
+{
+	delete snapshot.m_clusterGraph;
+	snapshot.m_clusterGraph = nullptr;
+	delete snapshot.m_islands;
+	snapshot.m_islands = nullptr;
+
 	// Cleanup allocated tiles
-	for (auto tile : m_tileRefs)
+	for (auto tile : snapshot.m_tileRefs)
+		ReleaseTileData(snapshot, tile.first, tile.second);
+	snapshot.m_tileRefs.clear();
+
+	if (snapshot.m_navMesh) {
+		dtFreeNavMesh(snapshot.m_navMesh);
+		snapshot.m_navMesh = nullptr;
+	}
+}
+
+// Adds the second snapshot so tiles can change while other threads query. Enabling only works before the first tile
+// is added so both snapshots see the same changes, disabling drops the snapshot that is not published.
+int NavigationMesh::EnableConcurrentReads(int enabled)
+{
+	if (m_snapshotCount == 0)
+		return 0;
+
+	std::lock_guard<std::mutex> lock(m_writeLock);
+	int published = m_published.load();
+	NavigationSnapshot& other = m_snapshots[1 - published];
+	if (enabled)
 	{
-		uint8_t* deletedData;
-		int deletedDataLength = 0;
-		dtStatus status = m_navMesh->removeTile(tile, &deletedData, &deletedDataLength);
-		if (dtStatusSucceed(status))
+		if (m_snapshotCount == 2)
+			return 1;
+		if (!m_snapshots[published].m_tileRefs.empty())
+			return 0;
+
+		if (!InitSnapshot(other))
 		{
-			if (deletedData)
-				delete[] deletedData;
+			DestroySnapshot(other);
+			return 0;
 		}
+		if (m_snapshots[published].m_clusterGraph)
+			other.m_clusterGraph = new ClusterGraph(other.m_navMesh);
+		m_snapshotCount = 2;
+		return 1;
 	}
 
-	if (m_navQuery) {
-		dtFreeNavMeshQuery(m_navQuery);
-		m_navQuery = nullptr;
+	if (m_snapshotCount == 1)
+		return 1;
+
+	WaitForReaders(1 - published);
+	DiscardChanges();
+	DestroySnapshot(other);
+	m_snapshotCount = 1;
+	return 1;
+}
+
+// Enters the published snapshot. The reader count is raised before the published index is checked again, so a
+// writer that published in between either sees the count or the reader retries on the new snapshot.
+const NavigationSnapshot* NavigationMesh::AcquireSnapshot()
+{
+	for (;;)
+	{
+		int index = m_published.load();
+		m_readers[index].fetch_add(1);
+		if (m_published.load() == index)
+			return &m_snapshots[index];
+		m_readers[index].fetch_sub(1, std::memory_order_release);
 	}
-		
+}
+
+void NavigationMesh::ReleaseSnapshot(const NavigationSnapshot* snapshot)
+{
+	m_readers[snapshot - m_snapshots].fetch_sub(1, std::memory_order_release);
+}
 
-	if (m_navMesh) {
-		dtFreeNavMesh(m_navMesh);
-		m_navMesh = nullptr;
+void NavigationMesh::WaitForReaders(int index) const
+{
+	while (m_readers[index].load() != 0)
+		std::this_thread::yield();
+}
+
+// Snapshot the next change goes to, brought up to date once the readers it had before the last publish left
+NavigationSnapshot& NavigationMesh::BeginWrite()
+{
+	if (m_snapshotCount == 1)
+		return m_snapshots[m_published.load()];
+
+	int back = 1 - m_published.load();
+	WaitForReaders(back);
+	Replay(m_snapshots[back]);
+	return m_snapshots[back];
+}
+
+// Makes the written snapshot the one readers enter. The old one catches up right away when nobody reads it,
+// otherwise at the start of the next write.
+void NavigationMesh::Publish(NavigationSnapshot& snapshot)
+{
+	if (m_snapshotCount == 1)
+		return;
+
+	int index = (int)(&snapshot - m_snapshots);
+	m_published.store(index);
+	if (m_readers[1 - index].load() == 0)
+		Replay(m_snapshots[1 - index]);
+}
+
+void NavigationMesh::Replay(NavigationSnapshot& snapshot)
+{
+	for (const TileChange& change : m_changes)
+	{
+		if (!change.data)
+			RemoveTileData(snapshot, change.tileRef);
+		else if (!AddTileData(snapshot, change.data, change.dataLength, 0, change.tileRef, change.pack))
+		{
+			if (change.pack)
+				change.pack->Release();
+			else
+				delete[] change.data;
+		}
 	}
-		
+	m_changes.clear();
 }
 
-int NavigationMesh::Init(float cellTileSize)
+// Remembers a change for the snapshot that is not published, added tiles get their own copy of the data
+void NavigationMesh::QueueChange(dtTileRef tileRef, const uint8_t* data, int dataLength)
 {
-	// Allocate objects
-	m_navMesh = dtAllocNavMesh();
-	m_navQuery = dtAllocNavMeshQuery();
+	if (m_snapshotCount == 1)
+		return;
+	m_changes.push_back(TileChange{ tileRef, data ? CopyTileData(data, dataLength) : nullptr, dataLength, nullptr });
+}
 
-	if (!m_navMesh || !m_navQuery)
-		return 0;
+// Pack tiles are replayed from the replica view of the pack, a heap copy is only the fallback when it can't be mapped
+void NavigationMesh::QueuePackChange(dtTileRef tileRef, TilePack* pack, int index)
+{
+	if (m_snapshotCount == 1)
+		return;
 
-	dtNavMeshParams params = { 0 };
-	params.orig[0] = 0.0f;
-	params.orig[1] = 0.0f;
-	params.orig[2] = 0.0f;
-	params.tileWidth = cellTileSize;
-	params.tileHeight = cellTileSize;
+	const TilePackEntry* entry = pack->GetEntry(index);
+	uint8_t* data = pack->GetReplicaTileData(index);
+	if (!data)
+	{
+		QueueChange(tileRef, pack->GetTileData(index), (int)entry->size);
+		return;
+	}
+	pack->AddRef();
+	m_changes.push_back(TileChange{ tileRef, data, (int)entry->size, pack });
+}
 
-	// TODO: Link these parameters to the builder
-	int tileBits = 14;
-	if (tileBits > 14) tileBits = 14;
-	int polyBits = 22 - tileBits;
-	params.maxTiles = 1 << tileBits;
-	params.maxPolys = 1 << polyBits;
+void NavigationMesh::DiscardChanges()
+{
+	for (const TileChange& change : m_changes)
+	{
+		if (change.pack)
+			change.pack->Release();
+		else
+			delete[] change.data;
+	}
+	m_changes.clear();
+}
 
-	dtStatus status = m_navMesh->init(&params);
-	if (dtStatusFailed(status))
+int NavigationMesh::LoadTile(uint8_t* navData, int navDataLength)
+{
+	if (m_snapshotCount == 0)
+		return 0;
+	if (!navData)
 		return 0;
 
-	// Initialize the query object
-	status = m_navQuery->init(m_navMesh, 2048);
-	if (dtStatusFailed(status))
+	std::lock_guard<std::mutex> lock(m_writeLock);
+	NavigationSnapshot& snapshot = BeginWrite();
+
+	// Copy data
+	uint8_t* dataCopy = CopyTileData(navData, navDataLength);
+	dtTileRef tileRef = AddTileData(snapshot, dataCopy, navDataLength, 0, 0, nullptr);
+	if (!tileRef)
+	{
+		delete[] dataCopy;
 		return 0;
+	}
+
+	QueueChange(tileRef, navData, navDataLength);
+	Publish(snapshot);
 	return 1;
 }
 
-int NavigationMesh::LoadTile(uint8_t* navData, int navDataLength)
+// Adds a tile without copying, the navmesh takes ownership of data->navmeshData.
+// The buffer must come from dtAlloc (the builder output) since detour releases it with dtFree.
+// On success the pointer in data is cleared so neither the builder nor the caller frees it again.
+int NavigationMesh::LoadTileOwned(DtGeneratedData* data)
 {
-	if (!m_navMesh || !m_navQuery)
+	if (m_snapshotCount == 0)
 		return 0;
-	if (!navData)
+	if (!data || !data->navmeshData)
 		return 0;
 
-	// Copy data
-	uint8_t* dataCopy = new uint8_t[navDataLength];
-	memcpy(dataCopy, navData, navDataLength);
+	std::lock_guard<std::mutex> lock(m_writeLock);
+	NavigationSnapshot& snapshot = BeginWrite();
 
-	dtTileRef tileRef = 0;
-	if (dtStatusSucceed(m_navMesh->addTile(dataCopy, navDataLength, 0, 0, &tileRef)))
+	// The copy for the other snapshot is taken before detour links the data in
+	uint8_t* navData = data->navmeshData;
+	int navDataLength = data->navmeshDataLength;
+	QueueChange(0, navData, navDataLength);
+	dtTileRef tileRef = AddTileData(snapshot, navData, navDataLength, DT_TILE_FREE_DATA, 0, nullptr);
+	if (!m_changes.empty())
 	{
-		m_tileRefs.insert(tileRef);
-		return 1;
+		// BeginWrite emptied the queue, so the only entry is this tile
+		if (!tileRef)
+		{
+			delete[] m_changes.back().data;
+			m_changes.pop_back();
+		}
+		else
+			m_changes.back().tileRef = tileRef;
 	}
+	if (!tileRef)
+		return 0;
 
-	delete[] dataCopy;
-	return 0;
+	data->navmeshData = nullptr;
+	data->navmeshDataLength = 0;
+	Publish(snapshot);
+	return 1;
+}
+
+// Adds a tile straight from the mapped pack, the tile stays in the mapping and keeps the pack alive while resident
+int NavigationMesh::LoadTileFromPack(TilePack* pack, int index)
+{
+	if (m_snapshotCount == 0)
+		return 0;
+	if (!pack)
+		return 0;
+
+	const TilePackEntry* entry = pack->GetEntry(index);
+	if (!entry)
+		return 0;
+
+	std::lock_guard<std::mutex> lock(m_writeLock);
+	NavigationSnapshot& snapshot = BeginWrite();
+
+	uint8_t* navData = pack->GetTileData(index);
+	dtTileRef tileRef = AddTileData(snapshot, navData, (int)entry->size, 0, 0, pack);
+	if (!tileRef)
+		return 0;
+
+	pack->AddRef();
+	QueuePackChange(tileRef, pack, index);
+	Publish(snapshot);
+	return 1;
 }
 
 int NavigationMesh::RemoveTile(int2 tileCoordinate)
 {
-	dtTileRef tileRef = m_navMesh->getTileRefAt(tileCoordinate.x, tileCoordinate.y, 0);
+	return RemoveTile(tileCoordinate.x, tileCoordinate.y, 0);
+}
 
-	uint8_t* deletedData;
+int NavigationMesh::RemoveTile(int x, int y, int layer)
+{
+	if (m_snapshotCount == 0)
+		return 0;
+
+	std::lock_guard<std::mutex> lock(m_writeLock);
+	NavigationSnapshot& snapshot = BeginWrite();
+	dtTileRef tileRef = snapshot.m_navMesh->getTileRefAt(x, y, layer);
+	if (snapshot.m_tileRefs.find(tileRef) == snapshot.m_tileRefs.end())
+		return 0;
+
+	RemoveTileData(snapshot, tileRef);
+	QueueChange(tileRef, nullptr, 0);
+	Publish(snapshot);
+	return 1;
+}
+
+// Adds the tile to one snapshot, returns its ref or 0 when detour rejected it. A lastRef restores the tile under
+// the ref it got in the other snapshot.
+dtTileRef NavigationMesh::AddTileData(NavigationSnapshot& snapshot, uint8_t* data, int dataLength, int flags, dtTileRef lastRef, TilePack* pack)
+{
+	dtTileRef tileRef = 0;
+	if (dtStatusFailed(snapshot.m_navMesh->addTile(data, dataLength, flags, lastRef, &tileRef)))
+		return 0;
+
+	snapshot.m_tileRefs[tileRef] = pack;
+	snapshot.m_tileVersions[snapshot.m_navMesh->decodePolyIdTile((dtPolyRef)tileRef)]++;
+	if (snapshot.m_islands)
+		snapshot.m_islands->AddTile(tileRef);
+	if (snapshot.m_clusterGraph)
+		snapshot.m_clusterGraph->AddTile(tileRef);
+	return tileRef;
+}
+
+void NavigationMesh::RemoveTileData(NavigationSnapshot& snapshot, dtTileRef tileRef)
+{
+	auto it = snapshot.m_tileRefs.find(tileRef);
+	if (it == snapshot.m_tileRefs.end())
+		return;
+
+	ReleaseTileData(snapshot, it->first, it->second);
+	snapshot.m_tileRefs.erase(it);
+}
+
+void NavigationMesh::ReleaseTileData(NavigationSnapshot& snapshot, dtTileRef tileRef, TilePack* pack)
+{
+	// Owned tiles are freed by removeTile and return no data, copied ones are ours to delete
+	if (snapshot.m_clusterGraph)
+		snapshot.m_clusterGraph->RemoveTile(tileRef);
+	if (snapshot.m_islands)
+		snapshot.m_islands->RemoveTile(tileRef);
+
+	uint8_t* deletedData = nullptr;
 	int deletedDataLength = 0;
-	dtStatus status = m_navMesh->removeTile(tileRef, &deletedData, &deletedDataLength);
-	if (dtStatusSucceed(status))
+	dtStatus status = snapshot.m_navMesh->removeTile(tileRef, &deletedData, &deletedDataLength);
+	if (dtStatusFailed(status))
+		return;
+	snapshot.m_tileVersions[snapshot.m_navMesh->decodePolyIdTile((dtPolyRef)tileRef)]++;
+
+	if (pack)
+		pack->Release();
+	else if (deletedData)
+		delete[] deletedData;
+}
+
+void NavigationMesh::SetClusterGraph(NavigationSnapshot& snapshot, bool enabled)
+{
+	if (!enabled)
 	{
-		if (deletedData)
-			delete[] deletedData;
-		m_tileRefs.erase(tileRef);
+		delete snapshot.m_clusterGraph;
+		snapshot.m_clusterGraph = nullptr;
+		return;
+	}
+	if (snapshot.m_clusterGraph)
+		return;
+
+	snapshot.m_clusterGraph = new ClusterGraph(snapshot.m_navMesh);
+	for (auto tile : snapshot.m_tileRefs)
+		snapshot.m_clusterGraph->AddTile(tile.first);
+}
+
+// Builds the hierarchical graph over the resident tiles, from then on it follows every tile change.
+// With concurrent reads the graph changes like a tile, the snapshot readers left first and then the other one.
+int NavigationMesh::EnableClusterGraph(int enabled)
+{
+	if (m_snapshotCount == 0)
+		return 0;
+
+	std::lock_guard<std::mutex> lock(m_writeLock);
+	NavigationSnapshot& snapshot = BeginWrite();
+	SetClusterGraph(snapshot, enabled != 0);
+	if (m_snapshotCount == 1)
 		return 1;
+
+	Publish(snapshot);
+	int other = 1 - m_published.load();
+	WaitForReaders(other);
+	Replay(m_snapshots[other]);
+	SetClusterGraph(m_snapshots[other], enabled != 0);
+	return 1;
+}
+
+const ClusterGraph* NavigationMesh::GetClusterGraph() const
+{
+	return m_snapshots[m_published.load()].m_clusterGraph;
+}
+
+const NavigationIslands* NavigationMesh::GetIslands() const
+{
+	return m_snapshots[m_published.load()].m_islands;
+}
+
+// Takes a query from the pool and points it at the snapshot in use, its node pool is only reallocated when new
+NavigationMesh::PooledQuery::PooledQuery(NavigationMesh* navigation, const NavigationSnapshot& snapshot)
+{
+	m_navigation = navigation;
+	m_query = nullptr;
+	{
+		std::lock_guard<std::mutex> lock(navigation->m_queryLock);
+		if (!navigation->m_freeQueries.empty())
+		{
+			m_query = navigation->m_freeQueries.back();
+			navigation->m_freeQueries.pop_back();
+		}
+	}
+	if (!m_query)
+		m_query = dtAllocNavMeshQuery();
+	if (m_query && m_query->getAttachedNavMesh() != snapshot.m_navMesh && dtStatusFailed(m_query->init(snapshot.m_navMesh, 2048)))
+	{
+		dtFreeNavMeshQuery(m_query);
+		m_query = nullptr;
 	}
+}
 
-	return 0;
+NavigationMesh::PooledQuery::~PooledQuery()
+{
+	if (!m_query)
+		return;
+	std::lock_guard<std::mutex> lock(m_navigation->m_queryLock);
+	m_navigation->m_freeQueries.push_back(m_query);
+}
+
+dtNavMeshQuery* NavigationMesh::PooledQuery::Get() const
+{
+	return m_query;
 }
 
 int NavigationMesh::GetRandomPosition(float3* result)
 {
+	NavigationReadScope scope(this);
+	PooledQuery navQuery(this, scope.Get());
+	if (!navQuery.Get())
+		return 0;
+
 	dtPolyRef startPoly;
 	float3 startPoint;
 	dtQueryFilter filter;
 	dtStatus status;
 
-	status = m_navQuery->findRandomPoint(&filter, frand, &startPoly, &startPoint.x);
+	status = navQuery.Get()->findRandomPoint(&filter, frand, &startPoly, &startPoint.x);
 	if (dtStatusFailed(status)) {
 		return 0;
 	}
@@ -137,13 +531,18 @@ int NavigationMesh::GetRandomPosition(float3* result)
 
 int NavigationMesh::SamplePosition(float3 point, float3 extent, float3* result)
 {
+	NavigationReadScope scope(this);
+	PooledQuery navQuery(this, scope.Get());
+	if (!navQuery.Get())
+		return 0;
+
 	dtPolyRef startPoly;
 	float3 startPoint;
 
 	dtQueryFilter filter;
 	dtStatus status;
 
-	status = m_navQuery->findNearestPoly(&point.x, &extent.x, &filter, &startPoly, &startPoint.x);
+	status = navQuery.Get()->findNearestPoly(&point.x, &extent.x, &filter, &startPoly, &startPoint.x);
 	if (dtStatusFailed(status) || !startPoly) {
 		return 0;
 	}
@@ -156,6 +555,10 @@ int NavigationMesh::SamplePosition(float3 point, float3 extent, float3* result)
 
 int NavigationMesh::GetLocation(float3 point, float3 extent, float3* result) {
 
+	NavigationReadScope scope(this);
+	PooledQuery navQuery(this, scope.Get());
+	if (!navQuery.Get())
+		return 0;
 	dtPolyRef startPoly;
 	float3 startPoint;
 
@@ -165,12 +568,12 @@ int NavigationMesh::GetLocation(float3 point, float3 extent, float3* result) {
 	float npos[3];
 	bool overlay = false;
 
-	status = m_navQuery->findNearestPoly(&point.x, &extent.x, &filter, &startPoly, npos);
+	status = navQuery.Get()->findNearestPoly(&point.x, &extent.x, &filter, &startPoly, npos);
 	if (dtStatusFailed(status) || !startPoly) {
 		return 0;
 	}
 	
-	status = m_navQuery->closestPointOnPoly(startPoly, npos, &startPoint.x, &overlay);
+	status = navQuery.Get()->closestPointOnPoly(startPoly, npos, &startPoint.x, &overlay);
 	if (dtStatusFailed(status)) {
 		return 0;
 	}
@@ -182,38 +585,39 @@ int NavigationMesh::GetLocation(float3 point, float3 extent, float3* result) {
 
 }
 
-dtNavMeshQuery* NavigationMesh::GetNavmeshQuery()
-{
-	return m_navQuery;
-}
-
 dtNavMesh* NavigationMesh::GetNavmesh()
 {
-	return m_navMesh;
+	return m_snapshots[m_published.load()].m_navMesh;
 }
 
 void NavigationMesh::FindPath(NavMeshPathfindQuery query, NavMeshPathfindResult* result)
 {
+	NavigationReadScope scope(this);
+	PooledQuery navQuery(this, scope.Get());
+
 	// Reset result
 	result->pathFound = false;
+	if (!navQuery.Get())
+		return;
 	dtPolyRef startPoly, endPoly;
 	float3 startPoint, endPoint;
 
 	// Find the starting polygons and point on it to start from
-	dtQueryFilter filter;
+	dtQueryFilter defaultFilter;
+	const dtQueryFilter* filter = query.filter ? query.filter->Get() : &defaultFilter;
 	dtStatus status;
-	status = m_navQuery->findNearestPoly(&query.source.x, &query.findNearestPolyExtent.x, &filter, &startPoly, &startPoint.x);
+	status = navQuery.Get()->findNearestPoly(&query.source.x, &query.findNearestPolyExtent.x, filter, &startPoly, &startPoint.x);
 	if (dtStatusFailed(status))
 		return;
-	status = m_navQuery->findNearestPoly(&query.target.x, &query.findNearestPolyExtent.x, &filter, &endPoly, &endPoint.x);
+	status = navQuery.Get()->findNearestPoly(&query.target.x, &query.findNearestPolyExtent.x, filter, &endPoly, &endPoint.x);
 	if (dtStatusFailed(status))
 		return;
 
 	std::vector<dtPolyRef> polys;
 	polys.resize(query.maxPathPoints);
 	int pathPointCount = 0;
-	status = m_navQuery->findPath(startPoly, endPoly, &startPoint.x, &endPoint.x,
-		&filter, polys.data(), &pathPointCount, polys.size());
+	status = navQuery.Get()->findPath(startPoly, endPoly, &startPoint.x, &endPoint.x,
+		filter, polys.data(), &pathPointCount, polys.size());
 	if (dtStatusFailed(status) || (status & DT_PARTIAL_RESULT) != 0)
 		return;
 
@@ -223,7 +627,7 @@ void NavigationMesh::FindPath(NavMeshPathfindQuery query, NavMeshPathfindResult*
 	straightPath.resize(query.maxPathPoints);
 	straightPathFlags.resize(query.maxPathPoints);
 	straightpathPolys.resize(query.maxPathPoints);
-	status = m_navQuery->findStraightPath(&startPoint.x, &endPoint.x,
+	status = navQuery.Get()->findStraightPath(&startPoint.x, &endPoint.x,
 		polys.data(), pathPointCount,
 		(float*)result->pathPoints, straightPathFlags.data(), straightpathPolys.data(),
 		&result->numPathPoints, query.maxPathPoints);
@@ -234,12 +638,18 @@ void NavigationMesh::FindPath(NavMeshPathfindQuery query, NavMeshPathfindResult*
 
 void NavigationMesh::Raycast(NavMeshRaycastQuery query, NavMeshRaycastResult* result)
 {
+	NavigationReadScope scope(this);
+	PooledQuery navQuery(this, scope.Get());
+
 	// Reset result
 	result->hit = false;
-	dtQueryFilter filter;
+	if (!navQuery.Get())
+		return;
+	dtQueryFilter defaultFilter;
+	const dtQueryFilter* filter = query.filter ? query.filter->Get() : &defaultFilter;
 
 	dtPolyRef startPoly;
-	dtStatus status = m_navQuery->findNearestPoly(&query.start.x, &query.findNearestPolyExtent.x, &filter, &startPoly, 0);
+	dtStatus status = navQuery.Get()->findNearestPoly(&query.start.x, &query.findNearestPolyExtent.x, filter, &startPoly, 0);
 	if (dtStatusFailed(status))
 		return;
 
@@ -247,7 +657,7 @@ void NavigationMesh::Raycast(NavMeshRaycastQuery query, NavMeshRaycastResult* re
 	std::vector<dtPolyRef> polys;
 	polys.resize(query.maxPathPoints);
 	int raycastPolyCount = 0;
-	status = m_navQuery->raycast(startPoly, &query.start.x, &query.end.x, &filter, &t, &result->normal.x, polys.data(), &raycastPolyCount, polys.size());
+	status = navQuery.Get()->raycast(startPoly, &query.start.x, &query.end.x, filter, &t, &result->normal.x, polys.data(), &raycastPolyCount, polys.size());
 	if (dtStatusFailed(status))
 		return;
 
@@ -1,8 +1,15 @@
 #pragma once
 #include <DetourNavMeshQuery.h>
+#include <atomic>
 #include <cstdint>
+#include "ClusterGraph.hpp"
 #include "Navigation.hpp"
-#include <unordered_set>
+#include "NavigationIslands.hpp"
+#include "QueryFilter.hpp"
+#include "TilePack.hpp"
+#include <mutex>
+#include <unordered_map>
+#include <vector>
 
 using namespace std;
 
@@ -13,6 +20,8 @@ struct NavMeshPathfindQuery
 	float3 target;
 	float3 findNearestPolyExtent;
 	int maxPathPoints;
+	// Optional, null uses the default filter
+	const QueryFilter* filter;
 };
 struct NavMeshPathfindResult
 {
@@ -21,12 +30,26 @@ struct NavMeshPathfindResult
 	int numPathPoints = 0;
 };
 
+// Optional outputs of a straight path search, buffers left null are skipped
+struct NavMeshPathfindCorridor
+{
+	// Polygons from the start to the end polygon, room for the query's maxPathPoints
+	dtPolyRef* polys = nullptr;
+	int numPolys = 0;
+	// DT_STRAIGHTPATH_* flags of every path point, room for maxPathPoints
+	uint8_t* pathFlags = nullptr;
+	// Polygon entered at every path point, room for maxPathPoints
+	dtPolyRef* pathPolys = nullptr;
+};
+
 struct NavMeshRaycastQuery
 {
 	float3 start;
 	float3 end;
 	float3 findNearestPolyExtent;
 	int maxPathPoints;
+	// Optional, null uses the default filter
+	const QueryFilter* filter;
 };
 struct NavMeshRaycastResult
 {
@@ -36,24 +59,124 @@ struct NavMeshRaycastResult
 };
 //#pragma pack(pop)
 
+class NavigationMesh;
+
+// One copy of the navmesh and the state derived from it. With concurrent reads enabled the navigation mesh keeps
+// two of them with the same tiles under the same refs, see NavigationMesh.
+class NavigationSnapshot
+{
+	friend class NavigationMesh;
+
+	dtNavMesh* m_navMesh = nullptr;
+	// Resident tiles, mapped to the pack their data lives in or null for heap tiles
+	std::unordered_map<dtTileRef, TilePack*> m_tileRefs;
+	ClusterGraph* m_clusterGraph = nullptr;
+	NavigationIslands* m_islands = nullptr;
+	// Bumped whenever the tile at an index is added or removed, lets cached paths detect replaced tiles
+	std::vector<uint32_t> m_tileVersions;
+public:
+	dtNavMesh* GetNavmesh() const;
+	const ClusterGraph* GetClusterGraph() const;
+	const NavigationIslands* GetIslands() const;
+	uint32_t GetTileVersion(unsigned int tileIndex) const;
+};
+
+// Keeps the published snapshot for its lifetime, tile changes made meanwhile go to the other one.
+// Must not be held by the thread that adds or removes tiles.
+class NavigationReadScope
+{
+	NavigationMesh* m_navigation;
+	const NavigationSnapshot* m_snapshot;
+public:
+	NavigationReadScope(NavigationMesh* navigation);
+	~NavigationReadScope();
+	NavigationReadScope(const NavigationReadScope&) = delete;
+	NavigationReadScope& operator=(const NavigationReadScope&) = delete;
+	const NavigationSnapshot& Get() const;
+};
+
+// Tile changes are serialized by a write lock. Without concurrent reads every query has to be fenced against them
+// by the caller. With concurrent reads there are two snapshots used left-right style:
+// readers enter the published one without locks, a change is applied to the other one and published, and is
+// replayed onto the old one once the readers that entered it before the publish have left. Replays pass the tile
+// ref to addTile, so both snapshots hand out the same refs and readers switching between them keep their
+// corridors. Only writers wait for readers.
+// The second snapshot costs a second copy of every heap tile, detour links tiles in place so the data can't be
+// shared, and every tile change is applied twice including the cluster graph and island updates. Pack tiles are
+// replayed from a second copy-on-write view of the pack, so only the pages detour writes links into are duplicated.
 class NavigationMesh
 {
 private:
-	dtNavMesh* m_navMesh = nullptr;
-	dtNavMeshQuery* m_navQuery = nullptr;
-	std::unordered_set<dtTileRef> m_tileRefs;
+	// A change waiting to be replayed onto the snapshot that is not published, data is null for removals.
+	// Pack tiles point into the replica view of the pack and hold a reference to it.
+	struct TileChange
+	{
+		dtTileRef tileRef;
+		uint8_t* data;
+		int dataLength;
+		TilePack* pack;
+	};
+
+	// Query for the helpers below bound to the snapshot of their read scope. Queries come from a pool, so helper
+	// calls made concurrently under concurrent reads never share one.
+	class PooledQuery
+	{
+		NavigationMesh* m_navigation;
+		dtNavMeshQuery* m_query;
+	public:
+		PooledQuery(NavigationMesh* navigation, const NavigationSnapshot& snapshot);
+		~PooledQuery();
+		PooledQuery(const PooledQuery&) = delete;
+		PooledQuery& operator=(const PooledQuery&) = delete;
+		dtNavMeshQuery* Get() const;
+	};
+
+	std::mutex m_queryLock;
+	std::vector<dtNavMeshQuery*> m_freeQueries;
+	dtNavMeshParams m_params;
+	NavigationSnapshot m_snapshots[2];
+	int m_snapshotCount = 0;
+	std::atomic<int> m_published;
+	alignas(64) std::atomic<int> m_readers[2];
+	alignas(64) std::mutex m_writeLock;
+	std::vector<TileChange> m_changes;
+
+	bool InitSnapshot(NavigationSnapshot& snapshot);
+	void DestroySnapshot(NavigationSnapshot& snapshot);
+	NavigationSnapshot& BeginWrite();
+	void Publish(NavigationSnapshot& snapshot);
+	void WaitForReaders(int index) const;
+	void Replay(NavigationSnapshot& snapshot);
+	void QueueChange(dtTileRef tileRef, const uint8_t* data, int dataLength);
+	void QueuePackChange(dtTileRef tileRef, TilePack* pack, int index);
+	void DiscardChanges();
+	dtTileRef AddTileData(NavigationSnapshot& snapshot, uint8_t* data, int dataLength, int flags, dtTileRef lastRef, TilePack* pack);
+	void RemoveTileData(NavigationSnapshot& snapshot, dtTileRef tileRef);
+	void ReleaseTileData(NavigationSnapshot& snapshot, dtTileRef tileRef, TilePack* pack);
+	void SetClusterGraph(NavigationSnapshot& snapshot, bool enabled);
 public:
 	
 	NavigationMesh();
 	~NavigationMesh();
 	int Init(float cellTileSize);
+	int EnableConcurrentReads(int enabled);
 	int LoadTile(uint8_t* navData, int navDataLength);
+	int LoadTileOwned(DtGeneratedData* data);
+	int LoadTileFromPack(TilePack* pack, int index);
 	int RemoveTile(int2 tileCoordinate);
+	int RemoveTile(int x, int y, int layer);
+	// Convenience queries, each enters the published snapshot with its own query and is safe next to tile changes
+	// once concurrent reads are enabled
 	void FindPath(NavMeshPathfindQuery query, NavMeshPathfindResult* result);
 	void Raycast(NavMeshRaycastQuery query, NavMeshRaycastResult* result);
 	int SamplePosition(float3 point, float3 extent, float3* result);
 	int GetRandomPosition(float3* result);
+	const NavigationSnapshot* AcquireSnapshot();
+	void ReleaseSnapshot(const NavigationSnapshot* snapshot);
+	// Published snapshot, for the thread that changes tiles or when reads are fenced by the caller
 	dtNavMesh* GetNavmesh();
-	dtNavMeshQuery* GetNavmeshQuery();
+	int EnableClusterGraph(int enabled);
+	const ClusterGraph* GetClusterGraph() const;
+	const NavigationIslands* GetIslands() const;
 	int GetLocation(float3 point, float3 extent, float3* result);
 };
@@ -0,0 +1,284 @@
+#include "NearestPolyBatch.hpp"
+#include <DetourCommon.h>
+#include <algorithm>
+#include <cfloat>
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__SSE2__)
+#define AINAV_SSE2 1
+#include <emmintrin.h>
+#endif
+
+// Same test as dtQueryFilter::passFilter, which is only inlined inside detour
+bool NearestPolyBatch::PassFilter(const dtPoly* poly) const
+{
+	return (poly->flags & m_filter->getIncludeFlags()) != 0 && (poly->flags & m_filter->getExcludeFlags()) == 0;
+}
+
+// Body of dtFindNearestPolyQuery::process for a single polygon
+void NearestPolyBatch::ProcessPoly(const dtNavMeshQuery* navQuery, const dtMeshTile* tile, dtPolyRef ref, const float* center, Nearest& nearest) const
+{
+	float closest[3];
+	float diff[3];
+	bool posOverPoly = false;
+	float d;
+	navQuery->closestPointOnPoly(ref, center, closest, &posOverPoly);
+
+	// Directly over a polygon and closer than climb height wins over the straight line nearest point
+	dtVsub(diff, center, closest);
+	if (posOverPoly)
+	{
+		d = dtAbs(diff[1]) - tile->header->walkableClimb;
+		d = d > 0 ? d * d : 0;
+	}
+	else
+		d = dtVlenSqr(diff);
+
+	if (d < nearest.distanceSqr)
+	{
+		dtVcopy(nearest.point, closest);
+		nearest.distanceSqr = d;
+		nearest.ref = ref;
+	}
+}
+
+// Never more than the distance ProcessPoly computes for the node's polygon, so polygons that cannot beat the current
+// nearest skip closestPointOnPoly without changing the result. Leaf bounds come from the detail mesh but are
+// truncated when quantized, one unit of margin on every side keeps the whole polygon inside.
+static float LowerBound(const dtBVNode* node, const float* center, const float* tbmin, float qfac, float walkableClimb)
+{
+	float gap[3];
+	for (int axis = 0; axis < 3; ++axis)
+	{
+		float q = (center[axis] - tbmin[axis]) * qfac;
+		float below = (float)node->bmin[axis] - 1.0f - q;
+		float above = q - (float)node->bmax[axis] - 1.0f;
+		gap[axis] = dtMax(dtMax(below, above), 0.0f) / qfac;
+	}
+
+	// Only a point inside the polygon's xz bounds can be over it and measured by height above climb alone
+	if (gap[0] > 0.0f || gap[2] > 0.0f)
+		return dtVlenSqr(gap);
+	float d = gap[1] - walkableClimb;
+	return d > 0.0f ? d * d : 0.0f;
+}
+
+// Tiles built without a BV tree, same bounds test as queryPolygonsInTile
+void NearestPolyBatch::QueryTileLinear(const dtNavMeshQuery* navQuery, const dtMeshTile* tile, const float* center, const float* extent, Nearest& nearest) const
+{
+	float qmin[3], qmax[3];
+	dtVsub(qmin, center, extent);
+	dtVadd(qmax, center, extent);
+
+	const dtPolyRef base = navQuery->getAttachedNavMesh()->getPolyRefBase(tile);
+	for (int i = 0; i < tile->header->polyCount; ++i)
+	{
+		const dtPoly* poly = &tile->polys[i];
+		if (poly->getType() == DT_POLYTYPE_OFFMESH_CONNECTION || !PassFilter(poly))
+			continue;
+
+		float bmin[3], bmax[3];
+		const float* v = &tile->verts[poly->verts[0] * 3];
+		dtVcopy(bmin, v);
+		dtVcopy(bmax, v);
+		for (int j = 1; j < poly->vertCount; ++j)
+		{
+			v = &tile->verts[poly->verts[j] * 3];
+			dtVmin(bmin, v);
+			dtVmax(bmax, v);
+		}
+		if (dtOverlapBounds(qmin, qmax, bmin, bmax))
+			ProcessPoly(navQuery, tile, base | (dtPolyRef)i, center, nearest);
+	}
+}
+
+// Walks the BV tree once for up to Lanes queries. A subtree is skipped only when no lane overlaps it, leaves are
+// handed to the overlapping lanes in tree order so every query sees its polygons in the same order as alone.
+void NearestPolyBatch::QueryTile(const dtNavMeshQuery* navQuery, const dtMeshTile* tile, const Lookup* lookups, int count,
+	const float3* points, const float3* extents)
+{
+	if (!tile->bvTree)
+	{
+		for (int i = 0; i < count; ++i)
+			QueryTileLinear(navQuery, tile, &points[lookups[i].query].x, &extents[lookups[i].query].x, m_nearest[lookups[i].query]);
+		return;
+	}
+
+	const float* tbmin = tile->header->bmin;
+	const float* tbmax = tile->header->bmax;
+	const float qfac = tile->header->bvQuantFactor;
+
+	// Quantized boxes as in queryPolygonsInTile, unused lanes get an empty box that overlaps nothing
+	alignas(16) int qmin[3][Lanes];
+	alignas(16) int qmax[3][Lanes];
+	for (int lane = 0; lane < Lanes; ++lane)
+	{
+		for (int axis = 0; axis < 3; ++axis)
+		{
+			if (lane >= count)
+			{
+				qmin[axis][lane] = 0x10000;
+				qmax[axis][lane] = -1;
+				continue;
+			}
+			const float* center = &points[lookups[lane].query].x;
+			const float* extent = &extents[lookups[lane].query].x;
+			float minv = dtClamp(center[axis] - extent[axis], tbmin[axis], tbmax[axis]) - tbmin[axis];
+			float maxv = dtClamp(center[axis] + extent[axis], tbmin[axis], tbmax[axis]) - tbmin[axis];
+			qmin[axis][lane] = (unsigned short)(qfac * minv) & 0xfffe;
+			qmax[axis][lane] = (unsigned short)(qfac * maxv + 1) | 1;
+		}
+	}
+
+#if AINAV_SSE2
+	const __m128i minX = _mm_load_si128((const __m128i*)qmin[0]);
+	const __m128i minY = _mm_load_si128((const __m128i*)qmin[1]);
+	const __m128i minZ = _mm_load_si128((const __m128i*)qmin[2]);
+	const __m128i maxX = _mm_load_si128((const __m128i*)qmax[0]);
+	const __m128i maxY = _mm_load_si128((const __m128i*)qmax[1]);
+	const __m128i maxZ = _mm_load_si128((const __m128i*)qmax[2]);
+#endif
+
+	const dtPolyRef base = navQuery->getAttachedNavMesh()->getPolyRefBase(tile);
+	const dtBVNode* node = &tile->bvTree[0];
+	const dtBVNode* end = &tile->bvTree[tile->header->bvNodeCount];
+	while (node < end)
+	{
+#if AINAV_SSE2
+		// A lane misses the node when its box is fully on one side on any axis
+		__m128i separated = _mm_or_si128(
+			_mm_or_si128(_mm_cmpgt_epi32(minX, _mm_set1_epi32(node->bmax[0])), _mm_cmplt_epi32(maxX, _mm_set1_epi32(node->bmin[0]))),
+			_mm_or_si128(
+				_mm_or_si128(_mm_cmpgt_epi32(minY, _mm_set1_epi32(node->bmax[1])), _mm_cmplt_epi32(maxY, _mm_set1_epi32(node->bmin[1]))),
+				_mm_or_si128(_mm_cmpgt_epi32(minZ, _mm_set1_epi32(node->bmax[2])), _mm_cmplt_epi32(maxZ, _mm_set1_epi32(node->bmin[2])))));
+		int overlapMask = ~_mm_movemask_ps(_mm_castsi128_ps(separated)) & ((1 << Lanes) - 1);
+#else
+		int overlapMask = 0;
+		for (int lane = 0; lane < Lanes; ++lane)
+		{
+			bool overlap = qmin[0][lane] <= node->bmax[0] && qmax[0][lane] >= node->bmin[0]
+				&& qmin[1][lane] <= node->bmax[1] && qmax[1][lane] >= node->bmin[1]
+				&& qmin[2][lane] <= node->bmax[2] && qmax[2][lane] >= node->bmin[2];
+			overlapMask |= overlap ? 1 << lane : 0;
+		}
+#endif
+		const bool isLeafNode = node->i >= 0;
+
+		if (isLeafNode && overlapMask && PassFilter(&tile->polys[node->i]))
+		{
+			dtPolyRef ref = base | (dtPolyRef)node->i;
+			for (int lane = 0; lane < count; ++lane)
+			{
+				if (!(overlapMask & (1 << lane)))
+					continue;
+				const float* center = &points[lookups[lane].query].x;
+				Nearest& nearest = m_nearest[lookups[lane].query];
+				if (LowerBound(node, center, tbmin, qfac, tile->header->walkableClimb) < nearest.distanceSqr)
+					ProcessPoly(navQuery, tile, ref, center, nearest);
+			}
+		}
+
+		if (overlapMask || isLeafNode)
+			node++;
+		else
+			node += -node->i;
+	}
+}
+
+void NearestPolyBatch::SortLookups()
+{
+	if (m_lookups.empty())
+		return;
+
+	int minx = m_lookups[0].tx, maxx = minx, miny = m_lookups[0].ty, maxy = miny;
+	for (const Lookup& lookup : m_lookups)
+	{
+		minx = std::min(minx, lookup.tx);
+		maxx = std::max(maxx, lookup.tx);
+		miny = std::min(miny, lookup.ty);
+		maxy = std::max(maxy, lookup.ty);
+	}
+
+	int64_t width = (int64_t)maxx - minx + 1;
+	int64_t buckets = width * ((int64_t)maxy - miny + 1);
+	if (buckets > MaxBuckets)
+	{
+		std::stable_sort(m_lookups.begin(), m_lookups.end(), [](const Lookup& a, const Lookup& b)
+		{
+			return a.ty != b.ty ? a.ty < b.ty : a.tx < b.tx;
+		});
+		return;
+	}
+
+	m_bucketStarts.assign((size_t)buckets + 1, 0);
+	for (const Lookup& lookup : m_lookups)
+		m_bucketStarts[(lookup.ty - miny) * width + (lookup.tx - minx) + 1]++;
+	for (size_t i = 1; i < m_bucketStarts.size(); ++i)
+		m_bucketStarts[i] += m_bucketStarts[i - 1];
+
+	m_sorted.resize(m_lookups.size());
+	for (const Lookup& lookup : m_lookups)
+		m_sorted[m_bucketStarts[(lookup.ty - miny) * width + (lookup.tx - minx)]++] = lookup;
+	m_lookups.swap(m_sorted);
+}
+
+int NearestPolyBatch::Run(const dtNavMeshQuery* navQuery, const dtQueryFilter* filter, const float3* points, const float3* extents, int count, float3* outPos, dtPolyRef* outRef)
+{
+	m_filter = filter;
+	const dtNavMesh* navMesh = navQuery->getAttachedNavMesh();
+	m_lookups.clear();
+	m_nearest.resize(count);
+	for (int i = 0; i < count; ++i)
+	{
+		m_nearest[i].distanceSqr = FLT_MAX;
+		m_nearest[i].ref = 0;
+		if (!dtVisfinite(&points[i].x) || !dtVisfinite(&extents[i].x))
+			continue;
+
+		// One lookup for every tile the box touches, like queryPolygons
+		float bmin[3], bmax[3];
+		dtVsub(bmin, &points[i].x, &extents[i].x);
+		dtVadd(bmax, &points[i].x, &extents[i].x);
+		int minx, miny, maxx, maxy;
+		navMesh->calcTileLoc(bmin, &minx, &miny);
+		navMesh->calcTileLoc(bmax, &maxx, &maxy);
+		for (int y = miny; y <= maxy; ++y)
+		{
+			for (int x = minx; x <= maxx; ++x)
+				m_lookups.push_back(Lookup{ x, y, i });
+		}
+	}
+
+	// Tile by tile in the y then x order queryPolygons visits them. A counting sort over the tile rectangle the
+	// lookups cover keeps the input order within a tile, rectangles too large for buckets use a stable sort.
+	SortLookups();
+
+	static const int MaxLayers = 32;
+	const dtMeshTile* layers[MaxLayers];
+	size_t first = 0;
+	while (first < m_lookups.size())
+	{
+		size_t last = first;
+		while (last < m_lookups.size() && m_lookups[last].tx == m_lookups[first].tx && m_lookups[last].ty == m_lookups[first].ty)
+			last++;
+
+		int layerCount = navMesh->getTilesAt(m_lookups[first].tx, m_lookups[first].ty, layers, MaxLayers);
+		for (size_t chunk = first; chunk < last; chunk += Lanes)
+		{
+			int lanes = (int)std::min((size_t)Lanes, last - chunk);
+			for (int layer = 0; layer < layerCount; ++layer)
+				QueryTile(navQuery, layers[layer], &m_lookups[chunk], lanes, points, extents);
+		}
+		first = last;
+	}
+
+	int found = 0;
+	for (int i = 0; i < count; ++i)
+	{
+		outRef[i] = m_nearest[i].ref;
+		if (!m_nearest[i].ref)
+			continue;
+		outPos[i] = { m_nearest[i].point[0], m_nearest[i].point[1], m_nearest[i].point[2] };
+		found++;
+	}
+	return found;
+}
@@ -0,0 +1,50 @@
+#pragma once
+#include <DetourNavMesh.h>
+#include <DetourNavMeshQuery.h>
+#include "Navigation.hpp"
+#include <cstdint>
+#include <vector>
+
+// findNearestPoly for many points at once, with the same result for every point as one findNearestPoly call.
+// Lookups are sorted by tile so every tile is fetched once, and the boxes of up to Lanes queries in the same tile
+// are tested against each BV tree node together (SSE2 where available), so nearby queries share one traversal.
+// Polygons whose bounds are already farther than a query's nearest polygon skip closestPointOnPoly.
+// Owned by a single query, the scratch is reused between calls.
+class NearestPolyBatch
+{
+public:
+	static const int Lanes = 4;
+	static const int MaxBuckets = 1 << 16;
+
+private:
+	struct Lookup
+	{
+		int tx;
+		int ty;
+		int query;
+	};
+
+	struct Nearest
+	{
+		float distanceSqr;
+		dtPolyRef ref;
+		float point[3];
+	};
+
+	std::vector<Lookup> m_lookups;
+	std::vector<Lookup> m_sorted;
+	std::vector<int> m_bucketStarts;
+	std::vector<Nearest> m_nearest;
+	const dtQueryFilter* m_filter = nullptr;
+
+	void SortLookups();
+	bool PassFilter(const dtPoly* poly) const;
+	void ProcessPoly(const dtNavMeshQuery* navQuery, const dtMeshTile* tile, dtPolyRef ref, const float* center, Nearest& nearest) const;
+	void QueryTile(const dtNavMeshQuery* navQuery, const dtMeshTile* tile, const Lookup* lookups, int count,
+		const float3* points, const float3* extents);
+	void QueryTileLinear(const dtNavMeshQuery* navQuery, const dtMeshTile* tile, const float* center, const float* extent, Nearest& nearest) const;
+public:
+	// Writes the nearest polygon passing the filter to every point, 0 in outRef where none is inside the extents.
+	// outPos is only written where a polygon was found. Returns the number of points with a polygon.
+	int Run(const dtNavMeshQuery* navQuery, const dtQueryFilter* filter, const float3* points, const float3* extents, int count, float3* outPos, dtPolyRef* outRef);
+};
@@ -0,0 +1,114 @@
+#include "PathCache.hpp"
+#include "NavigationMesh.hpp"
+#include <algorithm>
+#include <iterator>
+
+PathCache::PathCache(int capacity) :
+	m_capacity(capacity)
+{
+	m_lookup.reserve(capacity);
+}
+
+bool PathCache::IsCurrent(const NavigationSnapshot& snapshot, const Entry& entry) const
+{
+	for (size_t i = 0; i < entry.tiles.size(); i += 2)
+	{
+		if (snapshot.GetTileVersion(entry.tiles[i]) != entry.tiles[i + 1])
+			return false;
+	}
+	return true;
+}
+
+bool PathCache::Find(const NavigationSnapshot& snapshot, dtPolyRef startRef, dtPolyRef endRef, uint32_t filter, dtPolyRef* path, int* pathCount, int maxPath)
+{
+	auto it = m_lookup.find(Key{ startRef, endRef, filter });
+	if (it == m_lookup.end())
+	{
+		m_misses++;
+		return false;
+	}
+
+	std::list<Entry>::iterator entry = it->second;
+	if (!IsCurrent(snapshot, *entry))
+	{
+		m_lookup.erase(it);
+		m_entries.erase(entry);
+		m_misses++;
+		return false;
+	}
+	if ((int)entry->path.size() > maxPath)
+	{
+		m_misses++;
+		return false;
+	}
+
+	m_entries.splice(m_entries.begin(), m_entries, entry);
+	std::copy(entry->path.begin(), entry->path.end(), path);
+	*pathCount = (int)entry->path.size();
+	m_hits++;
+	return true;
+}
+
+void PathCache::Store(const NavigationSnapshot& snapshot, dtPolyRef startRef, dtPolyRef endRef, uint32_t filter, const dtPolyRef* path, int pathCount)
+{
+	// A corridor cut short by the caller's maxPath would be returned as a full hit to longer queries
+	if (m_capacity <= 0 || pathCount <= 0 || path[pathCount - 1] != endRef)
+		return;
+
+	Key key{ startRef, endRef, filter };
+	auto it = m_lookup.find(key);
+	if (it != m_lookup.end())
+	{
+		m_entries.erase(it->second);
+		m_lookup.erase(it);
+	}
+
+	// Reuse the evicted entry so a warm cache does not allocate
+	if ((int)m_entries.size() >= m_capacity)
+	{
+		m_lookup.erase(m_entries.back().key);
+		m_entries.splice(m_entries.begin(), m_entries, std::prev(m_entries.end()));
+	}
+	else
+		m_entries.emplace_front();
+
+	Entry& entry = m_entries.front();
+	entry.key = key;
+	entry.path.assign(path, path + pathCount);
+	entry.tiles.clear();
+
+	const dtNavMesh* navMesh = snapshot.GetNavmesh();
+	unsigned int lastTile = ~0u;
+	for (int i = 0; i < pathCount; ++i)
+	{
+		unsigned int tileIndex = navMesh->decodePolyIdTile(path[i]);
+		if (tileIndex == lastTile)
+			continue;
+		lastTile = tileIndex;
+
+		bool known = false;
+		for (size_t t = 0; t < entry.tiles.size() && !known; t += 2)
+			known = entry.tiles[t] == tileIndex;
+		if (known)
+			continue;
+		entry.tiles.push_back(tileIndex);
+		entry.tiles.push_back(snapshot.GetTileVersion(tileIndex));
+	}
+	m_lookup[key] = m_entries.begin();
+}
+
+void PathCache::Clear()
+{
+	m_entries.clear();
+	m_lookup.clear();
+}
+
+int PathCache::GetHits() const
+{
+	return m_hits;
+}
+
+int PathCache::GetMisses() const
+{
+	return m_misses;
+}
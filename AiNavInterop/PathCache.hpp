@@ -0,0 +1,69 @@
+#pragma once
+#include <DetourNavMesh.h>
+#include <cstdint>
+#include <list>
+#include <unordered_map>
+#include <vector>
+
+class NavigationSnapshot;
+
+// Least recently used polygon corridors keyed by start and end polygon, owned by a single query.
+// Every entry remembers the version of each tile its corridor crosses and is dropped on lookup once one of those
+// tiles was removed or replaced. Corridors are valid for any points inside the start and end polygons, so agents
+// moving to the same destination from the same polygon share one search.
+// Tiles added elsewhere do not invalidate anything, a cached corridor stays walkable but a new tile may open a
+// shorter route it does not take.
+class PathCache
+{
+	struct Key
+	{
+		dtPolyRef startRef;
+		dtPolyRef endRef;
+		// Filter the corridor was searched with, 0 for the default filter
+		uint32_t filter;
+
+		bool operator==(const Key& other) const
+		{
+			return startRef == other.startRef && endRef == other.endRef && filter == other.filter;
+		}
+	};
+
+	struct KeyHash
+	{
+		size_t operator()(const Key& key) const
+		{
+			uint64_t hash = key.startRef * 0x9E3779B97F4A7C15ull;
+			hash ^= (key.endRef + (hash << 6) + (hash >> 2)) * 0xC2B2AE3D27D4EB4Full;
+			return (size_t)(hash ^ key.filter);
+		}
+	};
+
+	struct Entry
+	{
+		Key key;
+		std::vector<dtPolyRef> path;
+		// Tile index and version pairs of the tiles the corridor crosses
+		std::vector<uint32_t> tiles;
+	};
+
+	int m_capacity;
+	// Most recently used first
+	std::list<Entry> m_entries;
+	std::unordered_map<Key, std::list<Entry>::iterator, KeyHash> m_lookup;
+	int m_hits = 0;
+	int m_misses = 0;
+
+	bool IsCurrent(const NavigationSnapshot& snapshot, const Entry& entry) const;
+public:
+	PathCache(int capacity);
+
+	// Tile versions are read from the snapshot the query runs on, both snapshots of a navmesh keep the same versions.
+	// Copies the cached corridor into path, false on a miss or when it does not fit in maxPath
+	bool Find(const NavigationSnapshot& snapshot, dtPolyRef startRef, dtPolyRef endRef, uint32_t filter, dtPolyRef* path, int* pathCount, int maxPath);
+	// Stores a complete corridor, evicting the least recently used entry when full. Corridors that don't end on endRef are ignored
+	void Store(const NavigationSnapshot& snapshot, dtPolyRef startRef, dtPolyRef endRef, uint32_t filter, const dtPolyRef* path, int pathCount);
+	void Clear();
+
+	int GetHits() const;
+	int GetMisses() const;
+};
@@ -0,0 +1,381 @@
+#include "PathService.hpp"
+#include <algorithm>
+
+// Internal slot states, the low word of Slot::word
+static const uint32_t SlotFree = 0;
+static const uint32_t SlotQueued = 1;
+static const uint32_t SlotRunning = 2;
+static const uint32_t SlotCancelled = 3;
+static const uint32_t SlotSucceeded = 4;
+static const uint32_t SlotFailed = 5;
+
+// Searches a worker interleaves, and the number of detour iterations each one gets per turn
+static const int SearchesPerWorker = 4;
+static const int IterationsPerSlice = 64;
+static const int MaxRequests = 0xffff;
+
+static uint64_t MakeWord(uint32_t handle, uint32_t state)
+{
+	return (uint64_t)handle << 32 | state;
+}
+
+PathRequestRing::PathRequestRing(int capacity)
+{
+	size_t size = 2;
+	while (size < (size_t)capacity)
+		size <<= 1;
+	m_cells = std::vector<Cell>(size);
+	for (size_t i = 0; i < size; ++i)
+		m_cells[i].sequence.store(i, std::memory_order_relaxed);
+	m_mask = size - 1;
+	m_enqueue.store(0, std::memory_order_relaxed);
+	m_dequeue.store(0, std::memory_order_relaxed);
+}
+
+bool PathRequestRing::Push(int value)
+{
+	size_t position = m_enqueue.load(std::memory_order_relaxed);
+	for (;;)
+	{
+		Cell& cell = m_cells[position & m_mask];
+		size_t sequence = cell.sequence.load(std::memory_order_acquire);
+		intptr_t diff = (intptr_t)sequence - (intptr_t)position;
+		if (diff == 0)
+		{
+			if (m_enqueue.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+			{
+				cell.value = value;
+				cell.sequence.store(position + 1, std::memory_order_release);
+				return true;
+			}
+		}
+		else if (diff < 0)
+			return false; // Full
+		else
+			position = m_enqueue.load(std::memory_order_relaxed);
+	}
+}
+
+bool PathRequestRing::Pop(int& value)
+{
+	size_t position = m_dequeue.load(std::memory_order_relaxed);
+	for (;;)
+	{
+		Cell& cell = m_cells[position & m_mask];
+		size_t sequence = cell.sequence.load(std::memory_order_acquire);
+		intptr_t diff = (intptr_t)sequence - (intptr_t)(position + 1);
+		if (diff == 0)
+		{
+			if (m_dequeue.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+			{
+				value = cell.value;
+				cell.sequence.store(position + m_mask + 1, std::memory_order_release);
+				return true;
+			}
+		}
+		else if (diff < 0)
+			return false; // Empty
+		else
+			position = m_dequeue.load(std::memory_order_relaxed);
+	}
+}
+
+PathService::PathService(NavigationMesh* navmesh, int workerCount, int maxNodes, int capacity, int maxPathPoints)
+	: m_requests(std::min(std::max(capacity, 1), MaxRequests)), m_free((int)m_requests.size()), m_queued((int)m_requests.size())
+{
+	m_navmesh = navmesh;
+	m_maxNodes = maxNodes;
+	m_maxPathPoints = std::max(maxPathPoints, 2);
+	m_iterationsPerSlice = IterationsPerSlice;
+	m_queuedCount = 0;
+	m_generation = 0;
+	m_sleeping = 0;
+	m_shutdown = false;
+
+	for (int i = 0; i < (int)m_requests.size(); ++i)
+	{
+		m_requests[i].word = MakeWord(0, SlotFree);
+		m_requests[i].points.resize(m_maxPathPoints);
+		m_requests[i].numPoints = 0;
+		m_free.Push(i);
+	}
+
+	workerCount = std::max(workerCount, 1);
+	for (int i = 0; i < workerCount; ++i)
+		m_workers.emplace_back(&PathService::WorkerMain, this);
+}
+
+PathService::~PathService()
+{
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_shutdown = true;
+	}
+	m_wake.notify_all();
+	for (auto& worker : m_workers)
+		worker.join();
+}
+
+// Queues a path request, returns its handle or 0 when every request slot is in use
+uint32_t PathService::Request(NavMeshPathfindQuery query)
+{
+	int slot;
+	if (!m_free.Pop(slot))
+		return 0;
+
+	// Generation in the high half, never 0 so a valid handle is never 0 either
+	uint32_t generation = m_generation.fetch_add(1, std::memory_order_relaxed) % 0xffff + 1;
+	uint32_t handle = generation << 16 | (uint32_t)slot;
+
+	Slot& request = m_requests[slot];
+	request.query = query;
+	request.query.maxPathPoints = std::min(std::max(query.maxPathPoints, 1), m_maxPathPoints);
+	request.numPoints = 0;
+	request.word.store(MakeWord(handle, SlotQueued), std::memory_order_release);
+
+	// Sequentially consistent on purpose, pairs with the sleeping check in WorkerMain
+	m_queued.Push(slot);
+	m_queuedCount.fetch_add(1);
+	if (m_sleeping.load() > 0)
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_wake.notify_one();
+	}
+	return handle;
+}
+
+// Returns the request status. Once it succeeded or failed the result is written and the handle is released,
+// result->pathPoints needs room for the query's maxPathPoints.
+int PathService::Poll(uint32_t handle, NavMeshPathfindResult* result)
+{
+	int slot = (int)(handle & 0xffff);
+	if (!handle || slot >= (int)m_requests.size())
+		return PathRequestInvalid;
+
+	Slot& request = m_requests[slot];
+	uint64_t word = request.word.load(std::memory_order_acquire);
+	if ((uint32_t)(word >> 32) != handle)
+		return PathRequestInvalid;
+
+	uint32_t state = (uint32_t)word;
+	if (state == SlotQueued || state == SlotRunning)
+		return PathRequestPending;
+	if (state != SlotSucceeded && state != SlotFailed)
+		return PathRequestInvalid;
+
+	// Claim the result, a concurrent Poll or Cancel of the same handle loses here
+	if (!request.word.compare_exchange_strong(word, MakeWord(handle, SlotCancelled), std::memory_order_acq_rel))
+		return PathRequestInvalid;
+
+	if (result)
+	{
+		result->pathFound = state == SlotSucceeded;
+		result->numPathPoints = 0;
+		if (state == SlotSucceeded && result->pathPoints)
+		{
+			std::copy(request.points.begin(), request.points.begin() + request.numPoints, result->pathPoints);
+			result->numPathPoints = request.numPoints;
+		}
+	}
+	FreeSlot(slot);
+	return state == SlotSucceeded ? PathRequestSucceeded : PathRequestFailed;
+}
+
+// Drops a request, pending ones are abandoned by their worker at the next slice
+void PathService::Cancel(uint32_t handle)
+{
+	int slot = (int)(handle & 0xffff);
+	if (!handle || slot >= (int)m_requests.size())
+		return;
+
+	Slot& request = m_requests[slot];
+	uint64_t word = request.word.load(std::memory_order_acquire);
+	for (;;)
+	{
+		if ((uint32_t)(word >> 32) != handle)
+			return;
+		uint32_t state = (uint32_t)word;
+		if (state == SlotQueued || state == SlotRunning)
+		{
+			if (request.word.compare_exchange_weak(word, MakeWord(handle, SlotCancelled), std::memory_order_acq_rel))
+				return;
+		}
+		else if (state == SlotSucceeded || state == SlotFailed)
+		{
+			if (request.word.compare_exchange_weak(word, MakeWord(handle, SlotCancelled), std::memory_order_acq_rel))
+			{
+				FreeSlot(slot);
+				return;
+			}
+		}
+		else
+			return;
+	}
+}
+
+int PathService::GetPendingCount() const
+{
+	int pending = 0;
+	for (const auto& request : m_requests)
+	{
+		uint32_t state = (uint32_t)request.word.load(std::memory_order_relaxed);
+		if (state == SlotQueued || state == SlotRunning)
+			pending++;
+	}
+	return pending;
+}
+
+void PathService::FreeSlot(int slot)
+{
+	m_requests[slot].word.store(MakeWord(0, SlotFree), std::memory_order_release);
+	m_free.Push(slot);
+}
+
+// Publishes a finished search unless the request was cancelled in the meantime
+void PathService::Complete(int slot, uint32_t handle, int state)
+{
+	uint64_t expected = MakeWord(handle, SlotRunning);
+	if (!m_requests[slot].word.compare_exchange_strong(expected, MakeWord(handle, (uint32_t)state), std::memory_order_acq_rel))
+		FreeSlot(slot);
+}
+
+// Finishes the running search and lets go of its snapshot, a state of SlotCancelled only frees the slot
+void PathService::EndSearch(Search& search, int state)
+{
+	if (state == SlotCancelled)
+		FreeSlot(search.slot);
+	else
+		Complete(search.slot, search.handle, state);
+	m_navmesh->ReleaseSnapshot(search.snapshot);
+	search.snapshot = nullptr;
+}
+
+// Takes the next queued request, returns false when the queue is empty
+bool PathService::BeginSearch(Search& search, std::vector<dtPolyRef>& polys)
+{
+	for (;;)
+	{
+		int slot;
+		if (!m_queued.Pop(slot))
+			return false;
+		m_queuedCount.fetch_sub(1, std::memory_order_relaxed);
+
+		Slot& request = m_requests[slot];
+		uint64_t word = request.word.load(std::memory_order_acquire);
+		uint32_t handle = (uint32_t)(word >> 32);
+		if ((uint32_t)word != SlotQueued || !request.word.compare_exchange_strong(word, MakeWord(handle, SlotRunning), std::memory_order_acq_rel))
+		{
+			FreeSlot(slot); // Cancelled while queued
+			continue;
+		}
+
+		// The search stays on this snapshot for all its slices
+		search.slot = slot;
+		search.handle = handle;
+		search.snapshot = m_navmesh->AcquireSnapshot();
+		dtNavMeshQuery* navQuery = search.navQuery;
+		if (navQuery->getAttachedNavMesh() != search.snapshot->GetNavmesh())
+			navQuery->init(search.snapshot->GetNavmesh(), m_maxNodes);
+
+		const NavMeshPathfindQuery& query = request.query;
+		dtPolyRef startPoly = 0, endPoly = 0;
+		const dtQueryFilter* filter = query.filter ? query.filter->Get() : &m_filter;
+		dtStatus status = navQuery->findNearestPoly(&query.source.x, &query.findNearestPolyExtent.x, filter, &startPoly, search.startPoint);
+		if (dtStatusSucceed(status))
+			status = navQuery->findNearestPoly(&query.target.x, &query.findNearestPolyExtent.x, filter, &endPoly, search.endPoint);
+		// Unreachable targets fail here instead of searching every polygon on the start island
+		const NavigationIslands* islands = search.snapshot->GetIslands();
+		if (dtStatusSucceed(status) && islands && !islands->IsConnected(startPoly, endPoly))
+			status = DT_FAILURE;
+		if (dtStatusSucceed(status))
+			status = navQuery->initSlicedFindPath(startPoly, endPoly, search.startPoint, search.endPoint, filter);
+		if (dtStatusFailed(status))
+		{
+			EndSearch(search, SlotFailed);
+			continue;
+		}
+
+		if ((int)polys.size() < query.maxPathPoints)
+			polys.resize(query.maxPathPoints);
+		return true;
+	}
+}
+
+// Runs one slice of the search, returns false once the search is finished
+bool PathService::StepSearch(Search& search, std::vector<dtPolyRef>& polys)
+{
+	Slot& request = m_requests[search.slot];
+	if ((uint32_t)request.word.load(std::memory_order_acquire) == SlotCancelled)
+	{
+		EndSearch(search, SlotCancelled);
+		return false;
+	}
+
+	dtNavMeshQuery* navQuery = search.navQuery;
+	dtStatus status = navQuery->updateSlicedFindPath(m_iterationsPerSlice, nullptr);
+	if (dtStatusInProgress(status))
+		return true;
+
+	// Same rules as AiQuery::FindStraightPath, partial paths count as failures
+	int polyCount = 0;
+	if (dtStatusSucceed(status))
+		status = navQuery->finalizeSlicedFindPath(polys.data(), &polyCount, request.query.maxPathPoints);
+	if (dtStatusFailed(status) || (status & DT_PARTIAL_RESULT) != 0)
+	{
+		EndSearch(search, SlotFailed);
+		return false;
+	}
+
+	status = navQuery->findStraightPath(search.startPoint, search.endPoint, polys.data(), polyCount,
+		&request.points[0].x, nullptr, nullptr, &request.numPoints, request.query.maxPathPoints);
+	EndSearch(search, dtStatusFailed(status) ? SlotFailed : SlotSucceeded);
+	return false;
+}
+
+void PathService::WorkerMain()
+{
+	dtNavMesh* navMesh = m_navmesh->GetNavmesh();
+	std::vector<Search> searches(SearchesPerWorker);
+	std::vector<bool> active(SearchesPerWorker, false);
+	std::vector<std::vector<dtPolyRef>> polys(SearchesPerWorker);
+	for (auto& search : searches)
+	{
+		search.navQuery = dtAllocNavMeshQuery();
+		search.navQuery->init(navMesh, m_maxNodes);
+		search.snapshot = nullptr;
+	}
+
+	while (!m_shutdown.load(std::memory_order_acquire))
+	{
+		int running = 0;
+		for (int i = 0; i < SearchesPerWorker; ++i)
+		{
+			if (!active[i])
+				active[i] = BeginSearch(searches[i], polys[i]);
+			if (active[i])
+				running++;
+		}
+
+		if (running == 0)
+		{
+			std::unique_lock<std::mutex> lock(m_mutex);
+			m_sleeping++;
+			m_wake.wait(lock, [&] { return m_shutdown.load() || m_queuedCount.load() > 0; });
+			m_sleeping--;
+			continue;
+		}
+
+		for (int i = 0; i < SearchesPerWorker; ++i)
+		{
+			if (active[i])
+				active[i] = StepSearch(searches[i], polys[i]);
+		}
+	}
+
+	for (int i = 0; i < SearchesPerWorker; ++i)
+	{
+		if (active[i])
+			EndSearch(searches[i], SlotFailed);
+		dtFreeNavMeshQuery(searches[i].navQuery);
+	}
+}
@@ -0,0 +1,93 @@
+#pragma once
+#include "NavigationMesh.hpp"
+#include <DetourNavMeshQuery.h>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Request status returned by PathService::Poll
+static const int PathRequestInvalid = 0;
+static const int PathRequestPending = 1;
+static const int PathRequestSucceeded = 2;
+static const int PathRequestFailed = 3;
+
+// Bounded multi producer multi consumer queue of slot indices, lock free
+class PathRequestRing
+{
+	struct Cell
+	{
+		std::atomic<size_t> sequence;
+		int value;
+	};
+
+	std::vector<Cell> m_cells;
+	size_t m_mask = 0;
+	alignas(64) std::atomic<size_t> m_enqueue;
+	alignas(64) std::atomic<size_t> m_dequeue;
+public:
+	PathRequestRing(int capacity);
+	bool Push(int value);
+	bool Pop(int& value);
+};
+
+// Finds straight paths on worker threads. Each worker owns a few dtNavMeshQuery instances and round robins
+// updateSlicedFindPath over them, so a long search only delays the requests sharing its worker by one slice.
+// Request never blocks, results are picked up by handle with Poll.
+// Every search holds the navmesh snapshot it started on until it finishes. With concurrent reads enabled tiles can
+// change while requests are pending, otherwise they must not be added or removed until the requests finished.
+class PathService
+{
+	struct Slot
+	{
+		// Handle in the high 32 bits, state in the low ones, so a stale handle never matches a reused slot
+		std::atomic<uint64_t> word;
+		NavMeshPathfindQuery query;
+		std::vector<float3> points;
+		int numPoints;
+	};
+
+	struct Search
+	{
+		dtNavMeshQuery* navQuery;
+		const NavigationSnapshot* snapshot;
+		int slot;
+		uint32_t handle;
+		float startPoint[3];
+		float endPoint[3];
+	};
+
+	NavigationMesh* m_navmesh;
+	dtQueryFilter m_filter;
+	int m_maxNodes;
+	int m_maxPathPoints;
+	int m_iterationsPerSlice;
+
+	std::vector<Slot> m_requests;
+	PathRequestRing m_free;
+	PathRequestRing m_queued;
+	std::atomic<int> m_queuedCount;
+	std::atomic<uint32_t> m_generation;
+
+	std::vector<std::thread> m_workers;
+	std::mutex m_mutex;
+	std::condition_variable m_wake;
+	std::atomic<int> m_sleeping;
+	std::atomic<bool> m_shutdown;
+
+	void WorkerMain();
+	bool BeginSearch(Search& search, std::vector<dtPolyRef>& polys);
+	bool StepSearch(Search& search, std::vector<dtPolyRef>& polys);
+	void EndSearch(Search& search, int state);
+	void Complete(int slot, uint32_t handle, int state);
+	void FreeSlot(int slot);
+public:
+	PathService(NavigationMesh* navmesh, int workerCount, int maxNodes, int capacity, int maxPathPoints);
+	~PathService();
+	uint32_t Request(NavMeshPathfindQuery query);
+	int Poll(uint32_t handle, NavMeshPathfindResult* result);
+	void Cancel(uint32_t handle);
+	int GetPendingCount() const;
+};
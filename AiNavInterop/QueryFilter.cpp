@@ -0,0 +1,54 @@
+#include "QueryFilter.hpp"
+
+std::atomic<uint32_t> QueryFilter::s_nextId(1);
+
+QueryFilter::QueryFilter()
+{
+	Touch();
+}
+
+void QueryFilter::Touch()
+{
+	uint32_t id = s_nextId++;
+	if (id == 0)
+		id = s_nextId++;
+	m_id = id;
+}
+
+void QueryFilter::SetIncludeFlags(unsigned short flags)
+{
+	m_filter.setIncludeFlags(flags);
+	Touch();
+}
+
+void QueryFilter::SetExcludeFlags(unsigned short flags)
+{
+	m_filter.setExcludeFlags(flags);
+	Touch();
+}
+
+bool QueryFilter::SetAreaCost(int area, float cost)
+{
+	if (area < 0 || area >= DT_MAX_AREAS)
+		return false;
+	m_filter.setAreaCost(area, cost);
+	Touch();
+	return true;
+}
+
+float QueryFilter::GetAreaCost(int area) const
+{
+	if (area < 0 || area >= DT_MAX_AREAS)
+		return 0.0f;
+	return m_filter.getAreaCost(area);
+}
+
+const dtQueryFilter* QueryFilter::Get() const
+{
+	return &m_filter;
+}
+
+uint32_t QueryFilter::GetId() const
+{
+	return m_id;
+}
@@ -0,0 +1,30 @@
+#pragma once
+#include <DetourNavMeshQuery.h>
+#include <atomic>
+#include <cstdint>
+
+// Polygon flags and area costs shared by queries, path service requests and crowd filter slots through a handle.
+// Wraps the plain dtQueryFilter, custom costs are table data so every query keeps the inlined non virtual getCost
+// of the default filter. Every change takes a new id, caches key their entries by it so results searched with
+// older costs are never returned. Filters must not change while a path service request using them is pending.
+class QueryFilter
+{
+	static std::atomic<uint32_t> s_nextId;
+
+	dtQueryFilter m_filter;
+	uint32_t m_id;
+
+	void Touch();
+public:
+	QueryFilter();
+
+	void SetIncludeFlags(unsigned short flags);
+	void SetExcludeFlags(unsigned short flags);
+	// False for areas outside 0..DT_MAX_AREAS-1
+	bool SetAreaCost(int area, float cost);
+	float GetAreaCost(int area) const;
+
+	const dtQueryFilter* Get() const;
+	// Unique among all filters and changes, never 0 which caches use for the default filter
+	uint32_t GetId() const;
+};
@@ -0,0 +1,100 @@
+#include "RayBatch.hpp"
+#include <DetourCommon.h>
+#include <algorithm>
+
+// Looks up the rays in m_unresolved, identical start points share one lookup
+void RayBatch::ResolveStarts(const dtNavMeshQuery* navQuery, NearestPolyBatch& nearestBatch, const dtQueryFilter* filter,
+	const float3* starts, const float3& extent)
+{
+	std::sort(m_unresolved.begin(), m_unresolved.end(), [starts](int a, int b)
+	{
+		const float3& pa = starts[a];
+		const float3& pb = starts[b];
+		if (pa.x != pb.x) return pa.x < pb.x;
+		if (pa.z != pb.z) return pa.z < pb.z;
+		if (pa.y != pb.y) return pa.y < pb.y;
+		return a < b;
+	});
+
+	m_points.clear();
+	for (size_t i = 0; i < m_unresolved.size(); ++i)
+	{
+		const float3& point = starts[m_unresolved[i]];
+		if (m_points.empty() || m_points.back().x != point.x || m_points.back().y != point.y || m_points.back().z != point.z)
+			m_points.push_back(point);
+	}
+
+	int pointCount = (int)m_points.size();
+	m_extents.assign(pointCount, extent);
+	m_nearestPos.resize(pointCount);
+	m_nearestRefs.resize(pointCount);
+	nearestBatch.Run(navQuery, filter, m_points.data(), m_extents.data(), pointCount, m_nearestPos.data(), m_nearestRefs.data());
+
+	int point = -1;
+	for (size_t i = 0; i < m_unresolved.size(); ++i)
+	{
+		const float3& start = starts[m_unresolved[i]];
+		if (point < 0 || m_points[point].x != start.x || m_points[point].y != start.y || m_points[point].z != start.z)
+			point++;
+		m_rays[m_unresolved[i]].ref = m_nearestRefs[point];
+	}
+}
+
+int RayBatch::Run(const dtNavMeshQuery* navQuery, NearestPolyBatch& nearestBatch, const dtQueryFilter* filter, const float3* starts,
+	const float3* ends, const dtPolyRef* startRefs, int count, float3 extent, dtPolyRef* visited, int maxVisited,
+	NavMeshRaycastBatchResult* results)
+{
+	if (count <= 0)
+		return 0;
+
+	m_rays.resize(count);
+	m_unresolved.clear();
+	for (int i = 0; i < count; ++i)
+	{
+		// Non-finite rays can't start, they would also break the ordering the start lookup sorts by
+		if (!dtVisfinite(&starts[i].x) || !dtVisfinite(&ends[i].x))
+		{
+			m_rays[i] = Ray{ 0, i };
+			continue;
+		}
+
+		dtPolyRef ref = startRefs ? startRefs[i] : 0;
+		m_rays[i] = Ray{ ref, i };
+		if (!ref || !navQuery->isValidPolyRef(ref, filter))
+			m_unresolved.push_back(i);
+	}
+	if (!m_unresolved.empty())
+		ResolveStarts(navQuery, nearestBatch, filter, starts, extent);
+
+	// Rays from the same polygon one after another
+	std::sort(m_rays.begin(), m_rays.end(), [](const Ray& a, const Ray& b)
+	{
+		return a.ref != b.ref ? a.ref < b.ref : a.index < b.index;
+	});
+
+	bool hitOnly = !visited || maxVisited <= 0;
+	int cast = 0;
+	for (const Ray& ray : m_rays)
+	{
+		NavMeshRaycastBatchResult& result = results[ray.index];
+		result.t = -1.0f;
+		result.normal = { 0.0f, 0.0f, 0.0f };
+		result.startRef = ray.ref;
+		result.visitedCount = 0;
+		if (!ray.ref)
+			continue;
+
+		dtRaycastHit hit;
+		hit.path = hitOnly ? nullptr : visited + (size_t)ray.index * maxVisited;
+		hit.maxPath = hitOnly ? 0 : maxVisited;
+		dtStatus status = navQuery->raycast(ray.ref, &starts[ray.index].x, &ends[ray.index].x, filter, 0, &hit);
+		if (dtStatusFailed(status))
+			continue;
+
+		result.t = hit.t;
+		result.normal = { hit.hitNormal[0], hit.hitNormal[1], hit.hitNormal[2] };
+		result.visitedCount = hit.pathCount;
+		cast++;
+	}
+	return cast;
+}
@@ -0,0 +1,48 @@
+#pragma once
+#include <DetourNavMesh.h>
+#include <DetourNavMeshQuery.h>
+#include "Navigation.hpp"
+#include "NearestPolyBatch.hpp"
+#include <vector>
+
+// Per ray result of RayBatch::Run
+struct NavMeshRaycastBatchResult
+{
+	// Fraction of the ray walked before a wall, FLT_MAX when it reached the end and -1 when it could not start
+	float t;
+	float3 normal;
+	// Polygon the ray started in, can be passed back as a start ref on the next batch
+	dtPolyRef startRef;
+	// Polygons written to the visited list, 0 in hit only mode
+	int visitedCount;
+};
+
+// dtNavMeshQuery::raycast for many rays at once, with the same result per ray as AiQuery::Raycast.
+// Missing start refs are resolved with one NearestPolyBatch run over the distinct start points, so rays fired from
+// the same origin share a single lookup. Rays are then cast grouped by start polygon to keep its tile in cache.
+// Owned by a single query, the scratch is reused between calls.
+class RayBatch
+{
+	struct Ray
+	{
+		dtPolyRef ref;
+		int index;
+	};
+
+	std::vector<Ray> m_rays;
+	std::vector<int> m_unresolved;
+	std::vector<float3> m_points;
+	std::vector<float3> m_extents;
+	std::vector<float3> m_nearestPos;
+	std::vector<dtPolyRef> m_nearestRefs;
+
+	void ResolveStarts(const dtNavMeshQuery* navQuery, NearestPolyBatch& nearestBatch, const dtQueryFilter* filter,
+		const float3* starts, const float3& extent);
+public:
+	// startRefs is optional, a 0 or stale ref is looked up within extent around the start. Without a visited buffer
+	// the rays run in hit only mode, otherwise ray i writes up to maxVisited polygons at visited + i * maxVisited.
+	// Returns the number of rays that could start.
+	int Run(const dtNavMeshQuery* navQuery, NearestPolyBatch& nearestBatch, const dtQueryFilter* filter, const float3* starts,
+		const float3* ends, const dtPolyRef* startRefs, int count, float3 extent, dtPolyRef* visited, int maxVisited,
+		NavMeshRaycastBatchResult* results);
+};
@@ -312,6 +312,40 @@ private:
 	rcHeightfield& operator=(const rcHeightfield&);
 };
 
+/// Represents a span in a flat heightfield.
+/// @see rcFlatHeightfield
+struct rcFlatSpan
+{
+	unsigned short smin;	///< The lower limit of the span. [Limit: < #smax]
+	unsigned short smax;	///< The upper limit of the span. [Limit: <= #RC_SPAN_MAX_HEIGHT]
+	unsigned char area;		///< The area id assigned to the span.
+};
+
+/// A heightfield holding the spans of every column in one contiguous array, sorted from the bottom up.
+/// Built from a rasterized #rcHeightfield so the filters and compaction read plain arrays instead of
+/// following span lists across the span pools.
+/// @ingroup recast
+struct rcFlatHeightfield
+{
+	rcFlatHeightfield();
+	~rcFlatHeightfield();
+
+	int width;			///< The width of the heightfield. (Along the x-axis in cell units.)
+	int height;			///< The height of the heightfield. (Along the z-axis in cell units.)
+	float bmin[3];  	///< The minimum bounds in world space. [(x, y, z)]
+	float bmax[3];		///< The maximum bounds in world space. [(x, y, z)]
+	float cs;			///< The size of each cell. (On the xz-plane.)
+	float ch;			///< The height of each cell. (The minimum increment along the y-axis.)
+	int* columns;		///< Column x + y*width holds the spans [columns[i], columns[i+1]). [Size: width*height + 1]
+	rcFlatSpan* spans;	///< All spans, ordered by column. [Size: #spanCount]
+	int spanCount;		///< The number of spans.
+
+private:
+	// Explicitly-disabled copy constructor and copy assignment operator.
+	rcFlatHeightfield(const rcFlatHeightfield&);
+	rcFlatHeightfield& operator=(const rcFlatHeightfield&);
+};
+
 /// Provides information on the content of a cell column in a compact heightfield. 
 struct rcCompactCell
 {
@@ -466,6 +500,18 @@ rcHeightfield* rcAllocHeightfield();
 ///  @see rcAllocHeightfield
 void rcFreeHeightField(rcHeightfield* hf);
 
+/// Allocates a flat heightfield object using the Recast allocator.
+///  @return A flat heightfield that is ready for initialization, or null on failure.
+///  @ingroup recast
+///  @see rcBuildFlatHeightfield, rcFreeFlatHeightfield
+rcFlatHeightfield* rcAllocFlatHeightfield();
+
+/// Frees the specified flat heightfield object using the Recast allocator.
+///  @param[in]		fhf		A flat heightfield allocated using #rcAllocFlatHeightfield
+///  @ingroup recast
+///  @see rcAllocFlatHeightfield
+void rcFreeFlatHeightfield(rcFlatHeightfield* fhf);
+
 /// Allocates a compact heightfield object using the Recast allocator.
 ///  @return A compact heightfield that is ready for initialization, or null on failure.
 ///  @ingroup recast
@@ -592,6 +638,33 @@ static const unsigned char RC_WALKABLE_AREA = 63;
 /// to another span. (Has no neighbor.)
 static const int RC_NOT_CONNECTED = 0x3f;
 
+/// Instruction sets the triangle slope classification and rasterization kernels can use.
+/// Every level produces results bit-identical to #RC_SIMD_SCALAR.
+/// @see rcSetSimdLevel
+enum rcSimdLevel
+{
+	RC_SIMD_SCALAR = 0,	///< Plain C++.
+	RC_SIMD_SSE2,		///< 4-wide SSE2 kernels.
+	RC_SIMD_AVX2,		///< 8-wide AVX2 kernels.
+};
+
+/// @name SIMD Functions
+/// @{
+
+/// Returns the highest #rcSimdLevel the executing CPU supports.
+int rcGetSimdSupport();
+
+/// Limits the kernels Recast uses. The default is the highest supported level.
+/// Not thread safe; call it before starting builds.
+///  @param[in]		level	The requested #rcSimdLevel. Clamped to what rcGetSimdSupport() reports.
+///  @return The level now in use.
+int rcSetSimdLevel(int level);
+
+/// Returns the #rcSimdLevel currently in use.
+int rcGetSimdLevel();
+
+/// @}
+
 /// @name General helper functions
 /// @{
 
@@ -873,6 +946,40 @@ bool rcRasterizeTriangles(rcContext* ctx, const float* verts, const int nv,
 						  const int* tris, const unsigned char* areas, const int nt,
 						  rcHeightfield& solid, const int flagMergeThr = 1);
 
+/// A unit of work of a multithreaded build step.
+///  @param[in]		taskData	The task data given to the #rcParallelForFunc.
+///  @param[in]		index		The task index. [Limits: 0 <= value < count]
+typedef void (*rcTaskFunc)(void* taskData, int index);
+
+/// Runs @p task for every index in [0, @p count) and returns once all of them have completed.
+/// Tasks may run concurrently and in any order.
+///  @param[in]		userData	The user data given to the build step.
+///  @param[in]		task		The task to run.
+///  @param[in]		taskData	Data to pass to @p task.
+///  @param[in]		count		The number of tasks.
+typedef void (*rcParallelForFunc)(void* userData, rcTaskFunc task, void* taskData, int count);
+
+/// Rasterizes an indexed triangle mesh into the specified heightfield, splitting the rows into bands
+/// that are rasterized concurrently. Produces the same heightfield as rcRasterizeTriangles.
+///  @ingroup recast
+///  @param[in,out]	ctx				The build context to use during the operation.
+///  @param[in]		verts			The vertices. [(x, y, z) * @p nv]
+///  @param[in]		nv				The number of vertices.
+///  @param[in]		tris			The triangle indices. [(vertA, vertB, vertC) * @p nt]
+///  @param[in]		areas			The area id's of the triangles. [Limit: <= #RC_WALKABLE_AREA] [Size: @p nt]
+///  @param[in]		nt				The number of triangles.
+///  @param[in,out]	solid			An initialized heightfield.
+///  @param[in]		flagMergeThr	The distance where the walkable flag is favored over the non-walkable flag. 
+///  								[Limit: >= 0] [Units: vx]
+///  @param[in]		parallelFor		Runs the band tasks.
+///  @param[in]		userData		Passed to @p parallelFor.
+///  @param[in]		bandCount		The number of row bands. [Limit: > 0]
+///  @returns True if the operation completed successfully.
+bool rcRasterizeTrianglesParallel(rcContext* ctx, const float* verts, const int nv,
+								  const int* tris, const unsigned char* areas, const int nt,
+								  rcHeightfield& solid, const int flagMergeThr,
+								  rcParallelForFunc parallelFor, void* userData, const int bandCount);
+
 /// Rasterizes an indexed triangle mesh into the specified heightfield.
 ///  @ingroup recast
 ///  @param[in,out]	ctx			The build context to use during the operation.
@@ -936,6 +1043,30 @@ void rcFilterWalkableLowHeightSpans(rcContext* ctx, int walkableHeight, rcHeight
 ///  @returns The number of spans in the heightfield.
 int rcGetHeightFieldSpanCount(rcContext* ctx, rcHeightfield& hf);
 
+/// Copies the spans of a rasterized heightfield into a flat heightfield.
+///  @ingroup recast
+///  @param[in,out]	ctx		The build context to use during the operation.
+///  @param[in]		hf		A fully built heightfield.  (All spans have been added.)
+///  @param[out]	fhf		The resulting flat heightfield. (Must be pre-allocated.)
+///  @returns True if the operation completed successfully.
+bool rcBuildFlatHeightfield(rcContext* ctx, const rcHeightfield& hf, rcFlatHeightfield& fhf);
+
+/// Same as the #rcHeightfield overload, working on a flat heightfield.
+///  @ingroup recast
+///  @see rcBuildFlatHeightfield
+void rcFilterLowHangingWalkableObstacles(rcContext* ctx, const int walkableClimb, rcFlatHeightfield& solid);
+
+/// Same as the #rcHeightfield overload, working on a flat heightfield.
+///  @ingroup recast
+///  @see rcBuildFlatHeightfield
+void rcFilterLedgeSpans(rcContext* ctx, const int walkableHeight,
+						const int walkableClimb, rcFlatHeightfield& solid);
+
+/// Same as the #rcHeightfield overload, working on a flat heightfield.
+///  @ingroup recast
+///  @see rcBuildFlatHeightfield
+void rcFilterWalkableLowHeightSpans(rcContext* ctx, int walkableHeight, rcFlatHeightfield& solid);
+
 /// @}
 /// @name Compact Heightfield Functions
 /// @see rcCompactHeightfield
@@ -954,6 +1085,12 @@ int rcGetHeightFieldSpanCount(rcContext* ctx, rcHeightfield& hf);
 bool rcBuildCompactHeightfield(rcContext* ctx, const int walkableHeight, const int walkableClimb,
 							   rcHeightfield& hf, rcCompactHeightfield& chf);
 
+/// Same as the #rcHeightfield overload, building the compact heightfield from a flat heightfield.
+///  @ingroup recast
+///  @see rcBuildFlatHeightfield
+bool rcBuildCompactHeightfield(rcContext* ctx, const int walkableHeight, const int walkableClimb,
+							   const rcFlatHeightfield& fhf, rcCompactHeightfield& chf);
+
 /// Erodes the walkable area within the heightfield by the specified radius. 
 ///  @ingroup recast
 ///  @param[in,out]	ctx		The build context to use during the operation.
@@ -1021,6 +1158,18 @@ void rcMarkCylinderArea(rcContext* ctx, const float* pos,
 ///  @returns True if the operation completed successfully.
 bool rcBuildDistanceField(rcContext* ctx, rcCompactHeightfield& chf);
 
+/// Builds the distance field for the specified compact heightfield, splitting the rows into bands
+/// that are processed concurrently where the algorithm allows. Produces the same field as rcBuildDistanceField.
+///  @ingroup recast
+///  @param[in,out]	ctx			The build context to use during the operation.
+///  @param[in,out]	chf			A populated compact heightfield.
+///  @param[in]		parallelFor	Runs the band tasks.
+///  @param[in]		userData	Passed to @p parallelFor.
+///  @param[in]		bandCount	The number of row bands. [Limit: > 0]
+///  @returns True if the operation completed successfully.
+bool rcBuildDistanceFieldParallel(rcContext* ctx, rcCompactHeightfield& chf,
+								  rcParallelForFunc parallelFor, void* userData, const int bandCount);
+
 /// Builds region data for the heightfield using watershed partitioning.
 ///  @ingroup recast
 ///  @param[in,out]	ctx				The build context to use during the operation.
@@ -1035,6 +1184,25 @@ bool rcBuildDistanceField(rcContext* ctx, rcCompactHeightfield& chf);
 bool rcBuildRegions(rcContext* ctx, rcCompactHeightfield& chf,
 					const int borderSize, const int minRegionArea, const int mergeRegionArea);
 
+/// Builds region data for the heightfield using watershed partitioning, running the level scans and
+/// region expansion concurrently. Produces the same regions as rcBuildRegions.
+///  @ingroup recast
+///  @param[in,out]	ctx				The build context to use during the operation.
+///  @param[in,out]	chf				A populated compact heightfield.
+///  @param[in]		borderSize		The size of the non-navigable border around the heightfield.
+///  								[Limit: >=0] [Units: vx]
+///  @param[in]		minRegionArea	The minimum number of cells allowed to form isolated island areas.
+///  								[Limit: >=0] [Units: vx].
+///  @param[in]		mergeRegionArea		Any regions with a span count smaller than this value will, if possible,
+///  								be merged with larger regions. [Limit: >=0] [Units: vx] 
+///  @param[in]		parallelFor		Runs the tasks.
+///  @param[in]		userData		Passed to @p parallelFor.
+///  @param[in]		bandCount		The number of row bands and the maximum number of tasks per step. [Limit: > 0]
+///  @returns True if the operation completed successfully.
+bool rcBuildRegionsParallel(rcContext* ctx, rcCompactHeightfield& chf,
+							const int borderSize, const int minRegionArea, const int mergeRegionArea,
+							rcParallelForFunc parallelFor, void* userData, const int bandCount);
+
 /// Builds region data for the heightfield by partitioning the heightfield in non-overlapping layers.
 ///  @ingroup recast
 ///  @param[in,out]	ctx				The build context to use during the operation.
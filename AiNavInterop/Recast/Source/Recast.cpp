@@ -26,6 +26,7 @@
 #include "Recast.h"
 #include "RecastAlloc.h"
 #include "RecastAssert.h"
+#include "RecastSimd.h"
 
 namespace
 {
@@ -129,6 +130,34 @@ void rcFreeHeightField(rcHeightfield* hf)
 	rcDelete(hf);
 }
 
+rcFlatHeightfield* rcAllocFlatHeightfield()
+{
+	return rcNew<rcFlatHeightfield>(RC_ALLOC_PERM);
+}
+rcFlatHeightfield::rcFlatHeightfield()
+	: width()
+	, height()
+	, bmin()
+	, bmax()
+	, cs()
+	, ch()
+	, columns()
+	, spans()
+	, spanCount()
+{
+}
+
+rcFlatHeightfield::~rcFlatHeightfield()
+{
+	rcFree(columns);
+	rcFree(spans);
+}
+
+void rcFreeFlatHeightfield(rcFlatHeightfield* fhf)
+{
+	rcDelete(fhf);
+}
+
 rcCompactHeightfield* rcAllocCompactHeightfield()
 {
 	return rcNew<rcCompactHeightfield>(RC_ALLOC_PERM);
@@ -341,9 +370,17 @@ void rcMarkWalkableTriangles(rcContext* ctx, const float walkableSlopeAngle,
 	
 	const float walkableThr = cosf(walkableSlopeAngle/180.0f*RC_PI);
 
+	// The kernels classify whole batches; the remainder goes through the scalar loop.
+	int i = 0;
+	const int level = rcGetSimdLevel();
+	if (level >= RC_SIMD_AVX2)
+		i = rcClassifySlopesAvx2(verts, tris, nt, walkableThr, false, areas);
+	else if (level >= RC_SIMD_SSE2)
+		i = rcClassifySlopesSse2(verts, tris, nt, walkableThr, false, areas);
+
 	float norm[3];
 	
-	for (int i = 0; i < nt; ++i)
+	for (; i < nt; ++i)
 	{
 		const int* tri = &tris[i*3];
 		calcTriNormal(&verts[tri[0]*3], &verts[tri[1]*3], &verts[tri[2]*3], norm);
@@ -370,9 +407,17 @@ void rcClearUnwalkableTriangles(rcContext* ctx, const float walkableSlopeAngle,
 	
 	const float walkableThr = cosf(walkableSlopeAngle/180.0f*RC_PI);
 	
+	// The kernels classify whole batches; the remainder goes through the scalar loop.
+	int i = 0;
+	const int level = rcGetSimdLevel();
+	if (level >= RC_SIMD_AVX2)
+		i = rcClassifySlopesAvx2(verts, tris, nt, walkableThr, true, areas);
+	else if (level >= RC_SIMD_SSE2)
+		i = rcClassifySlopesSse2(verts, tris, nt, walkableThr, true, areas);
+
 	float norm[3];
 	
-	for (int i = 0; i < nt; ++i)
+	for (; i < nt; ++i)
 	{
 		const int* tri = &tris[i*3];
 		calcTriNormal(&verts[tri[0]*3], &verts[tri[1]*3], &verts[tri[2]*3], norm);
@@ -405,24 +450,68 @@ int rcGetHeightFieldSpanCount(rcContext* ctx, rcHeightfield& hf)
 
 /// @par
 ///
-/// This is just the beginning of the process of fully building a compact heightfield.
-/// Various filters may be applied, then the distance field and regions built.
-/// E.g: #rcBuildDistanceField and #rcBuildRegions
-///
-/// See the #rcConfig documentation for more information on the configuration parameters.
+/// The spans of each column keep their bottom up order, columns follow each other along the x-axis, then the z-axis.
+/// Filtering the flat heightfield and compacting it gives the same result as doing the same on @p hf.
 ///
-/// @see rcAllocCompactHeightfield, rcHeightfield, rcCompactHeightfield, rcConfig
-bool rcBuildCompactHeightfield(rcContext* ctx, const int walkableHeight, const int walkableClimb,
-							   rcHeightfield& hf, rcCompactHeightfield& chf)
+/// @see rcAllocFlatHeightfield, rcHeightfield, rcFlatHeightfield
+bool rcBuildFlatHeightfield(rcContext* ctx, const rcHeightfield& hf, rcFlatHeightfield& fhf)
 {
 	rcAssert(ctx);
-	
-	rcScopedTimer timer(ctx, RC_TIMER_BUILD_COMPACTHEIGHTFIELD);
-	
+
 	const int w = hf.width;
 	const int h = hf.height;
-	const int spanCount = rcGetHeightFieldSpanCount(ctx, hf);
 
+	rcFree(fhf.columns);
+	rcFree(fhf.spans);
+	fhf.spans = 0;
+	fhf.spanCount = 0;
+	fhf.width = w;
+	fhf.height = h;
+	rcVcopy(fhf.bmin, hf.bmin);
+	rcVcopy(fhf.bmax, hf.bmax);
+	fhf.cs = hf.cs;
+	fhf.ch = hf.ch;
+	fhf.columns = (int*)rcAlloc(sizeof(int)*(w*h+1), RC_ALLOC_PERM);
+	if (!fhf.columns)
+	{
+		ctx->log(RC_LOG_ERROR, "rcBuildFlatHeightfield: Out of memory 'columns' (%d)", w*h+1);
+		return false;
+	}
+
+	// Every span lives in one of the pools, so their capacity bounds the span count and one pass over the columns is enough.
+	int maxSpans = 0;
+	for (const rcSpanPool* pool = hf.pools; pool; pool = pool->next)
+		maxSpans += RC_SPANS_PER_POOL;
+
+	fhf.spans = (rcFlatSpan*)rcAlloc(sizeof(rcFlatSpan)*rcMax(maxSpans, 1), RC_ALLOC_PERM);
+	if (!fhf.spans)
+	{
+		ctx->log(RC_LOG_ERROR, "rcBuildFlatHeightfield: Out of memory 'spans' (%d)", maxSpans);
+		return false;
+	}
+
+	int idx = 0;
+	for (int i = 0; i < w*h; ++i)
+	{
+		fhf.columns[i] = idx;
+		for (const rcSpan* s = hf.spans[i]; s; s = s->next)
+		{
+			rcFlatSpan& fs = fhf.spans[idx++];
+			fs.smin = (unsigned short)s->smin;
+			fs.smax = (unsigned short)s->smax;
+			fs.area = (unsigned char)s->area;
+		}
+	}
+	fhf.columns[w*h] = idx;
+	fhf.spanCount = idx;
+
+	return true;
+}
+
+static bool allocCompactHeightfield(rcContext* ctx, const int walkableHeight, const int walkableClimb,
+									const int w, const int h, const float* bmin, const float* bmax,
+									const float cs, const float ch, const int spanCount, rcCompactHeightfield& chf)
+{
 	// Fill in header.
 	chf.width = w;
 	chf.height = h;
@@ -430,11 +519,11 @@ bool rcBuildCompactHeightfield(rcContext* ctx, const int walkableHeight, const i
 	chf.walkableHeight = walkableHeight;
 	chf.walkableClimb = walkableClimb;
 	chf.maxRegions = 0;
-	rcVcopy(chf.bmin, hf.bmin);
-	rcVcopy(chf.bmax, hf.bmax);
-	chf.bmax[1] += walkableHeight*hf.ch;
-	chf.cs = hf.cs;
-	chf.ch = hf.ch;
+	rcVcopy(chf.bmin, bmin);
+	rcVcopy(chf.bmax, bmax);
+	chf.bmax[1] += walkableHeight*ch;
+	chf.cs = cs;
+	chf.ch = ch;
 	chf.cells = (rcCompactCell*)rcAlloc(sizeof(rcCompactCell)*w*h, RC_ALLOC_PERM);
 	if (!chf.cells)
 	{
@@ -456,37 +545,13 @@ bool rcBuildCompactHeightfield(rcContext* ctx, const int walkableHeight, const i
 		return false;
 	}
 	memset(chf.areas, RC_NULL_AREA, sizeof(unsigned char)*spanCount);
-	
-	const int MAX_HEIGHT = 0xffff;
-	
-	// Fill in cells and spans.
-	int idx = 0;
-	for (int y = 0; y < h; ++y)
-	{
-		for (int x = 0; x < w; ++x)
-		{
-			const rcSpan* s = hf.spans[x + y*w];
-			// If there are no spans at this cell, just leave the data to index=0, count=0.
-			if (!s) continue;
-			rcCompactCell& c = chf.cells[x+y*w];
-			c.index = idx;
-			c.count = 0;
-			while (s)
-			{
-				if (s->area != RC_NULL_AREA)
-				{
-					const int bot = (int)s->smax;
-					const int top = s->next ? (int)s->next->smin : MAX_HEIGHT;
-					chf.spans[idx].y = (unsigned short)rcClamp(bot, 0, 0xffff);
-					chf.spans[idx].h = (unsigned char)rcClamp(top - bot, 0, 0xff);
-					chf.areas[idx] = s->area;
-					idx++;
-					c.count++;
-				}
-				s = s->next;
-			}
-		}
-	}
+	return true;
+}
+
+static void buildCompactConnections(rcContext* ctx, const int walkableHeight, const int walkableClimb, rcCompactHeightfield& chf)
+{
+	const int w = chf.width;
+	const int h = chf.height;
 
 	// Find neighbour connections.
 	const int MAX_LAYERS = RC_NOT_CONNECTED-1;
@@ -544,6 +609,121 @@ bool rcBuildCompactHeightfield(rcContext* ctx, const int walkableHeight, const i
 		ctx->log(RC_LOG_ERROR, "rcBuildCompactHeightfield: Heightfield has too many layers %d (max: %d)",
 				 tooHighNeighbour, MAX_LAYERS);
 	}
+}
+
+/// @par
+///
+/// This is just the beginning of the process of fully building a compact heightfield.
+/// Various filters may be applied, then the distance field and regions built.
+/// E.g: #rcBuildDistanceField and #rcBuildRegions
+///
+/// See the #rcConfig documentation for more information on the configuration parameters.
+///
+/// @see rcAllocCompactHeightfield, rcHeightfield, rcCompactHeightfield, rcConfig
+bool rcBuildCompactHeightfield(rcContext* ctx, const int walkableHeight, const int walkableClimb,
+							   rcHeightfield& hf, rcCompactHeightfield& chf)
+{
+	rcAssert(ctx);
+	
+	rcScopedTimer timer(ctx, RC_TIMER_BUILD_COMPACTHEIGHTFIELD);
+	
+	const int w = hf.width;
+	const int h = hf.height;
+	const int spanCount = rcGetHeightFieldSpanCount(ctx, hf);
+
+	if (!allocCompactHeightfield(ctx, walkableHeight, walkableClimb, w, h, hf.bmin, hf.bmax, hf.cs, hf.ch, spanCount, chf))
+		return false;
+	
+	const int MAX_HEIGHT = 0xffff;
+	
+	// Fill in cells and spans.
+	int idx = 0;
+	for (int y = 0; y < h; ++y)
+	{
+		for (int x = 0; x < w; ++x)
+		{
+			const rcSpan* s = hf.spans[x + y*w];
+			// If there are no spans at this cell, just leave the data to index=0, count=0.
+			if (!s) continue;
+			rcCompactCell& c = chf.cells[x+y*w];
+			c.index = idx;
+			c.count = 0;
+			while (s)
+			{
+				if (s->area != RC_NULL_AREA)
+				{
+					const int bot = (int)s->smax;
+					const int top = s->next ? (int)s->next->smin : MAX_HEIGHT;
+					chf.spans[idx].y = (unsigned short)rcClamp(bot, 0, 0xffff);
+					chf.spans[idx].h = (unsigned char)rcClamp(top - bot, 0, 0xff);
+					chf.areas[idx] = s->area;
+					idx++;
+					c.count++;
+				}
+				s = s->next;
+			}
+		}
+	}
+
+	buildCompactConnections(ctx, walkableHeight, walkableClimb, chf);
+	
+	return true;
+}
+
+/// @par
+///
+/// Builds the same compact heightfield as the #rcHeightfield overload.
+///
+/// @see rcAllocCompactHeightfield, rcFlatHeightfield, rcCompactHeightfield, rcBuildFlatHeightfield
+bool rcBuildCompactHeightfield(rcContext* ctx, const int walkableHeight, const int walkableClimb,
+							   const rcFlatHeightfield& fhf, rcCompactHeightfield& chf)
+{
+	rcAssert(ctx);
+	
+	rcScopedTimer timer(ctx, RC_TIMER_BUILD_COMPACTHEIGHTFIELD);
+	
+	const int w = fhf.width;
+	const int h = fhf.height;
+	int spanCount = 0;
+	for (int i = 0; i < fhf.spanCount; ++i)
+	{
+		if (fhf.spans[i].area != RC_NULL_AREA)
+			spanCount++;
+	}
+
+	if (!allocCompactHeightfield(ctx, walkableHeight, walkableClimb, w, h, fhf.bmin, fhf.bmax, fhf.cs, fhf.ch, spanCount, chf))
+		return false;
+	
+	const int MAX_HEIGHT = 0xffff;
+	
+	// Fill in cells and spans.
+	int idx = 0;
+	for (int i = 0; i < w*h; ++i)
+	{
+		const int first = fhf.columns[i];
+		const int end = fhf.columns[i+1];
+		// If there are no spans at this cell, just leave the data to index=0, count=0.
+		if (first == end) continue;
+		rcCompactCell& c = chf.cells[i];
+		c.index = idx;
+		c.count = 0;
+		for (int j = first; j < end; ++j)
+		{
+			const rcFlatSpan& s = fhf.spans[j];
+			if (s.area != RC_NULL_AREA)
+			{
+				const int bot = (int)s.smax;
+				const int top = j+1 < end ? (int)fhf.spans[j+1].smin : MAX_HEIGHT;
+				chf.spans[idx].y = (unsigned short)rcClamp(bot, 0, 0xffff);
+				chf.spans[idx].h = (unsigned char)rcClamp(top - bot, 0, 0xff);
+				chf.areas[idx] = s.area;
+				idx++;
+				c.count++;
+			}
+		}
+	}
+
+	buildCompactConnections(ctx, walkableHeight, walkableClimb, chf);
 	
 	return true;
 }
@@ -200,3 +200,174 @@ void rcFilterWalkableLowHeightSpans(rcContext* ctx, int walkableHeight, rcHeight
 		}
 	}
 }
+
+/// @par
+///
+/// Same filter as the #rcHeightfield overload, reading each column as a contiguous run of spans.
+///
+/// @see rcFlatHeightfield, rcBuildFlatHeightfield
+void rcFilterLowHangingWalkableObstacles(rcContext* ctx, const int walkableClimb, rcFlatHeightfield& solid)
+{
+	rcAssert(ctx);
+
+	rcScopedTimer timer(ctx, RC_TIMER_FILTER_LOW_OBSTACLES);
+	
+	const int ncells = solid.width * solid.height;
+	
+	for (int i = 0; i < ncells; ++i)
+	{
+		bool previousWalkable = false;
+		unsigned char previousArea = RC_NULL_AREA;
+		
+		for (int j = solid.columns[i], end = solid.columns[i+1]; j < end; ++j)
+		{
+			rcFlatSpan& s = solid.spans[j];
+			const bool walkable = s.area != RC_NULL_AREA;
+			// If current span is not walkable, but there is walkable
+			// span just below it, mark the span above it walkable too.
+			if (!walkable && previousWalkable)
+			{
+				if (rcAbs((int)s.smax - (int)solid.spans[j-1].smax) <= walkableClimb)
+					s.area = previousArea;
+			}
+			// Copy walkable flag so that it cannot propagate
+			// past multiple non-walkable objects.
+			previousWalkable = walkable;
+			previousArea = s.area;
+		}
+	}
+}
+
+/// @par
+///
+/// Same filter as the #rcHeightfield overload, reading each column as a contiguous run of spans.
+/// Because the spans of a column are sorted, a neighbour scan stops at the first span too high to
+/// leave a walkable gap, and a span stops looking at neighbours once it is known to be a ledge.
+///
+/// @see rcFlatHeightfield, rcBuildFlatHeightfield
+void rcFilterLedgeSpans(rcContext* ctx, const int walkableHeight, const int walkableClimb,
+						rcFlatHeightfield& solid)
+{
+	rcAssert(ctx);
+	
+	rcScopedTimer timer(ctx, RC_TIMER_FILTER_BORDER);
+
+	const int w = solid.width;
+	const int h = solid.height;
+	const int MAX_HEIGHT = 0xffff;
+	const int* columns = solid.columns;
+	rcFlatSpan* spans = solid.spans;
+	
+	// Mark border spans.
+	for (int y = 0; y < h; ++y)
+	{
+		for (int x = 0; x < w; ++x)
+		{
+			const int end = columns[x + y*w + 1];
+			for (int i = columns[x + y*w]; i < end; ++i)
+			{
+				rcFlatSpan& s = spans[i];
+				// Skip non walkable spans.
+				if (s.area == RC_NULL_AREA)
+					continue;
+				
+				const int bot = (int)(s.smax);
+				const int top = i+1 < end ? (int)(spans[i+1].smin) : MAX_HEIGHT;
+				
+				// Min and max height of accessible neighbours.
+				int asmin = s.smax;
+				int asmax = s.smax;
+				bool ledge = false;
+
+				for (int dir = 0; dir < 4 && !ledge; ++dir)
+				{
+					int dx = x + rcGetDirOffsetX(dir);
+					int dy = y + rcGetDirOffsetY(dir);
+					// Out of bounds neighbours count as a drop to minus infinity.
+					if (dx < 0 || dy < 0 || dx >= w || dy >= h)
+					{
+						ledge = -walkableClimb - bot < -walkableClimb;
+						continue;
+					}
+
+					// From minus infinity to the first span.
+					const int nfirst = columns[dx + dy*w];
+					const int nend = columns[dx + dy*w + 1];
+					int nbot = -walkableClimb;
+					int ntop = nfirst < nend ? (int)spans[nfirst].smin : MAX_HEIGHT;
+					// Skip neightbour if the gap between the spans is too small.
+					if (rcMin(top,ntop) - rcMax(bot,nbot) > walkableHeight && nbot - bot < -walkableClimb)
+					{
+						ledge = true;
+						break;
+					}
+					
+					// Rest of the spans.
+					for (int k = nfirst; k < nend; ++k)
+					{
+						nbot = (int)spans[k].smax;
+						// Higher spans only make the gap below top smaller.
+						if (top - nbot <= walkableHeight)
+							break;
+						ntop = k+1 < nend ? (int)spans[k+1].smin : MAX_HEIGHT;
+						// Skip neightbour if the gap between the spans is too small.
+						if (rcMin(top,ntop) - rcMax(bot,nbot) > walkableHeight)
+						{
+							// The current span is close to a ledge if the drop to any
+							// neighbour span is less than the walkableClimb.
+							if (nbot - bot < -walkableClimb)
+							{
+								ledge = true;
+								break;
+							}
+						
+							// Find min/max accessible neighbour height. 
+							if (rcAbs(nbot - bot) <= walkableClimb)
+							{
+								if (nbot < asmin) asmin = nbot;
+								if (nbot > asmax) asmax = nbot;
+							}
+							
+						}
+					}
+				}
+				
+				// If the difference between all neighbours is too large,
+				// we are at steep slope, mark the span as ledge.
+				if (ledge || (asmax - asmin) > walkableClimb)
+				{
+					s.area = RC_NULL_AREA;
+				}
+			}
+		}
+	}
+}
+
+/// @par
+///
+/// Same filter as the #rcHeightfield overload, reading each column as a contiguous run of spans.
+///
+/// @see rcFlatHeightfield, rcBuildFlatHeightfield
+void rcFilterWalkableLowHeightSpans(rcContext* ctx, int walkableHeight, rcFlatHeightfield& solid)
+{
+	rcAssert(ctx);
+	
+	rcScopedTimer timer(ctx, RC_TIMER_FILTER_WALKABLE);
+	
+	const int ncells = solid.width * solid.height;
+	const int MAX_HEIGHT = 0xffff;
+	
+	// Remove walkable flag from spans which do not have enough
+	// space above them for the agent to stand there.
+	for (int i = 0; i < ncells; ++i)
+	{
+		const int end = solid.columns[i+1];
+		for (int j = solid.columns[i]; j < end; ++j)
+		{
+			const int bot = (int)(solid.spans[j].smax);
+			const int top = j+1 < end ? (int)(solid.spans[j+1].smin) : MAX_HEIGHT;
+			if ((top - bot) <= walkableHeight)
+				solid.spans[j].area = RC_NULL_AREA;
+		}
+	}
+}
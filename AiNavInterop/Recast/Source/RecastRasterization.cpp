@@ -19,9 +19,11 @@
 #define _USE_MATH_DEFINES
 #include <math.h>
 #include <stdio.h>
+#include <string.h>
 #include "Recast.h"
 #include "RecastAlloc.h"
 #include "RecastAssert.h"
+#include "RecastSimd.h"
 
 inline bool overlapBounds(const float* amin, const float* amax, const float* bmin, const float* bmax)
 {
@@ -236,13 +238,30 @@ static void dividePoly(const float* in, int nin,
 	*nout2 = n;
 }
 
+static inline void divide(const bool simd, const float* in, int nin,
+						  float* out1, int* nout1, float* out2, int* nout2, float x, int axis)
+{
+#if RC_SIMD_X86
+	if (simd)
+	{
+		rcDividePolySse2(in, nin, out1, nout1, out2, nout2, x, axis);
+		return;
+	}
+#else
+	rcIgnoreUnused(simd);
+#endif
+	dividePoly(in, nin, out1, nout1, out2, nout2, x, axis);
+}
+
 
 
+// Only rows in [rowMin, rowMax] receive spans. Rows below rowMin are still clipped off one by one,
+// so every row sees exactly the polygon it would see when rasterizing the whole triangle.
 static bool rasterizeTri(const float* v0, const float* v1, const float* v2,
 						 const unsigned char area, rcHeightfield& hf,
 						 const float* bmin, const float* bmax,
 						 const float cs, const float ics, const float ich,
-						 const int flagMergeThr)
+						 const int flagMergeThr, const int rowMin, const int rowMax)
 {
 	const int w = hf.width;
 	const int h = hf.height;
@@ -266,6 +285,8 @@ static bool rasterizeTri(const float* v0, const float* v1, const float* v2,
 	int y1 = (int)((tmax[2] - bmin[2])*ics);
 	y0 = rcClamp(y0, 0, h-1);
 	y1 = rcClamp(y1, 0, h-1);
+	if (y1 > rowMax)
+		y1 = rowMax;
 	
 	// Clip the triangle into all grid cells it touches.
 	float buf[7*3*4];
@@ -275,13 +296,15 @@ static bool rasterizeTri(const float* v0, const float* v1, const float* v2,
 	rcVcopy(&in[1*3], v1);
 	rcVcopy(&in[2*3], v2);
 	int nvrow, nvIn = 3;
+	const bool simd = rcGetSimdLevel() >= RC_SIMD_SSE2;
 	
 	for (int y = y0; y <= y1; ++y)
 	{
 		// Clip polygon to row. Store the remaining polygon as well
 		const float cz = bmin[2] + y*cs;
-		dividePoly(in, nvIn, inrow, &nvrow, p1, &nvIn, cz+cs, 2);
+		divide(simd, in, nvIn, inrow, &nvrow, p1, &nvIn, cz+cs, 2);
 		rcSwap(in, p1);
+		if (y < rowMin) continue;
 		if (nvrow < 3) continue;
 		
 		// find the horizontal bounds in the row
@@ -302,7 +325,7 @@ static bool rasterizeTri(const float* v0, const float* v1, const float* v2,
 		{
 			// Clip polygon to column. store the remaining polygon as well
 			const float cx = bmin[0] + x*cs;
-			dividePoly(inrow, nv2, p1, &nv, p2, &nv2, cx+cs, 0);
+			divide(simd, inrow, nv2, p1, &nv, p2, &nv2, cx+cs, 0);
 			rcSwap(inrow, p2);
 			if (nv < 3) continue;
 			
@@ -349,7 +372,7 @@ bool rcRasterizeTriangle(rcContext* ctx, const float* v0, const float* v1, const
 
 	const float ics = 1.0f/solid.cs;
 	const float ich = 1.0f/solid.ch;
-	if (!rasterizeTri(v0, v1, v2, area, solid, solid.bmin, solid.bmax, solid.cs, ics, ich, flagMergeThr))
+	if (!rasterizeTri(v0, v1, v2, area, solid, solid.bmin, solid.bmax, solid.cs, ics, ich, flagMergeThr, 0, solid.height-1))
 	{
 		ctx->log(RC_LOG_ERROR, "rcRasterizeTriangle: Out of memory.");
 		return false;
@@ -380,7 +403,7 @@ bool rcRasterizeTriangles(rcContext* ctx, const float* verts, const int /*nv*/,
 		const float* v1 = &verts[tris[i*3+1]*3];
 		const float* v2 = &verts[tris[i*3+2]*3];
 		// Rasterize.
-		if (!rasterizeTri(v0, v1, v2, areas[i], solid, solid.bmin, solid.bmax, solid.cs, ics, ich, flagMergeThr))
+		if (!rasterizeTri(v0, v1, v2, areas[i], solid, solid.bmin, solid.bmax, solid.cs, ics, ich, flagMergeThr, 0, solid.height-1))
 		{
 			ctx->log(RC_LOG_ERROR, "rcRasterizeTriangles: Out of memory.");
 			return false;
@@ -412,7 +435,7 @@ bool rcRasterizeTriangles(rcContext* ctx, const float* verts, const int /*nv*/,
 		const float* v1 = &verts[tris[i*3+1]*3];
 		const float* v2 = &verts[tris[i*3+2]*3];
 		// Rasterize.
-		if (!rasterizeTri(v0, v1, v2, areas[i], solid, solid.bmin, solid.bmax, solid.cs, ics, ich, flagMergeThr))
+		if (!rasterizeTri(v0, v1, v2, areas[i], solid, solid.bmin, solid.bmax, solid.cs, ics, ich, flagMergeThr, 0, solid.height-1))
 		{
 			ctx->log(RC_LOG_ERROR, "rcRasterizeTriangles: Out of memory.");
 			return false;
@@ -443,7 +466,7 @@ bool rcRasterizeTriangles(rcContext* ctx, const float* verts, const unsigned cha
 		const float* v1 = &verts[(i*3+1)*3];
 		const float* v2 = &verts[(i*3+2)*3];
 		// Rasterize.
-		if (!rasterizeTri(v0, v1, v2, areas[i], solid, solid.bmin, solid.bmax, solid.cs, ics, ich, flagMergeThr))
+		if (!rasterizeTri(v0, v1, v2, areas[i], solid, solid.bmin, solid.bmax, solid.cs, ics, ich, flagMergeThr, 0, solid.height-1))
 		{
 			ctx->log(RC_LOG_ERROR, "rcRasterizeTriangles: Out of memory.");
 			return false;
@@ -452,3 +475,200 @@ bool rcRasterizeTriangles(rcContext* ctx, const float* verts, const unsigned cha
 
 	return true;
 }
+
+// A run of heightfield rows rasterized by one task into its own span pool.
+struct rcRasterBand
+{
+	rcHeightfield* hf;	// Shares the column array of the target heightfield, owns its pools and freelist.
+	int rowMin;
+	int rowMax;
+	const int* tris;	// Triangles touching the band, in input order.
+	int ntris;
+	bool ok;
+};
+
+struct rcRasterTask
+{
+	const float* verts;
+	const int* tris;
+	const unsigned char* areas;
+	const rcHeightfield* solid;
+	rcRasterBand* bands;
+	float ics;
+	float ich;
+	int flagMergeThr;
+};
+
+static void rasterizeBand(void* taskData, int index)
+{
+	const rcRasterTask& task = *(const rcRasterTask*)taskData;
+	rcRasterBand& band = task.bands[index];
+	const rcHeightfield& solid = *task.solid;
+	for (int i = 0; i < band.ntris; ++i)
+	{
+		const int t = band.tris[i];
+		const float* v0 = &task.verts[task.tris[t*3+0]*3];
+		const float* v1 = &task.verts[task.tris[t*3+1]*3];
+		const float* v2 = &task.verts[task.tris[t*3+2]*3];
+		if (!rasterizeTri(v0, v1, v2, task.areas[t], *band.hf, solid.bmin, solid.bmax, solid.cs, task.ics, task.ich,
+						  task.flagMergeThr, band.rowMin, band.rowMax))
+		{
+			band.ok = false;
+			return;
+		}
+	}
+}
+
+/// @par
+///
+/// The heightfield is split into @p bandCount runs of rows along the z-axis. Triangles are binned into
+/// every band they touch and each band is rasterized as one task of @p parallelFor. A column belongs to
+/// exactly one band and sees its triangles in input order, so the result is identical to rcRasterizeTriangles.
+/// Every band allocates spans from its own pools, which are handed over to @p solid once all bands are done.
+///
+/// Falls back to rcRasterizeTriangles when @p parallelFor is null or there is only one band.
+///
+/// @see rcHeightfield, rcRasterizeTriangles
+bool rcRasterizeTrianglesParallel(rcContext* ctx, const float* verts, const int nv,
+								  const int* tris, const unsigned char* areas, const int nt,
+								  rcHeightfield& solid, const int flagMergeThr,
+								  rcParallelForFunc parallelFor, void* userData, const int bandCount)
+{
+	rcAssert(ctx);
+
+	const int h = solid.height;
+	const int nbands = rcMin(bandCount, h);
+	if (!parallelFor || nbands <= 1)
+		return rcRasterizeTriangles(ctx, verts, nv, tris, areas, nt, solid, flagMergeThr);
+
+	rcScopedTimer timer(ctx, RC_TIMER_RASTERIZE_TRIANGLES);
+
+	const float ics = 1.0f/solid.cs;
+	const float ich = 1.0f/solid.ch;
+	const int rowsPerBand = (h + nbands-1) / nbands;
+
+	// Row range of every triangle, -1 for triangles outside the heightfield.
+	rcScopedDelete<int> triRows((int*)rcAlloc(sizeof(int)*nt*2, RC_ALLOC_TEMP));
+	rcScopedDelete<int> bandStart((int*)rcAlloc(sizeof(int)*(nbands+1), RC_ALLOC_TEMP));
+	rcScopedDelete<rcRasterBand> bands((rcRasterBand*)rcAlloc(sizeof(rcRasterBand)*nbands, RC_ALLOC_TEMP));
+	if (!triRows || !bandStart || !bands)
+	{
+		ctx->log(RC_LOG_ERROR, "rcRasterizeTrianglesParallel: Out of memory.");
+		return false;
+	}
+	memset((int*)bandStart, 0, sizeof(int)*(nbands+1));
+
+	for (int i = 0; i < nt; ++i)
+	{
+		const float* v0 = &verts[tris[i*3+0]*3];
+		const float* v1 = &verts[tris[i*3+1]*3];
+		const float* v2 = &verts[tris[i*3+2]*3];
+		float tmin[3], tmax[3];
+		rcVcopy(tmin, v0);
+		rcVcopy(tmax, v0);
+		rcVmin(tmin, v1);
+		rcVmin(tmin, v2);
+		rcVmax(tmax, v1);
+		rcVmax(tmax, v2);
+		triRows[i*2+0] = -1;
+		if (!overlapBounds(solid.bmin, solid.bmax, tmin, tmax))
+			continue;
+
+		// Same footprint as rasterizeTri.
+		const int y0 = rcClamp((int)((tmin[2] - solid.bmin[2])*ics), 0, h-1);
+		const int y1 = rcClamp((int)((tmax[2] - solid.bmin[2])*ics), 0, h-1);
+		triRows[i*2+0] = y0;
+		triRows[i*2+1] = y1;
+		for (int b = y0 / rowsPerBand; b <= y1 / rowsPerBand; ++b)
+			bandStart[b+1]++;
+	}
+	for (int b = 0; b < nbands; ++b)
+		bandStart[b+1] += bandStart[b];
+
+	rcScopedDelete<int> bandTris((int*)rcAlloc(sizeof(int)*rcMax(bandStart[nbands], 1), RC_ALLOC_TEMP));
+	if (!bandTris)
+	{
+		ctx->log(RC_LOG_ERROR, "rcRasterizeTrianglesParallel: Out of memory.");
+		return false;
+	}
+
+	bool ok = true;
+	for (int b = 0; b < nbands; ++b)
+	{
+		rcRasterBand& band = bands[b];
+		band.hf = rcAllocHeightfield();
+		band.rowMin = b * rowsPerBand;
+		band.rowMax = rcMin(band.rowMin + rowsPerBand, h) - 1;
+		band.tris = &bandTris[bandStart[b]];
+		band.ntris = 0;
+		band.ok = band.hf != 0;
+		if (!band.hf)
+		{
+			ok = false;
+			continue;
+		}
+		band.hf->width = solid.width;
+		band.hf->height = solid.height;
+		band.hf->spans = solid.spans;
+	}
+
+	if (ok)
+	{
+		for (int i = 0; i < nt; ++i)
+		{
+			if (triRows[i*2+0] < 0)
+				continue;
+			for (int b = triRows[i*2+0] / rowsPerBand; b <= triRows[i*2+1] / rowsPerBand; ++b)
+				bandTris[bandStart[b] + bands[b].ntris++] = i;
+		}
+
+		rcRasterTask task;
+		task.verts = verts;
+		task.tris = tris;
+		task.areas = areas;
+		task.solid = &solid;
+		task.bands = bands;
+		task.ics = ics;
+		task.ich = ich;
+		task.flagMergeThr = flagMergeThr;
+		parallelFor(userData, rasterizeBand, &task, nbands);
+	}
+
+	// Hand the span pools and free spans of every band over to the heightfield.
+	for (int b = 0; b < nbands; ++b)
+	{
+		rcHeightfield* hf = bands[b].hf;
+		if (!hf)
+			continue;
+		ok = ok && bands[b].ok;
+
+		if (hf->pools)
+		{
+			rcSpanPool* last = hf->pools;
+			while (last->next)
+				last = last->next;
+			last->next = solid.pools;
+			solid.pools = hf->pools;
+		}
+		if (hf->freelist)
+		{
+			rcSpan* last = hf->freelist;
+			while (last->next)
+				last = last->next;
+			last->next = solid.freelist;
+			solid.freelist = hf->freelist;
+		}
+		hf->spans = 0;
+		hf->pools = 0;
+		hf->freelist = 0;
+		rcFreeHeightField(hf);
+	}
+
+	if (!ok)
+	{
+		ctx->log(RC_LOG_ERROR, "rcRasterizeTrianglesParallel: Out of memory.");
+		return false;
+	}
+
+	return true;
+}
@@ -37,17 +37,12 @@ struct LevelStackEntry
 };
 }  // namespace
 
-static void calculateDistanceField(rcCompactHeightfield& chf, unsigned short* src, unsigned short& maxDist)
+// Marks the spans of rows [y0, y1) that lie on an area boundary with 0 and every other span with 0xffff.
+static void markBoundaryCells(const rcCompactHeightfield& chf, unsigned short* src, const int y0, const int y1)
 {
 	const int w = chf.width;
-	const int h = chf.height;
 	
-	// Init distance and points.
-	for (int i = 0; i < chf.spanCount; ++i)
-		src[i] = 0xffff;
-	
-	// Mark boundary cells.
-	for (int y = 0; y < h; ++y)
+	for (int y = y0; y < y1; ++y)
 	{
 		for (int x = 0; x < w; ++x)
 		{
@@ -69,13 +64,18 @@ static void calculateDistanceField(rcCompactHeightfield& chf, unsigned short* sr
 							nc++;
 					}
 				}
-				if (nc != 4)
-					src[i] = 0;
+				src[i] = nc != 4 ? 0 : 0xffff;
 			}
 		}
 	}
+}
+
+// The two chamfer passes. Every span depends on spans already visited in the same pass, so this stays serial.
+static void sweepDistanceField(const rcCompactHeightfield& chf, unsigned short* src)
+{
+	const int w = chf.width;
+	const int h = chf.height;
 	
-			
 	// Pass 1
 	for (int y = 0; y < h; ++y)
 	{
@@ -183,22 +183,27 @@ static void calculateDistanceField(rcCompactHeightfield& chf, unsigned short* sr
 			}
 		}
 	}	
+}
+
+static void calculateDistanceField(rcCompactHeightfield& chf, unsigned short* src, unsigned short& maxDist)
+{
+	markBoundaryCells(chf, src, 0, chf.height);
+	sweepDistanceField(chf, src);
 	
 	maxDist = 0;
 	for (int i = 0; i < chf.spanCount; ++i)
 		maxDist = rcMax(src[i], maxDist);
-	
 }
 
-static unsigned short* boxBlur(rcCompactHeightfield& chf, int thr,
-							   unsigned short* src, unsigned short* dst)
+// Blurs rows [y0, y1) of src into dst.
+static void boxBlurRows(const rcCompactHeightfield& chf, int thr,
+						const unsigned short* src, unsigned short* dst, const int y0, const int y1)
 {
 	const int w = chf.width;
-	const int h = chf.height;
 	
 	thr *= 2;
 	
-	for (int y = 0; y < h; ++y)
+	for (int y = y0; y < y1; ++y)
 	{
 		for (int x = 0; x < w; ++x)
 		{
@@ -246,6 +251,12 @@ static unsigned short* boxBlur(rcCompactHeightfield& chf, int thr,
 			}
 		}
 	}
+}
+
+static unsigned short* boxBlur(rcCompactHeightfield& chf, int thr,
+							   unsigned short* src, unsigned short* dst)
+{
+	boxBlurRows(chf, thr, src, dst, 0, chf.height);
 	return dst;
 }
 
@@ -359,16 +370,257 @@ struct DirtyEntry
 	unsigned short region;
 	unsigned short distance2;
 };
+// Row bands and scratch buffers of rcBuildDistanceFieldParallel and rcBuildRegionsParallel.
+// Everything is allocated on the calling thread; a task only writes its own slice.
+struct rcRegionBands
+{
+	rcRegionBands() : parallelFor(0), userData(0), count(0), rowsPerBand(0),
+		spanStart(0), taskValues(0), cells(0), cellStacks(0), expanded(0) {}
+	~rcRegionBands()
+	{
+		rcFree(spanStart);
+		rcFree(taskValues);
+		rcFree(cells);
+		rcFree(cellStacks);
+		rcFree(expanded);
+	}
+
+	rcParallelForFunc parallelFor;
+	void* userData;
+	int count;					// Number of row bands.
+	int rowsPerBand;
+	int* spanStart;				// First span of every band. [Size: count+1]
+	int* taskValues;			// One result per task. [Size: count]
+	LevelStackEntry* cells;		// Cells collected by the bands, band b writes from spanStart[b]. [Size: spanCount]
+	unsigned char* cellStacks;	// Level stack of every collected cell. [Size: spanCount]
+	DirtyEntry* expanded;		// Expansion result of every stack entry. [Size: spanCount]
+
+private:
+	// Explicitly disabled copy constructor and copy assignment operator.
+	rcRegionBands(const rcRegionBands&);
+	rcRegionBands& operator=(const rcRegionBands&);
+};
+
+static bool initRegionBands(rcContext* ctx, const char* name, const rcCompactHeightfield& chf,
+							rcParallelForFunc parallelFor, void* userData, const int bandCount,
+							const bool regionScratch, rcRegionBands& bands)
+{
+	const int w = chf.width;
+	const int h = chf.height;
+
+	bands.parallelFor = parallelFor;
+	bands.userData = userData;
+	bands.rowsPerBand = (h + bandCount-1) / bandCount;
+	bands.count = (h + bands.rowsPerBand-1) / bands.rowsPerBand;
+	bands.spanStart = (int*)rcAlloc(sizeof(int)*(bands.count+1), RC_ALLOC_TEMP);
+	bands.taskValues = (int*)rcAlloc(sizeof(int)*bands.count, RC_ALLOC_TEMP);
+	if (!bands.spanStart || !bands.taskValues)
+	{
+		ctx->log(RC_LOG_ERROR, "%s: Out of memory 'bands' (%d).", name, bands.count);
+		return false;
+	}
+	if (regionScratch)
+	{
+		const int n = rcMax(chf.spanCount, 1);
+		bands.cells = (LevelStackEntry*)rcAlloc(sizeof(LevelStackEntry)*n, RC_ALLOC_TEMP);
+		bands.cellStacks = (unsigned char*)rcAlloc(sizeof(unsigned char)*n, RC_ALLOC_TEMP);
+		bands.expanded = (DirtyEntry*)rcAlloc(sizeof(DirtyEntry)*n, RC_ALLOC_TEMP);
+		if (!bands.cells || !bands.cellStacks || !bands.expanded)
+		{
+			ctx->log(RC_LOG_ERROR, "%s: Out of memory 'cells' (%d).", name, chf.spanCount);
+			return false;
+		}
+	}
+
+	// Spans are stored row by row. Empty cells have index 0, so a band starts at its first non-empty cell.
+	bands.spanStart[bands.count] = chf.spanCount;
+	for (int b = bands.count-1; b >= 0; --b)
+	{
+		bands.spanStart[b] = bands.spanStart[b+1];
+		for (int i = b*bands.rowsPerBand*w, ni = rcMin((b+1)*bands.rowsPerBand, h)*w; i < ni; ++i)
+		{
+			if (chf.cells[i].count)
+			{
+				bands.spanStart[b] = (int)chf.cells[i].index;
+				break;
+			}
+		}
+	}
+	return true;
+}
+
+// Returns the region of the neighbour with the smallest distance, or srcReg[i] if no neighbour qualifies.
+// The first direction wins ties, so the result only depends on srcReg and srcDist and not on the visiting order.
+static inline unsigned short expandCell(const rcCompactHeightfield& chf,
+										const unsigned short* srcReg, const unsigned short* srcDist,
+										const int x, const int y, const int i, unsigned short& d2)
+{
+	const int w = chf.width;
+
+	unsigned short r = srcReg[i];
+	d2 = 0xffff;
+	const unsigned char area = chf.areas[i];
+	const rcCompactSpan& s = chf.spans[i];
+	for (int dir = 0; dir < 4; ++dir)
+	{
+		if (rcGetCon(s, dir) == RC_NOT_CONNECTED) continue;
+		const int ax = x + rcGetDirOffsetX(dir);
+		const int ay = y + rcGetDirOffsetY(dir);
+		const int ai = (int)chf.cells[ax+ay*w].index + rcGetCon(s, dir);
+		if (chf.areas[ai] != area) continue;
+		if (srcReg[ai] > 0 && (srcReg[ai] & RC_BORDER_REG) == 0)
+		{
+			if ((int)srcDist[ai]+2 < (int)d2)
+			{
+				r = srcReg[ai];
+				d2 = srcDist[ai]+2;
+			}
+		}
+	}
+	return r;
+}
+
+// Smallest number of stack entries worth a task of their own.
+static const int RC_EXPAND_MIN_ENTRIES_PER_TASK = 256;
+
+struct rcExpandTask
+{
+	const rcCompactHeightfield* chf;
+	const unsigned short* srcReg;
+	const unsigned short* srcDist;
+	LevelStackEntry* stack;
+	rcRegionBands* bands;
+	int count;
+	int entriesPerTask;
+};
+
+static void expandChunk(void* taskData, int index)
+{
+	const rcExpandTask& task = *(const rcExpandTask*)taskData;
+	const int begin = rcMin(index*task.entriesPerTask, task.count);
+	const int end = rcMin(begin+task.entriesPerTask, task.count);
+
+	int failed = 0;
+	for (int j = begin; j < end; ++j)
+	{
+		LevelStackEntry& entry = task.stack[j];
+		DirtyEntry& result = task.bands->expanded[j];
+		result.index = -1;
+		if (entry.index < 0)
+		{
+			failed++;
+			continue;
+		}
+
+		unsigned short d2;
+		const unsigned short r = expandCell(*task.chf, task.srcReg, task.srcDist, entry.x, entry.y, entry.index, d2);
+		if (r)
+		{
+			result = DirtyEntry(entry.index, r, d2);
+			entry.index = -1; // mark as used
+		}
+		else
+		{
+			failed++;
+		}
+	}
+	task.bands->taskValues[index] = failed;
+}
+
+struct rcCollectTask
+{
+	const rcCompactHeightfield* chf;
+	const unsigned short* srcReg;
+	rcRegionBands* bands;
+	int startLevel;		// Shifted by loglevelsPerStack.
+	int nbStacks;
+	unsigned short loglevelsPerStack;
+};
+
+// Collects the unassigned cells of one band with their level stack, in the order sortCellsByLevel visits them.
+static void collectBand(void* taskData, int index)
+{
+	const rcCollectTask& task = *(const rcCollectTask*)taskData;
+	const rcCompactHeightfield& chf = *task.chf;
+	rcRegionBands& bands = *task.bands;
+	const int w = chf.width;
+	const int y0 = index*bands.rowsPerBand;
+	const int y1 = rcMin(y0+bands.rowsPerBand, chf.height);
+	LevelStackEntry* cells = bands.cells + bands.spanStart[index];
+	unsigned char* cellStacks = bands.cellStacks + bands.spanStart[index];
+
+	int n = 0;
+	for (int y = y0; y < y1; ++y)
+	{
+		for (int x = 0; x < w; ++x)
+		{
+			const rcCompactCell& c = chf.cells[x+y*w];
+			for (int i = (int)c.index, ni = (int)(c.index+c.count); i < ni; ++i)
+			{
+				if (chf.areas[i] == RC_NULL_AREA || task.srcReg[i] != 0)
+					continue;
+
+				int level = chf.dist[i] >> task.loglevelsPerStack;
+				int sId = task.startLevel - level;
+				if (sId >= task.nbStacks)
+					continue;
+				if (sId < 0)
+					sId = 0;
+
+				cells[n] = LevelStackEntry(x, y, i);
+				cellStacks[n] = (unsigned char)sId;
+				n++;
+			}
+		}
+	}
+	bands.taskValues[index] = n;
+}
+
+// Fills the stacks like sortCellsByLevel, with the bands scanned in parallel and appended in row order.
+static void collectCells(unsigned short startLevel,
+						 const rcCompactHeightfield& chf,
+						 const unsigned short* srcReg,
+						 unsigned int nbStacks, rcTempVector<LevelStackEntry>* stacks,
+						 unsigned short loglevelsPerStack,
+						 rcRegionBands& bands)
+{
+	for (unsigned int j=0; j<nbStacks; ++j)
+		stacks[j].clear();
+
+	rcCollectTask task;
+	task.chf = &chf;
+	task.srcReg = srcReg;
+	task.bands = &bands;
+	task.startLevel = startLevel >> loglevelsPerStack;
+	task.nbStacks = (int)nbStacks;
+	task.loglevelsPerStack = loglevelsPerStack;
+	bands.parallelFor(bands.userData, collectBand, &task, bands.count);
+
+	for (int b = 0; b < bands.count; ++b)
+	{
+		const int start = bands.spanStart[b];
+		for (int j = 0; j < bands.taskValues[b]; ++j)
+			stacks[bands.cellStacks[start+j]].push_back(bands.cells[start+j]);
+	}
+}
+
+// With bands set, large stacks are expanded in parallel chunks. Each iteration reads the regions of the
+// previous one only, so the chunks produce exactly what the serial loop does.
 static void expandRegions(int maxIter, unsigned short level,
 					      rcCompactHeightfield& chf,
 					      unsigned short* srcReg, unsigned short* srcDist,
 					      rcTempVector<LevelStackEntry>& stack,
-					      bool fillStack)
+					      bool fillStack, rcRegionBands* bands)
 {
 	const int w = chf.width;
 	const int h = chf.height;
 
-	if (fillStack)
+	if (fillStack && bands)
+	{
+		// Find cells revealed by the raised level: dist >= level, in one stack.
+		collectCells(level, chf, srcReg, 1, &stack, 0, *bands);
+	}
+	else if (fillStack)
 	{
 		// Find cells revealed by the raised level.
 		stack.clear();
@@ -404,56 +656,66 @@ static void expandRegions(int maxIter, unsigned short level,
 	{
 		int failed = 0;
 		dirtyEntries.clear();
-		
-		for (int j = 0; j < stack.size(); j++)
+
+		const int tasks = bands ? rcMin(bands->count, (int)stack.size() / RC_EXPAND_MIN_ENTRIES_PER_TASK) : 0;
+		if (tasks > 1)
 		{
-			int x = stack[j].x;
-			int y = stack[j].y;
-			int i = stack[j].index;
-			if (i < 0)
+			rcExpandTask task;
+			task.chf = &chf;
+			task.srcReg = srcReg;
+			task.srcDist = srcDist;
+			task.stack = stack.data();
+			task.bands = bands;
+			task.count = (int)stack.size();
+			task.entriesPerTask = (task.count + tasks-1) / tasks;
+			bands->parallelFor(bands->userData, expandChunk, &task, tasks);
+
+			for (int t = 0; t < tasks; ++t)
+				failed += bands->taskValues[t];
+			for (int j = 0; j < task.count; ++j)
 			{
-				failed++;
-				continue;
-			}
-			
-			unsigned short r = srcReg[i];
-			unsigned short d2 = 0xffff;
-			const unsigned char area = chf.areas[i];
-			const rcCompactSpan& s = chf.spans[i];
-			for (int dir = 0; dir < 4; ++dir)
-			{
-				if (rcGetCon(s, dir) == RC_NOT_CONNECTED) continue;
-				const int ax = x + rcGetDirOffsetX(dir);
-				const int ay = y + rcGetDirOffsetY(dir);
-				const int ai = (int)chf.cells[ax+ay*w].index + rcGetCon(s, dir);
-				if (chf.areas[ai] != area) continue;
-				if (srcReg[ai] > 0 && (srcReg[ai] & RC_BORDER_REG) == 0)
+				const DirtyEntry& result = bands->expanded[j];
+				if (result.index >= 0)
 				{
-					if ((int)srcDist[ai]+2 < (int)d2)
-					{
-						r = srcReg[ai];
-						d2 = srcDist[ai]+2;
-					}
+					srcReg[result.index] = result.region;
+					srcDist[result.index] = result.distance2;
 				}
 			}
-			if (r)
+		}
+		else
+		{
+			for (int j = 0; j < stack.size(); j++)
 			{
-				stack[j].index = -1; // mark as used
-				dirtyEntries.push_back(DirtyEntry(i, r, d2));
+				int x = stack[j].x;
+				int y = stack[j].y;
+				int i = stack[j].index;
+				if (i < 0)
+				{
+					failed++;
+					continue;
+				}
+				
+				unsigned short d2;
+				unsigned short r = expandCell(chf, srcReg, srcDist, x, y, i, d2);
+				if (r)
+				{
+					stack[j].index = -1; // mark as used
+					dirtyEntries.push_back(DirtyEntry(i, r, d2));
+				}
+				else
+				{
+					failed++;
+				}
 			}
-			else
-			{
-				failed++;
+			
+			// Copy entries that differ between src and dst to keep them in sync.
+			for (int i = 0; i < dirtyEntries.size(); i++) {
+				int idx = dirtyEntries[i].index;
+				srcReg[idx] = dirtyEntries[i].region;
+				srcDist[idx] = dirtyEntries[i].distance2;
 			}
 		}
 		
-		// Copy entries that differ between src and dst to keep them in sync.
-		for (int i = 0; i < dirtyEntries.size(); i++) {
-			int idx = dirtyEntries[i].index;
-			srcReg[idx] = dirtyEntries[i].region;
-			srcDist[idx] = dirtyEntries[i].distance2;
-		}
-		
 		if (failed == stack.size())
 			break;
 		
@@ -1302,6 +1564,110 @@ bool rcBuildDistanceField(rcContext* ctx, rcCompactHeightfield& chf)
 	return true;
 }
 
+struct rcDistanceTask
+{
+	const rcCompactHeightfield* chf;
+	rcRegionBands* bands;
+	unsigned short* src;
+	unsigned short* dst;
+};
+
+static void markBoundaryBand(void* taskData, int index)
+{
+	const rcDistanceTask& task = *(const rcDistanceTask*)taskData;
+	const int y0 = index*task.bands->rowsPerBand;
+	markBoundaryCells(*task.chf, task.src, y0, rcMin(y0+task.bands->rowsPerBand, task.chf->height));
+}
+
+static void blurBand(void* taskData, int index)
+{
+	const rcDistanceTask& task = *(const rcDistanceTask*)taskData;
+	const rcRegionBands& bands = *task.bands;
+	const int y0 = index*bands.rowsPerBand;
+	boxBlurRows(*task.chf, 1, task.src, task.dst, y0, rcMin(y0+bands.rowsPerBand, task.chf->height));
+
+	// Like calculateDistanceField, the maximum is taken before blurring.
+	unsigned short maxDist = 0;
+	for (int i = bands.spanStart[index]; i < bands.spanStart[index+1]; ++i)
+		maxDist = rcMax(task.src[i], maxDist);
+	bands.taskValues[index] = maxDist;
+}
+
+/// @par
+///
+/// Boundary detection and the blur run over @p bandCount row bands as tasks of @p parallelFor.
+/// The two chamfer passes in between carry their result from span to span in scan order and stay serial.
+/// The distance field is identical to the one of rcBuildDistanceField.
+///
+/// Falls back to rcBuildDistanceField when @p parallelFor is null or there is only one band.
+///
+/// @see rcCompactHeightfield, rcBuildDistanceField, rcBuildRegionsParallel
+bool rcBuildDistanceFieldParallel(rcContext* ctx, rcCompactHeightfield& chf,
+								  rcParallelForFunc parallelFor, void* userData, const int bandCount)
+{
+	rcAssert(ctx);
+	
+	if (!parallelFor || rcMin(bandCount, chf.height) <= 1)
+		return rcBuildDistanceField(ctx, chf);
+
+	rcScopedTimer timer(ctx, RC_TIMER_BUILD_DISTANCEFIELD);
+	
+	if (chf.dist)
+	{
+		rcFree(chf.dist);
+		chf.dist = 0;
+	}
+
+	rcRegionBands bands;
+	if (!initRegionBands(ctx, "rcBuildDistanceFieldParallel", chf, parallelFor, userData, bandCount, false, bands))
+		return false;
+	
+	unsigned short* src = (unsigned short*)rcAlloc(sizeof(unsigned short)*chf.spanCount, RC_ALLOC_TEMP);
+	if (!src)
+	{
+		ctx->log(RC_LOG_ERROR, "rcBuildDistanceFieldParallel: Out of memory 'src' (%d).", chf.spanCount);
+		return false;
+	}
+	unsigned short* dst = (unsigned short*)rcAlloc(sizeof(unsigned short)*chf.spanCount, RC_ALLOC_TEMP);
+	if (!dst)
+	{
+		ctx->log(RC_LOG_ERROR, "rcBuildDistanceFieldParallel: Out of memory 'dst' (%d).", chf.spanCount);
+		rcFree(src);
+		return false;
+	}
+
+	rcDistanceTask task;
+	task.chf = &chf;
+	task.bands = &bands;
+	task.src = src;
+	task.dst = dst;
+
+	{
+		rcScopedTimer timerDist(ctx, RC_TIMER_BUILD_DISTANCEFIELD_DIST);
+
+		parallelFor(userData, markBoundaryBand, &task, bands.count);
+		sweepDistanceField(chf, src);
+	}
+
+	{
+		rcScopedTimer timerBlur(ctx, RC_TIMER_BUILD_DISTANCEFIELD_BLUR);
+
+		parallelFor(userData, blurBand, &task, bands.count);
+
+		unsigned short maxDist = 0;
+		for (int b = 0; b < bands.count; ++b)
+			maxDist = rcMax((unsigned short)bands.taskValues[b], maxDist);
+		chf.maxDistance = maxDist;
+
+		// Store distance.
+		chf.dist = dst;
+	}
+	
+	rcFree(src);
+	
+	return true;
+}
+
 static void paintRectRegion(int minx, int maxx, int miny, int maxy, unsigned short regId,
 							rcCompactHeightfield& chf, unsigned short* srcReg)
 {
@@ -1504,27 +1870,10 @@ bool rcBuildRegionsMonotone(rcContext* ctx, rcCompactHeightfield& chf,
 	return true;
 }
 
-/// @par
-/// 
-/// Non-null regions will consist of connected, non-overlapping walkable spans that form a single contour.
-/// Contours will form simple polygons.
-/// 
-/// If multiple regions form an area that is smaller than @p minRegionArea, then all spans will be
-/// re-assigned to the zero (null) region.
-/// 
-/// Watershed partitioning can result in smaller than necessary regions, especially in diagonal corridors. 
-/// @p mergeRegionArea helps reduce unecessarily small regions.
-/// 
-/// See the #rcConfig documentation for more information on the configuration parameters.
-/// 
-/// The region data will be available via the rcCompactHeightfield::maxRegions
-/// and rcCompactSpan::reg fields.
-/// 
-/// @warning The distance field must be created using #rcBuildDistanceField before attempting to build regions.
-/// 
-/// @see rcCompactHeightfield, rcCompactSpan, rcBuildDistanceField, rcBuildRegionsMonotone, rcConfig
-bool rcBuildRegions(rcContext* ctx, rcCompactHeightfield& chf,
-					const int borderSize, const int minRegionArea, const int mergeRegionArea)
+// The watershed partitioning of rcBuildRegions. With bands set, the level scans and region expansion run in parallel.
+static bool buildRegions(rcContext* ctx, rcCompactHeightfield& chf,
+						 const int borderSize, const int minRegionArea, const int mergeRegionArea,
+						 rcRegionBands* bands)
 {
 	rcAssert(ctx);
 	
@@ -1589,7 +1938,9 @@ bool rcBuildRegions(rcContext* ctx, rcCompactHeightfield& chf,
 
 //		ctx->startTimer(RC_TIMER_DIVIDE_TO_LEVELS);
 
-		if (sId == 0)
+		if (sId == 0 && bands)
+			collectCells(level, chf, srcReg, NB_STACKS, lvlStacks, 1, *bands);
+		else if (sId == 0)
 			sortCellsByLevel(level, chf, srcReg, NB_STACKS, lvlStacks, 1);
 		else 
 			appendStacks(lvlStacks[sId-1], lvlStacks[sId], srcReg); // copy left overs from last level
@@ -1600,7 +1951,7 @@ bool rcBuildRegions(rcContext* ctx, rcCompactHeightfield& chf,
 			rcScopedTimer timerExpand(ctx, RC_TIMER_BUILD_REGIONS_EXPAND);
 
 			// Expand current regions until no empty connected cells found.
-			expandRegions(expandIters, level, chf, srcReg, srcDist, lvlStacks[sId], false);
+			expandRegions(expandIters, level, chf, srcReg, srcDist, lvlStacks[sId], false, bands);
 		}
 		
 		{
@@ -1631,7 +1982,7 @@ bool rcBuildRegions(rcContext* ctx, rcCompactHeightfield& chf,
 	}
 	
 	// Expand current regions until no empty connected cells found.
-	expandRegions(expandIters*8, 0, chf, srcReg, srcDist, stack, true);
+	expandRegions(expandIters*8, 0, chf, srcReg, srcDist, stack, true, bands);
 	
 	ctx->stopTimer(RC_TIMER_BUILD_REGIONS_WATERSHED);
 	
@@ -1658,6 +2009,60 @@ bool rcBuildRegions(rcContext* ctx, rcCompactHeightfield& chf,
 	return true;
 }
 
+/// @par
+/// 
+/// Non-null regions will consist of connected, non-overlapping walkable spans that form a single contour.
+/// Contours will form simple polygons.
+/// 
+/// If multiple regions form an area that is smaller than @p minRegionArea, then all spans will be
+/// re-assigned to the zero (null) region.
+/// 
+/// Watershed partitioning can result in smaller than necessary regions, especially in diagonal corridors. 
+/// @p mergeRegionArea helps reduce unecessarily small regions.
+/// 
+/// See the #rcConfig documentation for more information on the configuration parameters.
+/// 
+/// The region data will be available via the rcCompactHeightfield::maxRegions
+/// and rcCompactSpan::reg fields.
+/// 
+/// @warning The distance field must be created using #rcBuildDistanceField before attempting to build regions.
+/// 
+/// @see rcCompactHeightfield, rcCompactSpan, rcBuildDistanceField, rcBuildRegionsMonotone, rcConfig
+bool rcBuildRegions(rcContext* ctx, rcCompactHeightfield& chf,
+					const int borderSize, const int minRegionArea, const int mergeRegionArea)
+{
+	return buildRegions(ctx, chf, borderSize, minRegionArea, mergeRegionArea, 0);
+}
+
+/// @par
+///
+/// Runs the watershed of rcBuildRegions with the level scans and the region expansion split across
+/// @p bandCount tasks of @p parallelFor. Flooding new regions hands out region ids in scan order and
+/// stays serial. Expansion reads only the previous iteration and the first direction wins ties,
+/// so the regions are identical to the ones of rcBuildRegions.
+///
+/// Falls back to rcBuildRegions when @p parallelFor is null or there is only one band.
+///
+/// @warning The distance field must be created using #rcBuildDistanceField or #rcBuildDistanceFieldParallel
+/// before attempting to build regions.
+///
+/// @see rcCompactHeightfield, rcBuildRegions, rcBuildDistanceFieldParallel
+bool rcBuildRegionsParallel(rcContext* ctx, rcCompactHeightfield& chf,
+							const int borderSize, const int minRegionArea, const int mergeRegionArea,
+							rcParallelForFunc parallelFor, void* userData, const int bandCount)
+{
+	rcAssert(ctx);
+
+	if (!parallelFor || rcMin(bandCount, chf.height) <= 1)
+		return rcBuildRegions(ctx, chf, borderSize, minRegionArea, mergeRegionArea);
+
+	rcRegionBands bands;
+	if (!initRegionBands(ctx, "rcBuildRegionsParallel", chf, parallelFor, userData, bandCount, true, bands))
+		return false;
+
+	return buildRegions(ctx, chf, borderSize, minRegionArea, mergeRegionArea, &bands);
+}
+
 
 bool rcBuildLayerRegions(rcContext* ctx, rcCompactHeightfield& chf,
 						 const int borderSize, const int minRegionArea)
@@ -0,0 +1,196 @@
+//
+// Copyright (c) 2009-2010 Mikko Mononen memon@inside.org
+//
+// This software is provided 'as-is', without any express or implied
+// warranty.  In no event will the authors be held liable for any damages
+// arising from the use of this software.
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute it
+// freely, subject to the following restrictions:
+// 1. The origin of this software must not be misrepresented; you must not
+//    claim that you wrote the original software. If you use this software
+//    in a product, an acknowledgment in the product documentation would be
+//    appreciated but is not required.
+// 2. Altered source versions must be plainly marked as such, and must not be
+//    misrepresented as being the original software.
+// 3. This notice may not be removed or altered from any source distribution.
+//
+
+#include "Recast.h"
+#include "RecastSimd.h"
+
+#if RC_SIMD_X86
+#include <emmintrin.h>
+#include <immintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#define RC_TARGET_AVX2
+#else
+#define RC_TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+#endif
+
+// -1 means "use the best supported level".
+static int sRecastSimdLevel = -1;
+
+static int rcDetectSimd()
+{
+#if RC_SIMD_X86
+#if defined(_MSC_VER)
+	int info[4];
+	__cpuid(info, 0);
+	const int maxLeaf = info[0];
+	__cpuid(info, 1);
+	const bool osxsave = (info[2] & (1 << 27)) != 0;
+	const bool avx = (info[2] & (1 << 28)) != 0;
+	if (maxLeaf >= 7 && osxsave && avx && (_xgetbv(0) & 6) == 6)
+	{
+		__cpuidex(info, 7, 0);
+		if (info[1] & (1 << 5))
+			return RC_SIMD_AVX2;
+	}
+#else
+	__builtin_cpu_init();
+	if (__builtin_cpu_supports("avx2"))
+		return RC_SIMD_AVX2;
+#endif
+	return RC_SIMD_SSE2;
+#else
+	return RC_SIMD_SCALAR;
+#endif
+}
+
+int rcGetSimdSupport()
+{
+	static const int support = rcDetectSimd();
+	return support;
+}
+
+int rcSetSimdLevel(int level)
+{
+	sRecastSimdLevel = rcClamp(level, (int)RC_SIMD_SCALAR, rcGetSimdSupport());
+	return sRecastSimdLevel;
+}
+
+int rcGetSimdLevel()
+{
+	return sRecastSimdLevel < 0 ? rcGetSimdSupport() : sRecastSimdLevel;
+}
+
+#if RC_SIMD_X86
+
+// Writes the area of every lane set in mask.
+static inline void storeAreas(unsigned char* areas, int mask, const unsigned char area)
+{
+	for (int lane = 0; mask; ++lane, mask >>= 1)
+	{
+		if (mask & 1)
+			areas[lane] = area;
+	}
+}
+
+// Same expressions as calcTriNormal followed by the walkableThr test, one triangle per lane.
+int rcClassifySlopesSse2(const float* verts, const int* tris, int nt, float walkableThr, bool clear, unsigned char* areas)
+{
+	const __m128 thr = _mm_set1_ps(walkableThr);
+	const __m128 one = _mm_set1_ps(1.0f);
+	const unsigned char area = clear ? RC_NULL_AREA : RC_WALKABLE_AREA;
+
+	int i = 0;
+	for (; i + 4 <= nt; i += 4)
+	{
+		const int* t = &tris[i*3];
+		const float* a0 = &verts[t[0]*3]; const float* b0 = &verts[t[1]*3]; const float* c0 = &verts[t[2]*3];
+		const float* a1 = &verts[t[3]*3]; const float* b1 = &verts[t[4]*3]; const float* c1 = &verts[t[5]*3];
+		const float* a2 = &verts[t[6]*3]; const float* b2 = &verts[t[7]*3]; const float* c2 = &verts[t[8]*3];
+		const float* a3 = &verts[t[9]*3]; const float* b3 = &verts[t[10]*3]; const float* c3 = &verts[t[11]*3];
+
+		const __m128 ax = _mm_set_ps(a3[0], a2[0], a1[0], a0[0]);
+		const __m128 ay = _mm_set_ps(a3[1], a2[1], a1[1], a0[1]);
+		const __m128 az = _mm_set_ps(a3[2], a2[2], a1[2], a0[2]);
+
+		const __m128 e0x = _mm_sub_ps(_mm_set_ps(b3[0], b2[0], b1[0], b0[0]), ax);
+		const __m128 e0y = _mm_sub_ps(_mm_set_ps(b3[1], b2[1], b1[1], b0[1]), ay);
+		const __m128 e0z = _mm_sub_ps(_mm_set_ps(b3[2], b2[2], b1[2], b0[2]), az);
+		const __m128 e1x = _mm_sub_ps(_mm_set_ps(c3[0], c2[0], c1[0], c0[0]), ax);
+		const __m128 e1y = _mm_sub_ps(_mm_set_ps(c3[1], c2[1], c1[1], c0[1]), ay);
+		const __m128 e1z = _mm_sub_ps(_mm_set_ps(c3[2], c2[2], c1[2], c0[2]), az);
+
+		const __m128 nx = _mm_sub_ps(_mm_mul_ps(e0y, e1z), _mm_mul_ps(e0z, e1y));
+		const __m128 ny = _mm_sub_ps(_mm_mul_ps(e0z, e1x), _mm_mul_ps(e0x, e1z));
+		const __m128 nz = _mm_sub_ps(_mm_mul_ps(e0x, e1y), _mm_mul_ps(e0y, e1x));
+		const __m128 len = _mm_add_ps(_mm_add_ps(_mm_mul_ps(nx, nx), _mm_mul_ps(ny, ny)), _mm_mul_ps(nz, nz));
+		const __m128 y = _mm_mul_ps(ny, _mm_div_ps(one, _mm_sqrt_ps(len)));
+
+		// cmple rather than a negated cmpgt so NaN normals are left alone, like the scalar tests.
+		const __m128 hit = clear ? _mm_cmple_ps(y, thr) : _mm_cmpgt_ps(y, thr);
+		storeAreas(&areas[i], _mm_movemask_ps(hit), area);
+	}
+	return i;
+}
+
+// Hardware gathers are slower than plain loads for three-float vertices on common cores.
+RC_TARGET_AVX2
+static inline __m256 lanes8(const float* const* v, const int k)
+{
+	return _mm256_setr_ps(v[0][k], v[1][k], v[2][k], v[3][k], v[4][k], v[5][k], v[6][k], v[7][k]);
+}
+
+RC_TARGET_AVX2
+int rcClassifySlopesAvx2(const float* verts, const int* tris, int nt, float walkableThr, bool clear, unsigned char* areas)
+{
+	const __m256 thr = _mm256_set1_ps(walkableThr);
+	const __m256 one = _mm256_set1_ps(1.0f);
+	const unsigned char area = clear ? RC_NULL_AREA : RC_WALKABLE_AREA;
+
+	int i = 0;
+	for (; i + 8 <= nt; i += 8)
+	{
+		const int* t = &tris[i*3];
+		const float* a[8];
+		const float* b[8];
+		const float* c[8];
+		for (int k = 0; k < 8; ++k)
+		{
+			a[k] = &verts[t[k*3+0]*3];
+			b[k] = &verts[t[k*3+1]*3];
+			c[k] = &verts[t[k*3+2]*3];
+		}
+
+		const __m256 ax = lanes8(a, 0);
+		const __m256 ay = lanes8(a, 1);
+		const __m256 az = lanes8(a, 2);
+
+		const __m256 e0x = _mm256_sub_ps(lanes8(b, 0), ax);
+		const __m256 e0y = _mm256_sub_ps(lanes8(b, 1), ay);
+		const __m256 e0z = _mm256_sub_ps(lanes8(b, 2), az);
+		const __m256 e1x = _mm256_sub_ps(lanes8(c, 0), ax);
+		const __m256 e1y = _mm256_sub_ps(lanes8(c, 1), ay);
+		const __m256 e1z = _mm256_sub_ps(lanes8(c, 2), az);
+
+		// Separate multiplies and adds; the target deliberately leaves out FMA so nothing gets contracted.
+		const __m256 nx = _mm256_sub_ps(_mm256_mul_ps(e0y, e1z), _mm256_mul_ps(e0z, e1y));
+		const __m256 ny = _mm256_sub_ps(_mm256_mul_ps(e0z, e1x), _mm256_mul_ps(e0x, e1z));
+		const __m256 nz = _mm256_sub_ps(_mm256_mul_ps(e0x, e1y), _mm256_mul_ps(e0y, e1x));
+		const __m256 len = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(nx, nx), _mm256_mul_ps(ny, ny)), _mm256_mul_ps(nz, nz));
+		const __m256 y = _mm256_mul_ps(ny, _mm256_div_ps(one, _mm256_sqrt_ps(len)));
+
+		const __m256 hit = clear ? _mm256_cmp_ps(y, thr, _CMP_LE_OQ) : _mm256_cmp_ps(y, thr, _CMP_GT_OQ);
+		storeAreas(&areas[i], _mm256_movemask_ps(hit), area);
+	}
+	return i;
+}
+
+#else
+
+int rcClassifySlopesSse2(const float*, const int*, int, float, bool, unsigned char*)
+{
+	return 0;
+}
+
+int rcClassifySlopesAvx2(const float*, const int*, int, float, bool, unsigned char*)
+{
+	return 0;
+}
+
+#endif
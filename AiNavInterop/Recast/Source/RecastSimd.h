@@ -0,0 +1,101 @@
+//
+// Copyright (c) 2009-2010 Mikko Mononen memon@inside.org
+//
+// This software is provided 'as-is', without any express or implied
+// warranty.  In no event will the authors be held liable for any damages
+// arising from the use of this software.
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute it
+// freely, subject to the following restrictions:
+// 1. The origin of this software must not be misrepresented; you must not
+//    claim that you wrote the original software. If you use this software
+//    in a product, an acknowledgment in the product documentation would be
+//    appreciated but is not required.
+// 2. Altered source versions must be plainly marked as such, and must not be
+//    misrepresented as being the original software.
+// 3. This notice may not be removed or altered from any source distribution.
+//
+
+#ifndef RECAST_SIMD_H
+#define RECAST_SIMD_H
+
+// Vector kernels behind rcMarkWalkableTriangles, rcClearUnwalkableTriangles and the triangle rasterizer.
+// Every kernel performs the same IEEE operations in the same order as the scalar code, so results are bit-identical.
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define RC_SIMD_X86 1
+#else
+#define RC_SIMD_X86 0
+#endif
+
+/// Classifies triangles by the y component of their normal, 4 or 8 at a time.
+/// With @p clear set, triangles whose normal y is <= @p walkableThr get #RC_NULL_AREA (rcClearUnwalkableTriangles),
+/// otherwise triangles whose normal y is > @p walkableThr get #RC_WALKABLE_AREA (rcMarkWalkableTriangles).
+/// Returns the number of triangles processed, always a multiple of the kernel width. The caller finishes the rest.
+int rcClassifySlopesSse2(const float* verts, const int* tris, int nt, float walkableThr, bool clear, unsigned char* areas);
+int rcClassifySlopesAvx2(const float* verts, const int* tris, int nt, float walkableThr, bool clear, unsigned char* areas);
+
+#if RC_SIMD_X86
+
+#include <emmintrin.h>
+
+static inline __m128 rcLoadVert3(const float* v)
+{
+	// Exactly three floats; never reads past the end of the vertex.
+	return _mm_movelh_ps(_mm_castsi128_ps(_mm_loadl_epi64((const __m128i*)v)), _mm_load_ss(v + 2));
+}
+
+static inline void rcStoreVert3(float* dst, const __m128 v)
+{
+	_mm_storel_epi64((__m128i*)dst, _mm_castps_si128(v));
+	_mm_store_ss(dst + 2, _mm_movehl_ps(v, v));
+}
+
+/// dividePoly of the rasterizer with the edge intersections computed on whole vertices.
+/// Inline so the rasterizer's clipping loops can absorb it.
+inline void rcDividePolySse2(const float* in, int nin, float* out1, int* nout1, float* out2, int* nout2, float x, int axis)
+{
+	float d[12];
+	for (int i = 0; i < nin; ++i)
+		d[i] = x - in[i*3+axis];
+
+	int m = 0, n = 0;
+	__m128 vj = rcLoadVert3(&in[(nin-1)*3]);
+	for (int i = 0, j = nin-1; i < nin; j=i, ++i)
+	{
+		const __m128 vi = rcLoadVert3(&in[i*3]);
+		bool ina = d[j] >= 0;
+		bool inb = d[i] >= 0;
+		if (ina != inb)
+		{
+			const float s = d[j] / (d[j] - d[i]);
+			const __m128 p = _mm_add_ps(vj, _mm_mul_ps(_mm_sub_ps(vi, vj), _mm_set1_ps(s)));
+			rcStoreVert3(&out1[m*3], p);
+			rcStoreVert3(&out2[n*3], p);
+			m++;
+			n++;
+			// add the i'th point to the right polygon. Do NOT add points that are on the dividing line
+			// since these were already added above
+			if (d[i] > 0)
+				rcStoreVert3(&out1[m++*3], vi);
+			else if (d[i] < 0)
+				rcStoreVert3(&out2[n++*3], vi);
+		}
+		else // same side
+		{
+			// add the i'th point to the right polygon. Addition is done even for points on the dividing line
+			if (d[i] >= 0)
+				rcStoreVert3(&out1[m++*3], vi);
+			if (!(d[i] > 0))
+				rcStoreVert3(&out2[n++*3], vi);
+		}
+		vj = vi;
+	}
+
+	*nout1 = m;
+	*nout2 = n;
+}
+
+#endif
+
+#endif // RECAST_SIMD_H
@@ -0,0 +1,271 @@
+#include "TilePack.hpp"
+#include <DetourNavMesh.h>
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+static bool EntryLess(const TilePackEntry& a, const TilePackEntry& b)
+{
+	if (a.x != b.x) return a.x < b.x;
+	if (a.y != b.y) return a.y < b.y;
+	return a.layer < b.layer;
+}
+
+TilePack::TilePack()
+{
+	m_refCount = 1;
+}
+
+TilePack::~TilePack()
+{
+	Unmap();
+}
+
+TilePack* TilePack::Open(const char* path)
+{
+	TilePack* pack = new TilePack();
+	if (!pack->Map(path))
+	{
+		delete pack;
+		return nullptr;
+	}
+
+	// Only the header and the index are touched here, tile pages are faulted in when a tile is added
+	const TilePackHeader* header = (const TilePackHeader*)pack->m_base;
+	if (pack->m_size < sizeof(TilePackHeader) || header->magic != TilePackMagic || header->version != TilePackVersion
+		|| header->tileCount < 0 || sizeof(TilePackHeader) + (uint64_t)header->tileCount * sizeof(TilePackEntry) > pack->m_size)
+	{
+		delete pack;
+		return nullptr;
+	}
+
+	pack->m_tileCount = header->tileCount;
+	pack->m_entries = (const TilePackEntry*)(pack->m_base + sizeof(TilePackHeader));
+	for (int i = 0; i < pack->m_tileCount; ++i)
+	{
+		// FindTile binary searches the index, entries have to be sorted by (x, y, layer) without duplicates
+		const TilePackEntry& entry = pack->m_entries[i];
+		if (entry.offset % TilePackAlignment != 0 || entry.offset + entry.size > pack->m_size
+			|| (i > 0 && !EntryLess(pack->m_entries[i - 1], entry)))
+		{
+			delete pack;
+			return nullptr;
+		}
+	}
+	return pack;
+}
+
+#ifdef _WIN32
+bool TilePack::Map(const char* path)
+{
+	HANDLE file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+	if (file == INVALID_HANDLE_VALUE)
+		return false;
+	m_file = file;
+
+	LARGE_INTEGER size;
+	if (!GetFileSizeEx(file, &size) || size.QuadPart == 0)
+		return false;
+	m_size = (uint64_t)size.QuadPart;
+
+	m_mapping = CreateFileMappingA(file, nullptr, PAGE_WRITECOPY, 0, 0, nullptr);
+	if (!m_mapping)
+		return false;
+	m_base = MapView();
+	return m_base != nullptr;
+}
+
+uint8_t* TilePack::MapView() const
+{
+	return (uint8_t*)MapViewOfFile(m_mapping, FILE_MAP_COPY, 0, 0, 0);
+}
+
+void TilePack::Unmap()
+{
+	if (m_base)
+		UnmapViewOfFile(m_base);
+	if (m_replica)
+		UnmapViewOfFile(m_replica);
+	if (m_mapping)
+		CloseHandle(m_mapping);
+	if (m_file)
+		CloseHandle(m_file);
+	m_base = nullptr;
+	m_replica = nullptr;
+	m_mapping = nullptr;
+	m_file = nullptr;
+}
+#else
+bool TilePack::Map(const char* path)
+{
+	int fd = open(path, O_RDONLY);
+	if (fd < 0)
+		return false;
+	m_file = fd;
+
+	struct stat st;
+	if (fstat(fd, &st) != 0 || st.st_size == 0)
+		return false;
+	m_size = (uint64_t)st.st_size;
+
+	m_base = MapView();
+	return m_base != nullptr;
+}
+
+// Private writable mapping, detour writes links into the tiles but the file is never modified
+uint8_t* TilePack::MapView() const
+{
+	void* base = mmap(nullptr, m_size, PROT_READ | PROT_WRITE, MAP_PRIVATE, m_file, 0);
+	return base == MAP_FAILED ? nullptr : (uint8_t*)base;
+}
+
+void TilePack::Unmap()
+{
+	if (m_base)
+		munmap(m_base, m_size);
+	if (m_replica)
+		munmap(m_replica, m_size);
+	if (m_file >= 0)
+		close(m_file);
+	m_base = nullptr;
+	m_replica = nullptr;
+	m_file = -1;
+}
+#endif
+
+int TilePack::Write(const char* path, uint8_t** tiles, int* tileLengths, int count)
+{
+	if (!path || count < 0)
+		return 0;
+
+	std::vector<TilePackEntry> entries;
+	std::vector<int> sources;
+	for (int i = 0; i < count; ++i)
+	{
+		if (!tiles[i] || tileLengths[i] < (int)sizeof(dtMeshHeader))
+			return 0;
+		const dtMeshHeader* header = (const dtMeshHeader*)tiles[i];
+		if (header->magic != DT_NAVMESH_MAGIC || header->version != DT_NAVMESH_VERSION)
+			return 0;
+
+		TilePackEntry entry;
+		entry.x = header->x;
+		entry.y = header->y;
+		entry.layer = header->layer;
+		entry.size = (uint32_t)tileLengths[i];
+		entry.offset = (uint64_t)i;
+		entries.push_back(entry);
+	}
+
+	std::sort(entries.begin(), entries.end(), EntryLess);
+	for (int i = 1; i < count; ++i)
+	{
+		if (!EntryLess(entries[i - 1], entries[i]))
+			return 0; // Duplicate tile location
+	}
+
+	// Offset temporarily holds the source index, replace it with the page aligned file offset
+	uint64_t offset = sizeof(TilePackHeader) + (uint64_t)count * sizeof(TilePackEntry);
+	for (auto& entry : entries)
+	{
+		sources.push_back((int)entry.offset);
+		offset = (offset + TilePackAlignment - 1) / TilePackAlignment * TilePackAlignment;
+		entry.offset = offset;
+		offset += entry.size;
+	}
+
+	FILE* file = fopen(path, "wb");
+	if (!file)
+		return 0;
+
+	TilePackHeader header;
+	header.magic = TilePackMagic;
+	header.version = TilePackVersion;
+	header.tileCount = count;
+	header.alignment = TilePackAlignment;
+
+	bool ok = fwrite(&header, sizeof(header), 1, file) == 1;
+	if (ok && count > 0)
+		ok = fwrite(entries.data(), sizeof(TilePackEntry), count, file) == (size_t)count;
+
+	static const uint8_t padding[TilePackAlignment] = { 0 };
+	uint64_t position = sizeof(TilePackHeader) + (uint64_t)count * sizeof(TilePackEntry);
+	for (int i = 0; ok && i < count; ++i)
+	{
+		size_t pad = (size_t)(entries[i].offset - position);
+		if (pad > 0)
+			ok = fwrite(padding, 1, pad, file) == pad;
+		if (ok)
+			ok = fwrite(tiles[sources[i]], 1, entries[i].size, file) == entries[i].size;
+		position = entries[i].offset + entries[i].size;
+	}
+
+	if (fclose(file) != 0)
+		ok = false;
+	return ok ? 1 : 0;
+}
+
+int TilePack::GetTileCount() const
+{
+	return m_tileCount;
+}
+
+const TilePackEntry* TilePack::GetEntry(int index) const
+{
+	if (index < 0 || index >= m_tileCount)
+		return nullptr;
+	return &m_entries[index];
+}
+
+int TilePack::FindTile(int x, int y, int layer) const
+{
+	TilePackEntry key;
+	key.x = x;
+	key.y = y;
+	key.layer = layer;
+	const TilePackEntry* end = m_entries + m_tileCount;
+	const TilePackEntry* it = std::lower_bound(m_entries, end, key, EntryLess);
+	if (it == end || it->x != x || it->y != y || it->layer != layer)
+		return -1;
+	return (int)(it - m_entries);
+}
+
+uint8_t* TilePack::GetTileData(int index) const
+{
+	if (index < 0 || index >= m_tileCount)
+		return nullptr;
+	return m_base + m_entries[index].offset;
+}
+
+uint8_t* TilePack::GetReplicaTileData(int index)
+{
+	if (index < 0 || index >= m_tileCount)
+		return nullptr;
+
+	std::lock_guard<std::mutex> lock(m_replicaLock);
+	if (!m_replica)
+		m_replica = MapView();
+	return m_replica ? m_replica + m_entries[index].offset : nullptr;
+}
+
+void TilePack::AddRef()
+{
+	m_refCount++;
+}
+
+void TilePack::Release()
+{
+	if (--m_refCount == 0)
+		delete this;
+}
@@ -0,0 +1,69 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+
+// On disk layout of a tile pack:
+//   TilePackHeader
+//   TilePackEntry[tileCount], sorted by (x, y, layer)
+//   tile blobs, each starting on a TilePackAlignment boundary
+// The pack is mapped copy-on-write, detour patches links into tiles in place so only touched pages become private.
+// A second navmesh snapshot gets a view of its own, pages detour never writes stay shared with the first one.
+static const uint32_t TilePackMagic = 'A' << 24 | 'N' << 16 | 'T' << 8 | 'P';
+static const uint32_t TilePackVersion = 1;
+static const uint32_t TilePackAlignment = 4096;
+
+struct TilePackHeader
+{
+	uint32_t magic;
+	uint32_t version;
+	int32_t tileCount;
+	uint32_t alignment;
+};
+
+struct TilePackEntry
+{
+	int32_t x;
+	int32_t y;
+	int32_t layer;
+	uint32_t size;
+	uint64_t offset;
+};
+
+class TilePack
+{
+	uint8_t* m_base = nullptr;
+	// Second copy-on-write view, mapped the first time a tile is replicated
+	uint8_t* m_replica = nullptr;
+	std::mutex m_replicaLock;
+	uint64_t m_size = 0;
+	const TilePackEntry* m_entries = nullptr;
+	int m_tileCount = 0;
+	std::atomic<int> m_refCount;
+#ifdef _WIN32
+	void* m_file = nullptr;
+	void* m_mapping = nullptr;
+#else
+	int m_file = -1;
+#endif
+
+	TilePack();
+	~TilePack();
+	bool Map(const char* path);
+	uint8_t* MapView() const;
+	void Unmap();
+public:
+	static TilePack* Open(const char* path);
+	static int Write(const char* path, uint8_t** tiles, int* tileLengths, int count);
+
+	int GetTileCount() const;
+	const TilePackEntry* GetEntry(int index) const;
+	int FindTile(int x, int y, int layer) const;
+	uint8_t* GetTileData(int index) const;
+	// Same tile in the second view, for the snapshot that replays changes. Null when the view can't be mapped.
+	uint8_t* GetReplicaTileData(int index);
+
+	// Every tile resident in a navmesh holds a reference, the pack is unmapped when the last one is released
+	void AddRef();
+	void Release();
+};
@@ -0,0 +1,345 @@
+#include "TileResidency.hpp"
+#include <DetourAlloc.h>
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+
+// Callback sources can produce a tile later, a missing tile that stays in focus is asked for again after this long
+static const int AbsentRetryMs = 2000;
+
+TileResidencyManager::TileResidencyManager(NavigationMesh* navmesh)
+{
+	m_navmesh = navmesh;
+	m_worker = std::thread(&TileResidencyManager::WorkerMain, this);
+}
+
+TileResidencyManager::~TileResidencyManager()
+{
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_shutdown = true;
+	}
+	m_wake.notify_all();
+	m_worker.join();
+
+	// Resident tiles stay in the navmesh, only data that never made it in is ours to drop
+	for (auto& tile : m_fetched)
+		Discard(tile);
+	if (m_pack)
+		m_pack->Release();
+}
+
+void TileResidencyManager::SetPackSource(TilePack* pack)
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	if (pack)
+		pack->AddRef();
+	if (m_pack)
+		m_pack->Release();
+	m_pack = pack;
+	m_callback = nullptr;
+	m_callbackUserData = nullptr;
+	m_sourceGeneration++;
+	m_absent.clear();
+}
+
+void TileResidencyManager::SetCallbackSource(TileSourceCallback callback, void* userData)
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	if (m_pack)
+		m_pack->Release();
+	m_pack = nullptr;
+	m_callback = callback;
+	m_callbackUserData = userData;
+	m_sourceGeneration++;
+	m_absent.clear();
+}
+
+void TileResidencyManager::SetFocus(const DtResidencyFocus* focus, int count)
+{
+	m_focus.assign(focus, focus + (count > 0 ? count : 0));
+}
+
+int TileResidencyManager::GetResidentCount() const
+{
+	return (int)m_resident.size();
+}
+
+void TileResidencyManager::WorkerMain()
+{
+	for (;;)
+	{
+		TileKey key;
+		TilePack* pack;
+		TileSourceCallback callback;
+		void* userData;
+		int generation;
+		{
+			std::unique_lock<std::mutex> lock(m_mutex);
+			m_wake.wait(lock, [&] { return m_shutdown || !m_requests.empty(); });
+			if (m_shutdown)
+				return;
+			key = m_requests.front();
+			m_requests.pop_front();
+
+			pack = m_pack;
+			if (pack)
+				pack->AddRef();
+			callback = m_callback;
+			userData = m_callbackUserData;
+			generation = m_sourceGeneration;
+		}
+
+		FetchedTile tile;
+		tile.key = key;
+		tile.generation = generation;
+		tile.packIndex = -1;
+		tile.data = nullptr;
+		tile.dataLength = 0;
+
+		if (pack)
+		{
+			tile.packIndex = pack->FindTile(key.x, key.y, key.layer);
+			if (tile.packIndex >= 0)
+			{
+				// Fault the tile pages in here so the commit on the update thread doesn't stall on IO
+				const uint8_t* data = pack->GetTileData(tile.packIndex);
+				uint32_t size = pack->GetEntry(tile.packIndex)->size;
+				volatile uint8_t sink = 0;
+				for (uint32_t offset = 0; offset < size; offset += TilePackAlignment)
+					sink += data[offset];
+				tile.dataLength = (int)size;
+			}
+			pack->Release();
+		}
+		else if (callback)
+		{
+			uint8_t* data = nullptr;
+			int dataLength = 0;
+			if (callback(key.x, key.y, key.layer, &data, &dataLength, userData) && data && dataLength > 0)
+			{
+				tile.data = (uint8_t*)dtAlloc(dataLength, DT_ALLOC_PERM);
+				if (tile.data)
+				{
+					memcpy(tile.data, data, dataLength);
+					tile.dataLength = dataLength;
+				}
+			}
+		}
+
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_fetched.push_back(tile);
+	}
+}
+
+void TileResidencyManager::Discard(FetchedTile& tile)
+{
+	if (tile.data)
+		dtFree(tile.data);
+	tile.data = nullptr;
+}
+
+// Every tile touching a focus circle, mapped to the distance from the closest focus point
+void TileResidencyManager::CollectWanted(std::unordered_map<TileKey, float, TileKeyHash>& wanted)
+{
+	const dtNavMesh* navMesh = m_navmesh->GetNavmesh();
+	const dtNavMeshParams* params = navMesh->getParams();
+
+	for (const auto& focus : m_focus)
+	{
+		float radius = focus.radius > 0.0f ? focus.radius : 0.0f;
+		float bmin[3] = { focus.position.x - radius, focus.position.y, focus.position.z - radius };
+		float bmax[3] = { focus.position.x + radius, focus.position.y, focus.position.z + radius };
+		int minx, miny, maxx, maxy;
+		navMesh->calcTileLoc(bmin, &minx, &miny);
+		navMesh->calcTileLoc(bmax, &maxx, &maxy);
+
+		for (int ty = miny; ty <= maxy; ++ty)
+		{
+			for (int tx = minx; tx <= maxx; ++tx)
+			{
+				// Distance from the focus point to the tile rectangle on the xz plane
+				float x0 = params->orig[0] + tx * params->tileWidth;
+				float z0 = params->orig[2] + ty * params->tileHeight;
+				float dx = std::max(std::max(x0 - focus.position.x, focus.position.x - (x0 + params->tileWidth)), 0.0f);
+				float dz = std::max(std::max(z0 - focus.position.z, focus.position.z - (z0 + params->tileHeight)), 0.0f);
+				float distSqr = dx * dx + dz * dz;
+				if (distSqr > radius * radius)
+					continue;
+
+				// Packs can hold several layers per location, callbacks are asked for layer 0 only
+				int layers = 1;
+				if (m_pack)
+				{
+					layers = 0;
+					while (m_pack->FindTile(tx, ty, layers) >= 0)
+						layers++;
+				}
+
+				for (int layer = 0; layer < layers; ++layer)
+				{
+					TileKey key = { tx, ty, layer };
+					auto it = wanted.find(key);
+					if (it == wanted.end() || distSqr < it->second)
+						wanted[key] = distSqr;
+				}
+			}
+		}
+	}
+}
+
+void TileResidencyManager::CancelRequests()
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	for (const auto& key : m_requests)
+		m_pending.erase(key);
+	m_requests.clear();
+}
+
+// Evicts tiles no focus needs anymore, queues missing ones closest first and commits fetched tiles.
+// Stops once budgetMs or budgetBytes is used up (values <= 0 disable a budget), always committing at least one tile.
+// Returns the number of tiles added or removed.
+int TileResidencyManager::Update(float budgetMs, int budgetBytes)
+{
+	auto start = std::chrono::steady_clock::now();
+	auto overBudget = [&](int bytes)
+	{
+		if (budgetBytes > 0 && bytes >= budgetBytes)
+			return true;
+		if (budgetMs > 0.0f)
+		{
+			std::chrono::duration<float, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+			return elapsed.count() >= budgetMs;
+		}
+		return false;
+	};
+
+	std::unordered_map<TileKey, float, TileKeyHash> wanted;
+	CollectWanted(wanted);
+
+	int changed = 0;
+	int bytes = 0;
+
+	// Evict
+	for (auto it = m_resident.begin(); it != m_resident.end();)
+	{
+		if (wanted.count(*it))
+		{
+			++it;
+			continue;
+		}
+		if (overBudget(bytes))
+			break;
+		m_navmesh->RemoveTile(it->x, it->y, it->layer);
+		it = m_resident.erase(it);
+		changed++;
+	}
+
+	// Requests that are still queued are rebuilt below in priority order
+	CancelRequests();
+
+	std::vector<std::pair<float, TileKey>> missing;
+	const dtNavMesh* navMesh = m_navmesh->GetNavmesh();
+	int generation;
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		generation = m_sourceGeneration;
+
+		// A missing tile is requested again once it re-enters a focus area, or after a while for callback sources
+		auto now = std::chrono::steady_clock::now();
+		for (auto it = m_absent.begin(); it != m_absent.end();)
+		{
+			if (!wanted.count(it->first) || (!m_pack && now - it->second >= std::chrono::milliseconds(AbsentRetryMs)))
+				it = m_absent.erase(it);
+			else
+				++it;
+		}
+
+		for (const auto& entry : wanted)
+		{
+			const TileKey& key = entry.first;
+			if (m_resident.count(key) || m_pending.count(key) || m_absent.count(key))
+				continue;
+			// Tiles added outside of the manager are left alone
+			if (navMesh->getTileAt(key.x, key.y, key.layer))
+				continue;
+			missing.push_back(std::make_pair(entry.second, key));
+		}
+	}
+	std::sort(missing.begin(), missing.end(), [](const std::pair<float, TileKey>& a, const std::pair<float, TileKey>& b) { return a.first < b.first; });
+
+	if (!missing.empty())
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		for (const auto& entry : missing)
+		{
+			m_requests.push_back(entry.second);
+			m_pending.insert(entry.second);
+		}
+	}
+	m_wake.notify_one();
+
+	// Commit
+	std::vector<FetchedTile> fetched;
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		fetched.swap(m_fetched);
+	}
+
+	size_t next = 0;
+	int committed = 0;
+	for (; next < fetched.size(); ++next)
+	{
+		if (committed > 0 && overBudget(bytes))
+			break;
+
+		FetchedTile& tile = fetched[next];
+		bool current = tile.generation == generation;
+		if (current && tile.packIndex < 0 && !tile.data)
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			m_absent[tile.key] = std::chrono::steady_clock::now();
+		}
+
+		if (!current || !wanted.count(tile.key) || m_resident.count(tile.key))
+		{
+			Discard(tile);
+			m_pending.erase(tile.key);
+			continue;
+		}
+
+		int added = 0;
+		if (tile.packIndex >= 0 && m_pack)
+		{
+			added = m_navmesh->LoadTileFromPack(m_pack, tile.packIndex);
+		}
+		else if (tile.data)
+		{
+			DtGeneratedData data;
+			data.success = true;
+			data.navmeshData = tile.data;
+			data.navmeshDataLength = tile.dataLength;
+			added = m_navmesh->LoadTileOwned(&data);
+			tile.data = data.navmeshData;
+		}
+		Discard(tile);
+		m_pending.erase(tile.key);
+
+		if (added)
+		{
+			m_resident.insert(tile.key);
+			bytes += tile.dataLength;
+			committed++;
+			changed++;
+		}
+	}
+
+	// Out of budget, the rest is committed on the next update
+	if (next < fetched.size())
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_fetched.insert(m_fetched.begin(), fetched.begin() + next, fetched.end());
+	}
+
+	return changed;
+}
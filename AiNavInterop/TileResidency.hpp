@@ -0,0 +1,85 @@
+#pragma once
+#include "Navigation.hpp"
+#include "NavigationMesh.hpp"
+#include "TilePack.hpp"
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+struct DtResidencyFocus
+{
+	float3 position;
+	float radius;
+};
+
+// Tile source callback, fills data/dataLength for the requested tile and returns 1, or 0 if there is no such tile.
+// The data only has to stay valid until the callback returns. Called from the residency worker thread.
+typedef int (*TileSourceCallback)(int x, int y, int layer, uint8_t** data, int* dataLength, void* userData);
+
+// Keeps the tiles around a set of focus points resident in a NavigationMesh.
+// Tile data is fetched from the source on a worker thread, Update then commits fetched tiles and evicts tiles
+// that left every focus area within a per call time and byte budget.
+// Update changes the navmesh, so it has the same synchronization requirements as AddTile/RemoveTile.
+class TileResidencyManager
+{
+	struct TileKey
+	{
+		int x;
+		int y;
+		int layer;
+		bool operator==(const TileKey& other) const { return x == other.x && y == other.y && layer == other.layer; }
+	};
+	struct TileKeyHash
+	{
+		size_t operator()(const TileKey& key) const
+		{
+			return (size_t)((uint64_t)(uint32_t)key.x * 73856093u ^ (uint64_t)(uint32_t)key.y * 19349663u ^ (uint64_t)(uint32_t)key.layer * 83492791u);
+		}
+	};
+	struct FetchedTile
+	{
+		TileKey key;
+		int generation;
+		int packIndex;
+		uint8_t* data;
+		int dataLength;
+	};
+
+	NavigationMesh* m_navmesh;
+	TilePack* m_pack = nullptr;
+	TileSourceCallback m_callback = nullptr;
+	void* m_callbackUserData = nullptr;
+	std::vector<DtResidencyFocus> m_focus;
+
+	std::unordered_set<TileKey, TileKeyHash> m_resident;
+	std::unordered_set<TileKey, TileKeyHash> m_pending;
+	// Tiles the source didn't have, with the time they were found missing so callback sources are asked again later
+	std::unordered_map<TileKey, std::chrono::steady_clock::time_point, TileKeyHash> m_absent;
+	int m_sourceGeneration = 0;
+
+	std::thread m_worker;
+	std::mutex m_mutex;
+	std::condition_variable m_wake;
+	std::deque<TileKey> m_requests;
+	std::vector<FetchedTile> m_fetched;
+	bool m_shutdown = false;
+
+	void WorkerMain();
+	void Discard(FetchedTile& tile);
+	void CollectWanted(std::unordered_map<TileKey, float, TileKeyHash>& wanted);
+	void CancelRequests();
+public:
+	TileResidencyManager(NavigationMesh* navmesh);
+	~TileResidencyManager();
+	void SetPackSource(TilePack* pack);
+	void SetCallbackSource(TileSourceCallback callback, void* userData);
+	void SetFocus(const DtResidencyFocus* focus, int count);
+	int Update(float budgetMs, int budgetBytes);
+	int GetResidentCount() const;
+};
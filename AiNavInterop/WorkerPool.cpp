@@ -0,0 +1,118 @@
+#include "WorkerPool.hpp"
+
+// Pool and worker index of the current thread while it is executing pool tasks, null and -1 otherwise.
+// A task of one pool calling into another pool is an outside caller of that pool.
+static thread_local const WorkerPool* t_pool = nullptr;
+static thread_local int t_poolWorker = -1;
+
+WorkerPool::WorkerPool(int workerCount)
+{
+	m_next = 0;
+	if (workerCount < 1)
+		workerCount = 1;
+	for (int i = 1; i < workerCount; ++i)
+		m_threads.emplace_back(&WorkerPool::WorkerMain, this, i);
+}
+
+WorkerPool::~WorkerPool()
+{
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_shutdown = true;
+	}
+	m_wake.notify_all();
+	for (auto& thread : m_threads)
+		thread.join();
+}
+
+int WorkerPool::GetWorkerCount() const
+{
+	return (int)m_threads.size() + 1;
+}
+
+int WorkerPool::GetDefaultWorkerCount()
+{
+	int count = (int)std::thread::hardware_concurrency();
+	return count > 0 ? count : 1;
+}
+
+void WorkerPool::RunTasks(int worker)
+{
+	const WorkerPool* previousPool = t_pool;
+	int previousWorker = t_poolWorker;
+	t_pool = this;
+	t_poolWorker = worker;
+	for (;;)
+	{
+		int index = m_next.fetch_add(1);
+		if (index >= m_count)
+			break;
+		(*m_task)(index, worker);
+	}
+	t_pool = previousPool;
+	t_poolWorker = previousWorker;
+}
+
+void WorkerPool::WorkerMain(int worker)
+{
+	uint64_t seen = 0;
+	for (;;)
+	{
+		{
+			std::unique_lock<std::mutex> lock(m_mutex);
+			m_wake.wait(lock, [&] { return m_shutdown || m_generation != seen; });
+			if (m_shutdown)
+				return;
+			seen = m_generation;
+		}
+
+		RunTasks(worker);
+
+		std::lock_guard<std::mutex> lock(m_mutex);
+		if (--m_running == 0)
+			m_done.notify_one();
+	}
+}
+
+void WorkerPool::ParallelFor(int count, const std::function<void(int index, int worker)>& task)
+{
+	if (count <= 0)
+		return;
+
+	// Nested work runs inline on the calling worker, there is nobody left to hand it to
+	if (t_pool == this)
+	{
+		for (int i = 0; i < count; ++i)
+			task(i, t_poolWorker);
+		return;
+	}
+
+	std::lock_guard<std::mutex> dispatch(m_dispatchMutex);
+
+	// Trivial work runs inline as worker 0, still under the dispatch lock so no other caller is worker 0 meanwhile
+	if (m_threads.empty() || count == 1)
+	{
+		m_task = &task;
+		m_count = count;
+		m_next = 0;
+		RunTasks(0);
+		m_task = nullptr;
+		return;
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_task = &task;
+		m_count = count;
+		m_next = 0;
+		m_running = (int)m_threads.size();
+		m_generation++;
+	}
+	m_wake.notify_all();
+
+	RunTasks(0);
+
+	std::unique_lock<std::mutex> lock(m_mutex);
+	m_done.wait(lock, [&] { return m_running == 0; });
+	m_task = nullptr;
+}
@@ -0,0 +1,40 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Fixed set of native worker threads used to fan work out from a single call.
+// The calling thread takes part in every ParallelFor as worker 0, so a pool of N workers owns N - 1 threads.
+// Calls made from inside a running task of the same pool execute inline on the calling worker,
+// a task of another pool calls in like any outside thread and waits for its turn.
+class WorkerPool
+{
+	std::vector<std::thread> m_threads;
+	std::mutex m_mutex;
+	std::mutex m_dispatchMutex;
+	std::condition_variable m_wake;
+	std::condition_variable m_done;
+	const std::function<void(int, int)>* m_task = nullptr;
+	std::atomic<int> m_next;
+	int m_count = 0;
+	int m_running = 0;
+	uint64_t m_generation = 0;
+	bool m_shutdown = false;
+
+	void WorkerMain(int worker);
+	void RunTasks(int worker);
+public:
+	WorkerPool(int workerCount);
+	~WorkerPool();
+	int GetWorkerCount() const;
+
+	// Runs task(index, worker) for every index in [0, count) and returns once all of them finished.
+	// worker is in [0, GetWorkerCount()) and is stable for the duration of one task.
+	void ParallelFor(int count, const std::function<void(int index, int worker)>& task);
+
+	static int GetDefaultWorkerCount();
+};
@@ -68,6 +68,212 @@ namespace AiNav.Test
             outVerts.Dispose();
             outIndices.Dispose();
 
+            builder.Dispose();
+        }
+
+        [Test]
+        public void BuildInputPerTileSkipsFailedTiles()
+        {
+            NavMeshBuildSettings buildSettings = NavMeshBuildSettings.Default();
+            NavAgentSettings agentSettings = NavAgentSettings.Default();
+            NavMeshBuilder builder = new NavMeshBuilder(buildSettings, agentSettings);
+
+            NavMeshTestData data = NavMeshTestData.Load();
+            data.GetInputData(out float3[] vertices, out int[] indices);
+
+            int2 coord = new int2(0, 0);
+            int2 emptyCoord = new int2(1, 0);
+            NavMeshInputBuilder input = new NavMeshInputBuilder(new NavMeshTileBounds(coord, NavMeshBuildUtils.CalculateTileBoundingBox(buildSettings, coord)));
+            input.Append(vertices, indices, DtArea.WALKABLE);
+            NavMeshInputBuilder emptyInput = new NavMeshInputBuilder(new NavMeshTileBounds(emptyCoord, NavMeshBuildUtils.CalculateTileBoundingBox(buildSettings, emptyCoord)));
+
+            // The empty tile fails on its own, the other tile of the batch still builds
+            Assert.IsFalse(builder.BuildInputPerTile(new List<NavMeshBuildInput> { emptyInput.ToBuildInput(), input.ToBuildInput() }));
+            input.Dispose();
+            emptyInput.Dispose();
+
+            Assert.IsTrue(builder.Tiles.ContainsKey(coord));
+            Assert.AreEqual(1, builder.TileErrors.Count);
+            Assert.AreEqual(-1000, builder.TileErrors[emptyCoord]);
+            builder.Dispose();
+        }
+
+        [Test]
+        public void BuildTilesWithArena()
+        {
+            AssertSameTiles(false, (builder, variant) => builder.UseBuildArena = variant);
+        }
+
+        [Test]
+        public void BuildSingleTileParallelRasterization()
+        {
+            AssertSameTiles(true, (builder, variant) => builder.ParallelRasterization = variant);
+        }
+
+        [Test]
+        public void BuildSingleTileParallelRegions()
+        {
+            AssertSameTiles(true, (builder, variant) => builder.ParallelRegions = variant);
+        }
+
+        [Test]
+        public void BuildTilesWithSimdLevels()
+        {
+            int support = Navigation.NavMesh.GetSimdSupport();
+            try
+            {
+                AssertSameTiles(false, (builder, variant) =>
+                {
+                    int level = variant ? support : 0;
+                    Assert.AreEqual(level, Navigation.NavMesh.SetSimdLevel(level));
+                });
+            }
+            finally
+            {
+                Navigation.NavMesh.SetSimdLevel(support);
+            }
+        }
+
+        [Test]
+        public void BuildTilesWithPartitionTypes()
+        {
+            NavAgentSettings agentSettings = NavAgentSettings.Default();
+            NavMeshTestData data = NavMeshTestData.Load();
+            data.GetInputData(out float3[] vertices, out int[] indices);
+
+            NavMeshInputBuilder input = new NavMeshInputBuilder(default);
+            input.Append(vertices, indices, DtArea.WALKABLE);
+
+            int tileCount = -1;
+            foreach (DtPartitionType partitionType in new[] { DtPartitionType.Watershed, DtPartitionType.Monotone, DtPartitionType.Layers })
+            {
+                NavMeshBuildSettings buildSettings = NavMeshBuildSettings.Default();
+                buildSettings.PartitionType = partitionType;
+                NavMeshBuilder builder = new NavMeshBuilder(buildSettings, agentSettings);
+                Assert.IsTrue(builder.BuildAllFromSingleInput(input.ToBuildInput()), partitionType.ToString());
+
+                Assert.Greater(builder.Tiles.Count, 0, partitionType.ToString());
+                if (tileCount >= 0)
+                {
+                    Assert.AreEqual(tileCount, builder.Tiles.Count, partitionType.ToString());
+                }
+                tileCount = builder.Tiles.Count;
+                builder.Dispose();
+            }
+            input.Dispose();
+        }
+
+        [Test]
+        public void LoadTilePack()
+        {
+            NavMeshTestData data = NavMeshTestData.Load();
+            string path = System.IO.Path.GetTempFileName();
+            Assert.IsTrue(AiNavTilePack.Write(path, data.Tiles));
+
+            AiNavTilePack pack = new AiNavTilePack(path);
+            Assert.AreEqual(data.Tiles.Count, pack.TileCount);
+
+            NavMeshBuildSettings buildSettings = NavMeshBuildSettings.Default();
+            AiNavMesh navmesh = new AiNavMesh(buildSettings.TileSize, buildSettings.CellSize);
+            Assert.AreEqual(data.Tiles.Count, navmesh.AddOrReplaceTiles(pack));
+
+            // Tiles keep the mapping alive after the pack is disposed
+            pack.Dispose();
+
+            AiNavQuery query = new AiNavQuery(navmesh, 1024);
+            NavQuerySettings querySettings = NavQuerySettings.Default;
+            Assert.IsTrue(query.HasPath(querySettings, new float3(1f, 0f, 1f), new float3(250f, 0f, 250f)));
+
+            query.Dispose();
+            navmesh.Dispose();
+            System.IO.File.Delete(path);
+        }
+
+        [Test]
+        public void RejectUnsortedTilePack()
+        {
+            NavMeshTestData data = NavMeshTestData.Load();
+            string path = System.IO.Path.GetTempFileName();
+            Assert.IsTrue(AiNavTilePack.Write(path, data.Tiles));
+
+            // Swap the first two index entries, lookups binary search the index so the pack has to be rejected
+            const int headerSize = 16;
+            const int entrySize = 24;
+            byte[] bytes = System.IO.File.ReadAllBytes(path);
+            byte[] first = new byte[entrySize];
+            System.Array.Copy(bytes, headerSize, first, 0, entrySize);
+            System.Array.Copy(bytes, headerSize + entrySize, bytes, headerSize, entrySize);
+            System.Array.Copy(first, 0, bytes, headerSize + entrySize, entrySize);
+            System.IO.File.WriteAllBytes(path, bytes);
+
+            Assert.Throws<System.ApplicationException>(() => new AiNavTilePack(path));
+            System.IO.File.Delete(path);
+        }
+
+        [Test]
+        public void ConcurrentReads()
+        {
+            NavMeshTestData data = NavMeshTestData.Load();
+            NavMeshBuildSettings buildSettings = NavMeshBuildSettings.Default();
+            AiNavMesh navmesh = new AiNavMesh(buildSettings.TileSize, buildSettings.CellSize);
+            Assert.IsTrue(navmesh.EnableConcurrentReads(true));
+            navmesh.AddOrReplaceTiles(data.Tiles);
+
+            AiNavQuery query = new AiNavQuery(navmesh, 1024);
+            NavQuerySettings querySettings = NavQuerySettings.Default;
+            float3 start = new float3(1f, 0f, 1f);
+            float3 end = new float3(250f, 0f, 250f);
+            Assert.IsTrue(query.HasPath(querySettings, start, end));
+
+            // Replacing tiles publishes the other snapshot, the query follows it
+            navmesh.AddOrReplaceTiles(data.Tiles);
+            Assert.IsTrue(query.HasPath(querySettings, start, end));
+
+            // Enabling again needs an empty navmesh
+            Assert.IsTrue(navmesh.EnableConcurrentReads(false));
+            Assert.IsTrue(query.HasPath(querySettings, start, end));
+            Assert.IsFalse(navmesh.EnableConcurrentReads(true));
+
+            query.Dispose();
+            navmesh.Dispose();
+        }
+
+        [Test]
+        public void TileResidency()
+        {
+            NavMeshTestData data = NavMeshTestData.Load();
+            string path = System.IO.Path.GetTempFileName();
+            Assert.IsTrue(AiNavTilePack.Write(path, data.Tiles));
+            AiNavTilePack pack = new AiNavTilePack(path);
+
+            NavMeshBuildSettings buildSettings = NavMeshBuildSettings.Default();
+            AiNavMesh navmesh = new AiNavMesh(buildSettings.TileSize, buildSettings.CellSize);
+            AiNavResidency residency = new AiNavResidency(navmesh, pack);
+
+            float3 focusPosition = new float3(1f, 0f, 1f);
+            residency.SetFocus(new List<DtResidencyFocus> { new DtResidencyFocus { Position = focusPosition, Radius = 10f } });
+
+            // Tiles are read asynchronously, give the worker a moment
+            for (int i = 0; i < 100 && residency.ResidentCount == 0; i++)
+            {
+                residency.Update(0f, 0);
+                System.Threading.Thread.Sleep(10);
+            }
+            Assert.IsTrue(residency.ResidentCount > 0);
+
+            AiNavQuery query = new AiNavQuery(navmesh, 1024);
+            Assert.IsTrue(query.SamplePosition(focusPosition, new float3(4f, 4f, 4f), out float3 onMesh));
+            query.Dispose();
+
+            // Without a focus everything is evicted
+            residency.SetFocus(new List<DtResidencyFocus>());
+            residency.Update(0f, 0);
+            Assert.AreEqual(0, residency.ResidentCount);
+
+            residency.Dispose();
+            pack.Dispose();
+            navmesh.Dispose();
+            System.IO.File.Delete(path);
         }
 
         [Test]
@@ -107,6 +313,204 @@ namespace AiNav.Test
             query.Dispose();
         }
 
+        [Test]
+        public unsafe void FindPathCorridor()
+        {
+            AiNavMesh navmesh = LoadMesh();
+            AiNavQuery query = new AiNavQuery(navmesh, 1024);
+            NavQuerySettings querySettings = NavQuerySettings.Default;
+            AiNativeArray<float3> expected = new AiNativeArray<float3>(querySettings.MaxPathPoints);
+            AiNativeArray<float3> path = new AiNativeArray<float3>(querySettings.MaxPathPoints);
+            AiNativeArray<uint> corridor = new AiNativeArray<uint>(querySettings.MaxPathPoints);
+            AiNativeArray<uint> pathPolys = new AiNativeArray<uint>(querySettings.MaxPathPoints);
+            AiNativeArray<byte> pathFlags = new AiNativeArray<byte>(querySettings.MaxPathPoints);
+            float3 start = new float3(1f, 0f, 1f);
+            float3 end = new float3(250f, 0f, 250f);
+
+            Assert.IsTrue(query.TryFindPath(querySettings, start, end, (float3*)expected.GetUnsafePtr(), out int expectedLength));
+            bool found = query.TryFindPath(querySettings, start, end, (float3*)path.GetUnsafePtr(), out int pathLength,
+                (uint*)corridor.GetUnsafePtr(), out int corridorLength, (byte*)pathFlags.GetUnsafePtr(), (uint*)pathPolys.GetUnsafePtr());
+            Assert.IsTrue(found);
+            Assert.AreEqual(expectedLength, pathLength);
+            for (int i = 0; i < pathLength; i++)
+            {
+                Assert.AreEqual(expected[i], path[i]);
+            }
+
+            // Corridor runs from the start polygon to the end polygon, flags mark the first and last point
+            Assert.Greater(corridorLength, 0);
+            Assert.AreEqual(corridor[0], pathPolys[0]);
+            Assert.AreNotEqual(0, pathFlags[0] & 1);
+            Assert.AreNotEqual(0, pathFlags[pathLength - 1] & 2);
+
+            navmesh.Dispose();
+            expected.Dispose();
+            path.Dispose();
+            corridor.Dispose();
+            pathPolys.Dispose();
+            pathFlags.Dispose();
+            query.Dispose();
+        }
+
+        [Test]
+        public unsafe void ClusterGraphFindPath()
+        {
+            AiNavMesh navmesh = LoadMesh();
+            AiNavQuery query = new AiNavQuery(navmesh, 1024);
+            NavQuerySettings querySettings = NavQuerySettings.Default;
+            AiNativeArray<float3> path = new AiNativeArray<float3>(querySettings.MaxPathPoints);
+            AiNativeArray<float3> expected = new AiNativeArray<float3>(querySettings.MaxPathPoints);
+            float3 start = new float3(1f, 0f, 1f);
+            float3 end = new float3(250f, 0f, 250f);
+
+            bool expectedFound = query.TryFindPath(querySettings, start, end, (float3*)expected.GetUnsafePtr(), out int expectedLength);
+
+            Assert.IsTrue(navmesh.EnableClusterGraph(true));
+            Assert.IsTrue(query.HasPath(querySettings, start, end));
+            bool found = query.TryFindPath(querySettings, start, end, (float3*)path.GetUnsafePtr(), out int pathLength);
+            Assert.IsTrue(found);
+            Assert.AreEqual(expectedFound, found);
+            Assert.AreEqual(expected[expectedLength - 1], path[pathLength - 1]);
+
+            path.Dispose();
+            expected.Dispose();
+            query.Dispose();
+            navmesh.Dispose();
+        }
+
+        [Test]
+        public void NavigationIslands()
+        {
+            AiNavMesh navmesh = LoadMesh();
+            AiNavQuery query = new AiNavQuery(navmesh, 1024);
+            NavQuerySettings querySettings = NavQuerySettings.Default;
+            float3 start = new float3(1f, 0f, 1f);
+            float3 end = new float3(250f, 0f, 250f);
+
+            int startIsland = query.GetIsland(start, querySettings.FindNearestPolyExtent);
+            Assert.AreNotEqual(0, startIsland);
+            Assert.AreEqual(startIsland, query.GetIsland(end, querySettings.FindNearestPolyExtent));
+            Assert.IsTrue(query.HasPath(querySettings, start, end));
+
+            query.Dispose();
+            navmesh.Dispose();
+        }
+
+        [Test]
+        public void NavigationIslandsIncremental()
+        {
+            NavMeshTestData data = NavMeshTestData.Load();
+            NavMeshBuildSettings buildSettings = NavMeshBuildSettings.Default();
+            AiNavMesh rebuilt = new AiNavMesh(buildSettings.TileSize, buildSettings.CellSize);
+            rebuilt.AddOrReplaceTiles(data.Tiles);
+
+            // Remove every other tile and add them back, islands are split and merged around each changed tile only
+            AiNavMesh streamed = new AiNavMesh(buildSettings.TileSize, buildSettings.CellSize);
+            streamed.AddOrReplaceTiles(data.Tiles);
+            int tilesPerSide = (int)math.ceil(256f / buildSettings.TileCellSize);
+            for (int y = 0; y < tilesPerSide; y++)
+            {
+                for (int x = 0; x < tilesPerSide; x++)
+                {
+                    if ((x + y) % 2 == 0)
+                    {
+                        streamed.RemoveTile(new int2(x, y));
+                    }
+                }
+            }
+            streamed.AddOrReplaceTiles(data.Tiles);
+
+            // Ids may differ, the grouping of the sample points has to match
+            AiNavQuery rebuiltQuery = new AiNavQuery(rebuilt, 1024);
+            AiNavQuery streamedQuery = new AiNavQuery(streamed, 1024);
+            NavQuerySettings querySettings = NavQuerySettings.Default;
+            List<int> rebuiltIslands = new List<int>();
+            List<int> streamedIslands = new List<int>();
+            for (float z = 1f; z < 256f; z += 16f)
+            {
+                for (float x = 1f; x < 256f; x += 16f)
+                {
+                    float3 point = new float3(x, 0f, z);
+                    rebuiltIslands.Add(rebuiltQuery.GetIsland(point, querySettings.FindNearestPolyExtent));
+                    streamedIslands.Add(streamedQuery.GetIsland(point, querySettings.FindNearestPolyExtent));
+                }
+            }
+
+            for (int i = 0; i < rebuiltIslands.Count; i++)
+            {
+                Assert.AreEqual(rebuiltIslands[i] == 0, streamedIslands[i] == 0);
+                for (int j = i + 1; j < rebuiltIslands.Count; j++)
+                {
+                    Assert.AreEqual(rebuiltIslands[i] == rebuiltIslands[j], streamedIslands[i] == streamedIslands[j]);
+                }
+            }
+
+            rebuiltQuery.Dispose();
+            streamedQuery.Dispose();
+            rebuilt.Dispose();
+            streamed.Dispose();
+        }
+
+        [Test]
+        public unsafe void PathCacheHit()
+        {
+            AiNavMesh navmesh = LoadMesh();
+            AiNavQuery query = new AiNavQuery(navmesh, 1024);
+            NavQuerySettings querySettings = NavQuerySettings.Default;
+            AiNativeArray<float3> path = new AiNativeArray<float3>(querySettings.MaxPathPoints);
+            AiNativeArray<float3> cachedPath = new AiNativeArray<float3>(querySettings.MaxPathPoints);
+            float3 start = new float3(1f, 0f, 1f);
+            float3 end = new float3(250f, 0f, 250f);
+
+            Assert.IsTrue(query.EnablePathCache(16));
+            Assert.IsTrue(query.TryFindPath(querySettings, start, end, (float3*)path.GetUnsafePtr(), out int pathLength));
+            Assert.IsTrue(query.TryFindPath(querySettings, start, end, (float3*)cachedPath.GetUnsafePtr(), out int cachedLength));
+            query.GetPathCacheStats(out int hits, out int misses);
+            Assert.AreEqual(1, hits);
+            Assert.AreEqual(1, misses);
+            Assert.AreEqual(pathLength, cachedLength);
+            Assert.AreEqual(path[pathLength - 1], cachedPath[cachedLength - 1]);
+
+            path.Dispose();
+            cachedPath.Dispose();
+            query.Dispose();
+            navmesh.Dispose();
+        }
+
+        [Test]
+        public unsafe void QueryFilter()
+        {
+            AiNavMesh navmesh = LoadMesh();
+            AiNavQuery query = new AiNavQuery(navmesh, 1024);
+            AiCrowd crowd = new AiCrowd(navmesh.DtNavMesh);
+            AiNavFilter filter = new AiNavFilter();
+            NavQuerySettings querySettings = NavQuerySettings.Default;
+            float3 start = new float3(1f, 0f, 1f);
+            float3 end = new float3(250f, 0f, 250f);
+
+            // Built polygons carry flag 1
+            Assert.IsTrue(filter.SetAreaCost(63, 2f));
+            Assert.IsFalse(filter.SetAreaCost(AiNavFilter.MaxAreas, 2f));
+            Assert.AreEqual(2f, filter.GetAreaCost(63));
+            querySettings.Filter = filter.DtFilter;
+            Assert.IsTrue(query.HasPath(querySettings, start, end));
+            filter.SetExcludeFlags(1);
+            Assert.IsFalse(query.HasPath(querySettings, start, end));
+            Assert.IsTrue(query.HasPath(NavQuerySettings.Default, start, end));
+
+            Assert.IsTrue(crowd.SetFilter(1, filter));
+            Assert.IsFalse(crowd.SetFilter(16, filter));
+            DtAgentParams agentParams = DtAgentParams.Default;
+            agentParams.QueryFilterType = 1;
+            int idx = crowd.AddAgent(start, agentParams);
+            Assert.AreEqual(1, crowd.GetAgentParams(idx).QueryFilterType);
+
+            filter.Dispose();
+            crowd.Dispose();
+            query.Dispose();
+            navmesh.Dispose();
+        }
+
         [Test]
         public void CreateCrowd()
         {
@@ -119,6 +523,27 @@ namespace AiNav.Test
             navmesh.Dispose();
         }
 
+        [Test]
+        public unsafe void CrowdMoveFlowField()
+        {
+            AiNavMesh navmesh = LoadMesh();
+            AiCrowd crowd = new AiCrowd(navmesh.DtNavMesh);
+            AiFlowField field = new AiFlowField(navmesh, 65535);
+            NavQuerySettings querySettings = NavQuerySettings.Default;
+
+            int* indices = stackalloc int[2];
+            indices[0] = crowd.AddAgent(new float3(1f, 0f, 1f), DtAgentParams.Default);
+            indices[1] = crowd.AddAgent(new float3(3f, 0f, 1f), DtAgentParams.Default);
+            crowd.Update(0.1f);
+
+            Assert.IsTrue(field.Build(new float3(250f, 0f, 250f), querySettings.FindNearestPolyExtent));
+            Assert.AreEqual(2, crowd.RequestMoveField(field, indices, 2));
+
+            field.Dispose();
+            crowd.Dispose();
+            navmesh.Dispose();
+        }
+
         [Test]
         public void SetGetAgentParams()
         {
@@ -189,6 +614,163 @@ namespace AiNav.Test
             navmesh.Dispose();
         }
 
+        [Test]
+        public void ThreadedCrowdMatchesSerial()
+        {
+            int agentCount = 100;
+            AiNavMesh navmesh = LoadMesh();
+            AiNavQuery query = new AiNavQuery(navmesh, 1024);
+
+            AiCrowd serial = new AiCrowd(navmesh.DtNavMesh, agentCount);
+            AiCrowd threaded = new AiCrowd(navmesh.DtNavMesh, agentCount);
+            Assert.IsTrue(threaded.SetThreadCount(4));
+
+            DtAgentParams agentParams = DtAgentParams.Default;
+            for (int i = 0; i < agentCount; i++)
+            {
+                float3 position = default;
+                float3 target = default;
+                query.GetRandomPosition(ref position);
+                query.GetRandomPosition(ref target);
+
+                int idx = serial.AddAgent(position, agentParams);
+                Assert.AreEqual(idx, threaded.AddAgent(position, agentParams));
+                serial.RequestMoveAgent(idx, target);
+                threaded.RequestMoveAgent(idx, target);
+            }
+
+            for (int i = 0; i < 20; i++)
+            {
+                serial.Update(0.1f);
+                threaded.Update(0.1f);
+            }
+
+            for (int i = 0; i < agentCount; i++)
+            {
+                DtCrowdAgent a = serial.GetAgent(i);
+                DtCrowdAgent b = threaded.GetAgent(i);
+                Assert.AreEqual(a.Position, b.Position);
+                Assert.AreEqual(a.Velocity, b.Velocity);
+            }
+
+            serial.Dispose();
+            threaded.Dispose();
+            query.Dispose();
+            navmesh.Dispose();
+        }
+
+        [Test]
+        public unsafe void RequestMoveBatch()
+        {
+            int agentCount = 32;
+            AiNavMesh navmesh = LoadMesh();
+            AiNavQuery query = new AiNavQuery(navmesh, 1024);
+            AiCrowd single = new AiCrowd(navmesh.DtNavMesh, agentCount);
+            AiCrowd batched = new AiCrowd(navmesh.DtNavMesh, agentCount);
+
+            AiNativeArray<int> indices = new AiNativeArray<int>(agentCount);
+            AiNativeArray<float3> targets = new AiNativeArray<float3>(agentCount);
+            AiNativeArray<int> status = new AiNativeArray<int>(agentCount);
+
+            DtAgentParams agentParams = DtAgentParams.Default;
+            float3 shared = default;
+            query.GetRandomPosition(ref shared);
+            for (int i = 0; i < agentCount; i++)
+            {
+                float3 position = default;
+                float3 target = shared;
+                query.GetRandomPosition(ref position);
+                if (i % 2 == 0)
+                {
+                    query.GetRandomPosition(ref target);
+                }
+
+                indices[i] = single.AddAgent(position, agentParams);
+                Assert.AreEqual(indices[i], batched.AddAgent(position, agentParams));
+                targets[i] = target;
+                Assert.IsTrue(single.RequestMoveAgent(indices[i], target));
+            }
+
+            int* indicesPtr = (int*)indices.GetUnsafePtr();
+            float3* targetsPtr = (float3*)targets.GetUnsafePtr();
+            int* statusPtr = (int*)status.GetUnsafePtr();
+            Assert.AreEqual(agentCount, batched.RequestMoveBatch(indicesPtr, targetsPtr, agentCount, statusPtr));
+
+            // Unchanged targets are skipped, so repeating the batch every tick leaves the agents untouched
+            for (int i = 0; i < 20; i++)
+            {
+                single.Update(0.1f);
+                batched.Update(0.1f);
+                Assert.AreEqual(agentCount, batched.RequestMoveBatch(indicesPtr, targetsPtr, agentCount, statusPtr));
+            }
+
+            for (int i = 0; i < agentCount; i++)
+            {
+                Assert.AreEqual(1, status[i]);
+                Assert.AreEqual(single.GetAgent(indices[i]).Position, batched.GetAgent(indices[i]).Position);
+            }
+
+            indices.Dispose();
+            targets.Dispose();
+            status.Dispose();
+            single.Dispose();
+            batched.Dispose();
+            query.Dispose();
+            navmesh.Dispose();
+        }
+
+        [Test]
+        public unsafe void PathServiceMatchesQuery()
+        {
+            int requestCount = 64;
+            AiNavMesh navmesh = LoadMesh();
+            AiNavQuery query = new AiNavQuery(navmesh, 2048);
+            AiNavPathService service = new AiNavPathService(navmesh, 2);
+            NavQuerySettings settings = NavQuerySettings.Default;
+
+            float3[] starts = new float3[requestCount];
+            float3[] ends = new float3[requestCount];
+            uint[] handles = new uint[requestCount];
+            for (int i = 0; i < requestCount; i++)
+            {
+                query.GetRandomPosition(ref starts[i]);
+                query.GetRandomPosition(ref ends[i]);
+                handles[i] = service.Request(settings, starts[i], ends[i]);
+                Assert.AreNotEqual(0u, handles[i]);
+            }
+
+            AiNativeArray<float3> path = new AiNativeArray<float3>(settings.MaxPathPoints);
+            AiNativeArray<float3> expected = new AiNativeArray<float3>(settings.MaxPathPoints);
+            float3* pathPtr = (float3*)path.GetUnsafePtr();
+            for (int i = 0; i < requestCount; i++)
+            {
+                DtPathRequestStatus status;
+                int pathLength;
+                while ((status = service.Poll(handles[i], pathPtr, out pathLength)) == DtPathRequestStatus.Pending)
+                {
+                    System.Threading.Thread.Yield();
+                }
+
+                bool found = query.TryFindPath(settings, starts[i], ends[i], (float3*)expected.GetUnsafePtr(), out int expectedLength);
+                Assert.AreEqual(found, status == DtPathRequestStatus.Succeeded);
+                if (found)
+                {
+                    Assert.IsTrue(pathLength >= 2);
+                    Assert.AreEqual(expected[expectedLength - 1], path[pathLength - 1]);
+                }
+
+                // The handle is released by the poll that returned the result
+                Assert.AreEqual(DtPathRequestStatus.Invalid, service.Poll(handles[i], pathPtr, out pathLength));
+            }
+            Assert.AreEqual(0, service.PendingCount);
+
+            path.Dispose();
+            expected.Dispose();
+            service.Dispose();
+            query.Dispose();
+            navmesh.Dispose();
+        }
+
         [Test]
         public void MoveAgent()
         {
@@ -251,6 +833,60 @@ namespace AiNav.Test
             navmesh.Dispose();
         }
 
+        [Test]
+        public unsafe void GetAgentStates()
+        {
+            AiNavMesh navmesh = LoadMesh();
+            AiNavQuery query = new AiNavQuery(navmesh, 1024);
+            AiCrowd crowd = new AiCrowd(navmesh.DtNavMesh);
+
+            DtAgentParams agentParams = DtAgentParams.Default;
+            for (int i = 0; i < 4; i++)
+            {
+                float3 target = default;
+                query.GetRandomPosition(ref target);
+                int idx = crowd.AddAgent(new float3(2f + i, 0f, 2f), agentParams);
+                crowd.RequestMoveAgent(idx, target);
+            }
+            crowd.RemoveAgent(1);
+            crowd.Update(0.5f);
+
+            AiNativeArray<int> indices = new AiNativeArray<int>(16);
+            AiNativeArray<float3> positions = new AiNativeArray<float3>(16);
+            AiNativeArray<float3> velocities = new AiNativeArray<float3>(16);
+            AiNativeArray<int> corridorLengths = new AiNativeArray<int>(16);
+
+            DtCrowdAgentStates states = new DtCrowdAgentStates
+            {
+                Capacity = 16,
+                Indices = (int*)indices.GetUnsafePtr(),
+                Positions = (float3*)positions.GetUnsafePtr(),
+                Velocities = (float3*)velocities.GetUnsafePtr(),
+                CorridorLengths = (int*)corridorLengths.GetUnsafePtr()
+            };
+            int count = crowd.GetAgentStates(&states);
+            Assert.AreEqual(3, count);
+            Assert.AreEqual(3, states.Count);
+
+            int[] expected = { 0, 2, 3 };
+            for (int i = 0; i < count; i++)
+            {
+                Assert.AreEqual(expected[i], indices[i]);
+                DtCrowdAgent agent = crowd.GetAgent(indices[i]);
+                Assert.AreEqual(agent.Position, positions[i]);
+                Assert.AreEqual(agent.Velocity, velocities[i]);
+                Assert.IsTrue(corridorLengths[i] > 0);
+            }
+
+            indices.Dispose();
+            positions.Dispose();
+            velocities.Dispose();
+            corridorLengths.Dispose();
+            crowd.Dispose();
+            query.Dispose();
+            navmesh.Dispose();
+        }
+
         [Test]
         public void SamplePositionTest()
         {
@@ -273,6 +909,114 @@ namespace AiNav.Test
             navmesh.Dispose();
         }
 
+        [Test]
+        public unsafe void SamplePositionBatch()
+        {
+            AiNavMesh navmesh = LoadMesh();
+            AiNavQuery query = new AiNavQuery(navmesh, 1024);
+
+            float3* points = stackalloc float3[3];
+            float3* extents = stackalloc float3[3];
+            float3* results = stackalloc float3[3];
+            uint* refs = stackalloc uint[3];
+            points[0] = new float3(2f, 0f, 2f);
+            points[1] = new float3(100f, 1f, 120f);
+            points[2] = new float3(3000f, 1000f, 3000f);
+            for (int i = 0; i < 3; i++)
+                extents[i] = new float3(4f, 4f, 4f);
+
+            Assert.AreEqual(2, query.SamplePositionBatch(points, extents, 3, results, refs));
+            for (int i = 0; i < 2; i++)
+            {
+                Assert.IsTrue(query.SamplePosition(points[i], extents[i], out float3 expected));
+                Assert.AreEqual(expected, results[i]);
+            }
+            Assert.AreEqual(0u, refs[2]);
+
+            query.Dispose();
+            navmesh.Dispose();
+        }
+
+        [Test]
+        public unsafe void RaycastBatch()
+        {
+            AiNavMesh navmesh = LoadMesh();
+            AiNavQuery query = new AiNavQuery(navmesh, 1024);
+            const int count = 4;
+            const int maxVisited = 32;
+
+            float3* starts = stackalloc float3[count];
+            float3* ends = stackalloc float3[count];
+            DtRaycastBatchResult* results = stackalloc DtRaycastBatchResult[count];
+            DtRaycastBatchResult* hitOnly = stackalloc DtRaycastBatchResult[count];
+            uint* startRefs = stackalloc uint[count];
+            uint* visited = stackalloc uint[count * maxVisited];
+            float3 extent = new float3(4f, 4f, 4f);
+            for (int i = 0; i < 3; i++)
+            {
+                starts[i] = new float3(2f, 0f, 2f);
+                ends[i] = new float3(2f + 10f * i, 0f, 12f);
+            }
+            starts[3] = new float3(3000f, 1000f, 3000f);
+            ends[3] = new float3(3010f, 1000f, 3000f);
+
+            Assert.AreEqual(3, query.RaycastBatch(starts, ends, count, extent, results, null, visited, maxVisited));
+            Assert.AreEqual(-1f, results[3].T);
+            for (int i = 0; i < 3; i++)
+            {
+                Assert.AreNotEqual(0u, results[i].StartRef);
+                Assert.Greater(results[i].VisitedCount, 0);
+                Assert.AreEqual(results[i].StartRef, visited[i * maxVisited]);
+                startRefs[i] = results[i].StartRef;
+            }
+            startRefs[3] = 0;
+
+            // Known start refs and no visited list give the same hits
+            Assert.AreEqual(3, query.RaycastBatch(starts, ends, count, extent, hitOnly, startRefs));
+            for (int i = 0; i < count; i++)
+            {
+                Assert.AreEqual(results[i].T, hitOnly[i].T);
+                Assert.AreEqual(results[i].Normal, hitOnly[i].Normal);
+                Assert.AreEqual(0, hitOnly[i].VisitedCount);
+            }
+
+            query.Dispose();
+            navmesh.Dispose();
+        }
+
+        [Test]
+        public unsafe void RaycastBatchNonFinite()
+        {
+            AiNavMesh navmesh = LoadMesh();
+            AiNavQuery query = new AiNavQuery(navmesh, 1024);
+            const int count = 4;
+
+            float3* starts = stackalloc float3[count];
+            float3* ends = stackalloc float3[count];
+            DtRaycastBatchResult* results = stackalloc DtRaycastBatchResult[count];
+            float3 extent = new float3(4f, 4f, 4f);
+            for (int i = 0; i < count; i++)
+            {
+                starts[i] = new float3(2f, 0f, 2f);
+                ends[i] = new float3(2f + 10f * i, 0f, 12f);
+            }
+            starts[1] = new float3(float.NaN, 0f, 2f);
+            ends[3] = new float3(float.PositiveInfinity, 0f, 12f);
+
+            // Rays that can't start are skipped, the finite ones sharing their batch still resolve
+            Assert.AreEqual(2, query.RaycastBatch(starts, ends, count, extent, results));
+            Assert.AreNotEqual(0u, results[0].StartRef);
+            Assert.AreEqual(results[0].StartRef, results[2].StartRef);
+            for (int i = 1; i < count; i += 2)
+            {
+                Assert.AreEqual(-1f, results[i].T);
+                Assert.AreEqual(0u, results[i].StartRef);
+            }
+
+            query.Dispose();
+            navmesh.Dispose();
+        }
+
         [Test]
         public void GetLocation()
         {
@@ -300,6 +1044,40 @@ namespace AiNav.Test
             navmesh.Dispose();
         }
 
+        // Builds the test data twice and checks both builds produce byte identical tiles. prepare runs right before
+        // each build, with false for the reference build and true for the configuration under test.
+        // A single tile build covers tile (0, 0) only.
+        private void AssertSameTiles(bool singleTile, System.Action<NavMeshBuilder, bool> prepare)
+        {
+            NavMeshBuildSettings buildSettings = NavMeshBuildSettings.Default();
+            NavAgentSettings agentSettings = NavAgentSettings.Default();
+            NavMeshTestData data = NavMeshTestData.Load();
+            data.GetInputData(out float3[] vertices, out int[] indices);
+
+            int2 coord = new int2(0, 0);
+            NavMeshTileBounds tileBounds = singleTile ? new NavMeshTileBounds(coord, NavMeshBuildUtils.CalculateTileBoundingBox(buildSettings, coord)) : default;
+            NavMeshInputBuilder input = new NavMeshInputBuilder(tileBounds);
+            input.Append(vertices, indices, DtArea.WALKABLE);
+
+            NavMeshBuilder builder = new NavMeshBuilder(buildSettings, agentSettings);
+            NavMeshBuilder variantBuilder = new NavMeshBuilder(buildSettings, agentSettings);
+            prepare(builder, false);
+            Assert.IsTrue(singleTile ? builder.BuildSingleTile(input.ToBuildInput()) : builder.BuildAllFromSingleInput(input.ToBuildInput()));
+            prepare(variantBuilder, true);
+            Assert.IsTrue(singleTile ? variantBuilder.BuildSingleTile(input.ToBuildInput()) : variantBuilder.BuildAllFromSingleInput(input.ToBuildInput()));
+            input.Dispose();
+
+            Assert.Greater(builder.Tiles.Count, 0);
+            Assert.AreEqual(builder.Tiles.Count, variantBuilder.Tiles.Count);
+            foreach (var pair in builder.Tiles)
+            {
+                Assert.IsTrue(variantBuilder.Tiles.TryGetValue(pair.Key, out NavMeshTile variantTile));
+                CollectionAssert.AreEqual(pair.Value.Data, variantTile.Data);
+            }
+            builder.Dispose();
+            variantBuilder.Dispose();
+        }
+
         private AiNavMesh LoadMesh()
         {
             NavMeshTestData data = NavMeshTestData.Load();
@@ -76,6 +76,7 @@ namespace Game.Test
             GameLogger.Log("BuildTiles Output Vertices:{0} Triangles{1}", outVerts.Length, outIndices.Length);
             outVerts.Dispose();
             outIndices.Dispose();
+            builder.Dispose();
 
         }
 
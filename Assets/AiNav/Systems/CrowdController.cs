@@ -21,6 +21,14 @@ namespace AiNav
         private NativeArray<int> AgentCount;
         private NativeHashMap<int, NavAgentDebug> ReadOnlyAgents;
         private NativeArray<float3> Path;
+        private NativeArray<DtCrowdAgent> Agents;
+        private NativeArray<int> AgentIndices;
+        private NativeArray<float3> AgentPositions;
+        private NativeArray<float3> AgentVelocities;
+        private NativeArray<float> AgentDesiredSpeeds;
+        private NativeArray<byte> AgentPartial;
+        private NativeList<int> MoveIndices;
+        private NativeList<float3> MoveTargets;
 
         public CrowdController(AiNavMesh navMesh, SurfaceController surfaceController)
         {
@@ -29,6 +37,7 @@ namespace AiNav
 
             AiCrowd = new AiCrowd(NavMesh.DtNavMesh);
             Query = new AiNavQuery(NavMesh, 2048);
+            Query.EnablePathCache(64);
             AiCrowd.Update(Time.time);
 
             UpdateClock = new GameClock(CrowdTicksPerSecond);
@@ -36,6 +45,14 @@ namespace AiNav
             AgentCount = new NativeArray<int>(1, Allocator.Persistent);
             ReadOnlyAgents = new NativeHashMap<int, NavAgentDebug>(MaxAgents, Allocator.Persistent);
             Path = new NativeArray<float3>(1024, Allocator.Persistent);
+            Agents = new NativeArray<DtCrowdAgent>(MaxAgents, Allocator.Persistent);
+            AgentIndices = new NativeArray<int>(MaxAgents, Allocator.Persistent);
+            AgentPositions = new NativeArray<float3>(MaxAgents, Allocator.Persistent);
+            AgentVelocities = new NativeArray<float3>(MaxAgents, Allocator.Persistent);
+            AgentDesiredSpeeds = new NativeArray<float>(MaxAgents, Allocator.Persistent);
+            AgentPartial = new NativeArray<byte>(MaxAgents, Allocator.Persistent);
+            MoveIndices = new NativeList<int>(MaxAgents, Allocator.Persistent);
+            MoveTargets = new NativeList<float3>(MaxAgents, Allocator.Persistent);
         }
 
         public void OnDestroy()
@@ -43,6 +60,14 @@ namespace AiNav
             if (AgentCount.IsCreated) AgentCount.Dispose();
             if (ReadOnlyAgents.IsCreated) ReadOnlyAgents.Dispose();
             if (Path.IsCreated) Path.Dispose();
+            if (Agents.IsCreated) Agents.Dispose();
+            if (AgentIndices.IsCreated) AgentIndices.Dispose();
+            if (AgentPositions.IsCreated) AgentPositions.Dispose();
+            if (AgentVelocities.IsCreated) AgentVelocities.Dispose();
+            if (AgentDesiredSpeeds.IsCreated) AgentDesiredSpeeds.Dispose();
+            if (AgentPartial.IsCreated) AgentPartial.Dispose();
+            if (MoveIndices.IsCreated) MoveIndices.Dispose();
+            if (MoveTargets.IsCreated) MoveTargets.Dispose();
             Query.Dispose();
             AiCrowd.Dispose();
 
@@ -104,7 +129,10 @@ namespace AiNav
                     ReadOnlyAgents = ReadOnlyAgents,
                     PathLookup = system.GetBufferFromEntity<AgentPathBuffer>(false),
                     NavQuerySettings = NavQuerySettings.Default,
-                    Path = Path
+                    Path = Path,
+                    Agents = Agents,
+                    MoveIndices = MoveIndices,
+                    MoveTargets = MoveTargets
                 };
 
                 inputDeps = updateAgentJob.ScheduleSingle(system, inputDeps);
@@ -113,7 +141,15 @@ namespace AiNav
                 {
                     DeltaTime = Time.deltaTime,
                     AiCrowd = AiCrowd,
-                    AgentCount = AgentCount
+                    AgentCount = AgentCount,
+                    Agents = Agents,
+                    AgentIndices = AgentIndices,
+                    AgentPositions = AgentPositions,
+                    AgentVelocities = AgentVelocities,
+                    AgentDesiredSpeeds = AgentDesiredSpeeds,
+                    AgentPartial = AgentPartial,
+                    MoveIndices = MoveIndices,
+                    MoveTargets = MoveTargets
                 };
                 inputDeps = updateJob.Schedule(inputDeps);
             }
@@ -10,17 +10,61 @@ namespace AiNav
     public partial class CrowdController
     {
         [BurstCompile]
-        struct TickCrowdJob : IJob
+        unsafe struct TickCrowdJob : IJob
         {
             public float DeltaTime;
             public AiCrowd AiCrowd;
             [NativeDisableContainerSafetyRestriction]
             public NativeArray<int> AgentCount;
+            public NativeArray<DtCrowdAgent> Agents;
+            public NativeArray<int> AgentIndices;
+            public NativeArray<float3> AgentPositions;
+            public NativeArray<float3> AgentVelocities;
+            public NativeArray<float> AgentDesiredSpeeds;
+            public NativeArray<byte> AgentPartial;
+            public NativeList<int> MoveIndices;
+            public NativeList<float3> MoveTargets;
 
             public void Execute()
             {
+                // Move requests collected by CrowdAgentsJob go to the crowd in one call
+                AiCrowd.RequestMoveBatch((int*)MoveIndices.GetUnsafePtr(), (float3*)MoveTargets.GetUnsafePtr(), MoveIndices.Length);
+                MoveIndices.Clear();
+                MoveTargets.Clear();
+
                 AgentCount[0] = AiCrowd.GetAgentCount();
                 AiCrowd.Update(DeltaTime);
+
+                // Read every agent back with one call and scatter them by crowd index for CrowdAgentsJob
+                DtCrowdAgentStates states = new DtCrowdAgentStates
+                {
+                    Capacity = AgentIndices.Length,
+                    Indices = (int*)AgentIndices.GetUnsafePtr(),
+                    Positions = (float3*)AgentPositions.GetUnsafePtr(),
+                    Velocities = (float3*)AgentVelocities.GetUnsafePtr(),
+                    DesiredSpeeds = (float*)AgentDesiredSpeeds.GetUnsafePtr(),
+                    Partial = (byte*)AgentPartial.GetUnsafePtr()
+                };
+                int count = AiCrowd.GetAgentStates(&states);
+
+                UnsafeUtility.MemClear(Agents.GetUnsafePtr(), (long)Agents.Length * UnsafeUtility.SizeOf<DtCrowdAgent>());
+                for (int i = 0; i < count; i++)
+                {
+                    int crowdIndex = AgentIndices[i];
+                    if (crowdIndex >= Agents.Length)
+                    {
+                        continue;
+                    }
+
+                    Agents[crowdIndex] = new DtCrowdAgent
+                    {
+                        Active = 1,
+                        Partial = AgentPartial[i],
+                        DesiredSpeed = AgentDesiredSpeeds[i],
+                        Position = AgentPositions[i],
+                        Velocity = AgentVelocities[i]
+                    };
+                }
             }
         }
 
@@ -36,10 +80,17 @@ namespace AiNav
             [NativeDisableContainerSafetyRestriction]
             public NativeHashMap<int, NavAgentDebug> ReadOnlyAgents;
             public BufferFromEntity<AgentPathBuffer> PathLookup;
+            [ReadOnly]
+            public NativeArray<DtCrowdAgent> Agents;
+            public NativeList<int> MoveIndices;
+            public NativeList<float3> MoveTargets;
 
             public void Execute(Entity entity, int index, ref NavAgent agent, ref AgentPathData pathData)
             {
-                agent.DtCrowdAgent = AiCrowd.GetAgent(agent.CrowdIndex);
+                if (agent.CrowdIndex >= 0 && agent.CrowdIndex < Agents.Length)
+                {
+                    agent.DtCrowdAgent = Agents[agent.CrowdIndex];
+                }
 
                 if (UpdateActive(ref agent))
                 {
@@ -115,7 +166,8 @@ namespace AiNav
 
                 }
 
-                AiCrowd.RequestMoveAgent(agent.CrowdIndex, target);
+                MoveIndices.Add(agent.CrowdIndex);
+                MoveTargets.Add(target);
 
 
                 if (agent.UpdateParams == 1)
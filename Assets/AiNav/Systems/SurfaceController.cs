@@ -38,6 +38,11 @@ namespace AiNav
         private IntPtr RebuiltTilesPtr;
         private GCHandle RebuiltTilesHandle;
 
+        // Builds the dirty tiles, kept for the lifetime of the controller so its native worker pool is reused between rebuilds
+        private NavMeshBuilder TileBuilder;
+        private IntPtr TileBuilderPtr;
+        private GCHandle TileBuilderHandle;
+
         private System.Diagnostics.Stopwatch Watch;
         public NativeList<JobHandle> HandlesToWaitFor;
         private AiNavSystem AiNavSystem;
@@ -74,6 +79,10 @@ namespace AiNav
             RebuiltTilesHandle = GCHandle.Alloc(RebuiltTiles);
             RebuiltTilesPtr = GCHandle.ToIntPtr(RebuiltTilesHandle);
 
+            TileBuilder = new NavMeshBuilder(Config.BuildSettings, Config.AgentSettings);
+            TileBuilderHandle = GCHandle.Alloc(TileBuilder);
+            TileBuilderPtr = GCHandle.ToIntPtr(TileBuilderHandle);
+
             NavMesh = new AiNavMesh(Builder.BuildSettings.TileSize, Builder.BuildSettings.CellSize);
 
             bool loaded = NavMeshStoreSystem.Instance.LoadTiles(Config.SurfaceId, Tiles);
@@ -169,6 +178,8 @@ namespace AiNav
 
             RebuiltTilesHandle.Free();
             TilesHandle.Free();
+            TileBuilderHandle.Free();
+            TileBuilder.Dispose();
         }
 
         public JobHandle OnUpdate(JobHandle inputDeps)
@@ -301,8 +312,7 @@ namespace AiNav
 
                 BuildTileJob buildTileJob = new BuildTileJob
                 {
-                    AgentSettings = Builder.AgentSettings,
-                    BuildSettings = Builder.BuildSettings,
+                    TileBuilderPtr = TileBuilderPtr,
                     BuildInputs = BuildInputs,
                     RebuiltTilesPtr = RebuiltTilesPtr,
                     SurfaceId = Config.SurfaceId
@@ -197,8 +197,8 @@ namespace AiNav
 
         struct BuildTileJob : IJob
         {
-            public NavMeshBuildSettings BuildSettings;
-            public NavAgentSettings AgentSettings;
+            [NativeDisableUnsafePtrRestriction]
+            public IntPtr TileBuilderPtr;
             [NativeDisableUnsafePtrRestriction]
             public IntPtr RebuiltTilesPtr;
             public NativeQueue<NavMeshBuildInput> BuildInputs;
@@ -207,27 +207,30 @@ namespace AiNav
             public void Execute()
             {
                 Dictionary<int2, NavMeshTile> results = GCHandle.FromIntPtr(RebuiltTilesPtr).Target as Dictionary<int2, NavMeshTile>;
-                NavMeshBuilder navMeshBuilder = new NavMeshBuilder(BuildSettings, AgentSettings);
+                NavMeshBuilder navMeshBuilder = GCHandle.FromIntPtr(TileBuilderPtr).Target as NavMeshBuilder;
 
+                // All dirty tiles go to the native builder at once so they are built in parallel
+                List<NavMeshBuildInput> buildInputs = new List<NavMeshBuildInput>();
                 while (BuildInputs.TryDequeue(out NavMeshBuildInput buildInput))
                 {
-                    bool valid = navMeshBuilder.BuildSingleTile(buildInput);
-                    if (valid && navMeshBuilder.BuildResult.IsValidBuild)
-                    {
-                        if (navMeshBuilder.Tiles.TryGetValue(buildInput.TileBounds.Coord, out NavMeshTile tile))
-                        {
-                            results[tile.Coord] = tile;
-                        }
-                        else
-                        {
-                            //UnityEngine.Debug.LogFormat("BuildResult no tile id:{0} bound:{1} vertices:{2} indices:{3}",
-                            //    buildInput.TileBounds.Coord, buildInput.TileBounds.Bounds, buildInput.VerticesLength, buildInput.IndicesLength);
-                        }
-                    }
-                    else
-                    {
-                        UnityEngine.Debug.LogFormat("BuildResult: {0}", navMeshBuilder.BuildResult);
-                    }
+                    buildInputs.Add(buildInput);
+                }
+
+                if (buildInputs.Count == 0)
+                {
+                    return;
+                }
+
+                // A failed tile keeps its previous navmesh, the tiles that did build are still committed
+                navMeshBuilder.BuildInputPerTile(buildInputs);
+                foreach (NavMeshTile tile in navMeshBuilder.Tiles.Values)
+                {
+                    results[tile.Coord] = tile;
+                }
+
+                foreach (KeyValuePair<int2, int> tileError in navMeshBuilder.TileErrors)
+                {
+                    UnityEngine.Debug.LogFormat("BuildResult tile:{0} error:{1}", tileError.Key, tileError.Value);
                 }
             }
         }
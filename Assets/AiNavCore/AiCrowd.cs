@@ -68,6 +68,32 @@ namespace AiNav
             Navigation.Crowd.SetAgentParams(DtCrowd, idx, ref agentParams);
         }
 
+        /// <summary>
+        /// Requests moves for count agents with a single call. Agents already moving to the same target are skipped,
+        /// so this is cheap to call every tick with unchanged destinations.
+        /// </summary>
+        /// <param name="status">Optional, receives 1 for every agent moving to its target</param>
+        /// <returns>The number of agents moving to their target</returns>
+        public int RequestMoveBatch(int* indices, float3* targets, int count, int* status = null)
+        {
+            return Navigation.Crowd.RequestMoveBatch(DtCrowd, indices, targets, count, status);
+        }
+
+        /// <summary>
+        /// Gives every agent inside the field a corridor to its goal straight from the field, no path requests are queued
+        /// </summary>
+        /// <param name="status">Optional, receives 1 for every agent moving to the goal</param>
+        /// <returns>The number of agents moving to the goal</returns>
+        public int RequestMoveField(AiFlowField field, int* indices, int count, int* status = null)
+        {
+            return Navigation.Crowd.RequestMoveField(DtCrowd, field.DtFlowField, indices, count, status);
+        }
+
+        public void SetAgentParamsBatch(int* indices, DtAgentParams* agentParams, int count)
+        {
+            Navigation.Crowd.SetAgentParamsBatch(DtCrowd, indices, agentParams, count);
+        }
+
         public unsafe DtAgentParams GetAgentParams(int idx)
         {
             DtAgentParams result = default; ;
@@ -94,6 +120,32 @@ namespace AiNav
             Navigation.Crowd.Update(DtCrowd, dt);
         }
 
+        /// <summary>
+        /// Spreads Update over threadCount native threads, the calling thread included. Results don't depend on the thread count.
+        /// </summary>
+        public bool SetThreadCount(int threadCount)
+        {
+            return Navigation.Crowd.SetThreadCount(DtCrowd, threadCount) == 1;
+        }
+
+        /// <summary>
+        /// Copies the filter into slot filterType, agents use the slot matching their QueryFilterType. Changes to the filter
+        /// need another call, null restores the default filter.
+        /// </summary>
+        public bool SetFilter(int filterType, AiNavFilter filter)
+        {
+            return Navigation.Crowd.SetFilter(DtCrowd, filterType, filter != null ? filter.DtFilter : IntPtr.Zero) == 1;
+        }
+
+        /// <summary>
+        /// Reads back all active agents with a single call, entries are in ascending agent index order
+        /// </summary>
+        /// <returns>The number of agents written</returns>
+        public int GetAgentStates(DtCrowdAgentStates* states)
+        {
+            return Navigation.Crowd.GetAgentStates(DtCrowd, states);
+        }
+
         public int GetAgents(List<DtCrowdAgent> agents, int max)
         {
             DtCrowdAgentsResult result = default;
@@ -0,0 +1,43 @@
+﻿using System;
+using Unity.Mathematics;
+
+namespace AiNav
+{
+    /// <summary>
+    /// Shortest path tree towards one goal, shared by all agents converging on it instead of one search per agent.
+    /// Built on the main thread, tiles added after Build are not covered until it is built again.
+    /// </summary>
+    public class AiFlowField : IDisposable
+    {
+        public IntPtr DtFlowField { get; private set; }
+
+        public int PolyCount { get; private set; }
+
+        /// <param name="maxNodes">Search node pool, bounds the number of polygons the field can cover</param>
+        public AiFlowField(AiNavMesh navmesh, int maxNodes = 8192)
+        {
+            DtFlowField = Navigation.FlowField.Create(navmesh.DtNavMesh, maxNodes);
+            if (DtFlowField == IntPtr.Zero)
+            {
+                throw new ApplicationException("Unable to create flow field");
+            }
+        }
+
+        public void Dispose()
+        {
+            if (DtFlowField != IntPtr.Zero)
+            {
+                Navigation.FlowField.Destroy(DtFlowField);
+                DtFlowField = IntPtr.Zero;
+            }
+        }
+
+        /// <param name="radius">Search radius around the goal, 0 covers as much of the navmesh as the node pool allows</param>
+        /// <returns>False when the goal is not on the navmesh</returns>
+        public bool Build(float3 goal, float3 extent, float radius = 0f)
+        {
+            PolyCount = Navigation.FlowField.Build(DtFlowField, ref goal, ref extent, radius);
+            return PolyCount > 0;
+        }
+    }
+}
@@ -0,0 +1,64 @@
+﻿using System;
+
+namespace AiNav
+{
+    /// <summary>
+    /// Polygon flags and per area costs used in place of the default filter. Passed by handle to queries through
+    /// <see cref="NavQuerySettings.Filter"/> or <see cref="AiNavQuery.SetFilter"/> and copied into crowd filter slots with <see cref="AiCrowd.SetFilter"/>.
+    /// Must not be changed or disposed while path service requests using it are pending.
+    /// </summary>
+    public class AiNavFilter : IDisposable
+    {
+        public const int MaxAreas = 64;
+
+        public IntPtr DtFilter { get; private set; }
+
+        public AiNavFilter()
+        {
+            DtFilter = Navigation.Filter.Create();
+            if (DtFilter == IntPtr.Zero)
+            {
+                throw new ApplicationException("Unable to create filter");
+            }
+        }
+
+        public void Dispose()
+        {
+            if (DtFilter != IntPtr.Zero)
+            {
+                Navigation.Filter.Destroy(DtFilter);
+                DtFilter = IntPtr.Zero;
+            }
+        }
+
+        /// <summary>
+        /// Polygons need at least one of these flags, all by default
+        /// </summary>
+        public void SetIncludeFlags(ushort flags)
+        {
+            Navigation.Filter.SetIncludeFlags(DtFilter, flags);
+        }
+
+        /// <summary>
+        /// Polygons with any of these flags are skipped, none by default
+        /// </summary>
+        public void SetExcludeFlags(ushort flags)
+        {
+            Navigation.Filter.SetExcludeFlags(DtFilter, flags);
+        }
+
+        /// <summary>
+        /// Multiplier of the distance travelled through polygons of the area, 1 by default
+        /// </summary>
+        /// <returns>False for areas outside 0..MaxAreas-1</returns>
+        public bool SetAreaCost(int area, float cost)
+        {
+            return Navigation.Filter.SetAreaCost(DtFilter, area, cost) == 1;
+        }
+
+        public float GetAreaCost(int area)
+        {
+            return Navigation.Filter.GetAreaCost(DtFilter, area);
+        }
+    }
+}
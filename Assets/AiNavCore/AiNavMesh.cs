@@ -77,6 +77,48 @@ namespace AiNav
             return Navigation.NavMesh.RemoveTile(DtNavMesh, coord) == 1;
         }
 
+        /// <summary>
+        /// Enables or disables hierarchical pathfinding for long range queries on this navmesh
+        /// </summary>
+        public bool EnableClusterGraph(bool enabled)
+        {
+            return Navigation.NavMesh.EnableClusterGraph(DtNavMesh, enabled ? 1 : 0) == 1;
+        }
+
+        /// <summary>
+        /// Allows tiles to be added and removed while queries and crowds read this navmesh from jobs.
+        /// Only succeeds before the first tile is added.
+        /// Heap tiles are stored twice and every tile change is applied twice, see the README.
+        /// </summary>
+        public bool EnableConcurrentReads(bool enabled)
+        {
+            return Navigation.NavMesh.EnableConcurrentReads(DtNavMesh, enabled ? 1 : 0) == 1;
+        }
+
+        /// <summary>
+        /// Adds or replaces every tile of a pack, the tiles are used straight from the pack's memory mapping
+        /// </summary>
+        /// <returns>The number of tiles added</returns>
+        public int AddOrReplaceTiles(AiNavTilePack pack)
+        {
+            int added = 0;
+            for (int i = 0; i < pack.TileCount; i++)
+            {
+                if (Navigation.TilePack.GetTileLocation(pack.DtTilePack, i, out int x, out int y, out int layer) == 0)
+                    continue;
+
+                var coord = new int2(x, y);
+                RemoveTile(coord);
+
+                if (Navigation.TilePack.AddTile(DtNavMesh, pack.DtTilePack, x, y, layer) == 1)
+                {
+                    TileCoordinates.Add(coord);
+                    added++;
+                }
+            }
+            return added;
+        }
+
        
     }
 }
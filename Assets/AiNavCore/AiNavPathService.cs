@@ -0,0 +1,80 @@
+﻿using System;
+using Unity.Mathematics;
+
+namespace AiNav
+{
+    public enum DtPathRequestStatus
+    {
+        Invalid = 0,
+        Pending = 1,
+        Succeeded = 2,
+        Failed = 3
+    }
+
+    /// <summary>
+    /// Finds paths on native worker threads. Request never blocks, results are collected by handle with Poll.
+    /// Workers read the navmesh concurrently, tiles must not be added or removed while requests are pending.
+    /// </summary>
+    public class AiNavPathService : IDisposable
+    {
+        public IntPtr DtPathService { get; private set; }
+
+        public int PendingCount
+        {
+            get
+            {
+                return DtPathService != IntPtr.Zero ? Navigation.PathService.GetPendingCount(DtPathService) : 0;
+            }
+        }
+
+        /// <param name="workerCount">Native worker threads, 0 uses one per core</param>
+        /// <param name="capacity">Maximum number of requests in flight</param>
+        public AiNavPathService(AiNavMesh navmesh, int workerCount = 0, int maxNodes = 2048, int capacity = 4096, int maxPathPoints = 512)
+        {
+            DtPathService = Navigation.PathService.Create(navmesh.DtNavMesh, workerCount, maxNodes, capacity, maxPathPoints);
+            if (DtPathService == IntPtr.Zero)
+            {
+                throw new ApplicationException("Unable to create path service");
+            }
+        }
+
+        public void Dispose()
+        {
+            if (DtPathService != IntPtr.Zero)
+            {
+                Navigation.PathService.Destroy(DtPathService);
+                DtPathService = IntPtr.Zero;
+            }
+        }
+
+        /// <returns>The request handle, 0 if too many requests are in flight</returns>
+        public uint Request(NavQuerySettings querySettings, float3 start, float3 end)
+        {
+            DtPathFindQuery query;
+            query.Source = start;
+            query.Target = end;
+            query.MaxPathPoints = querySettings.MaxPathPoints;
+            query.FindNearestPolyExtent = querySettings.FindNearestPolyExtent;
+            query.Filter = querySettings.Filter;
+            return Navigation.PathService.Request(DtPathService, ref query);
+        }
+
+        /// <summary>
+        /// Once the request succeeded or failed the path is written and the handle is released
+        /// </summary>
+        /// <param name="path">Room for the MaxPathPoints of the request</param>
+        public unsafe DtPathRequestStatus Poll(uint handle, float3* path, out int pathLength)
+        {
+            DtPathFindResult result = default;
+            result.PathPoints = new IntPtr(path);
+            DtPathRequestStatus status = (DtPathRequestStatus)Navigation.PathService.Poll(DtPathService, handle, new IntPtr(&result));
+            pathLength = status == DtPathRequestStatus.Succeeded ? result.NumPathPoints : 0;
+            return status;
+        }
+
+        public void Cancel(uint handle)
+        {
+            Navigation.PathService.Cancel(DtPathService, handle);
+        }
+    }
+}
@@ -51,6 +51,7 @@ namespace AiNav
             query.Target = end;
             query.MaxPathPoints = querySettings.MaxPathPoints;
             query.FindNearestPolyExtent = querySettings.FindNearestPolyExtent;
+            query.Filter = querySettings.Filter;
 
             int result = Navigation.Query.HasPath(DtQuery, ref query);
             return result == 1;
@@ -67,6 +68,7 @@ namespace AiNav
             query.Target = end;
             query.MaxPathPoints = querySettings.MaxPathPoints;
             query.FindNearestPolyExtent = querySettings.FindNearestPolyExtent;
+            query.Filter = querySettings.Filter;
             DtPathFindResult queryResult;
 
             queryResult.PathPoints = new IntPtr(path);
@@ -78,6 +80,40 @@ namespace AiNav
             return true;
         }
 
+        // Same path as TryFindPath, also returning the polygon corridor it runs through. corridor needs room for MaxPathPoints
+        // refs, pathFlags and pathPolys are optional per point outputs sized like path.
+        public unsafe bool TryFindPath(NavQuerySettings querySettings, float3 start, float3 end, float3* path, out int pathLength,
+            uint* corridor, out int corridorLength, byte* pathFlags = null, uint* pathPolys = null)
+        {
+            pathLength = 0;
+            corridorLength = 0;
+            if (DtQuery == IntPtr.Zero)
+                return false;
+
+            DtPathFindQuery query;
+            query.Source = start;
+            query.Target = end;
+            query.MaxPathPoints = querySettings.MaxPathPoints;
+            query.FindNearestPolyExtent = querySettings.FindNearestPolyExtent;
+            query.Filter = querySettings.Filter;
+            DtPathFindResult queryResult;
+            queryResult.PathPoints = new IntPtr(path);
+
+            DtPathFindCorridor corridorResult;
+            corridorResult.Polys = new IntPtr(corridor);
+            corridorResult.NumPolys = 0;
+            corridorResult.PathFlags = new IntPtr(pathFlags);
+            corridorResult.PathPolys = new IntPtr(pathPolys);
+
+            Navigation.Query.FindStraightPathCorridor(DtQuery, ref query, new IntPtr(&queryResult), new IntPtr(&corridorResult));
+            if (!queryResult.PathFound)
+                return false;
+
+            pathLength = queryResult.NumPathPoints;
+            corridorLength = corridorResult.NumPolys;
+            return true;
+        }
+
         // SamplePosition does not use the detail mesh, height will not match surface
         public bool SamplePosition(float3 point, float range, out float3 result)
         {
@@ -90,12 +126,53 @@ namespace AiNav
             return Navigation.Query.SamplePosition(DtQuery, ref point, ref extent, out result) == 1;
         }
 
+        // Same result per point as SamplePosition, results is only written for points that were found and refs receives 0 for the others.
+        // Much cheaper than one call per point when validating thousands of spawn or target positions.
+        public unsafe int SamplePositionBatch(float3* points, float3* extents, int count, float3* results, uint* refs = null)
+        {
+            return Navigation.Query.SamplePositionBatch(DtQuery, points, extents, count, results, refs);
+        }
+
+        // Raycasts count rays in one call, rays from the same origin share one nearest polygon lookup. startRefs can hold the
+        // StartRef of a previous batch to skip the lookup. Ray i writes up to maxVisited polygons at visited + i * maxVisited,
+        // leaving visited null skips collecting them, which is all line of sight checks need.
+        public unsafe int RaycastBatch(float3* starts, float3* ends, int count, float3 extent, DtRaycastBatchResult* results,
+            uint* startRefs = null, uint* visited = null, int maxVisited = 0)
+        {
+            return Navigation.Query.RaycastBatch(DtQuery, starts, ends, startRefs, count, extent, visited, maxVisited, results);
+        }
+
         // GetLocation is the same as SamplePosition but it does use the detail mesh, returning the surface height
         public bool GetLocation(float3 point, float3 extent, out float3 result)
         {
             return Navigation.Query.GetLocation(DtQuery, ref point, ref extent, out result) == 1;
         }
 
+        // Connected region of the navmesh nearest to the point. Points on different islands never have a path, 0 when
+        // there is no navmesh near the point.
+        public int GetIsland(float3 point, float3 extent)
+        {
+            return Navigation.Query.GetIsland(DtQuery, ref point, ref extent);
+        }
+
+        // Keeps the corridors of the last capacity paths so queries between the same polygons skip the search, 0 disables it.
+        // Entries are dropped when a tile they cross is removed or replaced.
+        public bool EnablePathCache(int capacity)
+        {
+            return Navigation.Query.EnablePathCache(DtQuery, capacity) == 1;
+        }
+
+        public void GetPathCacheStats(out int hits, out int misses)
+        {
+            Navigation.Query.GetPathCacheStats(DtQuery, out hits, out misses);
+        }
+
+        // Filter for every call on this query, a filter in NavQuerySettings takes precedence. Null restores the default filter.
+        public void SetFilter(AiNavFilter filter)
+        {
+            Navigation.Query.SetFilter(DtQuery, filter != null ? filter.DtFilter : IntPtr.Zero);
+        }
+
         public bool GetRandomPosition(ref float3 result)
         {
             return Navigation.Query.GetRandomPosition(DtQuery, ref result) == 1;
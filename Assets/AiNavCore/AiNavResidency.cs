@@ -0,0 +1,60 @@
+﻿using System;
+using System.Collections.Generic;
+
+namespace AiNav
+{
+    /// <summary>
+    /// Keeps the tiles of a pack that are around a set of focus points resident in a navmesh.
+    /// Tiles are read on a native worker thread, Update commits and evicts them within a per call budget.
+    /// Update changes the navmesh, it must not run while queries or crowds use it.
+    /// </summary>
+    public class AiNavResidency : IDisposable
+    {
+        public IntPtr DtResidency { get; private set; }
+
+        public int ResidentCount
+        {
+            get
+            {
+                return DtResidency != IntPtr.Zero ? Navigation.Residency.GetResidentCount(DtResidency) : 0;
+            }
+        }
+
+        public AiNavResidency(AiNavMesh navmesh, AiNavTilePack pack)
+        {
+            DtResidency = Navigation.Residency.Create(navmesh.DtNavMesh);
+            if (DtResidency == IntPtr.Zero)
+            {
+                throw new ApplicationException("Unable to create residency manager");
+            }
+            Navigation.Residency.SetPackSource(DtResidency, pack.DtTilePack);
+        }
+
+        public void Dispose()
+        {
+            if (DtResidency != IntPtr.Zero)
+            {
+                Navigation.Residency.Destroy(DtResidency);
+                DtResidency = IntPtr.Zero;
+            }
+        }
+
+        public unsafe void SetFocus(List<DtResidencyFocus> focus)
+        {
+            DtResidencyFocus[] focusArray = focus.ToArray();
+            fixed (DtResidencyFocus* focusPtr = focusArray)
+            {
+                Navigation.Residency.SetFocus(DtResidency, focusPtr, focusArray.Length);
+            }
+        }
+
+        /// <summary>
+        /// Evicts and commits tiles until budgetMs or budgetBytes is used up, a value of 0 disables that budget
+        /// </summary>
+        /// <returns>The number of tiles added or removed</returns>
+        public int Update(float budgetMs, int budgetBytes)
+        {
+            return Navigation.Residency.Update(DtResidency, budgetMs, budgetBytes);
+        }
+    }
+}
@@ -0,0 +1,71 @@
+﻿using System;
+using System.Collections.Generic;
+using System.Runtime.InteropServices;
+
+namespace AiNav
+{
+    /// <summary>
+    /// Memory mapped file of navmesh tiles. Tiles added from a pack are not copied, their pages are read when first touched.
+    /// Disposing the pack is safe while tiles from it are still in a navmesh, the mapping lives until the last one is removed.
+    /// </summary>
+    public class AiNavTilePack : IDisposable
+    {
+        public IntPtr DtTilePack { get; private set; }
+
+        public int TileCount
+        {
+            get
+            {
+                return DtTilePack != IntPtr.Zero ? Navigation.TilePack.GetTileCount(DtTilePack) : 0;
+            }
+        }
+
+        public AiNavTilePack(string path)
+        {
+            DtTilePack = Navigation.TilePack.Open(path);
+            if (DtTilePack == IntPtr.Zero)
+            {
+                throw new ApplicationException("Unable to open tile pack " + path);
+            }
+        }
+
+        public void Dispose()
+        {
+            if (DtTilePack != IntPtr.Zero)
+            {
+                Navigation.TilePack.Close(DtTilePack);
+                DtTilePack = IntPtr.Zero;
+            }
+        }
+
+        public static unsafe bool Write(string path, List<byte[]> tiles)
+        {
+            byte*[] tilePtrs = new byte*[tiles.Count];
+            int[] tileLengths = new int[tiles.Count];
+            List<GCHandle> handles = new List<GCHandle>();
+            try
+            {
+                for (int i = 0; i < tiles.Count; i++)
+                {
+                    var handle = GCHandle.Alloc(tiles[i], GCHandleType.Pinned);
+                    handles.Add(handle);
+                    tilePtrs[i] = (byte*)handle.AddrOfPinnedObject();
+                    tileLengths[i] = tiles[i].Length;
+                }
+
+                fixed (byte** tilesPtr = tilePtrs)
+                fixed (int* tileLengthsPtr = tileLengths)
+                {
+                    return Navigation.TilePack.Write(path, tilesPtr, tileLengthsPtr, tiles.Count) == 1;
+                }
+            }
+            finally
+            {
+                foreach (var handle in handles)
+                {
+                    handle.Free();
+                }
+            }
+        }
+    }
+}
@@ -53,6 +53,12 @@ namespace AiNav
         /// </summary>
         public float MaxDetailSamplingError;
 
+        /// <summary>
+        /// How the walkable surface is split into regions. Watershed gives the best polygons,
+        /// monotone builds fastest and suits tiles that are rebuilt often, layers sits in between.
+        /// </summary>
+        public DtPartitionType PartitionType;
+
         public static NavMeshBuildSettings Default()
         {
             return new NavMeshBuildSettings
@@ -66,6 +72,7 @@ namespace AiNav
                 MaxEdgeError = 1.3f,
                 DetailSamplingDistance = 6.0f,
                 MaxDetailSamplingError = 1.0f,
+                PartitionType = DtPartitionType.Watershed,
             };
         }
 
@@ -81,7 +88,8 @@ namespace AiNav
         {
             return CellHeight.Equals(other.CellHeight) && CellSize.Equals(other.CellSize) && TileSize == other.TileSize && MinRegionArea.Equals(other.MinRegionArea) &&
                    RegionMergeArea.Equals(other.RegionMergeArea) && MaxEdgeLen.Equals(other.MaxEdgeLen) && MaxEdgeError.Equals(other.MaxEdgeError) &&
-                   DetailSamplingDistance.Equals(other.DetailSamplingDistance) && MaxDetailSamplingError.Equals(other.MaxDetailSamplingError);
+                   DetailSamplingDistance.Equals(other.DetailSamplingDistance) && MaxDetailSamplingError.Equals(other.MaxDetailSamplingError) &&
+                   PartitionType == other.PartitionType;
         }
 
         public override int GetHashCode()
@@ -97,6 +105,7 @@ namespace AiNav
                 hashCode = (hashCode * 397) ^ MaxEdgeError.GetHashCode();
                 hashCode = (hashCode * 397) ^ DetailSamplingDistance.GetHashCode();
                 hashCode = (hashCode * 397) ^ MaxDetailSamplingError.GetHashCode();
+                hashCode = (hashCode * 397) ^ (int)PartitionType;
                 return hashCode;
             }
         }
@@ -6,16 +6,44 @@ using Unity.Mathematics;
 
 namespace AiNav
 {
-    public class NavMeshBuilder 
+    /// <summary>
+    /// Builds navmesh tiles through a native builder and its worker pool, both are kept between builds until <see cref="Dispose"/>
+    /// </summary>
+    public class NavMeshBuilder : IDisposable
     {
         public NavMeshBuildSettings BuildSettings { get; private set; }
         public NavAgentSettings AgentSettings { get; private set; }
         public DtBoundingBox HeightBounds { get; private set; }
         public NavMeshBuildResult BuildResult;
         public Dictionary<int2, NavMeshTile> Tiles { get; private set; } = new Dictionary<int2, NavMeshTile>();
+
+        /// <summary>
+        /// Error code of every tile of the last build that failed, tiles without any walkable surface (110) are not included
+        /// </summary>
+        public Dictionary<int2, int> TileErrors { get; private set; } = new Dictionary<int2, int>();
+
+        /// <summary>
+        /// Bump allocates the native Recast intermediates from per builder arenas instead of the system allocator
+        /// </summary>
+        public bool UseBuildArena { get; set; }
+
+        /// <summary>
+        /// Splits the rasterization of a single tile build across the native worker pool, useful when rebuilding one tile from dense meshes
+        /// </summary>
+        public bool ParallelRasterization { get; set; }
+
+        /// <summary>
+        /// Splits the distance field and watershed region build of a single tile build across the native worker pool
+        /// </summary>
+        public bool ParallelRegions { get; set; }
         private HashSet<int2> TilesToBuild = new HashSet<int2>();
         private List<NavMeshBuildInput> InputsFromNativeList = new List<NavMeshBuildInput>();
 
+        private IntPtr NativeBuilder;
+        private bool NativeBuildArena;
+        private bool NativeParallelRasterization;
+        private bool NativeParallelRegions;
+
         public bool HasTilesToBuild
         {
             get
@@ -30,6 +58,15 @@ namespace AiNav
             AgentSettings = agentSettings;
         }
 
+        public void Dispose()
+        {
+            if (NativeBuilder != IntPtr.Zero)
+            {
+                Navigation.NavMesh.DestroyBuilder(NativeBuilder);
+                NativeBuilder = IntPtr.Zero;
+            }
+        }
+
         public void ClearTilesToBuild()
         {
             TilesToBuild.Clear();
@@ -94,6 +131,7 @@ namespace AiNav
         {
             HeightBounds = default;
             Tiles.Clear();
+            TileErrors.Clear();
             TilesToBuild.Clear();
 
             BuildResult = new NavMeshBuildResult();
@@ -101,31 +139,20 @@ namespace AiNav
             NormalizeInputHeights(inputs);
             SetGlobalBounds(inputs);
 
+            List<int2> tileCoords = new List<int2>();
             foreach (NavMeshBuildInput input in inputs)
             {
-                int result = BuildTile(input.TileBounds.Coord, BuildSettings, AgentSettings, input, 1, out NavMeshTile tile);
-
-                if (result == 0)
-                {
-                    Tiles[input.TileBounds.Coord] = tile;
-                    BuildResult.TilesBuilt++;
-                }
-                else if (result != 110)
-                {
-                    BuildResult.Result = result;
-                    return false;
-                }
+                tileCoords.Add(input.TileBounds.Coord);
             }
 
-            BuildResult.Result = 0;
-
-            return true;
+            return BuildTiles(tileCoords, inputs, 1);
         }
 
         public unsafe bool BuildAllFromSingleInput(NavMeshBuildInput single)
         {
             HeightBounds = default;
             Tiles.Clear();
+            TileErrors.Clear();
             TilesToBuild.Clear();
 
             List<NavMeshBuildInput> inputs = new List<NavMeshBuildInput>() { single };
@@ -134,28 +161,19 @@ namespace AiNav
             NormalizeInputHeights(inputs);
             SetGlobalBounds(inputs);
 
+            List<int2> tileCoords = new List<int2>();
+            List<NavMeshBuildInput> tileInputs = new List<NavMeshBuildInput>();
             foreach (NavMeshBuildInput input in inputs)
             {
                 var tiles = NavMeshBuildUtils.GetOverlappingTiles(BuildSettings, input.TileBounds.Bounds);
                 foreach (var tileCoord in tiles)
                 {
-                    int result = BuildTile(tileCoord, BuildSettings, AgentSettings, input, 1, out NavMeshTile tile);
-                    if (result == 0)
-                    {
-                        Tiles[tileCoord] = tile;
-                        BuildResult.TilesBuilt++;
-                    }
-                    else if (result != 110)
-                    {
-                        BuildResult.Result = result;
-                        return false;
-                    }
+                    tileCoords.Add(tileCoord);
+                    tileInputs.Add(input);
                 }
             }
 
-            BuildResult.Result = 0;
-
-            return true;
+            return BuildTiles(tileCoords, tileInputs, 1);
         }
 
         private void NormalizeInputHeights(List<NavMeshBuildInput> inputs)
@@ -188,31 +206,129 @@ namespace AiNav
             }
         }
 
-        private unsafe int BuildTile(int2 tileCoordinate, NavMeshBuildSettings buildSettings, NavAgentSettings agentSettings,
-            NavMeshBuildInput buildInput, long buildTimeStamp, out NavMeshTile meshTile)
+        /// <summary>
+        /// Builds all tiles with a single native call, the tiles are spread across the native worker pool.
+        /// A tile that fails or has no usable input is recorded in TileErrors and does not stop the others from building.
+        /// </summary>
+        private unsafe bool BuildTiles(List<int2> tileCoords, List<NavMeshBuildInput> inputs, long buildTimeStamp)
         {
-            
-            meshTile = null;
+            int error = 0;
+            List<int2> builtCoords = new List<int2>(tileCoords.Count);
+            List<DtTileInput> tileInputs = new List<DtTileInput>(tileCoords.Count);
+            for (int i = 0; i < tileCoords.Count; i++)
+            {
+                NavMeshBuildInput buildInput = inputs[i];
+                int inputError = 0;
+                if (buildInput.AreasLength != buildInput.IndicesLength / 3)
+                {
+                    inputError = -1001;
+                }
+                else if (buildInput.VerticesLength <= 0 || buildInput.IndicesLength <= 0)
+                {
+                    inputError = -1000;
+                }
+
+                if (inputError != 0)
+                {
+                    TileErrors[tileCoords[i]] = inputError;
+                    if (error == 0)
+                    {
+                        error = inputError;
+                    }
+                    continue;
+                }
+
+                builtCoords.Add(tileCoords[i]);
+                tileInputs.Add(new DtTileInput
+                {
+                    BuildSettings = CreateTileSettings(tileCoords[i], BuildSettings, AgentSettings),
+                    Vertices = buildInput.Vertices,
+                    NumVertices = buildInput.VerticesLength,
+                    Indices = buildInput.Indices,
+                    NumIndices = buildInput.IndicesLength,
+                    Areas = buildInput.Areas
+                });
+            }
 
-            if (buildInput.AreasLength != buildInput.IndicesLength / 3)
+            int count = tileInputs.Count;
+            if (count > 0)
             {
-                return -1001;
+                DtTileInput[] tileInputArray = tileInputs.ToArray();
+                DtGeneratedData[] generatedData = new DtGeneratedData[count];
+                IntPtr builder = GetNativeBuilder();
+
+                fixed (DtTileInput* tileInputsPtr = tileInputArray)
+                fixed (DtGeneratedData* generatedDataPtr = generatedData)
+                {
+                    Navigation.NavMesh.BuildTiles(builder, tileInputsPtr, count, generatedDataPtr);
+
+                    for (int i = 0; i < count; i++)
+                    {
+                        DtGeneratedData* generated = &generatedDataPtr[i];
+                        if (generated->Success && generated->NavmeshDataLength > 0)
+                        {
+                            Tiles[builtCoords[i]] = CreateTile(generated, buildTimeStamp);
+                            BuildResult.TilesBuilt++;
+                        }
+                        else if (generated->Error != 0 && generated->Error != 110)
+                        {
+                            TileErrors[builtCoords[i]] = generated->Error;
+                            if (error == 0)
+                            {
+                                error = generated->Error;
+                            }
+                        }
+
+                        // Results of a batched build are owned by the caller
+                        Navigation.NavMesh.FreeNavmeshData(generated);
+                    }
+                }
             }
 
-            if (buildInput.VerticesLength <= 0 || buildInput.IndicesLength <= 0)
+            BuildResult.Result = error;
+            return error == 0;
+        }
+
+        /// <summary>
+        /// Native builder shared by all builds so its worker pool is only started once, options are forwarded when they changed
+        /// </summary>
+        private IntPtr GetNativeBuilder()
+        {
+            if (NativeBuilder == IntPtr.Zero)
+            {
+                NativeBuilder = Navigation.NavMesh.CreateBuilder();
+                NativeBuildArena = false;
+                NativeParallelRasterization = false;
+                NativeParallelRegions = false;
+            }
+
+            if (UseBuildArena != NativeBuildArena)
+            {
+                Navigation.NavMesh.SetBuildArena(NativeBuilder, UseBuildArena ? 1 : 0, 0);
+                NativeBuildArena = UseBuildArena;
+            }
+            if (ParallelRasterization != NativeParallelRasterization)
+            {
+                Navigation.NavMesh.SetParallelRasterization(NativeBuilder, ParallelRasterization ? 1 : 0);
+                NativeParallelRasterization = ParallelRasterization;
+            }
+            if (ParallelRegions != NativeParallelRegions)
             {
-                return -1000;
+                Navigation.NavMesh.SetParallelRegions(NativeBuilder, ParallelRegions ? 1 : 0);
+                NativeParallelRegions = ParallelRegions;
             }
+            return NativeBuilder;
+        }
 
+        private DtBuildSettings CreateTileSettings(int2 tileCoordinate, NavMeshBuildSettings buildSettings, NavAgentSettings agentSettings)
+        {
             DtBoundingBox tileBoundingBox = NavMeshBuildUtils.CalculateTileBoundingBox(buildSettings, tileCoordinate);
             NavMeshBuildUtils.SnapBoundingBoxToCellHeight(buildSettings, ref tileBoundingBox);
 
             tileBoundingBox.min.y = HeightBounds.min.y;
             tileBoundingBox.max.y = HeightBounds.max.y;
 
-            IntPtr builder = Navigation.NavMesh.CreateBuilder();
-
-            DtBuildSettings internalBuildSettings = new DtBuildSettings
+            return new DtBuildSettings
             {
                 // Tile settings
                 BoundingBox = tileBoundingBox,
@@ -228,6 +344,7 @@ namespace AiNav
                 EdgeMaxError = buildSettings.MaxEdgeError,
                 DetailSampleDist = buildSettings.DetailSamplingDistance,
                 DetailSampleMaxError = buildSettings.MaxDetailSamplingError,
+                PartitionType = buildSettings.PartitionType,
 
                 // Agent settings
                 AgentHeight = agentSettings.Height,
@@ -235,32 +352,22 @@ namespace AiNav
                 AgentMaxClimb = agentSettings.MaxClimb,
                 AgentMaxSlope = agentSettings.MaxSlope
             };
+        }
 
-            Navigation.NavMesh.SetSettings(builder, new IntPtr(&internalBuildSettings));
-
-            IntPtr buildResultPtr = Navigation.NavMesh.Build2(builder, buildInput.Vertices, buildInput.VerticesLength, buildInput.Indices, buildInput.IndicesLength, buildInput.Areas);
-            
-            DtGeneratedData* generatedDataPtr = (DtGeneratedData*)buildResultPtr;
-
-            if (generatedDataPtr->Success && generatedDataPtr->NavmeshDataLength > 0)
-            {
-                meshTile = new NavMeshTile();
-
-                // Copy the generated navigationMesh data
-                meshTile.Data = new byte[generatedDataPtr->NavmeshDataLength + sizeof(long)];
-                Marshal.Copy(generatedDataPtr->NavmeshData, meshTile.Data, 0, generatedDataPtr->NavmeshDataLength);
-
-                // Append time stamp
-                byte[] timeStamp = BitConverter.GetBytes(buildTimeStamp);
-                for (int i = 0; i < timeStamp.Length; i++)
-                    meshTile.Data[meshTile.Data.Length - sizeof(long) + i] = timeStamp[i];
-            }
+        private unsafe NavMeshTile CreateTile(DtGeneratedData* generatedDataPtr, long buildTimeStamp)
+        {
+            NavMeshTile meshTile = new NavMeshTile();
 
-            int error = generatedDataPtr->Error;
-            Navigation.NavMesh.DestroyBuilder(builder);
+            // Copy the generated navigationMesh data
+            meshTile.Data = new byte[generatedDataPtr->NavmeshDataLength + sizeof(long)];
+            Marshal.Copy(generatedDataPtr->NavmeshData, meshTile.Data, 0, generatedDataPtr->NavmeshDataLength);
 
-            return error;
+            // Append time stamp
+            byte[] timeStamp = BitConverter.GetBytes(buildTimeStamp);
+            for (int i = 0; i < timeStamp.Length; i++)
+                meshTile.Data[meshTile.Data.Length - sizeof(long) + i] = timeStamp[i];
 
+            return meshTile;
         }
 
     }
@@ -25,5 +25,11 @@ namespace AiNav
         /// The maximum number of path points used internally and also the maximum number of output points
         /// </summary>
         public int MaxPathPoints;
+
+        /// <summary>
+        /// Handle of an <see cref="AiNavFilter"/> for flags and area costs, zero uses the filter set on the query or the default filter
+        /// </summary>
+        [NonSerialized]
+        public IntPtr Filter;
     }
 }
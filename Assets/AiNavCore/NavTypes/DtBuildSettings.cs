@@ -21,5 +21,6 @@ namespace AiNav
         public float AgentRadius;
         public float AgentMaxClimb;
         public float AgentMaxSlope;
+        public DtPartitionType PartitionType;
     }
 }
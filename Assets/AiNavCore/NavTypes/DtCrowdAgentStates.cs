@@ -0,0 +1,24 @@
+﻿using System;
+using Unity.Mathematics;
+
+namespace AiNav
+{
+    /// <summary>
+    /// Caller owned structure of arrays filled by <see cref="AiCrowd.GetAgentStates"/>, one entry per active agent.
+    /// Arrays left null are skipped, the others must have room for Capacity entries.
+    /// </summary>
+    [Serializable]
+    public unsafe struct DtCrowdAgentStates
+    {
+        public int Capacity;
+        public int Count;
+        public int* Indices;
+        public float3* Positions;
+        public float3* Velocities;
+        public float* DesiredSpeeds;
+        public byte* States;
+        public byte* Partial;
+        public uint* TargetRefs;
+        public int* CorridorLengths;
+    }
+}
@@ -0,0 +1,12 @@
+﻿namespace AiNav
+{
+    /// <summary>
+    /// Region partitioning used when building tiles, values match PartitionWatershed/PartitionMonotone/PartitionLayers in Navigation.hpp.
+    /// </summary>
+    public enum DtPartitionType
+    {
+        Watershed = 0,
+        Monotone = 1,
+        Layers = 2
+    }
+}
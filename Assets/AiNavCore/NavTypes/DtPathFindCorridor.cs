@@ -0,0 +1,26 @@
+﻿using System;
+
+namespace AiNav
+{
+    // Optional outputs of FindStraightPathCorridor, pointers left zero are skipped
+    [Serializable]
+    public struct DtPathFindCorridor
+    {
+        /// <summary>
+        /// Polygons from the start to the end polygon, room for <see cref="DtPathFindQuery.MaxPathPoints"/> uints
+        /// </summary>
+        public IntPtr Polys;
+
+        public int NumPolys;
+
+        /// <summary>
+        /// DT_STRAIGHTPATH flags of every path point (1 start, 2 end, 4 off mesh connection), room for MaxPathPoints bytes
+        /// </summary>
+        public IntPtr PathFlags;
+
+        /// <summary>
+        /// Polygon entered at every path point, room for MaxPathPoints uints
+        /// </summary>
+        public IntPtr PathPolys;
+    }
+}
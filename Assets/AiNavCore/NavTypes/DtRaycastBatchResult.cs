@@ -0,0 +1,19 @@
+﻿using System;
+using Unity.Mathematics;
+
+namespace AiNav
+{
+    [Serializable]
+    public struct DtRaycastBatchResult
+    {
+        // Fraction of the ray walked before a wall, float.MaxValue when it reached the end and -1 when it could not start
+        public float T;
+        public float3 Normal;
+        // Polygon the ray started in, can be passed back as a start ref on the next batch
+        public uint StartRef;
+        public int VisitedCount;
+
+        // True when a wall stopped the ray
+        public bool Blocked => T >= 0f && T < float.MaxValue;
+    }
+}
@@ -10,5 +10,6 @@ namespace AiNav
         public float3 Target;
         public float3 FindNearestPolyExtent;
         public int MaxPathPoints;
+        public IntPtr Filter;
     }
 }
@@ -0,0 +1,12 @@
+﻿using System;
+using Unity.Mathematics;
+
+namespace AiNav
+{
+    [Serializable]
+    public struct DtResidencyFocus
+    {
+        public float3 Position;
+        public float Radius;
+    }
+}
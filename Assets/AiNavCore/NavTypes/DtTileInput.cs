@@ -0,0 +1,19 @@
+﻿using System;
+using Unity.Mathematics;
+
+namespace AiNav
+{
+    /// <summary>
+    /// One tile of a batched build, see <see cref="Navigation.NavMesh.BuildTiles"/>
+    /// </summary>
+    [Serializable]
+    public unsafe struct DtTileInput
+    {
+        public DtBuildSettings BuildSettings;
+        public float3* Vertices;
+        public int NumVertices;
+        public int* Indices;
+        public int NumIndices;
+        public byte* Areas;
+    }
+}
@@ -44,6 +44,54 @@ namespace AiNav
             [DllImport(NativeLibrary, EntryPoint = "SetSettings", CallingConvention = CallingConvention.Cdecl)]
             public static extern void SetSettings(IntPtr builder, IntPtr settings);
 
+            /// <summary>
+            /// Enables or disables the per builder scratch arena. Recast intermediates are then bump allocated and reset between tiles.
+            /// </summary>
+            [SuppressUnmanagedCodeSecurity]
+            [DllImport(NativeLibrary, EntryPoint = "SetBuildArena", CallingConvention = CallingConvention.Cdecl)]
+            public static extern void SetBuildArena(IntPtr builder, int enabled, int initialSize);
+
+            /// <summary>
+            /// Rasterizes single tile builds in row bands across the native worker pool. The result is identical to a serial build.
+            /// </summary>
+            [SuppressUnmanagedCodeSecurity]
+            [DllImport(NativeLibrary, EntryPoint = "SetParallelRasterization", CallingConvention = CallingConvention.Cdecl)]
+            public static extern void SetParallelRasterization(IntPtr builder, int enabled);
+
+            /// <summary>
+            /// Builds the distance field and watershed regions of single tile builds across the native worker pool. The result is identical to a serial build.
+            /// </summary>
+            [SuppressUnmanagedCodeSecurity]
+            [DllImport(NativeLibrary, EntryPoint = "SetParallelRegions", CallingConvention = CallingConvention.Cdecl)]
+            public static extern void SetParallelRegions(IntPtr builder, int enabled);
+
+            /// <summary>
+            /// Returns the highest SIMD level the CPU supports: 0 scalar, 1 SSE2, 2 AVX2.
+            /// </summary>
+            [SuppressUnmanagedCodeSecurity]
+            [DllImport(NativeLibrary, EntryPoint = "GetSimdSupport", CallingConvention = CallingConvention.Cdecl)]
+            public static extern int GetSimdSupport();
+
+            /// <summary>
+            /// Limits the SIMD kernels used for slope classification and rasterization. Applies to every builder in the process.
+            /// Every level produces identical tiles. Returns the level in use after clamping to GetSimdSupport.
+            /// </summary>
+            [SuppressUnmanagedCodeSecurity]
+            [DllImport(NativeLibrary, EntryPoint = "SetSimdLevel", CallingConvention = CallingConvention.Cdecl)]
+            public static extern int SetSimdLevel(int level);
+
+            /// <summary>
+            /// Builds all tiles across the native worker pool. Returns the number of tiles built successfully.
+            /// The navmesh data in each output is owned by the caller and must be released with FreeNavmeshData.
+            /// </summary>
+            [SuppressUnmanagedCodeSecurity]
+            [DllImport(NativeLibrary, EntryPoint = "BuildNavmeshTiles", CallingConvention = CallingConvention.Cdecl)]
+            public static unsafe extern int BuildTiles(IntPtr builder, DtTileInput* inputs, int count, DtGeneratedData* outs);
+
+            [SuppressUnmanagedCodeSecurity]
+            [DllImport(NativeLibrary, EntryPoint = "FreeNavmeshData", CallingConvention = CallingConvention.Cdecl)]
+            public static unsafe extern void FreeNavmeshData(DtGeneratedData* data);
+
             /// <summary>
             /// Creates a new navigation mesh object. 
             /// You must add tiles to it with AddTile before you can perform navigation queries using Query
@@ -67,6 +115,14 @@ namespace AiNav
             [DllImport(NativeLibrary, EntryPoint = "AddTile", CallingConvention = CallingConvention.Cdecl)]
             public static extern int AddTile(IntPtr navmesh, IntPtr data, int dataLength);
 
+            /// <summary>
+            /// Adds the tile produced by the builder without copying it. The navmesh takes ownership of the data
+            /// and clears NavmeshData in the passed result on success, so it must not be freed again.
+            /// </summary>
+            [SuppressUnmanagedCodeSecurity]
+            [DllImport(NativeLibrary, EntryPoint = "AddTileOwned", CallingConvention = CallingConvention.Cdecl)]
+            public static extern int AddTileOwned(IntPtr navmesh, IntPtr generatedData);
+
             /// <summary>
             /// Removes a tile from the navigation mesh object
             /// </summary>
@@ -75,8 +131,183 @@ namespace AiNav
             [SuppressUnmanagedCodeSecurity]
             [DllImport(NativeLibrary, EntryPoint = "RemoveTile", CallingConvention = CallingConvention.Cdecl)]
             public static extern int RemoveTile(IntPtr navmesh, int2 tileCoordinate);
+
+            /// <summary>
+            /// Enables the hierarchical graph over tile border polygons. Queries between polygons more than one tile apart
+            /// then search the graph and refine the route into a corridor, instead of a flat search that can run out of nodes.
+            /// The graph is updated as tiles are added and removed.
+            /// </summary>
+            [SuppressUnmanagedCodeSecurity]
+            [DllImport(NativeLibrary, EntryPoint = "EnableClusterGraph", CallingConvention = CallingConvention.Cdecl)]
+            public static extern int EnableClusterGraph(IntPtr navmesh, int enabled);
+
+            /// <summary>
+            /// Lets queries, path requests and crowds run on other threads while tiles are added and removed.
+            /// Must be enabled before the first tile is added, resident tiles then take twice the memory.
+            /// </summary>
+            [SuppressUnmanagedCodeSecurity]
+            [DllImport(NativeLibrary, EntryPoint = "EnableConcurrentReads", CallingConvention = CallingConvention.Cdecl)]
+            public static extern int EnableConcurrentReads(IntPtr navmesh, int enabled);
+        }
+
+        public class TilePack
+        {
+            /// <summary>
+            /// Writes tiles into an indexed pack file with page aligned tile blobs
+            /// </summary>
+            [SuppressUnmanagedCodeSecurity]
+            [DllImport(NativeLibrary, EntryPoint = "TilePackWrite", CallingConvention = CallingConvention.Cdecl)]
+            public static unsafe extern int Write([MarshalAs(UnmanagedType.LPStr)] string path, byte** tiles, int* tileLengths, int count);
+
+            /// <summary>
+            /// Memory maps a pack. Only the index is read, tiles are paged in when added to a navmesh.
+            /// </summary>
+            [SuppressUnmanagedCodeSecurity]
+            [DllImport(NativeLibrary, EntryPoint = "TilePackOpen", CallingConvention = CallingConvention.Cdecl)]
+            public static extern IntPtr Open([MarshalAs(UnmanagedType.LPStr)] string path);
+
+            /// <summary>
+            /// Releases the pack. The mapping stays alive until all tiles added from it are removed.
+            /// </summary>
+            [SuppressUnmanagedCodeSecurity]
+            [DllImport(NativeLibrary, EntryPoint = "TilePackClose", CallingConvention = CallingConvention.Cdecl)]
+            public static extern void Close(IntPtr pack);
+
+            [SuppressUnmanagedCodeSecurity]
+            [DllImport(NativeLibrary, EntryPoint = "TilePackGetTileCount", CallingConvention = CallingConvention.Cdecl)]
+            public static extern int GetTileCount(IntPtr pack);
+
+            [SuppressUnmanagedCodeSecurity]
+            [DllImport(NativeLibrary, EntryPoint = "TilePackGetTileLocation", CallingConvention = CallingConvention.Cdecl)]
+            public static extern int GetTileLocation(IntPtr pack, int index, out int x, out int y, out int layer);
+
+            [SuppressUnmanagedCodeSecurity]
+            [DllImport(NativeLibrary, EntryPoint = "AddTileFromPack", CallingConvention = CallingConvention.Cdecl)]
+            public static extern int AddTile(IntPtr navmesh, IntPtr pack, int x, int y, int layer);
+
+            [SuppressUnmanagedCodeSecurity]
+            [DllImport(NativeLibrary, EntryPoint = "AddAllTilesFromPack", CallingConvention = CallingConvention.Cdecl)]
+            public static extern int AddAllTiles(IntPtr navmesh, IntPtr pack);
+        }
+
+        public class Residency
+        {
+            [UnmanagedFunctionPointer(CallingConvention.Cdecl)]
+            public unsafe delegate int TileSource(int x, int y, int layer, byte** data, int* dataLength, IntPtr userData);
+
+            [SuppressUnmanagedCodeSecurity]
+            [DllImport(NativeLibrary, EntryPoint = "ResidencyCreate", CallingConvention = CallingConvention.Cdecl)]
+            public static extern IntPtr Create(IntPtr navmesh);
+
+            [SuppressUnmanagedCodeSecurity]
+            [DllImport(NativeLibrary, EntryPoint = "ResidencyDestroy", CallingConvention = CallingConvention.Cdecl)]
+            public static extern void Destroy(IntPtr residency);
+
+            [SuppressUnmanagedCodeSecurity]
+            [DllImport(NativeLibrary, EntryPoint = "ResidencySetPackSource", CallingConvention = CallingConvention.Cdecl)]
+            public static extern void SetPackSource(IntPtr residency, IntPtr pack);
+
+            /// <summary>
+            /// The callback is invoked from a native worker thread, keep the delegate alive while the manager exists
+            /// </summary>
+            [SuppressUnmanagedCodeSecurity]
+            [DllImport(NativeLibrary, EntryPoint = "ResidencySetCallbackSource", CallingConvention = CallingConvention.Cdecl)]
+            public static extern void SetCallbackSource(IntPtr residency, TileSource callback, IntPtr userData);
+
+            [SuppressUnmanagedCodeSecurity]
+            [DllImport(NativeLibrary, EntryPoint = "ResidencySetFocus", CallingConvention = CallingConvention.Cdecl)]
+            public static unsafe extern void SetFocus(IntPtr residency, DtResidencyFocus* focus, int count);
+
+            /// <summary>
+            /// Evicts and commits tiles within the budget. Same synchronization rules as AddTile/RemoveTile.
+            /// </summary>
+            [SuppressUnmanagedCodeSecurity]
+            [DllImport(NativeLibrary, EntryPoint = "ResidencyUpdate", CallingConvention = CallingConvention.Cdecl)]
+            public static extern int Update(IntPtr residency, float budgetMs, int budgetBytes);
+
+            [SuppressUnmanagedCodeSecurity]
+            [DllImport(NativeLibrary, EntryPoint = "ResidencyGetResidentCount", CallingConvention = CallingConvention.Cdecl)]
+            public static extern int GetResidentCount(IntPtr residency);
+        }
+
+
+        public class PathService
+        {
+            [SuppressUnmanagedCodeSecurity]
+            [DllImport(NativeLibrary, EntryPoint = "PathServiceCreate", CallingConvention = CallingConvention.Cdecl)]
+            public static extern IntPtr Create(IntPtr navmesh, int workerCount, int maxNodes, int capacity, int maxPathPoints);
+
+            [SuppressUnmanagedCodeSecurity]
+            [DllImport(NativeLibrary, EntryPoint = "PathServiceDestroy", CallingConvention = CallingConvention.Cdecl)]
+            public static extern void Destroy(IntPtr service);
+
+            /// <summary>
+            /// Queues a path request and returns its handle, 0 when the service is full
+            /// </summary>
+            [SuppressUnmanagedCodeSecurity]
+            [DllImport(NativeLibrary, EntryPoint = "PathServiceRequest", CallingConvention = CallingConvention.Cdecl)]
+            public static extern uint Request(IntPtr service, ref DtPathFindQuery pathFindQuery);
+
+            /// <summary>
+            /// Returns the request status, writes the result and releases the handle once the request is finished
+            /// </summary>
+            [SuppressUnmanagedCodeSecurity]
+            [DllImport(NativeLibrary, EntryPoint = "PathServicePoll", CallingConvention = CallingConvention.Cdecl)]
+            public static extern int Poll(IntPtr service, uint handle, IntPtr resultStructure);
+
+            [SuppressUnmanagedCodeSecurity]
+            [DllImport(NativeLibrary, EntryPoint = "PathServiceCancel", CallingConvention = CallingConvention.Cdecl)]
+            public static extern void Cancel(IntPtr service, uint handle);
+
+            [SuppressUnmanagedCodeSecurity]
+            [DllImport(NativeLibrary, EntryPoint = "PathServiceGetPendingCount", CallingConvention = CallingConvention.Cdecl)]
+            public static extern int GetPendingCount(IntPtr service);
+        }
+
+        public class FlowField
+        {
+            [SuppressUnmanagedCodeSecurity]
+            [DllImport(NativeLibrary, EntryPoint = "FlowFieldCreate", CallingConvention = CallingConvention.Cdecl)]
+            public static extern IntPtr Create(IntPtr navmesh, int maxNodes);
+
+            [SuppressUnmanagedCodeSecurity]
+            [DllImport(NativeLibrary, EntryPoint = "FlowFieldDestroy", CallingConvention = CallingConvention.Cdecl)]
+            public static extern void Destroy(IntPtr field);
+
+            /// <summary>
+            /// Builds the next hop table towards the goal, returns the number of polygons covered
+            /// </summary>
+            [SuppressUnmanagedCodeSecurity]
+            [DllImport(NativeLibrary, EntryPoint = "FlowFieldBuild", CallingConvention = CallingConvention.Cdecl)]
+            public static extern int Build(IntPtr field, ref float3 goal, ref float3 extent, float radius);
         }
 
+        public class Filter
+        {
+            [SuppressUnmanagedCodeSecurity]
+            [DllImport(NativeLibrary, EntryPoint = "FilterCreate", CallingConvention = CallingConvention.Cdecl)]
+            public static extern IntPtr Create();
+
+            [SuppressUnmanagedCodeSecurity]
+            [DllImport(NativeLibrary, EntryPoint = "FilterDestroy", CallingConvention = CallingConvention.Cdecl)]
+            public static extern void Destroy(IntPtr filter);
+
+            [SuppressUnmanagedCodeSecurity]
+            [DllImport(NativeLibrary, EntryPoint = "FilterSetIncludeFlags", CallingConvention = CallingConvention.Cdecl)]
+            public static extern void SetIncludeFlags(IntPtr filter, int flags);
+
+            [SuppressUnmanagedCodeSecurity]
+            [DllImport(NativeLibrary, EntryPoint = "FilterSetExcludeFlags", CallingConvention = CallingConvention.Cdecl)]
+            public static extern void SetExcludeFlags(IntPtr filter, int flags);
+
+            [SuppressUnmanagedCodeSecurity]
+            [DllImport(NativeLibrary, EntryPoint = "FilterSetAreaCost", CallingConvention = CallingConvention.Cdecl)]
+            public static extern int SetAreaCost(IntPtr filter, int area, float cost);
+
+            [SuppressUnmanagedCodeSecurity]
+            [DllImport(NativeLibrary, EntryPoint = "FilterGetAreaCost", CallingConvention = CallingConvention.Cdecl)]
+            public static extern float GetAreaCost(IntPtr filter, int area);
+        }
 
         public class Query
         {
@@ -101,6 +332,10 @@ namespace AiNav
             [DllImport(NativeLibrary, EntryPoint = "QueryFindStraightPath", CallingConvention = CallingConvention.Cdecl)]
             public static extern void FindStraightPath(IntPtr aiQuery, ref DtPathFindQuery pathFindQuery, IntPtr resultStructure);
 
+            [SuppressUnmanagedCodeSecurity]
+            [DllImport(NativeLibrary, EntryPoint = "QueryFindStraightPathCorridor", CallingConvention = CallingConvention.Cdecl)]
+            public static extern void FindStraightPathCorridor(IntPtr aiQuery, ref DtPathFindQuery pathFindQuery, IntPtr resultStructure, IntPtr corridor);
+
             [SuppressUnmanagedCodeSecurity]
             [DllImport(NativeLibrary, EntryPoint = "QueryHasPath", CallingConvention = CallingConvention.Cdecl)]
             public static extern int HasPath(IntPtr aiQuery, ref DtPathFindQuery pathFindQuery);
@@ -109,11 +344,26 @@ namespace AiNav
             [DllImport(NativeLibrary, EntryPoint = "QueryRaycast", CallingConvention = CallingConvention.Cdecl)]
             public static extern void Raycast(IntPtr aiQuery, DtRaycastQuery pathFindQuery, IntPtr resultStructure);
 
+            /// <summary>
+            /// Raycast for count rays, startRefs and visited are optional. Without visited no visited polygons are collected.
+            /// Returns the number of rays that could start.
+            /// </summary>
+            [SuppressUnmanagedCodeSecurity]
+            [DllImport(NativeLibrary, EntryPoint = "QueryRaycastBatch", CallingConvention = CallingConvention.Cdecl)]
+            public static unsafe extern int RaycastBatch(IntPtr aiQuery, float3* starts, float3* ends, uint* startRefs, int count, float3 extent, uint* visited, int maxVisited, DtRaycastBatchResult* results);
+
 
             [SuppressUnmanagedCodeSecurity]
             [DllImport(NativeLibrary, EntryPoint = "QuerySamplePosition", CallingConvention = CallingConvention.Cdecl)]
             public static extern int SamplePosition(IntPtr aiQuery, ref float3 point, ref float3 extent, out float3 result);
 
+            /// <summary>
+            /// SamplePosition for count points with one extent each, refs is optional. Returns the number of points on the navmesh.
+            /// </summary>
+            [SuppressUnmanagedCodeSecurity]
+            [DllImport(NativeLibrary, EntryPoint = "QuerySamplePositionBatch", CallingConvention = CallingConvention.Cdecl)]
+            public static unsafe extern int SamplePositionBatch(IntPtr aiQuery, float3* points, float3* extents, int count, float3* results, uint* refs);
+
             [SuppressUnmanagedCodeSecurity]
             [DllImport(NativeLibrary, EntryPoint = "QueryGetRandomPosition", CallingConvention = CallingConvention.Cdecl)]
             public static extern int GetRandomPosition(IntPtr aiQuery, ref float3 result);
@@ -121,6 +371,25 @@ namespace AiNav
             [SuppressUnmanagedCodeSecurity]
             [DllImport(NativeLibrary, EntryPoint = "QueryGetLocation", CallingConvention = CallingConvention.Cdecl)]
             public static extern int GetLocation(IntPtr aiQuery, ref float3 point, ref float3 extent, out float3 result);
+
+            [SuppressUnmanagedCodeSecurity]
+            [DllImport(NativeLibrary, EntryPoint = "QueryGetIsland", CallingConvention = CallingConvention.Cdecl)]
+            public static extern int GetIsland(IntPtr aiQuery, ref float3 point, ref float3 extent);
+
+            [SuppressUnmanagedCodeSecurity]
+            [DllImport(NativeLibrary, EntryPoint = "QueryEnablePathCache", CallingConvention = CallingConvention.Cdecl)]
+            public static extern int EnablePathCache(IntPtr aiQuery, int capacity);
+
+            [SuppressUnmanagedCodeSecurity]
+            [DllImport(NativeLibrary, EntryPoint = "QueryGetPathCacheStats", CallingConvention = CallingConvention.Cdecl)]
+            public static extern void GetPathCacheStats(IntPtr aiQuery, out int hits, out int misses);
+
+            /// <summary>
+            /// Filter for calls that do not pass one with the query, zero restores the default filter
+            /// </summary>
+            [SuppressUnmanagedCodeSecurity]
+            [DllImport(NativeLibrary, EntryPoint = "QuerySetFilter", CallingConvention = CallingConvention.Cdecl)]
+            public static extern void SetFilter(IntPtr aiQuery, IntPtr filter);
         }
 
         public class Crowd
@@ -157,14 +426,55 @@ namespace AiNav
             [DllImport(NativeLibrary, EntryPoint = "CrowdRequestMoveAgent", CallingConvention = CallingConvention.Cdecl)]
             public static extern int RequestMoveAgent(IntPtr crowd, int idx, ref float3 position);
 
+            /// <summary>
+            /// Requests moves for count agents, agents already moving to the same target are left alone.
+            /// status is optional and receives 1 per agent moving to its target, returns the number of such agents.
+            /// </summary>
+            [SuppressUnmanagedCodeSecurity]
+            [DllImport(NativeLibrary, EntryPoint = "CrowdRequestMoveBatch", CallingConvention = CallingConvention.Cdecl)]
+            public static unsafe extern int RequestMoveBatch(IntPtr crowd, int* indices, float3* targets, int count, int* status);
+
+            /// <summary>
+            /// Moves count agents to the goal of a flow field without path requests, returns the number of agents moving
+            /// </summary>
+            [SuppressUnmanagedCodeSecurity]
+            [DllImport(NativeLibrary, EntryPoint = "CrowdRequestMoveField", CallingConvention = CallingConvention.Cdecl)]
+            public static unsafe extern int RequestMoveField(IntPtr crowd, IntPtr field, int* indices, int count, int* status);
+
+            [SuppressUnmanagedCodeSecurity]
+            [DllImport(NativeLibrary, EntryPoint = "CrowdSetAgentParamsBatch", CallingConvention = CallingConvention.Cdecl)]
+            public static unsafe extern void SetAgentParamsBatch(IntPtr crowd, int* indices, DtAgentParams* agentParams, int count);
+
             [SuppressUnmanagedCodeSecurity]
             [DllImport(NativeLibrary, EntryPoint = "CrowdUpdate", CallingConvention = CallingConvention.Cdecl)]
             public static extern void Update(IntPtr crowd, float dt);
 
+            /// <summary>
+            /// Runs the per agent update phases on threadCount native threads, 1 or less updates on the calling thread only.
+            /// Agent results are identical for any thread count.
+            /// </summary>
+            [SuppressUnmanagedCodeSecurity]
+            [DllImport(NativeLibrary, EntryPoint = "CrowdSetThreadCount", CallingConvention = CallingConvention.Cdecl)]
+            public static extern int SetThreadCount(IntPtr crowd, int threadCount);
+
+            /// <summary>
+            /// Copies the filter into one of the 16 filter slots agents select with QueryFilterType, zero restores the default filter
+            /// </summary>
+            [SuppressUnmanagedCodeSecurity]
+            [DllImport(NativeLibrary, EntryPoint = "CrowdSetFilter", CallingConvention = CallingConvention.Cdecl)]
+            public static extern int SetFilter(IntPtr crowd, int filterType, IntPtr filter);
+
             [SuppressUnmanagedCodeSecurity]
             [DllImport(NativeLibrary, EntryPoint = "CrowdGetAgents", CallingConvention = CallingConvention.Cdecl)]
             public static extern void GetAgents(IntPtr crowd, IntPtr agents);
 
+            /// <summary>
+            /// Writes the state of every active agent into the arrays of states, returns the number of agents written
+            /// </summary>
+            [SuppressUnmanagedCodeSecurity]
+            [DllImport(NativeLibrary, EntryPoint = "CrowdGetAgentStates", CallingConvention = CallingConvention.Cdecl)]
+            public static unsafe extern int GetAgentStates(IntPtr crowd, DtCrowdAgentStates* states);
+
             [SuppressUnmanagedCodeSecurity]
             [DllImport(NativeLibrary, EntryPoint = "CrowdGetAgent", CallingConvention = CallingConvention.Cdecl)]
             public static extern int GetAgent(IntPtr crowd, int idx, IntPtr crowdAgent);